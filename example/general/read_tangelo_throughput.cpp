@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+#include <kettle/kettle.hpp>
+
+/*
+    This example measures how quickly circuits in the tangelo format are read from a file, by parsing
+    the file into a `QuantumCircuit` or into a `CompactCircuit` every time, and by loading the circuit
+    from the caches of `read_tangelo_circuit_cached()` and `read_tangelo_compact_circuit_cached()`.
+
+    The circuit is made mostly of the CNOT, RZ, and H gates that dominate the trotterized circuits
+    produced by tangelo, with a few other gates mixed in.
+*/
+
+auto make_tangelo_like_circuit(std::size_t n_qubits, std::size_t n_gates) -> ket::QuantumCircuit
+{
+    auto prng = std::mt19937 {12345};
+    auto qubit_dist = std::uniform_int_distribution<std::size_t> {0, n_qubits - 1};
+    auto kind_dist = std::uniform_int_distribution<int> {0, 9};
+    auto angle_dist = std::uniform_real_distribution<double> {-M_PI, M_PI};
+
+    auto circuit = ket::QuantumCircuit {n_qubits};
+
+    while (circuit.n_circuit_elements() < n_gates) {
+        const auto target = qubit_dist(prng);
+        const auto kind = kind_dist(prng);
+
+        if (kind < 4) {
+            const auto control = qubit_dist(prng);
+            if (control != target) {
+                circuit.add_cx_gate(control, target);
+            }
+        }
+        else if (kind < 7) {
+            circuit.add_rz_gate(target, angle_dist(prng));
+        }
+        else if (kind < 9) {
+            circuit.add_h_gate(target);
+        }
+        else {
+            circuit.add_rx_gate(target, angle_dist(prng));
+        }
+    }
+
+    return circuit;
+}
+
+auto n_circuit_gates(const ket::QuantumCircuit& circuit) -> std::size_t
+{
+    return circuit.n_circuit_elements();
+}
+
+auto n_circuit_gates(const ket::CompactCircuit& circuit) -> std::size_t
+{
+    return circuit.n_gates();
+}
+
+/*
+    The shortest time taken by `read()` over `n_repetitions` calls, or a negative time if any of
+    the circuits read back has the wrong number of gates.
+*/
+template <typename Function>
+auto best_read_seconds(std::size_t n_repetitions, std::size_t n_gates, Function&& read) -> double
+{
+    auto best_seconds = std::chrono::duration<double>::max();
+    for (std::size_t i {0}; i < n_repetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto circuit = read();
+        const auto stop = std::chrono::steady_clock::now();
+
+        if (n_circuit_gates(circuit) != n_gates) {
+            return -1.0;
+        }
+
+        best_seconds = std::min(best_seconds, std::chrono::duration<double> {stop - start});
+    }
+
+    return best_seconds.count();
+}
+
+auto main() -> int
+{
+    const auto n_qubits = std::size_t {16};
+    const auto n_gates = std::size_t {1'000'000};
+    const auto n_repetitions = std::size_t {5};
+
+    const auto filepath = std::filesystem::temp_directory_path() / "kettle_read_tangelo_throughput.dat";
+    ket::write_tangelo_circuit(make_tangelo_like_circuit(n_qubits, n_gates), filepath);
+
+    const auto n_bytes = std::filesystem::file_size(filepath);
+    const auto cache_dirpath = std::filesystem::temp_directory_path() / "kettle_read_tangelo_throughput_cache";
+
+    const auto parse_seconds = best_read_seconds(n_repetitions, n_gates, [&]() {
+        return ket::read_tangelo_circuit(n_qubits, filepath, 0);
+    });
+
+    const auto compact_parse_seconds = best_read_seconds(n_repetitions, n_gates, [&]() {
+        return ket::read_tangelo_compact_circuit(n_qubits, filepath, 0);
+    });
+
+    // the first call fills the cache, and every later call loads from it
+    const auto cached_seconds = best_read_seconds(n_repetitions + 1, n_gates, [&]() {
+        return ket::read_tangelo_circuit_cached(n_qubits, filepath, 0, cache_dirpath);
+    });
+
+    const auto compact_cached_seconds = best_read_seconds(n_repetitions + 1, n_gates, [&]() {
+        return ket::read_tangelo_compact_circuit_cached(n_qubits, filepath, 0, cache_dirpath);
+    });
+
+    std::filesystem::remove(filepath);
+    std::filesystem::remove_all(cache_dirpath);
+
+    if (parse_seconds < 0.0 || compact_parse_seconds < 0.0 || cached_seconds < 0.0 || compact_cached_seconds < 0.0) {
+        std::cerr << "ERROR: the circuit read back has the wrong number of gates\n";
+        return 1;
+    }
+
+    const auto megabytes = static_cast<double>(n_bytes) / 1.0e6;
+
+    std::cout << "file size       : " << megabytes << " MB\n";
+    std::cout << "number of gates : " << n_gates << '\n';
+    std::cout << "parse time      : " << parse_seconds << " s\n";
+    std::cout << "throughput      : " << megabytes / parse_seconds << " MB/s\n";
+    std::cout << "                : " << static_cast<double>(n_gates) / parse_seconds / 1.0e6 << " million gates/s\n";
+    std::cout << "compact parse   : " << compact_parse_seconds << " s\n";
+    std::cout << "throughput      : " << megabytes / compact_parse_seconds << " MB/s\n";
+    std::cout << "cached time     : " << cached_seconds << " s\n";
+    std::cout << "compact cached  : " << compact_cached_seconds << " s\n";
+
+    return 0;
+}
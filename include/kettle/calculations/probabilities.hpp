@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <vector>
@@ -50,4 +51,23 @@ auto calculate_probabilities(
     const QuantumNoise* noise = nullptr
 ) -> std::map<std::string, double>;
 
+/*
+    Calculates the exact marginal probability distribution over the qubits in `qubit_indices`,
+    with all the other qubits traced out.
+
+    The output is a dense vector of 2^m probabilities, where `m` is the number of qubits in
+    `qubit_indices`. Bit `k` of an index into the output corresponds to the qubit at `qubit_indices[k]`,
+    so the output has the same little endian layout as `calculate_probabilities_raw()`.
+
+    NOTE: unlike the `marginal_qubits` of `perform_measurements_as_counts_marginal()`, which are the
+    qubits that get traced out, the `qubit_indices` here are the qubits that are kept.
+
+    If `noise` is provided, only the noise of the kept qubits affects the result.
+*/
+auto calculate_marginal_probabilities(
+    const QuantumState& state,
+    const std::vector<std::size_t>& qubit_indices,
+    const QuantumNoise* noise = nullptr
+) -> std::vector<double>;
+
 }  // namespace ket
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 #include <iterator>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "kettle/circuit/control_flow_predicate.hpp"
@@ -54,8 +56,26 @@ public:
         return elements_[index];
     }
 
+    /*
+        A counter that changes every time the circuit is modified, for anything that keeps a view of the
+        circuit up to date (for example, `CircuitDag`). Adding circuit elements increases it by the number
+        of elements added, and every other modification (removing an element, changing the value of a
+        parameter, and so on) increases it by one.
+    */
+    [[nodiscard]]
+    constexpr auto generation() const noexcept -> std::size_t
+    {
+        return generation_;
+    }
+
     void pop_back();
 
+    /*
+        Reserves space for at least `n_elements` circuit elements, so that adding that many
+        elements does not reallocate the underlying storage.
+    */
+    void reserve_circuit_elements(std::size_t n_elements);
+
     [[nodiscard]]
     constexpr auto begin() const noexcept
     {
@@ -225,6 +245,17 @@ public:
     template <ControlAndTargetIndices Container = ControlAndTargetIndicesIList>
     void add_cu_gate(const Matrix2X2& gate, const Container& pairs);
 
+    /*
+        Add a gate that applies exp(-i angle P / 2), where P is the Pauli string `pauli_string`; for example,
+        the Pauli string `Z` gives the same gate as an RZ gate with the same angle.
+
+        The Pauli string must act on the same number of qubits as the circuit, must have at least one
+        non-identity term, and its phase must be +1 or -1 (so that P is Hermitian).
+    */
+    void add_pauli_rotation_gate(const SparsePauliString& pauli_string, double angle);
+    auto add_pauli_rotation_gate(const SparsePauliString& pauli_string, double initial_angle, ket::param::parameterized key) -> ket::param::ParameterID;
+    void add_pauli_rotation_gate(const SparsePauliString& pauli_string, const ket::param::ParameterID& id);
+
     /*
         If no bit is provided to `add_m_gate()`, then the measured bit is assigned to the same
         index as the qubit's index.
@@ -355,12 +386,33 @@ public:
 //        double tolerance = MATCHING_PARAMETER_VALUE_TOLERANCE
     );
 
+    /*
+        Add a repeat statement to the `QuantumCircuit`.
+
+        This statement executes `subcircuit` a total of `n_repetitions` times in a row, while only
+        storing a single copy of it.
+    */
+    void add_repeat_statement(std::size_t n_repetitions, QuantumCircuit subcircuit);
+
+    /*
+        Add a controlled block to the `QuantumCircuit`.
+
+        This statement executes `subcircuit` only on the part of the state where all the qubits in
+        `control_qubits` are `1`. The gates in `subcircuit` are simulated as they are, on a view of
+        that part of the state, rather than being rewritten as controlled gates.
+
+        The `subcircuit` cannot act on any of the control qubits, or contain any measurement gates.
+    */
+    template <QubitIndices Container = QubitIndicesIList>
+    void add_controlled_block(const Container& control_qubits, QuantumCircuit subcircuit);
+
     void add_classical_register_circuit_logger();
 
     void add_statevector_circuit_logger();
 
     void add_circuit_logger(CircuitLogger circuit_logger);
 
+    friend class CircuitAccess_;
     friend auto append_circuits(QuantumCircuit left, const QuantumCircuit& right) -> QuantumCircuit;
     friend void extend_circuit(QuantumCircuit& left, const QuantumCircuit& right);
     friend auto transpile_to_primitive(const QuantumCircuit& circuit, double tolerance_sq) -> QuantumCircuit;
@@ -371,11 +423,22 @@ private:
     std::vector<CircuitElement> elements_;
     ket::param::ParameterDataMap parameter_data_;
     std::size_t parameter_count_ {0};
+    std::size_t generation_ {0};
+
+    template <typename Element>
+    void emplace_back_element_(Element&& element)
+    {
+        elements_.emplace_back(std::forward<Element>(element));
+        ++generation_;
+    }
 
     void check_qubit_range_(std::size_t target_index, std::string_view qubit_name, std::string_view gate_name) const;
+    void check_qubit_range_(std::size_t target_index, std::string_view qubit_name, ket::Gate gate) const;
 
     void check_bit_range_(std::size_t bit_index) const;
 
+    void check_pauli_rotation_string_(const SparsePauliString& pauli_string) const;
+
     void add_one_target_gate_(std::size_t target_index, ket::Gate gate);
     void add_one_target_one_angle_gate_(std::size_t target_index, double angle, ket::Gate gate);
     void add_one_control_one_target_gate_(std::size_t control_index, std::size_t target_index, ket::Gate gate);
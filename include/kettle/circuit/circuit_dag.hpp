@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+
+/*
+    This header file contains the `CircuitDag` class, a dependency view of the elements of a `QuantumCircuit`.
+
+    A `QuantumCircuit` stores its elements as a flat list, in the order they were added. The `CircuitDag`
+    adds the dependencies between these elements:
+      - the wire of each qubit (and each classical bit) holds the indices of the elements that act on it,
+        in order
+      - the predecessors of an element are the elements directly before it on any of its wires, and the
+        successors are the elements directly after it on any of its wires
+      - the ASAP (as soon as possible) layer of an element is one more than the largest layer of its
+        predecessors; elements in the same layer act on different wires, and can be applied in any order
+
+    A measurement gate acts on both its qubit and its classical bit. Control flow statements and circuit
+    loggers act on every wire, and separate everything before them from everything after them.
+
+    The view only refers to elements by their index in the circuit, and building it takes time proportional
+    to the number of elements. The view can be kept in sync with `sync()`; if elements were only added to
+    the circuit since the last call, it only processes the new elements, and otherwise it rebuilds the view.
+*/
+
+namespace ket
+{
+
+class CircuitDag
+{
+public:
+    explicit CircuitDag(const QuantumCircuit& circuit);
+
+    /*
+        Updates the view to match `circuit`, which must be the circuit the view was built from. The
+        generation of the circuit tells whether elements were only added since the last call; any other
+        change (such as removing elements and then adding new ones) rebuilds the view.
+    */
+    void sync(const QuantumCircuit& circuit);
+
+    [[nodiscard]]
+    constexpr auto n_qubits() const noexcept -> std::size_t
+    {
+        return n_qubits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_bits() const noexcept -> std::size_t
+    {
+        return n_bits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_nodes() const noexcept -> std::size_t
+    {
+        return layers_.size();
+    }
+
+    [[nodiscard]]
+    constexpr auto n_layers() const noexcept -> std::size_t
+    {
+        return layer_nodes_.size();
+    }
+
+    [[nodiscard]]
+    auto qubit_wire(std::size_t qubit) const -> const std::vector<std::size_t>&;
+
+    [[nodiscard]]
+    auto bit_wire(std::size_t bit) const -> const std::vector<std::size_t>&;
+
+    [[nodiscard]]
+    auto predecessors(std::size_t i_node) const -> const std::vector<std::size_t>&;
+
+    [[nodiscard]]
+    auto successors(std::size_t i_node) const -> const std::vector<std::size_t>&;
+
+    [[nodiscard]]
+    auto layer(std::size_t i_node) const -> std::size_t;
+
+    /*
+        The indices of the elements in the ASAP layer `i_layer`, in increasing order.
+    */
+    [[nodiscard]]
+    auto layer_nodes(std::size_t i_layer) const -> const std::vector<std::size_t>&;
+
+private:
+    std::size_t n_qubits_;
+    std::size_t n_bits_;
+
+    // the generation of the circuit the last time the view was synced with it
+    std::size_t generation_ {0};
+
+    // the first `n_qubits_` wires belong to the qubits, and the rest to the classical bits
+    std::vector<std::vector<std::size_t>> wires_;
+    std::vector<std::vector<std::size_t>> node_wires_;
+    std::vector<std::vector<std::size_t>> predecessors_;
+    std::vector<std::vector<std::size_t>> successors_;
+    std::vector<std::size_t> layers_;
+    std::vector<std::vector<std::size_t>> layer_nodes_;
+
+    void rebuild_(const QuantumCircuit& circuit);
+    void push_back_(const CircuitElement& element);
+};
+
+}  // namespace ket
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <utility>
 #include <variant>
 
 #include "kettle/gates/primitive_gate.hpp"
@@ -28,6 +29,11 @@ public:
         : element_ {ginfo}
     {}
 
+    // NOLINTNEXTLINE(*-explicit-*)
+    CircuitElement(GateInfo&& ginfo)
+        : element_ {std::move(ginfo)}
+    {}
+
     // NOLINTNEXTLINE(*-explicit-*)
     CircuitElement(ClassicalIfStatement instruction)
         : element_ {std::move(instruction)}
@@ -38,6 +44,16 @@ public:
         : element_ {std::move(instruction)}
     {}
 
+    // NOLINTNEXTLINE(*-explicit-*)
+    CircuitElement(RepeatStatement instruction)
+        : element_ {std::move(instruction)}
+    {}
+
+    // NOLINTNEXTLINE(*-explicit-*)
+    CircuitElement(ControlledBlock instruction)
+        : element_ {std::move(instruction)}
+    {}
+
     // NOLINTNEXTLINE(*explicit*)
     CircuitElement(CircuitLogger logger)
         : element_ {std::move(logger)}
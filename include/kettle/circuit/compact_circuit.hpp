@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/matrix2x2.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/parameter/parameter_expression.hpp"
+
+/*
+    This header file contains the `CompactCircuit` class, a memory-efficient way to store a circuit made
+    only of gates.
+
+    Each `GateInfo` instance in a `QuantumCircuit` holds room for every argument that any gate might need,
+    and up to three heap-allocated objects; copying a gate can allocate memory. In a `CompactCircuit`,
+    each gate is a 16-byte `CompactGate` record, and anything that does not fit in the record is stored
+    in pools owned by the circuit:
+      - the angles of gates with a fixed angle
+      - the 2x2 matrices of U and CU gates
+      - the parameter expressions of parameterized gates
+      - the Pauli strings of PAULI_ROT gates
+
+    The records refer to these objects by their index in the pool. Since the records are trivially
+    copyable, copying, iterating over, and extending a `CompactCircuit` is as cheap as it is for a plain
+    array of integers. A matrix is only stored once, no matter how many gates use it; the matrices of
+    the controlled circuits used in QPE are usually the same few matrices, repeated many times.
+
+    A `CompactCircuit` can be simulated directly, without decoding its gates; see `simulate()`.
+
+    A `CompactCircuit` cannot hold control flow statements or circuit loggers.
+*/
+
+namespace ket
+{
+
+/*
+    The meaning of the arguments of a `CompactGate` depend on the gate:
+      - for single-qubit gates, `arg0` is the target qubit
+      - for double-qubit gates, `arg0` is the control qubit and `arg1` is the target qubit
+      - for M gates, `arg0` is the qubit and `arg1` is the classical bit
+      - for PAULI_ROT gates, `arg0` is the index of the Pauli string
+
+    For gates with an angle, `payload` is the index of the angle, or the index of the parameter expression
+    if the gate is parameterized. For U and CU gates, `payload` is the index of the matrix.
+*/
+struct CompactGate
+{
+    Gate gate;
+    bool is_parameterized;
+    std::uint16_t unused;
+    std::uint32_t arg0;
+    std::uint32_t arg1;
+    std::uint32_t payload;
+};
+
+static_assert(sizeof(CompactGate) == 16);
+static_assert(std::is_trivially_copyable_v<CompactGate>);
+
+class CompactCircuit
+{
+public:
+    explicit CompactCircuit(std::size_t n_qubits, std::size_t n_bits);
+
+    explicit CompactCircuit(std::size_t n_qubits);
+
+    /*
+        Encodes the gates of `circuit`; throws a `std::runtime_error` if it holds a control flow statement
+        or a circuit logger.
+    */
+    explicit CompactCircuit(const QuantumCircuit& circuit);
+
+    [[nodiscard]]
+    constexpr auto n_qubits() const noexcept -> std::size_t
+    {
+        return n_qubits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_bits() const noexcept -> std::size_t
+    {
+        return n_bits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_gates() const noexcept -> std::size_t
+    {
+        return gates_.size();
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](std::size_t index) const noexcept -> const CompactGate&
+    {
+        return gates_[index];
+    }
+
+    [[nodiscard]]
+    constexpr auto begin() const noexcept
+    {
+        return std::begin(gates_);
+    }
+
+    [[nodiscard]]
+    constexpr auto end() const noexcept
+    {
+        return std::end(gates_);
+    }
+
+    [[nodiscard]]
+    constexpr auto parameter_data_map() const noexcept -> const ket::param::ParameterDataMap&
+    {
+        return parameter_data_;
+    }
+
+    /*
+        The pools that the records refer to; for example, the angle of a gate `gate` with a fixed angle
+        is `angles()[gate.payload]`.
+    */
+    [[nodiscard]]
+    constexpr auto angles() const noexcept -> const std::vector<double>&
+    {
+        return angles_;
+    }
+
+    [[nodiscard]]
+    constexpr auto unitaries() const noexcept -> const std::vector<Matrix2X2>&
+    {
+        return unitaries_;
+    }
+
+    [[nodiscard]]
+    constexpr auto parameter_expressions() const noexcept -> const std::vector<ket::param::ParameterExpression>&
+    {
+        return parameter_expressions_;
+    }
+
+    [[nodiscard]]
+    constexpr auto pauli_strings() const noexcept -> const std::vector<SparsePauliString>&
+    {
+        return pauli_strings_;
+    }
+
+    /*
+        The objects in the pools that `gate` refers to; each throws a `std::runtime_error` if `gate` does
+        not refer to that kind of object.
+    */
+    [[nodiscard]]
+    auto angle(const CompactGate& gate) const -> double;
+
+    [[nodiscard]]
+    auto unitary(const CompactGate& gate) const -> const Matrix2X2&;
+
+    [[nodiscard]]
+    auto parameter_expression(const CompactGate& gate) const -> const ket::param::ParameterExpression&;
+
+    [[nodiscard]]
+    auto pauli_string(const CompactGate& gate) const -> const SparsePauliString&;
+
+    /*
+        Decodes the gate at `index` back into a `GateInfo` instance.
+    */
+    [[nodiscard]]
+    auto gate_info(std::size_t index) const -> GateInfo;
+
+    /*
+        Encodes `gate_info` and appends it to the circuit; throws a `std::runtime_error` if the qubit or bit
+        indices do not fit the circuit, or if the gate is parameterized. Parameterized gates can only enter
+        a `CompactCircuit` through a `QuantumCircuit`, which keeps track of their parameters.
+    */
+    void push_back(const GateInfo& gate_info);
+
+    /*
+        Reserves space for at least `n_gates` gates, so that adding that many gates does not reallocate
+        the records.
+    */
+    void reserve(std::size_t n_gates);
+
+    /*
+        Decodes all the gates into a new `QuantumCircuit` instance.
+    */
+    [[nodiscard]]
+    auto to_circuit() const -> QuantumCircuit;
+
+    friend class CircuitAccess_;
+    friend void extend_circuit(CompactCircuit& left, const CompactCircuit& right);
+
+private:
+    // the bits of the elements of a matrix in the pool; matrices are only shared if they are exactly equal
+    using UnitaryKey_ = std::array<std::uint64_t, 8>;
+
+    std::size_t n_qubits_;
+    std::size_t n_bits_;
+    std::vector<CompactGate> gates_;
+    std::vector<double> angles_;
+    std::vector<Matrix2X2> unitaries_;
+    std::vector<ket::param::ParameterExpression> parameter_expressions_;
+    std::vector<SparsePauliString> pauli_strings_;
+    ket::param::ParameterDataMap parameter_data_;
+    std::size_t parameter_count_ {0};
+    std::map<UnitaryKey_, std::uint32_t> unitary_indices_;
+
+    void push_back_(const GateInfo& gate_info);
+
+    /*
+        Returns the index of `unitary` in the pool, and adds it to the pool if it is not there yet.
+    */
+    auto add_unitary_(const Matrix2X2& unitary) -> std::uint32_t;
+
+    /*
+        Rebuilds the lookup from the matrices in the pool to their indices, after the pool was filled in
+        directly; if a matrix appears more than once, its first index is used.
+    */
+    void index_unitaries_();
+};
+
+/*
+    Appends the gates of `right` to the end of `left`, and merges their parameters; the records are copied
+    over in bulk, and only the pool indices are changed. The matrices of `right` that are already in the
+    pool of `left` are not added again.
+*/
+void extend_circuit(CompactCircuit& left, const CompactCircuit& right);
+
+auto append_circuits(CompactCircuit left, const CompactCircuit& right) -> CompactCircuit;
+
+}  // namespace ket
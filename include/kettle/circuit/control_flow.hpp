@@ -1,11 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <variant>
+#include <vector>
 
 #include "kettle/circuit/classical_register.hpp"
 #include "kettle/circuit/control_flow_predicate.hpp"
-#include "kettle/common/clone_ptr.hpp"
+#include "kettle/common/cow_ptr.hpp"
 
 
 namespace ket
@@ -24,6 +26,8 @@ class QuantumCircuit;
     if-statement, while-loop-statement, and do-while-loop-statement. It is the
     responsibility of other sections of the codebase that interface with control
     flow statements to handle the logic of how the circuit is treated.
+
+    Copies of a statement share the same circuit, which is only copied if one of them modifies it.
 */
 class ClassicalOneBranchBooleanStatement
 {
@@ -42,7 +46,7 @@ public:
     }
 
     [[nodiscard]]
-    auto circuit() const -> const ket::ClonePtr<ket::QuantumCircuit>&
+    auto circuit() const -> const ket::CowPtr<ket::QuantumCircuit>&
     {
         return circuit_;
     }
@@ -55,7 +59,7 @@ public:
 
 private:
     ket::ControlFlowPredicate control_flow_predicate_;
-    ket::ClonePtr<ket::QuantumCircuit> circuit_;
+    ket::CowPtr<ket::QuantumCircuit> circuit_;
 };
 
 
@@ -88,13 +92,13 @@ public:
     }
 
     [[nodiscard]]
-    auto if_circuit() const -> const ket::ClonePtr<ket::QuantumCircuit>&
+    auto if_circuit() const -> const ket::CowPtr<ket::QuantumCircuit>&
     {
         return if_circuit_;
     }
 
     [[nodiscard]]
-    auto else_circuit() const -> const ket::ClonePtr<ket::QuantumCircuit>&
+    auto else_circuit() const -> const ket::CowPtr<ket::QuantumCircuit>&
     {
         return else_circuit_;
     }
@@ -107,8 +111,77 @@ public:
 
 private:
     ket::ControlFlowPredicate control_flow_predicate_;
-    ket::ClonePtr<ket::QuantumCircuit> if_circuit_;
-    ket::ClonePtr<ket::QuantumCircuit> else_circuit_;
+    ket::CowPtr<ket::QuantumCircuit> if_circuit_;
+    ket::CowPtr<ket::QuantumCircuit> else_circuit_;
+};
+
+
+/*
+    A statement that executes its circuit `n_repetitions` times in a row, without storing the
+    repeated copies; for example, it can hold the circuit for U, and apply U^(2^k).
+*/
+class RepeatStatement
+{
+public:
+    RepeatStatement(
+        std::size_t n_repetitions,
+        std::unique_ptr<ket::QuantumCircuit> circuit
+    )
+        : n_repetitions_ {n_repetitions}
+        , circuit_ {std::move(circuit)}
+    {}
+
+    [[nodiscard]]
+    constexpr auto n_repetitions() const noexcept -> std::size_t
+    {
+        return n_repetitions_;
+    }
+
+    [[nodiscard]]
+    auto circuit() const -> const ket::CowPtr<ket::QuantumCircuit>&
+    {
+        return circuit_;
+    }
+
+private:
+    std::size_t n_repetitions_;
+    ket::CowPtr<ket::QuantumCircuit> circuit_;
+};
+
+
+/*
+    A statement that executes its circuit only on the part of the state where all of its control
+    qubits are `1`. This has the same effect as replacing every gate in the circuit with a version
+    controlled by all the control qubits, without rewriting any of the gates.
+
+    The circuit cannot act on any of the control qubits, or contain any measurement gates.
+*/
+class ControlledBlock
+{
+public:
+    ControlledBlock(
+        std::vector<std::size_t> control_qubits,
+        std::unique_ptr<ket::QuantumCircuit> circuit
+    )
+        : control_qubits_ {std::move(control_qubits)}
+        , circuit_ {std::move(circuit)}
+    {}
+
+    [[nodiscard]]
+    constexpr auto control_qubits() const noexcept -> const std::vector<std::size_t>&
+    {
+        return control_qubits_;
+    }
+
+    [[nodiscard]]
+    auto circuit() const -> const ket::CowPtr<ket::QuantumCircuit>&
+    {
+        return circuit_;
+    }
+
+private:
+    std::vector<std::size_t> control_qubits_;
+    ket::CowPtr<ket::QuantumCircuit> circuit_;
 };
 
 
@@ -125,6 +198,16 @@ public:
         : instruction_ {std::move(instruction)}
     {}
 
+    // NOLINTNEXTLINE(*explicit*)
+    ClassicalControlFlowInstruction(RepeatStatement instruction)
+        : instruction_ {std::move(instruction)}
+    {}
+
+    // NOLINTNEXTLINE(*explicit*)
+    ClassicalControlFlowInstruction(ControlledBlock instruction)
+        : instruction_ {std::move(instruction)}
+    {}
+
     [[nodiscard]]
     constexpr auto is_if_statement() const -> bool
     {
@@ -137,6 +220,18 @@ public:
         return std::holds_alternative<ClassicalIfElseStatement>(instruction_);
     }
 
+    [[nodiscard]]
+    constexpr auto is_repeat_statement() const -> bool
+    {
+        return std::holds_alternative<RepeatStatement>(instruction_);
+    }
+
+    [[nodiscard]]
+    constexpr auto is_controlled_block() const -> bool
+    {
+        return std::holds_alternative<ControlledBlock>(instruction_);
+    }
+
     [[nodiscard]]
     constexpr auto get_if_statement() const -> const ClassicalIfStatement&
     {
@@ -149,8 +244,20 @@ public:
         return std::get<ClassicalIfElseStatement>(instruction_);
     }
 
+    [[nodiscard]]
+    constexpr auto get_repeat_statement() const -> const RepeatStatement&
+    {
+        return std::get<RepeatStatement>(instruction_);
+    }
+
+    [[nodiscard]]
+    constexpr auto get_controlled_block() const -> const ControlledBlock&
+    {
+        return std::get<ControlledBlock>(instruction_);
+    }
+
 private:
-    std::variant<ClassicalIfStatement, ClassicalIfElseStatement> instruction_;
+    std::variant<ClassicalIfStatement, ClassicalIfElseStatement, RepeatStatement, ControlledBlock> instruction_;
 };
 
 }  // namespace ket
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace ket
 {
 
@@ -9,4 +11,12 @@ void extend_circuit(QuantumCircuit& left, const QuantumCircuit& right);
 
 auto append_circuits(QuantumCircuit left, const QuantumCircuit& right) -> QuantumCircuit;
 
+/*
+    Creates a new circuit from the circuit elements in the half-open range [i_begin, i_end) of `circuit`.
+
+    The new circuit has the same number of qubits and bits as `circuit`, and keeps all of its parameters,
+    so the sliced circuit can be simulated, or joined back together with `extend_circuit()`.
+*/
+auto slice_circuit(const QuantumCircuit& circuit, std::size_t i_begin, std::size_t i_end) -> QuantumCircuit;
+
 }  // namespace ket
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "kettle/common/tolerance.hpp"
+
+/*
+    This header file contains the `collapse_pauli_rotation_gadgets()` function, which takes an
+    existing `QuantumCircuit` instance, and creates a new `QuantumCircuit` instance where each
+    sequence of primitive gates that applies exp(-i theta P / 2) for a Pauli string P is replaced
+    by a single PAULI_ROT gate.
+
+    The recognized sequences are the ones produced by tangelo (and by `transpile_to_primitive()`):
+      - H on each qubit with an X term, and RX(pi/2) on each qubit with a Y term
+      - CX gates from each qubit of P to the next higher one
+      - RZ(theta) on the highest qubit of P
+      - the same CX gates in reverse, followed by H for the X terms and RX(-pi/2) for the Y terms
+
+    Only sequences with at least two qubits and a fixed (non-parameterized) RZ angle are replaced.
+    The RX angles must match pi/2 and -pi/2 to within `tolerance`.
+*/
+
+namespace ket
+{
+
+class QuantumCircuit;
+
+auto collapse_pauli_rotation_gadgets(
+    const QuantumCircuit& circuit,
+    double tolerance = ket::PAULI_ROTATION_GADGET_ANGLE_TOLERANCE
+) -> QuantumCircuit;
+
+}  // namespace ket
@@ -21,6 +21,23 @@ auto make_binary_controlled_circuit_naive(
     const Container& mapped_qubits
 ) -> ket::QuantumCircuit;
 
+/*
+    This function creates the same binary-controlled circuit as `make_binary_controlled_circuit_naive()`,
+    but each power of the subcircuit is added as a `ControlledBlock` that holds a single `RepeatStatement`.
+    The new circuit only stores one copy of the subcircuit per control qubit, and none of its gates are
+    rewritten into controlled gates.
+
+    The new circuit holds control flow statements instead of gates, so it cannot be used with the tools
+    that only work on gates (such as `CheckpointSimulator` and the adjoint gradient).
+*/
+template <QubitIndices Container = QubitIndicesIList>
+auto make_binary_controlled_block_circuit(
+    const QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const Container& control_qubits,
+    const Container& mapped_qubits
+) -> ket::QuantumCircuit;
+
 /*
     This function creates a binary-controlled circuit by accepting a container of
     increasing binary powers of the subcircuit in question.
@@ -22,4 +22,20 @@ auto make_multiplicity_controlled_circuit(
     const Container& mapped_qubits
 ) -> ket::QuantumCircuit;
 
+/*
+    Creates a circuit with `n_new_qubits` qubits, that holds a single `ControlledBlock` controlled by
+    `control_qubits`, which applies `subcircuit` with its qubits moved to `mapped_qubits`.
+
+    This has the same effect as `make_multiplicity_controlled_circuit()`, but none of the gates are
+    rewritten into controlled gates; the simulator applies them as they are, on the part of the state
+    where all the control qubits are `1`.
+*/
+template <QubitIndices Container = QubitIndicesIList>
+auto make_controlled_block_circuit(
+    const ket::QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const Container& control_qubits,
+    const Container& mapped_qubits
+) -> ket::QuantumCircuit;
+
 }  // namespace ket
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    This header file contains the `optimize_circuit()` function, which takes an existing `QuantumCircuit`
+    instance, and creates a new `QuantumCircuit` instance that performs the same operation with fewer
+    gates, by removing redundant patterns with local (peephole) rewrites:
+      - pairs of gates that undo each other are removed (for example, CX-CX, H-H, X-X, S-SDAG)
+      - consecutive rotations of the same kind on the same qubits are merged (for example, RZ(a)-RZ(b)
+        becomes RZ(a + b)), and rotations with an angle of zero are removed
+
+    Two gates are consecutive if no gate between them acts on any of their qubits. At the highest level,
+    a gate can also be moved past gates that it commutes with, to find more of these pairs. For example,
+    the Z-diagonal gates commute with each other and with the control qubit of any controlled gate, and
+    X-rotations commute with the target qubit of a CX gate.
+
+    Parameterized gates are never merged or removed, but other gates can be moved past them.
+
+    Measurement gates act like any other gate that does not commute with anything on its qubit. Nothing
+    is moved past a control flow statement or a circuit logger; the subcircuits of control flow statements
+    are optimized separately.
+*/
+
+namespace ket
+{
+
+class QuantumCircuit;
+
+enum class CircuitOptimizationLevel : std::uint8_t
+{
+    NONE,       // the circuit is copied unchanged
+    CANCEL,     // remove and merge consecutive gates
+    COMMUTE     // also move gates past the gates they commute with
+};
+
+struct CircuitOptimizationStatistics
+{
+    std::size_t n_cancelled_pairs {0};          // pairs of gates that undo each other
+    std::size_t n_merged_rotations {0};         // pairs of rotations merged into a single rotation
+    std::size_t n_removed_zero_rotations {0};   // rotations removed because their angle is zero
+    std::size_t n_commuted_matches {0};         // of the above, the ones only found by commuting gates
+};
+
+auto optimize_circuit(
+    const QuantumCircuit& circuit,
+    CircuitOptimizationLevel level = CircuitOptimizationLevel::COMMUTE
+) -> QuantumCircuit;
+
+/*
+    Same as above, and adds the number of times each rule was applied to `statistics`.
+*/
+auto optimize_circuit(
+    const QuantumCircuit& circuit,
+    CircuitOptimizationLevel level,
+    CircuitOptimizationStatistics& statistics
+) -> QuantumCircuit;
+
+}  // namespace ket
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+
+/*
+    The CowPtr class is a thin wrapper around `std::shared_ptr<T>` that copies the data pointed to
+    only when it is about to be modified while other instances still point to it (copy-on-write).
+
+    Copying a CowPtr instance is O(1), no matter how large the data is. Reading the data through a
+    `const` instance never copies it. Reading it through a non-`const` instance hands out a mutable
+    reference, and so first gives the instance its own copy of the data if the data is shared.
+
+    This is used in situations where, like `ClonePtr<T>`, each instance should behave as if it holds
+    its own version of the data, but where the data is large, rarely modified, and often copied (such
+    as the subcircuits of control flow statements).
+
+    Like `std::shared_ptr<T>`, instances that share data can be copied and read from different threads
+    at the same time, but an instance must not be modified while it is being copied.
+*/
+
+namespace ket
+{
+
+template <typename T>
+class CowPtr
+{
+public:
+    explicit CowPtr(T data)
+        : data_ {std::make_shared<T>(std::move(data))}
+    {}
+
+    explicit CowPtr(std::unique_ptr<T> data)
+        : data_ {std::move(data)}
+    {}
+
+    auto operator*() const -> const T&
+    {
+        return *data_;
+    }
+
+    auto operator*() -> T&
+    {
+        if (data_ && data_.use_count() > 1) {
+            data_ = std::make_shared<T>(*data_);
+        }
+
+        return *data_;
+    }
+
+    explicit operator bool() const
+    {
+        return data_ != nullptr;
+    }
+
+    /*
+        Whether this instance and `other` currently point to the same data.
+    */
+    [[nodiscard]]
+    auto shares_data_with(const CowPtr& other) const noexcept -> bool
+    {
+        return data_ == other.data_;
+    }
+
+private:
+    std::shared_ptr<T> data_;
+};
+
+}  // namespace ket
@@ -8,5 +8,8 @@ constexpr inline auto CONSTRUCTION_NORMALIZATION_TOLERANCE = double {1.0e-6};
 constexpr inline auto COMPLEX_ALMOST_EQ_TOLERANCE_SQ = double {1.0e-6};
 constexpr inline auto MATRIX_2X2_SQRT_TOLERANCE = double {1.0e-6};
 constexpr inline auto MATCHING_PARAMETER_VALUE_TOLERANCE = double {1.0e-6};
+constexpr inline auto PAULI_OPERATOR_SIMPLIFY_TOLERANCE = double {1.0e-12};
+constexpr inline auto PAULI_ROTATION_GADGET_ANGLE_TOLERANCE = double {1.0e-8};
+constexpr inline auto OPTIMIZE_CIRCUIT_ANGLE_TOLERANCE = double {1.0e-12};
 
 }  // namespace ket
@@ -6,6 +6,7 @@
 
 #include "kettle/common/matrix2x2.hpp"
 #include "kettle/common/clone_ptr.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
 #include "kettle/parameter/parameter_expression.hpp"
 
 namespace ket
@@ -48,6 +49,7 @@ enum class Gate : std::uint8_t
     CP,
     U,
     CU,
+    PAULI_ROT,
     M
 };
 
@@ -67,6 +69,8 @@ enum class Gate : std::uint8_t
 
     The U and CU primitive gates can hold a pointer to a unitary 2x2 matrix.
 
+    The PAULI_ROT primitive gate applies exp(-i theta P / 2) for a Pauli string P; it holds a pointer
+    to the Pauli string, and its angle is stored the same way as for the other angle gates.
 */
 struct GateInfo
 {
@@ -76,6 +80,7 @@ struct GateInfo
     double arg2;
     ket::ClonePtr<Matrix2X2> unitary_ptr;
     ket::ClonePtr<ket::param::ParameterExpression> param_expression_ptr;
+    ket::ClonePtr<ket::SparsePauliString> pauli_string_ptr;
 };
 
 }  // namespace ket
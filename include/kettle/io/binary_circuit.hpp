@@ -0,0 +1,64 @@
+#pragma once
+
+#include <filesystem>
+#include <iostream>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/compact_circuit.hpp"
+
+/*
+    This header file contains functions to save and load quantum circuits in a binary format. It is
+    meant as a cache for circuits that are expensive to parse from a text format (like the tangelo
+    format), and not to be read by people or other programs.
+
+    The file starts with a 32-byte header:
+      - bytes [0, 8): the magic string "KETCIRCT"
+      - bytes [8, 12): the version of the format, as a `std::uint32_t`
+      - bytes [12, 16): the byte order mark `0x01020304`, as a `std::uint32_t`
+      - bytes [16, 24): the number of bytes in the rest of the file, as a `std::uint64_t`
+      - bytes [24, 32): a checksum of the rest of the file, as a `std::uint64_t`
+
+    It is followed by the circuit: its number of qubits and bits, its parameters, and then each of
+    its circuit elements in order. Every gate keeps its unitary matrix, parameter expression, and
+    Pauli string, and the circuits inside control flow statements are written out in full.
+
+    A loaded circuit goes through the same checks as a circuit built with the member functions of
+    `QuantumCircuit`, so a corrupted file throws instead of producing an invalid circuit.
+
+    The circuit loggers are saved as placeholders; anything they have already logged is not saved.
+
+    A `CompactCircuit` is saved with the same header, except that the magic string is "KETCMPCT". Its
+    gate records, angles, and matrices are written as raw arrays, so loading them is little more than
+    a copy; only the parameter expressions and Pauli strings are written one at a time. Every loaded
+    record is checked against the circuit and its pools.
+
+    All the numbers are written in the byte order of the machine that saves the file; the byte order
+    mark lets the loading functions reject files written on a machine with a different byte order.
+*/
+
+namespace ket
+{
+
+void save_circuit_binary(std::ostream& outstream, const QuantumCircuit& circuit);
+
+/*
+    The entire file is written with a single system call.
+*/
+void save_circuit_binary(const std::filesystem::path& filepath, const QuantumCircuit& circuit);
+
+auto load_circuit_binary(std::istream& instream) -> QuantumCircuit;
+
+/*
+    The file is memory mapped, and the circuit is built directly from the mapped bytes.
+*/
+auto load_circuit_binary(const std::filesystem::path& filepath) -> QuantumCircuit;
+
+void save_compact_circuit_binary(std::ostream& outstream, const CompactCircuit& circuit);
+
+void save_compact_circuit_binary(const std::filesystem::path& filepath, const CompactCircuit& circuit);
+
+auto load_compact_circuit_binary(std::istream& instream) -> CompactCircuit;
+
+auto load_compact_circuit_binary(const std::filesystem::path& filepath) -> CompactCircuit;
+
+}  // namespace ket
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+
+#include "kettle/state/state.hpp"
+
+/*
+    This header file contains functions to save and load statevectors in a binary format, which
+    is much faster to read and write than the text format of `save_statevector()` and
+    `load_statevector()`, but not meant to be read by people or other programs.
+
+    The file starts with a 32-byte header:
+      - bytes [0, 8): the magic string "KETSTATE"
+      - bytes [8, 12): the version of the format, as a `std::uint32_t`
+      - bytes [12, 16): the byte order mark `0x01020304`, as a `std::uint32_t`
+      - bytes [16, 20): the number of qubits, as a `std::uint32_t`
+      - bytes [20, 24): the number of bytes in each real number (8 or 4), as a `std::uint32_t`
+      - bytes [24, 32): a checksum of the amplitudes, as a `std::uint64_t`
+
+    It is followed by the amplitudes of the state in little endian order, with the real and imaginary
+    parts of each amplitude next to each other (the layout of `std::complex<double>`, or of
+    `std::complex<float>` with single precision).
+
+    All the numbers are written in the byte order of the machine that saves the file; the byte order
+    mark lets the loading functions reject files written on a machine with a different byte order.
+*/
+
+namespace ket
+{
+
+enum class StatevectorPrecision : std::uint8_t
+{
+    DOUBLE,
+    SINGLE
+};
+
+void save_statevector_binary(
+    std::ostream& outstream,
+    const QuantumState& state,
+    StatevectorPrecision precision = StatevectorPrecision::DOUBLE
+);
+
+/*
+    The entire file is written with a single system call.
+*/
+void save_statevector_binary(
+    const std::filesystem::path& filepath,
+    const QuantumState& state,
+    StatevectorPrecision precision = StatevectorPrecision::DOUBLE
+);
+
+auto load_statevector_binary(std::istream& instream) -> QuantumState;
+
+/*
+    The file is memory mapped, and the amplitudes are copied directly into the new state.
+*/
+auto load_statevector_binary(const std::filesystem::path& filepath) -> QuantumState;
+
+}  // namespace ket
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <filesystem>
 
+#include "kettle/io/binary_statevector.hpp"
 #include "kettle/state/state.hpp"
 
 
@@ -19,4 +20,40 @@ auto read_numpy_statevector(
     QuantumStateEndian input_endian = QuantumStateEndian::LITTLE
 ) -> QuantumState;
 
+/*
+    Reads a statevector from a NumPy `.npy` file, as written by `numpy.save()`; the array must hold
+    either `numpy.complex128` or `numpy.complex64` elements in little endian byte order, and have
+    a number of elements that is a power of 2.
+
+    A multidimensional array is read in C order. When reading from a file, the file is memory mapped
+    and the amplitudes are copied directly into the new state.
+*/
+auto read_npy_statevector(
+    std::istream& instream,
+    QuantumStateEndian input_endian = QuantumStateEndian::LITTLE
+) -> QuantumState;
+
+auto read_npy_statevector(
+    const std::filesystem::path& filepath,
+    QuantumStateEndian input_endian = QuantumStateEndian::LITTLE
+) -> QuantumState;
+
+/*
+    Writes a statevector to a NumPy `.npy` file, as a one-dimensional array of `numpy.complex128`
+    elements (or `numpy.complex64` elements, with single precision) that `numpy.load()` can read.
+*/
+void write_npy_statevector(
+    std::ostream& outstream,
+    const QuantumState& state,
+    StatevectorPrecision precision = StatevectorPrecision::DOUBLE,
+    QuantumStateEndian output_endian = QuantumStateEndian::LITTLE
+);
+
+void write_npy_statevector(
+    const std::filesystem::path& filepath,
+    const QuantumState& state,
+    StatevectorPrecision precision = StatevectorPrecision::DOUBLE,
+    QuantumStateEndian output_endian = QuantumStateEndian::LITTLE
+);
+
 }  // namespace ket
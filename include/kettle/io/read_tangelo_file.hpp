@@ -5,6 +5,7 @@
 #include <optional>
 
 #include <kettle/circuit/circuit.hpp>
+#include <kettle/circuit/compact_circuit.hpp>
 
 /*
 This script parses the file of gates produced by the tangelo code.
@@ -23,14 +24,20 @@ namespace ket
 {
 
 /*
-    The underlying helper function for `read_tangelo_circuit()`, that takes an input stream `stream`
-    as an argument instead of the path to the file.
+    The same as the overload of `read_tangelo_circuit()` that reads from a file, except that the
+    circuit is read from the input stream `stream`.
+
+    The rest of the stream is read into memory before it is parsed. If `line_starts_with_spaces` is
+    given, parsing stops at the first line that does not start with that many spaces. The stream is
+    never repositioned, so it can be a pipe; it is left just after the leading spaces of that line,
+    which were fewer than `line_starts_with_spaces`.
 */
-auto read_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-cognitive-complexity)
+auto read_tangelo_circuit(
     std::size_t n_qubits,
     std::istream& stream,
     std::size_t n_skip_lines,
-    std::optional<std::size_t> line_starts_with_spaces = std::nullopt
+    std::optional<std::size_t> line_starts_with_spaces = std::nullopt,
+    bool collapse_pauli_rotations = false
 ) -> QuantumCircuit;
 
 /*
@@ -39,13 +46,66 @@ auto read_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-co
 
     This function can skip the first `n_skip_lines` lines of the file.
 
-    For the time being, only primitive gates, SWAP gates, and control flow elements can be read.
+    For the time being, only primitive gates, SWAP gates, and control flow elements can be read;
+    this includes the 'REPEAT' and 'CONTROLLED' statements written by `write_tangelo_circuit()`.
     Any circuit elements related to logging are ignored.
+
+    If `collapse_pauli_rotations` is true, then each sequence of gates that tangelo uses to apply
+    exp(-i theta P / 2) for a Pauli string P is replaced by a single PAULI_ROT gate; see
+    `collapse_pauli_rotation_gadgets()` for the sequences that are recognized.
+
+    The file is memory mapped and parsed in place, and a line that cannot be parsed throws a
+    `std::runtime_error`.
 */
 auto read_tangelo_circuit(
+    std::size_t n_qubits,
+    const std::filesystem::path& filepath,
+    std::size_t n_skip_lines,
+    bool collapse_pauli_rotations = false
+) -> QuantumCircuit;
+
+/*
+    The same as the overload of `read_tangelo_circuit()` that reads from a file, except that the gates
+    are parsed straight into the 16-byte records of a `CompactCircuit`, without building a circuit
+    element for each of them. This is the fastest way to read the long, gate-only circuits of QPE.
+
+    Throws a `std::runtime_error` if the file holds a control flow statement.
+*/
+auto read_tangelo_compact_circuit(
     std::size_t n_qubits,
     const std::filesystem::path& filepath,
     std::size_t n_skip_lines
+) -> CompactCircuit;
+
+/*
+    The same as `read_tangelo_circuit()`, except that the parsed circuit is cached in the directory
+    `cache_directory`, in the binary format of `save_circuit_binary()`.
+
+    The cache file is named after a hash of the contents of `filepath` and of the other arguments,
+    so an edited file or a different way of reading it never picks up a stale circuit. Computing the
+    hash still reads the whole file, but that is much faster than parsing it.
+
+    A cache file that cannot be loaded is ignored, and the circuit is parsed again. If the cache file
+    cannot be written, the circuit is still returned.
+*/
+auto read_tangelo_circuit_cached(
+    std::size_t n_qubits,
+    const std::filesystem::path& filepath,
+    std::size_t n_skip_lines,
+    const std::filesystem::path& cache_directory,
+    bool collapse_pauli_rotations = false
 ) -> QuantumCircuit;
 
+/*
+    The same as `read_tangelo_circuit_cached()`, except that the circuit is read as a `CompactCircuit`,
+    and cached in the binary format of `save_compact_circuit_binary()`. Loading this cache is little
+    more than copying the gate records out of the file.
+*/
+auto read_tangelo_compact_circuit_cached(
+    std::size_t n_qubits,
+    const std::filesystem::path& filepath,
+    std::size_t n_skip_lines,
+    const std::filesystem::path& cache_directory
+) -> CompactCircuit;
+
 }  // namespace ket
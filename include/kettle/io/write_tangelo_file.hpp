@@ -26,7 +26,8 @@ namespace ket
     The underlying helper function for `write_tangelo_circuit()`, that takes an output stream `stream`
     as an argument instead of the path to the file.
 
-    MAYBE TODO: change to allow nested control flow?
+    The subcircuits of control flow statements are indented by four more spaces than the statement,
+    so control flow statements can be nested.
 */
 void write_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-cognitive-complexity)
     const ket::QuantumCircuit& circuit,
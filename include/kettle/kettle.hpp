@@ -3,12 +3,16 @@
 #include <kettle/calculations/measurements.hpp>
 #include <kettle/calculations/probabilities.hpp>
 #include <kettle/circuit/circuit.hpp>
+#include <kettle/circuit/circuit_dag.hpp>
 #include <kettle/circuit/classical_register.hpp>
+#include <kettle/circuit/compact_circuit.hpp>
 #include <kettle/circuit/control_flow_predicate.hpp>
 #include <kettle/circuit_operations/append_circuits.hpp>
+#include <kettle/circuit_operations/collapse_pauli_rotation_gadgets.hpp>
 #include <kettle/circuit_operations/compare_circuits.hpp>
 #include <kettle/circuit_operations/make_binary_controlled_circuit.hpp>
 #include <kettle/circuit_operations/make_controlled_circuit.hpp>
+#include <kettle/circuit_operations/optimize_circuit.hpp>
 #include <kettle/circuit_operations/transpile_to_primitive.hpp>
 #include <kettle/common/arange.hpp>
 #include <kettle/common/mathtools.hpp>
@@ -17,16 +21,26 @@
 #include <kettle/gates/multiplicity_controlled_u_gate.hpp>
 #include <kettle/gates/primitive_gate.hpp>
 #include <kettle/gates/random_u_gates.hpp>
+#include <kettle/io/binary_circuit.hpp>
+#include <kettle/io/binary_statevector.hpp>
 #include <kettle/io/read_pauli_operator.hpp>
 #include <kettle/io/read_tangelo_file.hpp>
 #include <kettle/io/numpy_statevector.hpp>
 #include <kettle/io/statevector.hpp>
 #include <kettle/io/write_tangelo_file.hpp>
+#include <kettle/operator/pauli/grouped_pauli_operator.hpp>
 #include <kettle/operator/pauli/pauli_operator.hpp>
 #include <kettle/operator/pauli/sparse_pauli_string.hpp>
+#include <kettle/optimize/adjoint_gradient.hpp>
 #include <kettle/optimize/n_local.hpp>
+#include <kettle/optimize/parameter_shift_gradient.hpp>
+#include <kettle/parameter/parameter_slots.hpp>
+#include <kettle/simulation/checkpoint_simulator.hpp>
+#include <kettle/simulation/dense_unitary.hpp>
 #include <kettle/simulation/simulate.hpp>
+#include <kettle/simulation/simulate_out_of_core.hpp>
 #include <kettle/simulation/simulate_pauli.hpp>
+#include <kettle/state/disk_state.hpp>
 #include <kettle/state/endian.hpp>
 #include <kettle/state/marginal.hpp>
 #include <kettle/state/project_state.hpp>
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/state/state.hpp"
+
+/*
+    This file contains the `GroupedPauliOperator` class, a precomputed form of a `PauliOperator`
+    that is meant to be evaluated many times, such as the Hamiltonian in a VQE calculation.
+*/
+
+
+namespace ket
+{
+
+/*
+    All the terms of a `PauliOperator` that flip the same qubits; they share an X-mask and only
+    differ in their Z-masks.
+
+    The `weights` already include the coefficient of each term, the phase of its Pauli string,
+    and the factor of i from each of its Y terms.
+*/
+struct PauliTermGroup
+{
+    std::size_t x_mask;
+    std::vector<std::size_t> z_masks;
+    std::vector<std::complex<double>> weights;
+};
+
+/*
+    The `GroupedPauliOperator` buckets the terms of a `PauliOperator` by their X-mask.
+
+    For a term with X-mask `x` and Z-mask `z`, the expectation value is a sum over the products
+    `conj(psi[i ^ x]) * psi[i]`, with the sign given by the parity of `i & z`. All terms in a group
+    share the same products, so the state only needs to be walked once per group, and the cost of
+    an evaluation scales with the number of distinct X-masks rather than the number of terms.
+*/
+class GroupedPauliOperator
+{
+public:
+    explicit GroupedPauliOperator(const PauliOperator& pauli_op);
+
+    [[nodiscard]]
+    constexpr auto n_qubits() const noexcept -> std::size_t
+    {
+        return n_qubits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_terms() const noexcept -> std::size_t
+    {
+        return n_terms_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_groups() const noexcept -> std::size_t
+    {
+        return groups_.size();
+    }
+
+    [[nodiscard]]
+    constexpr auto groups() const noexcept -> const std::vector<PauliTermGroup>&
+    {
+        return groups_;
+    }
+
+private:
+    std::size_t n_qubits_;
+    std::size_t n_terms_;
+    std::vector<PauliTermGroup> groups_;
+};
+
+auto expectation_value(const GroupedPauliOperator& grouped_op, const QuantumState& state) -> std::complex<double>;
+
+}  // namespace ket
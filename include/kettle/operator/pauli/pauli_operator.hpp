@@ -1,6 +1,7 @@
 #pragma once
 
 #include <complex>
+#include <cstddef>
 #include <initializer_list>
 #include <vector>
 
@@ -68,6 +69,16 @@ public:
 
     void remove(std::size_t index);
 
+    /*
+        Puts the `PauliOperator` into a canonical form, and returns the number of terms removed.
+
+        The phase of each Pauli string is folded into its coefficient, all terms with the same Pauli
+        string have their coefficients summed together, and any term whose coefficient has a magnitude
+        of at most `tolerance` is dropped. The remaining terms are sorted by their X-mask, and then their
+        Z-mask, so that terms acting on the state in the same way are next to each other.
+    */
+    auto simplify(double tolerance = PAULI_OPERATOR_SIMPLIFY_TOLERANCE) -> std::size_t;
+
 private:
     std::size_t n_qubits_;
     std::vector<WeightedPauliString> weighted_pauli_strings_;
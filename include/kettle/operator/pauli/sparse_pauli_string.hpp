@@ -113,6 +113,33 @@ public:
     [[nodiscard]]
     auto contains_index(std::size_t qubit_index) const noexcept -> bool;
 
+    /*
+        The packed bitmask of the qubits with an X or a Y term; bit `k % 64` of word `k / 64`
+        corresponds to the qubit at index `k`.
+    */
+    [[nodiscard]]
+    constexpr auto x_mask() const noexcept -> const std::vector<std::uint64_t>&
+    {
+        return x_mask_;
+    }
+
+    /*
+        The packed bitmask of the qubits with a Z or a Y term; bit `k % 64` of word `k / 64`
+        corresponds to the qubit at index `k`.
+    */
+    [[nodiscard]]
+    constexpr auto z_mask() const noexcept -> const std::vector<std::uint64_t>&
+    {
+        return z_mask_;
+    }
+
+    /*
+        Checks if this `SparsePauliString` commutes with `other`; two Pauli strings commute if they
+        anticommute on an even number of qubits.
+    */
+    [[nodiscard]]
+    auto commutes_with(const SparsePauliString& other) const -> bool;
+
     [[nodiscard]]
     auto equal_up_to_phase(const SparsePauliString& other) const -> bool;
 
@@ -123,10 +150,23 @@ private:
     std::size_t n_qubits_;
     PauliPhase phase_ {};
     std::vector<std::pair<std::size_t, PauliTerm>> pauli_indexed_terms_;
+    std::vector<std::uint64_t> x_mask_;
+    std::vector<std::uint64_t> z_mask_;
 
     void check_index_in_qubit_range_(std::size_t index) const;
     void check_n_qubits_not_zero_() const;
 
+    /*
+        Sets the bits for the qubit at `qubit_index` in the X-mask and Z-mask, according to `term`.
+    */
+    void set_mask_bits_(std::size_t qubit_index, PauliTerm term) noexcept;
+
+    /*
+        Creates the X-mask and the Z-mask from the stored terms; throws a `std::runtime_error` if any
+        of the terms is outside the qubit range, or if more than one term acts on the same qubit.
+    */
+    void build_masks_();
+
     /*
         Checks if a `PauliTerm` operator is being applied to the qubit at `qubit_index`;
         if yes, the index the `PauliTerm` instance in the internal container is returned,
@@ -135,6 +175,12 @@ private:
     [[nodiscard]]
     auto vector_index_(std::size_t qubit_index) const -> std::optional<std::size_t>;
 
+    // NOTE: the terms are also stored as a pair of packed bitmasks, using Y = iXZ
+    //   - this makes it possible to multiply Pauli strings, compare them, and check if they commute,
+    //     with a few bitwise operations per 64 qubits
+    //   - the simulations and expectation values can act on all the terms at once, rather than
+    //     making a pass over the state for each term
+
     // NOTE: why do we use a `std::vector` of pairs instead of a map?
     //   - first, because the Pauli string is sparse, we expect the container to hold very
     //     few of them; so the time complexity of a search is dominated by the prefactor,
@@ -143,4 +189,22 @@ private:
     //     doesn't matter; so a `std::vector` is faster for this anyways
 };
 
+/*
+    Creates a `SparsePauliString` from the packed X-mask and Z-mask described in `SparsePauliString::x_mask()`
+    and `SparsePauliString::z_mask()`; the terms are stored in increasing order of qubit index. Throws a
+    `std::runtime_error` if the masks do not have the correct number of words for `n_qubits`.
+*/
+auto pauli_string_from_masks(
+    const std::vector<std::uint64_t>& x_mask,
+    const std::vector<std::uint64_t>& z_mask,
+    std::size_t n_qubits,
+    PauliPhase phase = PauliPhase::PLUS_ONE
+) -> SparsePauliString;
+
+/*
+    Calculates the product `left * right` of two Pauli strings, including the phase; throws a
+    `std::runtime_error` if the two Pauli strings have different numbers of qubits.
+*/
+auto operator*(const SparsePauliString& left, const SparsePauliString& right) -> SparsePauliString;
+
 }  // namespace ket
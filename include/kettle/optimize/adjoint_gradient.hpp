@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/state/state.hpp"
+
+/*
+    This file contains functions for calculating the gradient of the expectation value of a
+    `PauliOperator` with respect to the parameters of a circuit, using the adjoint method.
+
+    The adjoint method simulates the circuit forward once, applies the operator once, and then walks
+    backwards through the gates, undoing each gate on two states at once. The entire gradient costs
+    roughly three simulations of the circuit, no matter how many parameters there are.
+*/
+
+namespace ket
+{
+
+struct ExpectationValueAndGradient
+{
+    double expectation_value;
+    std::vector<double> gradient;
+};
+
+/*
+    Calculates the expectation value of `pauli_op` for the state created by simulating `circuit` on
+    `initial_state`, and its gradient with respect to each parameter in `parameter_ids`; the i-th
+    element of the gradient is the derivative with respect to `parameter_ids[i]`.
+
+    The parameters can appear in any number of gates, and inside any `ParameterExpression`; the
+    contributions of every gate are combined with the chain rule. The `pauli_op` is assumed to be
+    Hermitian, so only the real part of the expectation value is returned.
+
+    The circuit cannot contain measurements or control flow.
+*/
+auto adjoint_gradient(
+    const QuantumCircuit& circuit,
+    const std::vector<param::ParameterID>& parameter_ids,
+    const PauliOperator& pauli_op,
+    const QuantumState& initial_state
+) -> ExpectationValueAndGradient;
+
+/*
+    Same as above, with the circuit simulated on the computational basis state |00...0>.
+*/
+auto adjoint_gradient(
+    const QuantumCircuit& circuit,
+    const std::vector<param::ParameterID>& parameter_ids,
+    const PauliOperator& pauli_op
+) -> ExpectationValueAndGradient;
+
+}  // namespace ket
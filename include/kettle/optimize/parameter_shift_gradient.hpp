@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/optimize/adjoint_gradient.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/state/state.hpp"
+
+/*
+    This file contains functions for calculating the gradient of a cost function with respect to the
+    parameters of a circuit, using the parameter-shift rule.
+
+    Unlike the adjoint method, the parameter-shift rule only ever runs the circuit forwards, so it works
+    for circuits with mid-circuit measurements and control flow, and for cost functions that are only
+    estimated (for example, an expectation value calculated from sampled measurements).
+
+    Each occurrence of a parameterized gate is differentiated separately, by running the circuit with
+    only that gate's angle shifted:
+      - RX, RY, RZ, P, CP and PAULI_ROT gates use the two-term rule, with shifts of +/- pi/2
+      - CRX, CRY and CRZ gates use the four-term rule, with shifts of +/- pi/2 and +/- 3pi/2
+
+    The derivatives of the occurrences are then combined with the chain rule, so parameters can be
+    shared between gates.
+
+    The part of the circuit before a shifted gate is the same for all of its shifted runs; the state
+    at that point is calculated once, and each shifted run only simulates the rest of the circuit. The
+    shifted runs are done in batches, concurrently.
+*/
+
+namespace ket
+{
+
+/*
+    The cost function takes the final state of a simulation; it is called concurrently from several
+    threads, so it must be safe to do so.
+*/
+using StateCostFunction = std::function<double(const QuantumState&)>;
+
+/*
+    Calculates the cost of the state created by simulating `circuit` on `initial_state`, and its gradient
+    with respect to each parameter in `parameter_ids`; the i-th element of the gradient is the derivative
+    with respect to `parameter_ids[i]`.
+
+    Every run of the circuit uses the same `prng_seed`, so the measurements in the shifted runs are
+    correlated with those of the unshifted run. If `n_threads` is not given, the number of hardware
+    threads is used.
+
+    Parameterized gates inside control flow subcircuits cannot be shifted, and cause an exception.
+*/
+auto parameter_shift_gradient(
+    const QuantumCircuit& circuit,
+    const std::vector<param::ParameterID>& parameter_ids,
+    const StateCostFunction& cost_function,
+    const QuantumState& initial_state,
+    std::optional<int> prng_seed = std::nullopt,
+    std::optional<std::size_t> n_threads = std::nullopt
+) -> ExpectationValueAndGradient;
+
+/*
+    Same as above, with the real part of the expectation value of `pauli_op` as the cost function.
+*/
+auto parameter_shift_gradient(
+    const QuantumCircuit& circuit,
+    const std::vector<param::ParameterID>& parameter_ids,
+    const PauliOperator& pauli_op,
+    const QuantumState& initial_state,
+    std::optional<int> prng_seed = std::nullopt,
+    std::optional<std::size_t> n_threads = std::nullopt
+) -> ExpectationValueAndGradient;
+
+/*
+    Holds everything `parameter_shift_objective()` needs to evaluate the cost function and its gradient.
+*/
+struct ParameterShiftObjective
+{
+    QuantumCircuit circuit;
+    std::vector<param::ParameterID> parameter_ids;
+    StateCostFunction cost_function;
+    QuantumState initial_state;
+    std::optional<int> prng_seed {std::nullopt};
+    std::optional<std::size_t> n_threads {std::nullopt};
+};
+
+/*
+    An objective function with the signature that nlopt expects, for example:
+
+        auto objective = ket::ParameterShiftObjective { ... };
+        opt.set_min_objective(ket::parameter_shift_objective, &objective);
+
+    The `data` must point to a `ParameterShiftObjective`. The `parameters` are assigned to the parameters
+    of the circuit in the order of `parameter_ids`, and the gradient is only calculated if `grad` is not
+    empty.
+*/
+auto parameter_shift_objective(const std::vector<double>& parameters, std::vector<double>& grad, void* data) -> double;
+
+}  // namespace ket
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/clone_ptr.hpp"
+#include "kettle/parameter/parameter.hpp"
+
+/*
+    Before a circuit is simulated, each of its parameters is assigned a dense integer slot, and the
+    values of the parameters are read from a plain array indexed by these slots.
+
+    The slots are assigned in the order that the parameters first appear in the circuit, with the
+    subcircuits of control flow statements visited in place; so the first parameterized gate of a
+    circuit always uses slot 0. Parameters that are not used by any gate are not given a slot.
+*/
+
+namespace ket
+{
+class StatevectorSimulator;
+}  // namespace ket
+
+namespace ket::param::internal
+{
+struct CompiledParameterSlots;
+}  // namespace ket::param::internal
+
+
+namespace ket::param
+{
+
+/*
+    A circuit with its parameter slots assigned, and the expression of every parameterized gate
+    compiled into a program over the slots.
+
+    The circuit is compiled once, when the instance is created; simulating it afterwards with a new
+    array of parameter values only reads from arrays. A circuit that is simulated many times with
+    different parameter values should be compiled once, and simulated through this class.
+*/
+class CompiledCircuit
+{
+public:
+    explicit CompiledCircuit(QuantumCircuit circuit);
+
+    CompiledCircuit(const CompiledCircuit& other);
+    CompiledCircuit(CompiledCircuit&& other) noexcept;
+    auto operator=(const CompiledCircuit& other) -> CompiledCircuit&;
+    auto operator=(CompiledCircuit&& other) noexcept -> CompiledCircuit&;
+    ~CompiledCircuit();
+
+    [[nodiscard]]
+    constexpr auto circuit() const noexcept -> const QuantumCircuit&
+    {
+        return circuit_;
+    }
+
+    /*
+        The id of the parameter assigned to each slot, in slot order.
+    */
+    [[nodiscard]]
+    auto slot_ids() const noexcept -> const std::vector<ParameterID>&;
+
+    [[nodiscard]]
+    auto n_slots() const noexcept -> std::size_t;
+
+    /*
+        The values of the parameters stored in the circuit, in slot order; this throws if any of
+        these parameters has not been given a value.
+    */
+    [[nodiscard]]
+    auto parameter_values() const -> std::vector<double>;
+
+private:
+    friend class ket::StatevectorSimulator;
+
+    QuantumCircuit circuit_;
+    ClonePtr<internal::CompiledParameterSlots> compiled_;
+};
+
+}  // namespace ket::param
+
+
+namespace ket
+{
+
+/*
+    Returns the id of the parameter assigned to each slot of `circuit`, in slot order.
+*/
+auto parameter_slot_ids(const QuantumCircuit& circuit) -> std::vector<param::ParameterID>;
+
+/*
+    Returns the current value of the parameter assigned to each slot of `circuit`, in slot order; this
+    throws if any of these parameters has not been given a value.
+*/
+auto parameter_slot_values(const QuantumCircuit& circuit) -> std::vector<double>;
+
+}  // namespace ket
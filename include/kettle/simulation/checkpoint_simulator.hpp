@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/clone_ptr.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/state/state.hpp"
+
+/*
+    This file contains a simulator for running the same parameterized circuit many times, where only a
+    few of the parameter values change between runs; for example, in coordinate descent, or when the
+    parameters are shifted one at a time.
+
+    The simulator keeps copies of the statevector (checkpoints) at chosen positions in the circuit. When
+    it is run again, it finds the first gate that uses a parameter whose value changed, and resumes the
+    simulation from the last checkpoint before that gate, instead of starting over from the initial state.
+*/
+
+namespace ket::param::internal
+{
+struct CompiledParameterSlots;
+}  // namespace ket::param::internal
+
+
+namespace ket
+{
+
+struct CheckpointCacheStatistics
+{
+    std::size_t n_hits {0};             // runs that resumed from a checkpoint, or reused the previous result
+    std::size_t n_misses {0};           // runs that started over from the initial state
+    std::size_t n_gates_skipped {0};    // gates that did not need to be simulated again
+    std::size_t n_gates_simulated {0};  // gates that were simulated
+};
+
+/*
+    The checkpoints are placed right before the first gate that uses each parameter, since these are the
+    positions that a run can resume from. As many checkpoints as fit in `memory_budget_in_bytes` are kept;
+    if there are more of these positions than that, an evenly spaced subset of them is chosen. The memory
+    for the current state is not counted in the budget.
+
+    Measurement gates and control flow statements cause an exception, because a resumed run would draw
+    different random numbers for the measurements than a full run. Circuit loggers are ignored.
+*/
+class CheckpointSimulator
+{
+public:
+    CheckpointSimulator(QuantumCircuit circuit, QuantumState initial_state, std::size_t memory_budget_in_bytes);
+
+    CheckpointSimulator(const CheckpointSimulator& other);
+    CheckpointSimulator(CheckpointSimulator&& other) noexcept;
+    auto operator=(const CheckpointSimulator& other) -> CheckpointSimulator&;
+    auto operator=(CheckpointSimulator&& other) noexcept -> CheckpointSimulator&;
+    ~CheckpointSimulator();
+
+    /*
+        Simulates the circuit with the parameter values stored in the circuit, and returns the final state.
+    */
+    auto run() -> const QuantumState&;
+
+    /*
+        Simulates the circuit with the values in `parameter_values`, given in the order of the slots in
+        `parameter_slot_ids()`, and returns the final state.
+    */
+    auto run(std::span<const double> parameter_values) -> const QuantumState&;
+
+    [[nodiscard]]
+    auto parameter_slot_ids() const -> const std::vector<param::ParameterID>&;
+
+    [[nodiscard]]
+    auto n_checkpoints() const noexcept -> std::size_t;
+
+    [[nodiscard]]
+    constexpr auto statistics() const noexcept -> const CheckpointCacheStatistics&
+    {
+        return statistics_;
+    }
+
+    void reset_statistics() noexcept;
+
+private:
+    QuantumCircuit circuit_;
+    QuantumState initial_state_;
+    QuantumState state_;
+    ClonePtr<param::internal::CompiledParameterSlots> compiled_;
+
+    std::vector<std::size_t> i_gate_elements_;           // the index of each gate in the circuit's elements
+    std::vector<std::size_t> i_first_gate_of_slot_;      // the first gate that uses each slot
+    std::vector<std::size_t> i_checkpoint_gates_;        // each checkpoint holds the state right before this gate
+    std::vector<std::optional<QuantumState>> checkpoints_;
+    std::vector<double> previous_parameter_values_;
+    bool has_been_run_ {false};
+
+    CheckpointCacheStatistics statistics_;
+
+    void choose_checkpoints_(std::size_t memory_budget_in_bytes);
+};
+
+}  // namespace ket
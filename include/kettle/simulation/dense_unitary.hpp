@@ -0,0 +1,137 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/tolerance.hpp"
+#include "kettle/common/utils.hpp"
+#include "kettle/state/state.hpp"
+
+/*
+    This header file contains the `DenseUnitary` class, which holds the full 2^m x 2^m matrix of
+    a circuit on m qubits, and functions to create it, multiply it, and apply it to a larger state.
+
+    For a small register, the matrix for a large power of a unitary can be found with a few matrix
+    products; for example, in QPE the operator U^(2^k) takes k squarings, instead of simulating the
+    circuit for U a total of 2^k times on the full state.
+*/
+
+namespace ket
+{
+
+/*
+    The largest number of qubits that a `DenseUnitary` can act on; the matrix holds 4^n_qubits complex
+    numbers, so the matrix on 14 qubits already takes 4 GiB of memory, and each matrix product takes
+    8^n_qubits operations. Anything larger throws a `std::runtime_error` before any memory is allocated.
+*/
+constexpr inline auto MAX_DENSE_UNITARY_QUBITS = std::size_t {14};
+
+class DenseUnitary
+{
+public:
+    /*
+        Creates the identity matrix on `n_qubits` qubits.
+    */
+    explicit DenseUnitary(std::size_t n_qubits);
+
+    /*
+        Creates the matrix on `n_qubits` qubits from its elements, given in row-major order.
+    */
+    DenseUnitary(std::size_t n_qubits, std::vector<std::complex<double>> elements);
+
+    [[nodiscard]]
+    constexpr auto n_qubits() const noexcept -> std::size_t
+    {
+        return n_qubits_;
+    }
+
+    /*
+        The number of rows (and columns) of the matrix.
+    */
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> std::size_t
+    {
+        return size_;
+    }
+
+    [[nodiscard]]
+    auto operator()(std::size_t row, std::size_t col) const -> const std::complex<double>&
+    {
+        return elements_[row * size_ + col];
+    }
+
+    auto operator()(std::size_t row, std::size_t col) -> std::complex<double>&
+    {
+        return elements_[row * size_ + col];
+    }
+
+    [[nodiscard]]
+    auto elements() const noexcept -> const std::vector<std::complex<double>>&
+    {
+        return elements_;
+    }
+
+private:
+    std::size_t n_qubits_;
+    std::size_t size_;
+    std::vector<std::complex<double>> elements_;
+};
+
+/*
+    The product `left * right`; applying the result to a state is the same as applying `right`
+    and then `left`.
+*/
+auto operator*(const DenseUnitary& left, const DenseUnitary& right) -> DenseUnitary;
+
+auto almost_eq(
+    const DenseUnitary& left,
+    const DenseUnitary& right,
+    double tolerance_sq = ket::COMPLEX_ALMOST_EQ_TOLERANCE_SQ
+) noexcept -> bool;
+
+/*
+    Creates the matrix of `circuit`, by simulating the circuit once for each computational basis
+    state; the columns are simulated in parallel.
+
+    The circuit must not contain measurements, since they are not unitary. If `n_threads` is not
+    given, the number of hardware threads is used.
+*/
+auto make_dense_unitary(
+    const QuantumCircuit& circuit,
+    std::optional<std::size_t> n_threads = std::nullopt
+) -> DenseUnitary;
+
+/*
+    Calculates U^(2^exponent) through `exponent` repeated squarings of U.
+*/
+auto dense_unitary_power_of_2(const DenseUnitary& unitary, std::size_t exponent) -> DenseUnitary;
+
+/*
+    Applies `unitary` to the qubits in `target_qubits` of `state`; bit `j` of the row and column
+    indices of the matrix corresponds to the qubit `target_qubits[j]` of the state.
+*/
+template <QubitIndices Container = QubitIndicesIList>
+void apply_dense_unitary(
+    QuantumState& state,
+    const DenseUnitary& unitary,
+    const Container& target_qubits,
+    std::optional<std::size_t> n_threads = std::nullopt
+);
+
+/*
+    Like `apply_dense_unitary()`, but the unitary is only applied to the part of the state where
+    all the qubits in `control_qubits` are in the `1` state.
+*/
+template <QubitIndices Container = QubitIndicesIList>
+void apply_controlled_dense_unitary(
+    QuantumState& state,
+    const DenseUnitary& unitary,
+    const Container& control_qubits,
+    const Container& target_qubits,
+    std::optional<std::size_t> n_threads = std::nullopt
+);
+
+}  // namespace ket
@@ -1,15 +1,28 @@
 #pragma once
 
 #include <optional>
+#include <span>
 #include <vector>
 
 #include "kettle/circuit/classical_register.hpp"
 #include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/compact_circuit.hpp"
 #include "kettle/circuit_loggers/circuit_logger.hpp"
 #include "kettle/common/clone_ptr.hpp"
 #include "kettle/state/state.hpp"
 
 
+namespace ket::param
+{
+class CompiledCircuit;
+}  // namespace ket::param
+
+namespace ket::param::internal
+{
+struct CompiledCircuitParameters;
+}  // namespace ket::param::internal
+
+
 namespace ket
 {
 
@@ -18,6 +31,27 @@ class StatevectorSimulator
 public:
     void run(const QuantumCircuit& circuit, QuantumState& state, std::optional<int> prng_seed = std::nullopt);
 
+    /*
+        Runs the simulation of the compiled circuit with the parameter values in `parameter_values`
+        instead of the values stored in the circuit; the values are given in slot order, as returned
+        by `CompiledCircuit::slot_ids()`.
+
+        The circuit is not compiled again, so this is the overload to use when the same circuit is
+        simulated many times with different parameter values.
+    */
+    void run(
+        const param::CompiledCircuit& compiled,
+        QuantumState& state,
+        std::span<const double> parameter_values,
+        std::optional<int> prng_seed = std::nullopt
+    );
+
+    /*
+        Runs the simulation of the gates of `circuit` straight from their compact records, without
+        decoding them into circuit elements; each parameter expression is evaluated once per run.
+    */
+    void run(const CompactCircuit& circuit, QuantumState& state, std::optional<int> prng_seed = std::nullopt);
+
     [[nodiscard]]
     auto has_been_run() const -> bool;
 
@@ -35,11 +69,28 @@ private:
     ket::ClonePtr<ClassicalRegister> cregister_ {nullptr};
     bool has_been_run_ {false};
     std::vector<CircuitLogger> circuit_loggers_;
+
+    void run_compiled_(
+        const QuantumCircuit& circuit,
+        const param::internal::CompiledCircuitParameters* compiled_circuit,
+        std::span<const double> parameter_values,
+        QuantumState& state,
+        std::optional<int> prng_seed
+    );
 };
 
 
 void simulate(const QuantumCircuit& circuit, QuantumState& state, std::optional<int> prng_seed = std::nullopt);
 
+void simulate(
+    const param::CompiledCircuit& compiled,
+    QuantumState& state,
+    std::span<const double> parameter_values,
+    std::optional<int> prng_seed = std::nullopt
+);
+
+void simulate(const CompactCircuit& circuit, QuantumState& state, std::optional<int> prng_seed = std::nullopt);
+
 }  // namespace ket
 
 
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/state/disk_state.hpp"
+
+/*
+    This header file contains the `simulate_out_of_core()` function, which simulates a circuit on a
+    state that is stored in a file, for states too large to fit in memory.
+
+    The gates are grouped into passes over the file. Gates that target qubits within a chunk are
+    applied to each chunk while it is in memory, and each gate that targets a qubit outside of a
+    chunk is applied while streaming through the pairs of chunks it mixes; independent gates are
+    moved between passes so that the file is read and written as few times as possible.
+
+    Repeat statements are run as loops over the passes of their bodies, and are never unrolled.
+*/
+
+namespace ket
+{
+
+/*
+    The circuit may contain gates, repeat statements, and controlled blocks; measurements, classical
+    if statements, and circuit loggers are not supported.
+
+    If `n_threads` is not given, the number of threads used for each gate depends on the chunk size.
+*/
+void simulate_out_of_core(
+    const QuantumCircuit& circuit,
+    DiskQuantumState& state,
+    std::optional<std::size_t> n_threads = std::nullopt
+);
+
+}  // namespace ket
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+#include "kettle/state/state.hpp"
+
+/*
+    This header file contains the `DiskQuantumState` class, which holds the amplitudes of a state in a
+    file instead of in memory, so that states too large for the available memory can be simulated.
+
+    The amplitudes are stored in little endian order, as raw `std::complex<double>` values with no
+    header; the file holds 2^n_qubits * 16 bytes. The amplitudes are read and written in chunks of
+    2^n_chunk_qubits amplitudes, and at most two chunks are held in memory at once during a simulation.
+*/
+
+namespace ket
+{
+
+class DiskQuantumState
+{
+public:
+    /*
+        Creates the file at `filepath` holding the |0000...0> state, replacing any existing file.
+    */
+    DiskQuantumState(const std::filesystem::path& filepath, std::size_t n_qubits, std::size_t n_chunk_qubits);
+
+    /*
+        Creates the file at `filepath` holding the amplitudes of `state`, replacing any existing file.
+    */
+    DiskQuantumState(const std::filesystem::path& filepath, const QuantumState& state, std::size_t n_chunk_qubits);
+
+    /*
+        Opens an existing file at `filepath`, such as one left behind by an earlier run; the number
+        of qubits is found from the size of the file.
+    */
+    DiskQuantumState(const std::filesystem::path& filepath, std::size_t n_chunk_qubits);
+
+    DiskQuantumState(const DiskQuantumState&) = delete;
+    auto operator=(const DiskQuantumState&) -> DiskQuantumState& = delete;
+
+    DiskQuantumState(DiskQuantumState&& other) noexcept;
+    auto operator=(DiskQuantumState&& other) noexcept -> DiskQuantumState&;
+
+    /*
+        Closes the file; the file itself is left on disk.
+    */
+    ~DiskQuantumState();
+
+    [[nodiscard]]
+    constexpr auto n_qubits() const noexcept -> std::size_t
+    {
+        return n_qubits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_states() const noexcept -> std::size_t
+    {
+        return std::size_t {1} << n_qubits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_chunk_qubits() const noexcept -> std::size_t
+    {
+        return n_chunk_qubits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_chunk_states() const noexcept -> std::size_t
+    {
+        return std::size_t {1} << n_chunk_qubits_;
+    }
+
+    [[nodiscard]]
+    constexpr auto n_chunks() const noexcept -> std::size_t
+    {
+        return std::size_t {1} << (n_qubits_ - n_chunk_qubits_);
+    }
+
+    [[nodiscard]]
+    auto filepath() const noexcept -> const std::filesystem::path&
+    {
+        return filepath_;
+    }
+
+    /*
+        Copies the amplitudes of chunk `i_chunk` (the amplitudes with indices in the range
+        [i_chunk * n_chunk_states(), (i_chunk + 1) * n_chunk_states())) into `chunk`.
+    */
+    void read_chunk(std::size_t i_chunk, std::span<std::complex<double>> chunk) const;
+
+    void write_chunk(std::size_t i_chunk, std::span<const std::complex<double>> chunk);
+
+    /*
+        Loads the entire state into memory; this is meant for states that fit in memory.
+    */
+    [[nodiscard]]
+    auto to_state() const -> QuantumState;
+
+private:
+    std::filesystem::path filepath_;
+    std::size_t n_qubits_;
+    std::size_t n_chunk_qubits_;
+    int descriptor_ {-1};
+
+    void check_chunk_(std::size_t i_chunk, std::size_t chunk_size) const;
+};
+
+}  // namespace ket
@@ -60,7 +60,8 @@ auto main(int argc, char** argv) -> int
     }();
 
     const auto n_total_qubits = arguments.n_ancilla_qubits + arguments.n_unitary_qubits;
-    const auto circuit = ket::read_tangelo_circuit(n_total_qubits, arguments.abs_gate_filepath, 0);
+    const auto cache_dirpath = arguments.abs_gate_filepath.parent_path() / ".kettle_circuit_cache";
+    const auto circuit = ket::read_tangelo_compact_circuit_cached(n_total_qubits, arguments.abs_gate_filepath, 0, cache_dirpath);
 
     auto statevector = ket::QuantumState {n_total_qubits};
     ket::simulate(circuit, statevector);
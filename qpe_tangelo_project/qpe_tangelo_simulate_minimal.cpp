@@ -73,13 +73,24 @@ struct CommandLineArguments
     int i_continue;
 };
 
+/*
+    A run restarted with `i_continue` reads the same large circuit files again; the parsed circuits
+    are cached in a directory next to them, so only the first run pays for parsing. The circuit files
+    only hold gates, so they are read and simulated as compact circuits.
+*/
+auto read_circuit(const std::filesystem::path& circuit_filepath, std::size_t n_total_qubits) -> ket::CompactCircuit
+{
+    const auto cache_dirpath = circuit_filepath.parent_path() / ".kettle_circuit_cache";
+    return ket::read_tangelo_compact_circuit_cached(n_total_qubits, circuit_filepath, 0, cache_dirpath);
+}
+
 void simulate_subcircuit(
     const std::filesystem::path& circuit_filepath,
     ket::QuantumState& statevector,
     std::size_t n_total_qubits
 )
 {
-    const auto circuit = ket::read_tangelo_circuit(n_total_qubits, circuit_filepath, 0);
+    const auto circuit = read_circuit(circuit_filepath, n_total_qubits);
     ket::simulate(circuit, statevector);
 }
 
@@ -88,6 +99,29 @@ auto statevector_filename(int i) -> std::string
     return std::format("statevector.dat{}", i);
 }
 
+// the checkpoints are only read back in by this program, so they use the much faster binary format
+auto checkpoint_filename(int i) -> std::string
+{
+    return std::format("statevector.bin{}", i);
+}
+
+// runs started before the binary checkpoints were introduced left text checkpoints behind; these are
+// still used to continue a run, but only if there is no binary checkpoint for the same step
+auto load_checkpoint(const std::filesystem::path& abs_input_dirpath, int i) -> ket::QuantumState
+{
+    const auto binary_filepath = abs_input_dirpath / checkpoint_filename(i);
+    if (std::filesystem::exists(binary_filepath)) {
+        return ket::load_statevector_binary(binary_filepath);
+    }
+
+    const auto text_filepath = abs_input_dirpath / statevector_filename(i);
+    if (std::filesystem::exists(text_filepath)) {
+        return ket::load_statevector(text_filepath);
+    }
+
+    throw std::runtime_error {std::format("ERROR: no checkpoint found for step {}.\n", i)};
+}
+
 void simulate_unitary(
     const CommandLineArguments& args,
     ket::QuantumState& statevector,
@@ -105,7 +139,8 @@ void simulate_unitary(
         return args.abs_circuits_dirpath / output.str();
     }();
 
-    const auto circuit = ket::read_tangelo_circuit(n_total_qubits, circuit_filepath, 0);
+    // the circuit is read once per power, and every trotter step simulates the same compact records
+    const auto circuit = read_circuit(circuit_filepath, n_total_qubits);
 
     for (std::size_t i {0}; i < n_powers; ++i) {
         if (args.i_continue != RUN_FROM_START_KEY && count <= args.i_continue) {
@@ -113,11 +148,11 @@ void simulate_unitary(
             continue;
         }
 
-        for (std::size_t i_trotter_ {0}; i_trotter_ < args.n_trotter_steps; ++i_trotter_) {
+        for (std::size_t i_step {0}; i_step < args.n_trotter_steps; ++i_step) {
             ket::simulate(circuit, statevector);
         }
 
-        ket::save_statevector(args.abs_input_dirpath / statevector_filename(count), statevector);
+        ket::save_statevector_binary(args.abs_input_dirpath / checkpoint_filename(count), statevector);
         ++count;
     }
 }
@@ -141,7 +176,7 @@ auto main(int argc, char** argv) -> int
         if (args.i_continue == RUN_FROM_START_KEY) {
             return ket::QuantumState {n_total_qubits};
         } else {
-            return ket::load_statevector(args.abs_input_dirpath / statevector_filename(args.i_continue));
+            return load_checkpoint(args.abs_input_dirpath, args.i_continue);
         }
     }();
 
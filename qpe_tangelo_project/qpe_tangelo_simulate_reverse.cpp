@@ -60,7 +60,10 @@ void simulate_subcircuit(
     std::size_t n_total_qubits
 )
 {
-    const auto circuit = ket::read_tangelo_circuit(n_total_qubits, circuit_filepath, 0);
+    // the parsed circuit is cached next to the circuit file, for the next run that reads it; the
+    // circuit files only hold gates, so they are read and simulated as compact circuits
+    const auto cache_dirpath = circuit_filepath.parent_path() / ".kettle_circuit_cache";
+    const auto circuit = ket::read_tangelo_compact_circuit_cached(n_total_qubits, circuit_filepath, 0, cache_dirpath);
     ket::simulate(circuit, statevector);
 }
 
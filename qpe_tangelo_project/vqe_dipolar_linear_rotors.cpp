@@ -155,6 +155,10 @@ auto main(int argc, char** argv) -> int
 
     auto pauli_op = ket::read_pauli_operator(args.abs_input_filepath, args.n_qubits);
 
+    // the Hamiltonian files contain repeated Pauli strings; merging them makes every expectation value cheaper
+    const auto n_removed_terms = pauli_op.simplify();
+    std::cout << "Removed " << n_removed_terms << " redundant terms from the Hamiltonian\n";
+
     // this is the circuit we use to find the ideal parameters
     auto circuit = ket::QuantumCircuit {args.n_qubits};
 
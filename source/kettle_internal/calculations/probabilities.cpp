@@ -1,6 +1,10 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <stdexcept>
 #include <string>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include "kettle/state/state.hpp"
@@ -10,6 +14,7 @@
 
 #include "kettle_internal/calculations/probabilities_internal.hpp"
 #include "kettle_internal/simulation/gate_pair_generator.hpp"
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
 
 /*
     This file contains code components to calculate the probabilities of each of
@@ -61,10 +66,13 @@ auto calculate_probabilities_raw(const QuantumState& state, const QuantumNoise*
     }
 
     if (noise != nullptr) {
+        auto noise_per_qubit = std::vector<double> {};
+        noise_per_qubit.reserve(n_qubits);
         for (std::size_t i_qubit {0}; i_qubit < n_qubits; ++i_qubit) {
-            const auto prob_noise = noise->get(i_qubit);
-            ket::internal::apply_noise_(prob_noise, i_qubit, n_qubits, probabilities);
+            noise_per_qubit.push_back(noise->get(i_qubit));
         }
+
+        ket::internal::apply_noise_fused_(noise_per_qubit, probabilities);
     }
 
     return probabilities;
@@ -102,6 +110,60 @@ auto calculate_probabilities(const QuantumState& state, const QuantumNoise* nois
     return probabilities;
 }
 
+auto calculate_marginal_probabilities(
+    const QuantumState& state,
+    const std::vector<std::size_t>& qubit_indices,
+    const QuantumNoise* noise
+) -> std::vector<double>
+{
+    namespace ki = ket::internal;
+
+    const auto n_states = state.n_states();
+    const auto n_qubits = state.n_qubits();
+    ki::check_marginal_qubit_indices_(qubit_indices, n_qubits);
+
+    const auto n_kept_qubits = qubit_indices.size();
+    const auto n_bins = std::size_t {1} << n_kept_qubits;
+    const auto gatherer = ki::QubitBitGatherer {qubit_indices, n_qubits};
+
+    // each thread accumulates into its own bins; this is only worthwhile if the bins are small
+    // compared to the number of states that each thread is responsible for
+    const auto n_threads = std::min(ki::default_number_of_threads_(n_states), std::max(std::size_t {1}, n_states / n_bins));
+
+    auto thread_bins = std::vector<std::vector<double>>(n_threads, std::vector<double>(n_bins, 0.0));
+
+    const auto accumulate = [&](const ki::FlatIndexPair& block, std::size_t i_thread) {
+        auto& bins = thread_bins[i_thread];
+        for (auto i_state = block.i_lower; i_state < block.i_upper; ++i_state) {
+            bins[gatherer.gather(i_state)] += std::norm(state[i_state]);
+        }
+    };
+
+    ki::parallel_for_(n_states, n_threads, accumulate);
+
+    // the reduction is done in thread order, so the result does not depend on thread scheduling
+    auto probabilities = std::move(thread_bins[0]);
+    for (std::size_t i_thread {1}; i_thread < n_threads; ++i_thread) {
+        for (std::size_t i_bin {0}; i_bin < n_bins; ++i_bin) {
+            probabilities[i_bin] += thread_bins[i_thread][i_bin];
+        }
+    }
+
+    // the bit-flip noise on a qubit commutes with tracing out the other qubits, so it can be applied
+    // to the much smaller marginal distribution
+    if (noise != nullptr) {
+        auto noise_per_bit = std::vector<double> {};
+        noise_per_bit.reserve(n_kept_qubits);
+        for (auto i_qubit : qubit_indices) {
+            noise_per_bit.push_back(noise->get(i_qubit));
+        }
+
+        ki::apply_noise_fused_(noise_per_bit, probabilities);
+    }
+
+    return probabilities;
+}
+
 }  // namespace ket
 
 namespace ket::internal
@@ -123,6 +185,79 @@ void apply_noise_(double noise, std::size_t i_qubit, std::size_t n_qubits, std::
     }
 }
 
+/*
+    Applies the noise of the qubits [i_first_qubit, i_first_qubit + n_group_qubits) in a single pass.
+
+    Each tile holds the `2^n_group_qubits` rows that are connected by flipping the bits of the qubits
+    in the group; the rows are `row_length` contiguous elements long, and are separated by a stride
+    of `2^i_first_qubit` elements.
+*/
+void apply_noise_to_qubit_group_(
+    const std::vector<double>& noise_per_qubit,
+    std::size_t i_first_qubit,
+    std::size_t n_group_qubits,
+    std::size_t row_length,
+    std::vector<double>& probabilities
+)
+{
+    const auto n_qubits = noise_per_qubit.size();
+    const auto row_stride = std::size_t {1} << i_first_qubit;
+    const auto n_rows = std::size_t {1} << n_group_qubits;
+    const auto n_chunks_per_stride = row_stride / row_length;
+    const auto n_outer = std::size_t {1} << (n_qubits - i_first_qubit - n_group_qubits);
+    const auto n_tiles = n_outer * n_chunks_per_stride;
+
+    const auto apply_to_tiles = [&](const FlatIndexPair& block, [[maybe_unused]] std::size_t i_thread) {
+        for (auto i_tile = block.i_lower; i_tile < block.i_upper; ++i_tile) {
+            const auto i_outer = i_tile / n_chunks_per_stride;
+            const auto i_chunk = i_tile % n_chunks_per_stride;
+            const auto i_tile_begin = (i_outer * row_stride * n_rows) + (i_chunk * row_length);
+
+            for (std::size_t i_bit {0}; i_bit < n_group_qubits; ++i_bit) {
+                const auto noise = noise_per_qubit[i_first_qubit + i_bit];
+                if (noise == 0.0) {
+                    continue;
+                }
+
+                const auto row_step = std::size_t {1} << i_bit;
+                for (std::size_t i_row_upper {0}; i_row_upper < n_rows; i_row_upper += 2 * row_step) {
+                    for (std::size_t i_row_lower {0}; i_row_lower < row_step; ++i_row_lower) {
+                        const auto i_row0 = i_row_upper + i_row_lower;
+                        auto* row0 = probabilities.data() + i_tile_begin + (i_row0 * row_stride);
+                        auto* row1 = row0 + (row_step * row_stride);
+
+                        for (std::size_t i_elem {0}; i_elem < row_length; ++i_elem) {
+                            const auto current_prob0 = row0[i_elem];
+                            const auto current_prob1 = row1[i_elem];
+                            row0[i_elem] = ((1.0 - noise) * current_prob0) + (noise * current_prob1);
+                            row1[i_elem] = ((1.0 - noise) * current_prob1) + (noise * current_prob0);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    const auto n_threads = std::min(default_number_of_threads_(probabilities.size()), n_tiles);
+    parallel_for_(n_tiles, n_threads, apply_to_tiles);
+}
+
+void apply_noise_fused_(const std::vector<double>& noise_per_qubit, std::vector<double>& probabilities)
+{
+    const auto n_qubits = noise_per_qubit.size();
+
+    std::size_t i_first_qubit {0};
+    while (i_first_qubit < n_qubits) {
+        const auto row_length = std::min(std::size_t {1} << i_first_qubit, NOISE_TILE_ROW_LENGTH_);
+        const auto row_length_bits = static_cast<std::size_t>(std::countr_zero(row_length));
+        const auto n_group_qubits = std::min(n_qubits - i_first_qubit, NOISE_TILE_BITS_ - row_length_bits);
+
+        apply_noise_to_qubit_group_(noise_per_qubit, i_first_qubit, n_group_qubits, row_length, probabilities);
+
+        i_first_qubit += n_group_qubits;
+    }
+}
+
 /*
     Ensures that the noise parameter lies in [0.0, 1.0]; otherwise, the noise application is invalid.
 */
@@ -135,4 +270,38 @@ void check_noise_value_(double value)
     }
 }
 
+void check_marginal_qubit_indices_(const std::vector<std::size_t>& qubit_indices, std::size_t n_qubits)
+{
+    auto is_seen = std::vector<bool>(n_qubits, false);
+
+    for (auto i_qubit : qubit_indices) {
+        if (i_qubit >= n_qubits) {
+            throw std::runtime_error {"ERROR: marginal qubit index is out of bounds for the QuantumState.\n"};
+        }
+
+        if (is_seen[i_qubit]) {
+            throw std::runtime_error {"ERROR: marginal qubit indices must not contain duplicates.\n"};
+        }
+
+        is_seen[i_qubit] = true;
+    }
+}
+
+QubitBitGatherer::QubitBitGatherer(const std::vector<std::size_t>& qubit_indices, std::size_t n_qubits)
+    : n_bytes_ {(n_qubits + BITS_PER_BYTE_ - 1) / BITS_PER_BYTE_}
+    , table_(n_bytes_ * BYTE_TABLE_SIZE_, 0)
+{
+    for (std::size_t i_output_bit {0}; i_output_bit < qubit_indices.size(); ++i_output_bit) {
+        const auto i_input_bit = qubit_indices[i_output_bit];
+        const auto i_byte = i_input_bit / BITS_PER_BYTE_;
+        const auto bit_in_byte = std::size_t {1} << (i_input_bit % BITS_PER_BYTE_);
+
+        for (std::size_t byte {0}; byte < BYTE_TABLE_SIZE_; ++byte) {
+            if ((byte & bit_in_byte) != 0) {
+                table_[(i_byte * BYTE_TABLE_SIZE_) + byte] |= (std::size_t {1} << i_output_bit);
+            }
+        }
+    }
+}
+
 }  // namespace ket::internal
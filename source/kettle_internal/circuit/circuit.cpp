@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <ranges>
@@ -14,6 +15,7 @@
 #include "kettle/common/matrix2x2.hpp"
 #include "kettle/common/utils.hpp"
 #include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
 #include "kettle/parameter/parameter.hpp"
 #include "kettle/parameter/parameter_expression.hpp"
 
@@ -21,6 +23,7 @@
 
 #include "kettle_internal/common/mathtools_internal.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
 #include "kettle_internal/gates/primitive_gate_map.hpp"
 #include "kettle_internal/common/utils_internal.hpp"
 
@@ -47,6 +50,75 @@ auto default_parameter_name_(std::size_t param_number) -> std::string
     return output.str();
 }
 
+/*
+    Throws if any gate in `circuit`, including the gates in the subcircuits of its control flow statements,
+    is a measurement gate or acts on one of the qubits in `control_qubits`.
+*/
+void check_controlled_block_subcircuit_(  // NOLINT(misc-no-recursion)
+    const ket::QuantumCircuit& circuit,
+    const std::vector<std::size_t>& control_qubits
+)
+{
+    namespace gid = ki::gate_id;
+    namespace cre = ki::create;
+
+    const auto check_not_control = [&](std::size_t qubit) {
+        if (std::ranges::find(control_qubits, qubit) != control_qubits.end()) {
+            throw std::runtime_error {"ERROR: the subcircuit of a controlled block cannot act on its control qubits.\n"};
+        }
+    };
+
+    for (const auto& element : circuit) {
+        if (element.is_control_flow()) {
+            const auto& control_flow = element.get_control_flow();
+
+            if (control_flow.is_if_statement()) {
+                check_controlled_block_subcircuit_(*control_flow.get_if_statement().circuit(), control_qubits);
+            }
+            else if (control_flow.is_if_else_statement()) {
+                const auto& if_else_stmt = control_flow.get_if_else_statement();
+                check_controlled_block_subcircuit_(*if_else_stmt.if_circuit(), control_qubits);
+                check_controlled_block_subcircuit_(*if_else_stmt.else_circuit(), control_qubits);
+            }
+            else if (control_flow.is_repeat_statement()) {
+                check_controlled_block_subcircuit_(*control_flow.get_repeat_statement().circuit(), control_qubits);
+            }
+            else if (control_flow.is_controlled_block()) {
+                const auto& block = control_flow.get_controlled_block();
+                for (auto qubit : block.control_qubits()) {
+                    check_not_control(qubit);
+                }
+                check_controlled_block_subcircuit_(*block.circuit(), control_qubits);
+            }
+            else {
+                throw std::runtime_error {"DEV ERROR: unimplemented control flow in `check_controlled_block_subcircuit_()`\n"};
+            }
+        }
+        else if (element.is_gate()) {
+            const auto& gate_info = element.get_gate();
+
+            if (gate_info.gate == ket::Gate::M) {
+                throw std::runtime_error {"ERROR: the subcircuit of a controlled block cannot contain measurement gates.\n"};
+            }
+            else if (gate_info.gate == ket::Gate::PAULI_ROT) {
+                for (const auto& [qubit, term] : (*gate_info.pauli_string_ptr).terms()) {
+                    if (term != ket::PauliTerm::I) {
+                        check_not_control(qubit);
+                    }
+                }
+            }
+            else if (gid::is_single_qubit_transform_gate(gate_info.gate)) {
+                check_not_control(cre::unpack_single_qubit_gate_index(gate_info));
+            }
+            else if (gid::is_double_qubit_transform_gate(gate_info.gate)) {
+                const auto [control, target] = cre::unpack_double_qubit_gate_indices(gate_info);
+                check_not_control(control);
+                check_not_control(target);
+            }
+        }
+    }
+}
+
 template <ket::QubitIndices Container = ket::QubitIndicesIList>
 void apply_fourier_transform_swaps_(ket::QuantumCircuit& circuit, const Container& container)
 {
@@ -87,6 +159,7 @@ void QuantumCircuit::set_parameter_value(const ket::param::ParameterID& id, doub
     }
 
     parameter_data_[id].value = angle;
+    ++generation_;
 }
 
 void QuantumCircuit::pop_back()
@@ -96,6 +169,12 @@ void QuantumCircuit::pop_back()
     }
 
     elements_.pop_back();
+    ++generation_;
+}
+
+void QuantumCircuit::reserve_circuit_elements(std::size_t n_elements)
+{
+    elements_.reserve(n_elements);
 }
 
 void QuantumCircuit::add_h_gate(std::size_t target_index)
@@ -653,7 +732,7 @@ template void QuantumCircuit::add_cp_gate<ControlAndTargetIndicesAndAnglesIList>
 void QuantumCircuit::add_u_gate(const Matrix2X2& gate, std::size_t target_index)
 {
     check_qubit_range_(target_index, "qubit", "U");
-    elements_.emplace_back(create::create_u_gate(target_index, ket::ClonePtr<Matrix2X2> {gate}));
+    emplace_back_element_(create::create_u_gate(target_index, ket::ClonePtr<Matrix2X2> {gate}));
 }
 
 template <QubitIndices Container>
@@ -672,7 +751,7 @@ void QuantumCircuit::add_cu_gate(const Matrix2X2& gate, std::size_t control_inde
     check_qubit_range_(control_index, "control qubit", "CU");
     check_qubit_range_(target_index, "target qubit", "CU");
 
-    elements_.emplace_back(create::create_cu_gate(control_index, target_index, ket::ClonePtr<Matrix2X2> {gate}));
+    emplace_back_element_(create::create_cu_gate(control_index, target_index, ket::ClonePtr<Matrix2X2> {gate}));
 }
 
 template <ControlAndTargetIndices Container>
@@ -685,11 +764,46 @@ void QuantumCircuit::add_cu_gate(const Matrix2X2& gate, const Container& pairs)
 template void QuantumCircuit::add_cu_gate<ControlAndTargetIndicesVector>(const Matrix2X2& gate, const ControlAndTargetIndicesVector& indices);
 template void QuantumCircuit::add_cu_gate<ControlAndTargetIndicesIList>(const Matrix2X2& gate, const ControlAndTargetIndicesIList& indices);
 
+void QuantumCircuit::add_pauli_rotation_gate(const SparsePauliString& pauli_string, double angle)
+{
+    check_pauli_rotation_string_(pauli_string);
+    emplace_back_element_(create::create_pauli_rotation_gate(ket::ClonePtr<SparsePauliString> {pauli_string}, angle));
+}
+
+auto QuantumCircuit::add_pauli_rotation_gate(
+    const SparsePauliString& pauli_string,
+    double initial_angle,
+    [[maybe_unused]] ket::param::parameterized key
+) -> ket::param::ParameterID
+{
+    check_pauli_rotation_string_(pauli_string);
+
+    auto [expression, id] = create_initialized_parameter_data_(initial_angle);
+    emplace_back_element_(create::create_pauli_rotation_parameter_gate(ket::ClonePtr<SparsePauliString> {pauli_string}, std::move(expression)));
+
+    return id;
+}
+
+void QuantumCircuit::add_pauli_rotation_gate(const SparsePauliString& pauli_string, const ket::param::ParameterID& id)
+{
+    check_pauli_rotation_string_(pauli_string);
+
+    auto expression = [&]() {
+        if (parameter_data_.contains(id)) {
+            return update_existing_parameter_data_(id);
+        } else {
+            return create_uninitialized_parameter_data_(id);
+        }
+    }();
+
+    emplace_back_element_(create::create_pauli_rotation_parameter_gate(ket::ClonePtr<SparsePauliString> {pauli_string}, std::move(expression)));
+}
+
 void QuantumCircuit::add_m_gate(std::size_t target_index)
 {
     check_qubit_range_(target_index, "qubit", "M");
     check_bit_range_(target_index);
-    elements_.emplace_back(create::create_m_gate(target_index, target_index));
+    emplace_back_element_(create::create_m_gate(target_index, target_index));
 }
 
 template <QubitIndices Container>
@@ -706,7 +820,7 @@ void QuantumCircuit::add_m_gate(std::size_t target_index, std::size_t bit_index)
 {
     check_qubit_range_(target_index, "qubit", "M");
     check_bit_range_(bit_index);
-    elements_.emplace_back(create::create_m_gate(target_index, bit_index));
+    emplace_back_element_(create::create_m_gate(target_index, bit_index));
 }
 
 template <QubitAndBitIndices Container>
@@ -919,7 +1033,7 @@ void QuantumCircuit::add_if_statement(
         std::make_unique<QuantumCircuit>(std::move(circuit))
     };
 
-    elements_.emplace_back(std::move(cfi));
+    emplace_back_element_(std::move(cfi));
 }
 
 // TODO: account for parameterization here
@@ -953,13 +1067,16 @@ void QuantumCircuit::add_if_else_statement(
         check_bit_range_(bit_index);
     }
 
+    merge_subcircuit_parameters_(if_subcircuit, MATCHING_PARAMETER_VALUE_TOLERANCE);
+    merge_subcircuit_parameters_(else_subcircuit, MATCHING_PARAMETER_VALUE_TOLERANCE);
+
     auto cfi = ClassicalIfElseStatement {
         std::move(predicate),
         std::make_unique<QuantumCircuit>(std::move(if_subcircuit)),
         std::make_unique<QuantumCircuit>(std::move(else_subcircuit))
     };
 
-    elements_.emplace_back(std::move(cfi));
+    emplace_back_element_(std::move(cfi));
 }
 
 // TODO: account for parameterization here
@@ -984,19 +1101,75 @@ void QuantumCircuit::add_if_not_else_statement(
     add_if_else_statement(std::move(predicate), std::move(if_subcircuit), std::move(else_subcircuit));
 }
 
+void QuantumCircuit::add_repeat_statement(std::size_t n_repetitions, QuantumCircuit subcircuit)
+{
+    if (subcircuit.n_qubits() != n_qubits_ || subcircuit.n_bits() != n_bits_) {
+        throw std::runtime_error {"ERROR: the repeated subcircuit must have the same number of qubits and bits as the circuit.\n"};
+    }
+
+    merge_subcircuit_parameters_(subcircuit, MATCHING_PARAMETER_VALUE_TOLERANCE);
+
+    auto cfi = RepeatStatement {
+        n_repetitions,
+        std::make_unique<QuantumCircuit>(std::move(subcircuit))
+    };
+
+    emplace_back_element_(std::move(cfi));
+}
+
+template <QubitIndices Container>
+void QuantumCircuit::add_controlled_block(const Container& control_qubits, QuantumCircuit subcircuit)
+{
+    if (subcircuit.n_qubits() != n_qubits_ || subcircuit.n_bits() != n_bits_) {
+        throw std::runtime_error {"ERROR: the controlled subcircuit must have the same number of qubits and bits as the circuit.\n"};
+    }
+
+    auto controls = std::vector<std::size_t> {control_qubits.begin(), control_qubits.end()};
+
+    if (controls.empty()) {
+        throw std::runtime_error {"ERROR: a controlled block needs at least one control qubit.\n"};
+    }
+
+    if (controls.size() >= n_qubits_) {
+        throw std::runtime_error {"ERROR: a controlled block needs at least one qubit that is not a control qubit.\n"};
+    }
+
+    for (auto control : controls) {
+        check_qubit_range_(control, "control qubit", "controlled block");
+    }
+
+    std::ranges::sort(controls);
+    if (std::ranges::adjacent_find(controls) != controls.end()) {
+        throw std::runtime_error {"ERROR: the control qubits of a controlled block must be unique.\n"};
+    }
+
+    check_controlled_block_subcircuit_(subcircuit, controls);
+
+    merge_subcircuit_parameters_(subcircuit, MATCHING_PARAMETER_VALUE_TOLERANCE);
+
+    auto cfi = ControlledBlock {
+        std::move(controls),
+        std::make_unique<QuantumCircuit>(std::move(subcircuit))
+    };
+
+    emplace_back_element_(std::move(cfi));
+}
+template void QuantumCircuit::add_controlled_block<QubitIndicesVector>(const QubitIndicesVector& control_qubits, QuantumCircuit subcircuit);
+template void QuantumCircuit::add_controlled_block<QubitIndicesIList>(const QubitIndicesIList& control_qubits, QuantumCircuit subcircuit);
+
 void QuantumCircuit::add_classical_register_circuit_logger()
 {
-    elements_.emplace_back(ClassicalRegisterCircuitLogger {});
+    emplace_back_element_(ClassicalRegisterCircuitLogger {});
 }
 
 void QuantumCircuit::add_statevector_circuit_logger()
 {
-    elements_.emplace_back(StatevectorCircuitLogger {});
+    emplace_back_element_(StatevectorCircuitLogger {});
 }
 
 void QuantumCircuit::add_circuit_logger(CircuitLogger circuit_logger)
 {
-    elements_.emplace_back(std::move(circuit_logger));
+    emplace_back_element_(std::move(circuit_logger));
 }
 
 void QuantumCircuit::check_qubit_range_(std::size_t target_index, std::string_view qubit_name, std::string_view gate_name) const
@@ -1013,6 +1186,14 @@ void QuantumCircuit::check_qubit_range_(std::size_t target_index, std::string_vi
     }
 }
 
+void QuantumCircuit::check_qubit_range_(std::size_t target_index, std::string_view qubit_name, ket::Gate gate) const
+{
+    // the name of the gate is only needed for the error message, so it is only looked up on failure
+    if (target_index >= n_qubits_) {
+        check_qubit_range_(target_index, qubit_name, ki::PRIMITIVE_GATES_TO_STRING.at(gate));
+    }
+}
+
 void QuantumCircuit::check_bit_range_(std::size_t bit_index) const
 {
     if (bit_index >= n_bits_) {
@@ -1026,14 +1207,36 @@ void QuantumCircuit::check_bit_range_(std::size_t bit_index) const
     }
 }
 
+void QuantumCircuit::check_pauli_rotation_string_(const SparsePauliString& pauli_string) const
+{
+    if (pauli_string.n_qubits() != n_qubits_) {
+        auto err_msg = std::stringstream {};
+
+        err_msg << "ERROR: the Pauli string of the 'PAULI_ROT' gate does not act on the same number of qubits as the circuit.\n";
+        err_msg << "circuit n_qubits      = " << n_qubits_ << '\n';
+        err_msg << "Pauli string n_qubits = " << pauli_string.n_qubits() << '\n';
+
+        throw std::runtime_error {err_msg.str()};
+    }
+
+    const auto is_zero = [](std::uint64_t word) { return word == 0; };
+    if (std::ranges::all_of(pauli_string.x_mask(), is_zero) && std::ranges::all_of(pauli_string.z_mask(), is_zero)) {
+        throw std::runtime_error {"ERROR: the Pauli string of the 'PAULI_ROT' gate must have at least one non-identity term.\n"};
+    }
+
+    const auto phase = pauli_string.phase();
+    if (phase != PauliPhase::PLUS_ONE && phase != PauliPhase::MINUS_ONE) {
+        throw std::runtime_error {"ERROR: the Pauli string of the 'PAULI_ROT' gate must have a phase of +1 or -1.\n"};
+    }
+}
+
 void QuantumCircuit::add_one_target_gate_(
     std::size_t target_index,
     ket::Gate gate
 )
 {
-    const auto gate_name = ki::PRIMITIVE_GATES_TO_STRING.at(gate);
-    check_qubit_range_(target_index, "qubit", gate_name);
-    elements_.emplace_back(create::create_one_target_gate(gate, target_index));
+    check_qubit_range_(target_index, "qubit", gate);
+    emplace_back_element_(create::create_one_target_gate(gate, target_index));
 }
 
 void QuantumCircuit::add_one_target_one_angle_gate_(
@@ -1042,9 +1245,8 @@ void QuantumCircuit::add_one_target_one_angle_gate_(
     ket::Gate gate
 )
 {
-    const auto gate_name = ki::PRIMITIVE_GATES_TO_STRING.at(gate);
-    check_qubit_range_(target_index, "qubit", gate_name);
-    elements_.emplace_back(create::create_one_target_one_angle_gate(gate, target_index, angle));
+    check_qubit_range_(target_index, "qubit", gate);
+    emplace_back_element_(create::create_one_target_one_angle_gate(gate, target_index, angle));
 }
 
 void QuantumCircuit::add_one_control_one_target_gate_(
@@ -1053,10 +1255,9 @@ void QuantumCircuit::add_one_control_one_target_gate_(
     ket::Gate gate
 )
 {
-    const auto gate_name = ki::PRIMITIVE_GATES_TO_STRING.at(gate);
-    check_qubit_range_(control_index, "control qubit", gate_name);
-    check_qubit_range_(target_index, "target qubit", gate_name);
-    elements_.emplace_back(create::create_one_control_one_target_gate(gate, control_index, target_index));
+    check_qubit_range_(control_index, "control qubit", gate);
+    check_qubit_range_(target_index, "target qubit", gate);
+    emplace_back_element_(create::create_one_control_one_target_gate(gate, control_index, target_index));
 }
 
 void QuantumCircuit::add_one_control_one_target_one_angle_gate_(
@@ -1066,10 +1267,9 @@ void QuantumCircuit::add_one_control_one_target_one_angle_gate_(
     ket::Gate gate
 )
 {
-    const auto gate_name = ki::PRIMITIVE_GATES_TO_STRING.at(gate);
-    check_qubit_range_(control_index, "control qubit", gate_name);
-    check_qubit_range_(target_index, "target qubit", gate_name);
-    elements_.emplace_back(create::create_one_control_one_target_one_angle_gate(gate, control_index, target_index, angle));
+    check_qubit_range_(control_index, "control qubit", gate);
+    check_qubit_range_(target_index, "target qubit", gate);
+    emplace_back_element_(create::create_one_control_one_target_one_angle_gate(gate, control_index, target_index, angle));
 }
 
 auto QuantumCircuit::add_one_target_one_parameter_gate_with_angle_(
@@ -1079,11 +1279,10 @@ auto QuantumCircuit::add_one_target_one_parameter_gate_with_angle_(
     [[maybe_unused]] ket::param::parameterized key
 ) -> ket::param::ParameterID
 {
-    const auto gate_name = ki::PRIMITIVE_GATES_TO_STRING.at(gate);
-    check_qubit_range_(target_index, "qubit", gate_name);
+    check_qubit_range_(target_index, "qubit", gate);
 
     auto [expression, id] = create_initialized_parameter_data_(initial_angle);
-    elements_.emplace_back(create::create_one_target_one_parameter_gate(gate, target_index, std::move(expression)));
+    emplace_back_element_(create::create_one_target_one_parameter_gate(gate, target_index, std::move(expression)));
 
     return id;
 }
@@ -1094,20 +1293,19 @@ void QuantumCircuit::add_one_target_one_parameter_gate_without_angle_(
     const ket::param::ParameterID& id
 )
 {
-    const auto gate_name = ki::PRIMITIVE_GATES_TO_STRING.at(gate);
-    check_qubit_range_(target_index, "qubit", gate_name);
+    check_qubit_range_(target_index, "qubit", gate);
 
     if (parameter_data_.contains(id)) {
         // if the parameter is already present;
         // no need to change its value; just update the count and create the new gate
         auto expression = update_existing_parameter_data_(id);
-        elements_.emplace_back(create::create_one_target_one_parameter_gate(gate, target_index, std::move(expression)));
+        emplace_back_element_(create::create_one_target_one_parameter_gate(gate, target_index, std::move(expression)));
     }
     else {
         // if the parameter is not here;
         // create a new entry, with an empty value
         auto expression = create_uninitialized_parameter_data_(id);
-        elements_.emplace_back(create::create_one_target_one_parameter_gate(gate, target_index, std::move(expression)));
+        emplace_back_element_(create::create_one_target_one_parameter_gate(gate, target_index, std::move(expression)));
     }
 }
 
@@ -1119,12 +1317,11 @@ auto QuantumCircuit::add_one_control_one_target_one_parameter_gate_with_angle_(
     [[maybe_unused]] ket::param::parameterized key
 ) -> ket::param::ParameterID
 {
-    const auto gate_name = ki::PRIMITIVE_GATES_TO_STRING.at(gate);
-    check_qubit_range_(control_index, "control qubit", gate_name);
-    check_qubit_range_(target_index, "target qubit", gate_name);
+    check_qubit_range_(control_index, "control qubit", gate);
+    check_qubit_range_(target_index, "target qubit", gate);
 
     auto [expression, id] = create_initialized_parameter_data_(initial_angle);
-    elements_.emplace_back(create::create_one_control_one_target_one_parameter_gate(gate, control_index, target_index, std::move(expression)));
+    emplace_back_element_(create::create_one_control_one_target_one_parameter_gate(gate, control_index, target_index, std::move(expression)));
 
     return id;
 }
@@ -1136,21 +1333,20 @@ void QuantumCircuit::add_one_control_one_target_one_parameter_gate_without_angle
     const ket::param::ParameterID& id
 )
 {
-    const auto gate_name = ki::PRIMITIVE_GATES_TO_STRING.at(gate);
-    check_qubit_range_(control_index, "control qubit", gate_name);
-    check_qubit_range_(target_index, "target qubit", gate_name);
+    check_qubit_range_(control_index, "control qubit", gate);
+    check_qubit_range_(target_index, "target qubit", gate);
 
     if (parameter_data_.contains(id)) {
         // if the parameter is already present;
         // no need to change its value; just update the count and create the new gate
         auto expression = update_existing_parameter_data_(id);
-        elements_.emplace_back(create::create_one_control_one_target_one_parameter_gate(gate, control_index, target_index, std::move(expression)));
+        emplace_back_element_(create::create_one_control_one_target_one_parameter_gate(gate, control_index, target_index, std::move(expression)));
     }
     else {
         // if the parameter is not here;
         // create a new entry, with an empty value
         auto expression = create_uninitialized_parameter_data_(id);
-        elements_.emplace_back(create::create_one_control_one_target_one_parameter_gate(gate, control_index, target_index, std::move(expression)));
+        emplace_back_element_(create::create_one_control_one_target_one_parameter_gate(gate, control_index, target_index, std::move(expression)));
     }
 }
 
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/circuit_element.hpp"
+#include "kettle/circuit/compact_circuit.hpp"
+#include "kettle/common/matrix2x2.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/parameter/parameter_expression.hpp"
+
+
+namespace ket
+{
+
+/*
+    Gives the implementation details of the library direct access to the members of a `QuantumCircuit`
+    or a `CompactCircuit`, for the functions that build a circuit element by element (the transpiler,
+    the binary circuit loader, and so on) without going through the checks of the public member functions.
+
+    This class is only a friend of `QuantumCircuit` and `CompactCircuit`; it is not part of the public
+    interface, and is only defined in the source tree. Changes made through it do not update the
+    generation of the circuit, so it should only be used on circuits that are still being built.
+*/
+class CircuitAccess_
+{
+public:
+    static auto elements(QuantumCircuit& circuit) noexcept -> std::vector<CircuitElement>&
+    {
+        return circuit.elements_;
+    }
+
+    static auto parameter_data(QuantumCircuit& circuit) noexcept -> param::ParameterDataMap&
+    {
+        return circuit.parameter_data_;
+    }
+
+    static auto parameter_count(QuantumCircuit& circuit) noexcept -> std::size_t&
+    {
+        return circuit.parameter_count_;
+    }
+
+    static auto parameter_count(const QuantumCircuit& circuit) noexcept -> std::size_t
+    {
+        return circuit.parameter_count_;
+    }
+
+    static auto gates(CompactCircuit& circuit) noexcept -> std::vector<CompactGate>&
+    {
+        return circuit.gates_;
+    }
+
+    static auto gates(const CompactCircuit& circuit) noexcept -> const std::vector<CompactGate>&
+    {
+        return circuit.gates_;
+    }
+
+    static auto angles(CompactCircuit& circuit) noexcept -> std::vector<double>&
+    {
+        return circuit.angles_;
+    }
+
+    /*
+        After the matrices are filled in, `index_unitaries()` must be called, so that matrices added
+        later are still only stored once.
+    */
+    static auto unitaries(CompactCircuit& circuit) noexcept -> std::vector<Matrix2X2>&
+    {
+        return circuit.unitaries_;
+    }
+
+    static void index_unitaries(CompactCircuit& circuit)
+    {
+        circuit.index_unitaries_();
+    }
+
+    static auto parameter_expressions(CompactCircuit& circuit) noexcept -> std::vector<param::ParameterExpression>&
+    {
+        return circuit.parameter_expressions_;
+    }
+
+    static auto pauli_strings(CompactCircuit& circuit) noexcept -> std::vector<SparsePauliString>&
+    {
+        return circuit.pauli_strings_;
+    }
+
+    static auto parameter_data(CompactCircuit& circuit) noexcept -> param::ParameterDataMap&
+    {
+        return circuit.parameter_data_;
+    }
+
+    static auto parameter_count(CompactCircuit& circuit) noexcept -> std::size_t&
+    {
+        return circuit.parameter_count_;
+    }
+
+    static auto parameter_count(const CompactCircuit& circuit) noexcept -> std::size_t
+    {
+        return circuit.parameter_count_;
+    }
+};
+
+}  // namespace ket
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/circuit_dag.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+
+
+namespace
+{
+
+void check_index_(std::size_t index, std::size_t size, std::string_view name)
+{
+    if (index >= size) {
+        auto message = std::string {"ERROR: the "};
+        message += name;
+        message += " index is out of range in `CircuitDag`\n";
+        throw std::runtime_error {message};
+    }
+}
+
+/*
+    Returns the wires that `element` acts on, in increasing order and without duplicates.
+*/
+auto element_wires_(const ket::CircuitElement& element, std::size_t n_qubits, std::size_t n_bits) -> std::vector<std::size_t>
+{
+    namespace gid = ket::internal::gate_id;
+    namespace cre = ket::internal::create;
+    using G = ket::Gate;
+
+    if (element.is_control_flow() || element.is_circuit_logger()) {
+        auto output = std::vector<std::size_t>(n_qubits + n_bits);
+        std::iota(output.begin(), output.end(), std::size_t {0});
+        return output;
+    }
+
+    if (!element.is_gate()) {
+        throw std::runtime_error {"DEV ERROR: invalid circuit element found in `CircuitDag`\n"};
+    }
+
+    const auto& info = element.get_gate();
+
+    if (info.gate == G::PAULI_ROT) {
+        auto output = std::vector<std::size_t> {};
+        for (const auto& [qubit, term] : (*info.pauli_string_ptr).terms()) {
+            if (term != ket::PauliTerm::I) {
+                output.push_back(qubit);
+            }
+        }
+        std::ranges::sort(output);
+
+        return output;
+    }
+    else if (info.gate == G::M) {
+        const auto [qubit, bit] = cre::unpack_m_gate(info);
+        return {qubit, n_qubits + bit};
+    }
+    else if (gid::is_single_qubit_transform_gate(info.gate)) {
+        return {cre::unpack_single_qubit_gate_index(info)};
+    }
+    else if (gid::is_double_qubit_transform_gate(info.gate)) {
+        const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+        return {std::min(control, target), std::max(control, target)};
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: invalid gate found in `CircuitDag`\n"};
+    }
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+CircuitDag::CircuitDag(const QuantumCircuit& circuit)
+    : n_qubits_ {circuit.n_qubits()}
+    , n_bits_ {circuit.n_bits()}
+{
+    rebuild_(circuit);
+}
+
+void CircuitDag::sync(const QuantumCircuit& circuit)
+{
+    if (circuit.n_qubits() != n_qubits_ || circuit.n_bits() != n_bits_) {
+        throw std::runtime_error {"ERROR: the circuit does not match the `CircuitDag` it is synced with\n"};
+    }
+
+    // adding elements increases the generation by the number of elements added, and any other change
+    // increases it without adding an element; so the two only match if elements were only added
+    const auto n_elements = circuit.n_circuit_elements();
+    const auto only_added = n_elements >= n_nodes() && circuit.generation() - generation_ == n_elements - n_nodes();
+
+    if (!only_added) {
+        rebuild_(circuit);
+        return;
+    }
+
+    for (auto i_node {n_nodes()}; i_node < n_elements; ++i_node) {
+        push_back_(circuit[i_node]);
+    }
+
+    generation_ = circuit.generation();
+}
+
+auto CircuitDag::qubit_wire(std::size_t qubit) const -> const std::vector<std::size_t>&
+{
+    check_index_(qubit, n_qubits_, "qubit");
+    return wires_[qubit];
+}
+
+auto CircuitDag::bit_wire(std::size_t bit) const -> const std::vector<std::size_t>&
+{
+    check_index_(bit, n_bits_, "bit");
+    return wires_[n_qubits_ + bit];
+}
+
+auto CircuitDag::predecessors(std::size_t i_node) const -> const std::vector<std::size_t>&
+{
+    check_index_(i_node, n_nodes(), "node");
+    return predecessors_[i_node];
+}
+
+auto CircuitDag::successors(std::size_t i_node) const -> const std::vector<std::size_t>&
+{
+    check_index_(i_node, n_nodes(), "node");
+    return successors_[i_node];
+}
+
+auto CircuitDag::layer(std::size_t i_node) const -> std::size_t
+{
+    check_index_(i_node, n_nodes(), "node");
+    return layers_[i_node];
+}
+
+auto CircuitDag::layer_nodes(std::size_t i_layer) const -> const std::vector<std::size_t>&
+{
+    check_index_(i_layer, n_layers(), "layer");
+    return layer_nodes_[i_layer];
+}
+
+void CircuitDag::push_back_(const CircuitElement& element)
+{
+    const auto i_node = n_nodes();
+    auto node_wires = element_wires_(element, n_qubits_, n_bits_);
+
+    auto predecessors = std::vector<std::size_t> {};
+    for (auto wire : node_wires) {
+        if (!wires_[wire].empty()) {
+            predecessors.push_back(wires_[wire].back());
+        }
+        wires_[wire].push_back(i_node);
+    }
+
+    std::ranges::sort(predecessors);
+    const auto duplicates = std::ranges::unique(predecessors);
+    predecessors.erase(duplicates.begin(), duplicates.end());
+
+    auto layer = std::size_t {0};
+    for (auto i_pred : predecessors) {
+        successors_[i_pred].push_back(i_node);
+        layer = std::max(layer, layers_[i_pred] + 1);
+    }
+
+    if (layer == layer_nodes_.size()) {
+        layer_nodes_.emplace_back();
+    }
+    layer_nodes_[layer].push_back(i_node);
+
+    node_wires_.push_back(std::move(node_wires));
+    predecessors_.push_back(std::move(predecessors));
+    successors_.emplace_back();
+    layers_.push_back(layer);
+}
+
+void CircuitDag::rebuild_(const QuantumCircuit& circuit)
+{
+    wires_.assign(n_qubits_ + n_bits_, {});
+    node_wires_.clear();
+    predecessors_.clear();
+    successors_.clear();
+    layers_.clear();
+    layer_nodes_.clear();
+
+    for (const auto& element : circuit) {
+        push_back_(element);
+    }
+
+    generation_ = circuit.generation();
+}
+
+}  // namespace ket
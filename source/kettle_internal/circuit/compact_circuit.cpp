@@ -0,0 +1,360 @@
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/compact_circuit.hpp"
+#include "kettle/common/clone_ptr.hpp"
+#include "kettle/common/matrix2x2.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/parameter/parameter_expression.hpp"
+
+#include "kettle_internal/circuit/circuit_access.hpp"
+#include "kettle_internal/common/matrix2x2_internal.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+
+
+namespace ki = ket::internal;
+
+namespace
+{
+
+using G = ket::Gate;
+namespace gid = ket::internal::gate_id;
+namespace cre = ket::internal::create;
+
+constexpr auto MAX_COMPACT_INDEX = static_cast<std::size_t>(std::numeric_limits<std::uint32_t>::max());
+
+auto to_compact_index_(std::size_t index) -> std::uint32_t
+{
+    if (index > MAX_COMPACT_INDEX) {
+        throw std::runtime_error {"ERROR: index is too large to be stored in a `CompactCircuit`\n"};
+    }
+
+    return static_cast<std::uint32_t>(index);
+}
+
+/*
+    Adds `value` to the end of `pool`, and returns its index.
+*/
+template <typename T>
+auto add_to_pool_(std::vector<T>& pool, T value) -> std::uint32_t
+{
+    const auto index = to_compact_index_(pool.size());
+    pool.push_back(std::move(value));
+
+    return index;
+}
+
+auto has_angle_(G gate) -> bool
+{
+    return gid::is_angle_transform_gate(gate) || gate == G::PAULI_ROT;
+}
+
+auto uses_unitary_(G gate) -> bool
+{
+    return gate == G::U || gate == G::CU;
+}
+
+/*
+    Returns a copy of `gate` with its pool indices shifted by the sizes of the pools of another circuit;
+    the matrices are not shifted, but looked up in `unitary_indices`, because matrices that the other
+    circuit already has are not added to its pool again.
+*/
+auto shifted_gate_(
+    ket::CompactGate gate,
+    std::uint32_t angle_offset,
+    const std::vector<std::uint32_t>& unitary_indices,
+    std::uint32_t expression_offset,
+    std::uint32_t pauli_offset
+) -> ket::CompactGate
+{
+    if (gate.gate == G::PAULI_ROT) {
+        gate.arg0 += pauli_offset;
+    }
+
+    if (gate.is_parameterized) {
+        gate.payload += expression_offset;
+    }
+    else if (has_angle_(gate.gate)) {
+        gate.payload += angle_offset;
+    }
+    else if (uses_unitary_(gate.gate)) {
+        gate.payload = unitary_indices[gate.payload];
+    }
+
+    return gate;
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+CompactCircuit::CompactCircuit(std::size_t n_qubits, std::size_t n_bits)
+    : n_qubits_ {n_qubits}
+    , n_bits_ {n_bits}
+{}
+
+CompactCircuit::CompactCircuit(std::size_t n_qubits)
+    : CompactCircuit {n_qubits, n_qubits}
+{}
+
+CompactCircuit::CompactCircuit(const QuantumCircuit& circuit)
+    : n_qubits_ {circuit.n_qubits()}
+    , n_bits_ {circuit.n_bits()}
+    , parameter_data_ {circuit.parameter_data_map()}
+    , parameter_count_ {CircuitAccess_::parameter_count(circuit)}
+{
+    gates_.reserve(circuit.n_circuit_elements());
+
+    for (const auto& element : circuit) {
+        if (!element.is_gate()) {
+            throw std::runtime_error {"ERROR: a `CompactCircuit` can only hold gates\n"};
+        }
+
+        push_back_(element.get_gate());
+    }
+}
+
+auto CompactCircuit::angle(const CompactGate& gate) const -> double
+{
+    if (gate.is_parameterized || !has_angle_(gate.gate)) {
+        throw std::runtime_error {"ERROR: the gate does not have a fixed angle\n"};
+    }
+
+    return angles_.at(gate.payload);
+}
+
+auto CompactCircuit::unitary(const CompactGate& gate) const -> const Matrix2X2&
+{
+    if (!uses_unitary_(gate.gate)) {
+        throw std::runtime_error {"ERROR: the gate does not have a unitary matrix\n"};
+    }
+
+    return unitaries_.at(gate.payload);
+}
+
+auto CompactCircuit::parameter_expression(const CompactGate& gate) const -> const ket::param::ParameterExpression&
+{
+    if (!gate.is_parameterized) {
+        throw std::runtime_error {"ERROR: the gate does not have a parameter expression\n"};
+    }
+
+    return parameter_expressions_.at(gate.payload);
+}
+
+auto CompactCircuit::pauli_string(const CompactGate& gate) const -> const SparsePauliString&
+{
+    if (gate.gate != G::PAULI_ROT) {
+        throw std::runtime_error {"ERROR: the gate does not have a Pauli string\n"};
+    }
+
+    return pauli_strings_.at(gate.arg0);
+}
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto CompactCircuit::gate_info(std::size_t index) const -> GateInfo
+{
+    const auto& gate = gates_.at(index);
+
+    if (gate.gate == G::M) {
+        return cre::create_m_gate(gate.arg0, gate.arg1);
+    }
+    else if (gate.gate == G::PAULI_ROT) {
+        auto pauli_ptr = ClonePtr<SparsePauliString> {pauli_string(gate)};
+        if (gate.is_parameterized) {
+            return cre::create_pauli_rotation_parameter_gate(std::move(pauli_ptr), parameter_expression(gate));
+        }
+        return cre::create_pauli_rotation_gate(std::move(pauli_ptr), angle(gate));
+    }
+    else if (gate.gate == G::U) {
+        return cre::create_u_gate(gate.arg0, ClonePtr<Matrix2X2> {unitary(gate)});
+    }
+    else if (gate.gate == G::CU) {
+        return cre::create_cu_gate(gate.arg0, gate.arg1, ClonePtr<Matrix2X2> {unitary(gate)});
+    }
+    else if (gid::is_one_target_transform_gate(gate.gate)) {
+        return cre::create_one_target_gate(gate.gate, gate.arg0);
+    }
+    else if (gid::is_one_target_one_angle_transform_gate(gate.gate)) {
+        if (gate.is_parameterized) {
+            return cre::create_one_target_one_parameter_gate(gate.gate, gate.arg0, parameter_expression(gate));
+        }
+        return cre::create_one_target_one_angle_gate(gate.gate, gate.arg0, angle(gate));
+    }
+    else if (gid::is_one_control_one_target_transform_gate(gate.gate)) {
+        return cre::create_one_control_one_target_gate(gate.gate, gate.arg0, gate.arg1);
+    }
+    else if (gid::is_one_control_one_target_one_angle_transform_gate(gate.gate)) {
+        if (gate.is_parameterized) {
+            return cre::create_one_control_one_target_one_parameter_gate(gate.gate, gate.arg0, gate.arg1, parameter_expression(gate));
+        }
+        return cre::create_one_control_one_target_one_angle_gate(gate.gate, gate.arg0, gate.arg1, angle(gate));
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: invalid gate found in `CompactCircuit`\n"};
+    }
+}
+
+void CompactCircuit::push_back(const GateInfo& gate_info)
+{
+    if (gate_info.param_expression_ptr) {
+        throw std::runtime_error {"ERROR: parameterized gates cannot be added directly to a `CompactCircuit`\n"};
+    }
+
+    const auto check_qubit = [&](std::size_t qubit) {
+        if (qubit >= n_qubits_) {
+            throw std::runtime_error {"ERROR: qubit index out of range in `CompactCircuit::push_back()`\n"};
+        }
+    };
+
+    if (gate_info.gate == G::M) {
+        const auto [qubit, bit] = cre::unpack_m_gate(gate_info);
+        check_qubit(qubit);
+        if (bit >= n_bits_) {
+            throw std::runtime_error {"ERROR: bit index out of range in `CompactCircuit::push_back()`\n"};
+        }
+    }
+    else if (gate_info.gate == G::PAULI_ROT) {
+        for (const auto& [qubit, ignore] : (*gate_info.pauli_string_ptr).terms()) {
+            check_qubit(qubit);
+        }
+    }
+    else if (gid::is_single_qubit_transform_gate(gate_info.gate)) {
+        check_qubit(cre::unpack_single_qubit_gate_index(gate_info));
+    }
+    else if (gid::is_double_qubit_transform_gate(gate_info.gate)) {
+        const auto [control, target] = cre::unpack_double_qubit_gate_indices(gate_info);
+        check_qubit(control);
+        check_qubit(target);
+    }
+
+    push_back_(gate_info);
+}
+
+auto CompactCircuit::to_circuit() const -> QuantumCircuit
+{
+    auto circuit = QuantumCircuit {n_qubits_, n_bits_};
+    CircuitAccess_::parameter_data(circuit) = parameter_data_;
+    CircuitAccess_::parameter_count(circuit) = parameter_count_;
+
+    auto& elements = CircuitAccess_::elements(circuit);
+    elements.reserve(gates_.size());
+    for (std::size_t i {0}; i < gates_.size(); ++i) {
+        elements.emplace_back(gate_info(i));
+    }
+
+    return circuit;
+}
+
+void CompactCircuit::reserve(std::size_t n_gates)
+{
+    gates_.reserve(n_gates);
+}
+
+void CompactCircuit::push_back_(const GateInfo& gate_info)
+{
+    auto gate = CompactGate {
+        .gate=gate_info.gate,
+        .is_parameterized=static_cast<bool>(gate_info.param_expression_ptr),
+        .unused=0,
+        .arg0=0,
+        .arg1=0,
+        .payload=0
+    };
+
+    if (gate.gate == G::PAULI_ROT) {
+        gate.arg0 = add_to_pool_(pauli_strings_, *gate_info.pauli_string_ptr);
+    }
+    else {
+        gate.arg0 = to_compact_index_(gate_info.arg0);
+        gate.arg1 = to_compact_index_(gate_info.arg1);
+    }
+
+    if (gate.is_parameterized) {
+        gate.payload = add_to_pool_(parameter_expressions_, *gate_info.param_expression_ptr);
+    }
+    else if (has_angle_(gate.gate)) {
+        gate.payload = add_to_pool_(angles_, gate_info.arg2);
+    }
+    else if (uses_unitary_(gate.gate)) {
+        gate.payload = add_unitary_(*gate_info.unitary_ptr);
+    }
+
+    gates_.push_back(gate);
+}
+
+auto CompactCircuit::add_unitary_(const Matrix2X2& unitary) -> std::uint32_t
+{
+    const auto key = ki::matrix2x2_bits_(unitary);
+    if (const auto it = unitary_indices_.find(key); it != unitary_indices_.end()) {
+        return it->second;
+    }
+
+    const auto index = add_to_pool_(unitaries_, unitary);
+    unitary_indices_.emplace(key, index);
+
+    return index;
+}
+
+void CompactCircuit::index_unitaries_()
+{
+    unitary_indices_.clear();
+    for (std::size_t i {0}; i < unitaries_.size(); ++i) {
+        unitary_indices_.try_emplace(ki::matrix2x2_bits_(unitaries_[i]), to_compact_index_(i));
+    }
+}
+
+void extend_circuit(CompactCircuit& left, const CompactCircuit& right)
+{
+    if (left.n_qubits_ != right.n_qubits_) {
+        throw std::runtime_error {"ERROR: cannot extend circuits with different numbers of qubits.\n"};
+    }
+
+    if (left.n_bits_ != right.n_bits_) {
+        throw std::runtime_error {"ERROR: cannot extend circuits with different numbers of bits.\n"};
+    }
+
+    // make sure that none of the shifted indices overflow, before anything is modified
+    to_compact_index_(left.angles_.size() + right.angles_.size());
+    to_compact_index_(left.unitaries_.size() + right.unitaries_.size());
+    to_compact_index_(left.parameter_expressions_.size() + right.parameter_expressions_.size());
+    to_compact_index_(left.pauli_strings_.size() + right.pauli_strings_.size());
+
+    const auto angle_offset = to_compact_index_(left.angles_.size());
+    const auto expression_offset = to_compact_index_(left.parameter_expressions_.size());
+    const auto pauli_offset = to_compact_index_(left.pauli_strings_.size());
+
+    // the index in the pool of `left` of each matrix in the pool of `right`
+    auto unitary_indices = std::vector<std::uint32_t> {};
+    unitary_indices.reserve(right.unitaries_.size());
+    for (const auto& unitary : right.unitaries_) {
+        unitary_indices.push_back(left.add_unitary_(unitary));
+    }
+
+    left.angles_.insert(left.angles_.end(), right.angles_.begin(), right.angles_.end());
+    left.parameter_expressions_.insert(left.parameter_expressions_.end(), right.parameter_expressions_.begin(), right.parameter_expressions_.end());
+    left.pauli_strings_.insert(left.pauli_strings_.end(), right.pauli_strings_.begin(), right.pauli_strings_.end());
+
+    left.gates_.reserve(left.gates_.size() + right.gates_.size());
+    for (const auto& gate : right.gates_) {
+        left.gates_.push_back(shifted_gate_(gate, angle_offset, unitary_indices, expression_offset, pauli_offset));
+    }
+
+    left.parameter_data_.insert(right.parameter_data_.begin(), right.parameter_data_.end());
+}
+
+auto append_circuits(CompactCircuit left, const CompactCircuit& right) -> CompactCircuit
+{
+    extend_circuit(left, right);
+    return left;
+}
+
+}  // namespace ket
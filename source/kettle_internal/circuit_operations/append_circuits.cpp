@@ -1,6 +1,9 @@
+#include <cstddef>
 #include <stdexcept>
 #include "kettle/circuit/circuit.hpp"
 
+#include "kettle_internal/circuit/circuit_access.hpp"
+
 namespace
 {
 
@@ -32,6 +35,7 @@ void extend_circuit(QuantumCircuit& left, const QuantumCircuit& right)
     left.elements_.reserve(n_new_elements);
     left.elements_.insert(left.elements_.end(), right.elements_.begin(), right.elements_.end());
     left.parameter_data_.insert(right.parameter_data_.begin(), right.parameter_data_.end());
+    left.generation_ += right.elements_.size();
 }
 
 auto append_circuits(QuantumCircuit left, const QuantumCircuit& right) -> QuantumCircuit
@@ -40,5 +44,24 @@ auto append_circuits(QuantumCircuit left, const QuantumCircuit& right) -> Quantu
     return left;
 }
 
+auto slice_circuit(const QuantumCircuit& circuit, std::size_t i_begin, std::size_t i_end) -> QuantumCircuit
+{
+    const auto& elements = circuit.circuit_elements();
+
+    if (i_begin > i_end || i_end > elements.size()) {
+        throw std::runtime_error {"ERROR: invalid range of circuit elements in `slice_circuit()`.\n"};
+    }
+
+    auto sliced = QuantumCircuit {circuit.n_qubits(), circuit.n_bits()};
+    CircuitAccess_::parameter_data(sliced) = circuit.parameter_data_map();
+    CircuitAccess_::parameter_count(sliced) = CircuitAccess_::parameter_count(circuit);
+
+    const auto begin = elements.begin() + static_cast<std::ptrdiff_t>(i_begin);
+    const auto end = elements.begin() + static_cast<std::ptrdiff_t>(i_end);
+    CircuitAccess_::elements(sliced).assign(begin, end);
+
+    return sliced;
+}
+
 
 }  // namespace ket
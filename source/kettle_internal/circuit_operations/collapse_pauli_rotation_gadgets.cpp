@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit_operations/collapse_pauli_rotation_gadgets.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+
+#include "kettle_internal/circuit/circuit_access.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+
+
+namespace
+{
+
+namespace cre = ket::internal::create;
+
+struct MatchedGadget_
+{
+    ket::SparsePauliString pauli_string;
+    double angle;
+    std::size_t n_elements;
+};
+
+/*
+    Returns the gate at `index` if it exists and is not parameterized; the gadgets read from tangelo
+    files only ever hold fixed angles.
+*/
+auto fixed_gate_at_(const std::vector<ket::CircuitElement>& elements, std::size_t index) -> const ket::GateInfo*
+{
+    if (index >= elements.size() || !elements[index].is_gate()) {
+        return nullptr;
+    }
+
+    const auto& info = elements[index].get_gate();
+    if (info.param_expression_ptr) {
+        return nullptr;
+    }
+
+    return &info;
+}
+
+auto is_rx_gate_with_angle_(const ket::GateInfo& info, double angle, double tolerance) -> bool
+{
+    if (info.gate != ket::Gate::RX) {
+        return false;
+    }
+
+    const auto [ignore, rx_angle] = cre::unpack_one_target_one_angle_gate(info);
+    return std::fabs(rx_angle - angle) < tolerance;
+}
+
+/*
+    Attempts to match a Pauli rotation gadget that starts at `i_start`; see the header file for the
+    sequence of gates that is recognized.
+*/
+auto match_pauli_rotation_gadget_(  // NOLINT(readability-function-cognitive-complexity)
+    const std::vector<ket::CircuitElement>& elements,
+    std::size_t i_start,
+    std::size_t n_qubits,
+    double tolerance
+) -> std::optional<MatchedGadget_>
+{
+    using G = ket::Gate;
+    using PT = ket::PauliTerm;
+
+    constexpr auto half_pi = std::numbers::pi / 2.0;
+
+    auto i_element = i_start;
+
+    // the change of basis; each qubit can only be changed once
+    auto terms = std::vector<PT>(n_qubits, PT::I);
+    auto n_basis_changes = std::size_t {0};
+    while (const auto* info = fixed_gate_at_(elements, i_element)) {
+        if (info->gate == G::H && terms[cre::unpack_one_target_gate(*info)] == PT::I) {
+            terms[cre::unpack_one_target_gate(*info)] = PT::X;
+        }
+        else if (is_rx_gate_with_angle_(*info, half_pi, tolerance) && terms[cre::unpack_one_target_gate(*info)] == PT::I) {
+            terms[cre::unpack_one_target_gate(*info)] = PT::Y;
+        }
+        else {
+            break;
+        }
+
+        ++n_basis_changes;
+        ++i_element;
+    }
+
+    // the CX ladder; each CX gate must start at the target of the previous one
+    auto support = std::vector<std::size_t> {};
+    while (const auto* info = fixed_gate_at_(elements, i_element)) {
+        if (info->gate != G::CX) {
+            break;
+        }
+
+        const auto [control, target] = cre::unpack_one_control_one_target_gate(*info);
+        if (support.empty()) {
+            support = {control, target};
+        }
+        else if (control == support.back() && std::ranges::find(support, target) == support.end()) {
+            support.push_back(target);
+        }
+        else {
+            break;
+        }
+
+        ++i_element;
+    }
+
+    if (support.size() < 2) {
+        return std::nullopt;
+    }
+
+    // the rotation itself
+    const auto* rz_info = fixed_gate_at_(elements, i_element);
+    if (rz_info == nullptr || rz_info->gate != G::RZ) {
+        return std::nullopt;
+    }
+
+    const auto [rz_target, angle] = cre::unpack_one_target_one_angle_gate(*rz_info);
+    if (rz_target != support.back()) {
+        return std::nullopt;
+    }
+    ++i_element;
+
+    // the CX ladder in reverse
+    for (std::size_t i {support.size() - 1}; i > 0; --i) {
+        const auto* info = fixed_gate_at_(elements, i_element);
+        if (info == nullptr || info->gate != G::CX) {
+            return std::nullopt;
+        }
+
+        const auto [control, target] = cre::unpack_one_control_one_target_gate(*info);
+        if (control != support[i - 1] || target != support[i]) {
+            return std::nullopt;
+        }
+        ++i_element;
+    }
+
+    // undoing the change of basis, in any order
+    auto is_undone = std::vector<bool>(n_qubits, false);
+    for (std::size_t i {0}; i < n_basis_changes; ++i) {
+        const auto* info = fixed_gate_at_(elements, i_element);
+        if (info == nullptr || (info->gate != G::H && info->gate != G::RX)) {
+            return std::nullopt;
+        }
+
+        const auto qubit = cre::unpack_one_target_gate(*info);
+        const auto expected = (info->gate == G::H) ? PT::X : PT::Y;
+        if (info->gate == G::RX && !is_rx_gate_with_angle_(*info, -half_pi, tolerance)) {
+            return std::nullopt;
+        }
+
+        if (terms[qubit] != expected || is_undone[qubit]) {
+            return std::nullopt;
+        }
+
+        is_undone[qubit] = true;
+        ++i_element;
+    }
+
+    // every qubit with a change of basis must be part of the ladder
+    auto pauli_indexed_terms = std::vector<std::pair<std::size_t, PT>> {};
+    for (auto qubit : support) {
+        const auto term = (terms[qubit] == PT::I) ? PT::Z : terms[qubit];
+        pauli_indexed_terms.emplace_back(qubit, term);
+        terms[qubit] = PT::I;
+    }
+
+    if (std::ranges::any_of(terms, [](auto term) { return term != PT::I; })) {
+        return std::nullopt;
+    }
+
+    return MatchedGadget_ {
+        .pauli_string=ket::SparsePauliString {std::move(pauli_indexed_terms), n_qubits},
+        .angle=angle,
+        .n_elements=i_element - i_start
+    };
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+// NOLINTNEXTLINE(misc-no-recursion)
+auto collapse_pauli_rotation_gadgets(const QuantumCircuit& circuit, double tolerance) -> QuantumCircuit
+{
+    auto new_circuit = QuantumCircuit {circuit.n_qubits(), circuit.n_bits()};
+    CircuitAccess_::parameter_data(new_circuit) = circuit.parameter_data_map();
+    CircuitAccess_::parameter_count(new_circuit) = CircuitAccess_::parameter_count(circuit);
+
+    const auto& elements = circuit.circuit_elements();
+    auto& new_elements = CircuitAccess_::elements(new_circuit);
+
+    std::size_t i_element {0};
+    while (i_element < elements.size()) {
+        const auto& circuit_element = elements[i_element];
+
+        if (circuit_element.is_circuit_logger()) {
+            new_elements.emplace_back(circuit_element);
+        }
+        else if (circuit_element.is_control_flow()) {
+            const auto& control_flow = circuit_element.get_control_flow();
+
+            if (control_flow.is_if_statement()) {
+                const auto& if_stmt = control_flow.get_if_statement();
+                auto collapsed_subcircuit = collapse_pauli_rotation_gadgets(*if_stmt.circuit(), tolerance);
+
+                auto cfi = ClassicalIfStatement {
+                    if_stmt.predicate(),
+                    std::make_unique<QuantumCircuit>(std::move(collapsed_subcircuit))
+                };
+
+                new_elements.emplace_back(std::move(cfi));
+            }
+            else if (control_flow.is_if_else_statement()) {
+                const auto& if_else_stmt = control_flow.get_if_else_statement();
+                auto collapsed_if_subcircuit = collapse_pauli_rotation_gadgets(*if_else_stmt.if_circuit(), tolerance);
+                auto collapsed_else_subcircuit = collapse_pauli_rotation_gadgets(*if_else_stmt.else_circuit(), tolerance);
+
+                auto cfi = ClassicalIfElseStatement {
+                    if_else_stmt.predicate(),
+                    std::make_unique<QuantumCircuit>(std::move(collapsed_if_subcircuit)),
+                    std::make_unique<QuantumCircuit>(std::move(collapsed_else_subcircuit))
+                };
+
+                new_elements.emplace_back(std::move(cfi));
+            }
+            else if (control_flow.is_repeat_statement()) {
+                const auto& repeat_stmt = control_flow.get_repeat_statement();
+                auto collapsed_subcircuit = collapse_pauli_rotation_gadgets(*repeat_stmt.circuit(), tolerance);
+
+                auto cfi = RepeatStatement {
+                    repeat_stmt.n_repetitions(),
+                    std::make_unique<QuantumCircuit>(std::move(collapsed_subcircuit))
+                };
+
+                new_elements.emplace_back(std::move(cfi));
+            }
+            else if (control_flow.is_controlled_block()) {
+                const auto& block = control_flow.get_controlled_block();
+                auto collapsed_subcircuit = collapse_pauli_rotation_gadgets(*block.circuit(), tolerance);
+
+                auto cfi = ControlledBlock {
+                    block.control_qubits(),
+                    std::make_unique<QuantumCircuit>(std::move(collapsed_subcircuit))
+                };
+
+                new_elements.emplace_back(std::move(cfi));
+            }
+            else {
+                throw std::runtime_error {"DEV ERROR: invalid control flow element found in `collapse_pauli_rotation_gadgets()`\n"};
+            }
+        }
+        else if (circuit_element.is_gate()) {
+            auto gadget = match_pauli_rotation_gadget_(elements, i_element, circuit.n_qubits(), tolerance);
+
+            if (gadget.has_value()) {
+                auto pauli_string = ket::ClonePtr<SparsePauliString> {std::move(gadget->pauli_string)};
+                new_elements.emplace_back(cre::create_pauli_rotation_gate(std::move(pauli_string), gadget->angle));
+                i_element += gadget->n_elements;
+                continue;
+            }
+
+            new_elements.emplace_back(circuit_element);
+        }
+        else {
+            throw std::runtime_error {"DEV ERROR: invalid circuit element found in `collapse_pauli_rotation_gadgets()`\n"};
+        }
+
+        ++i_element;
+    }
+
+    return new_circuit;
+}
+
+}  // namespace ket
@@ -88,6 +88,33 @@ auto have_matching_indices_(const ket::GateInfo& left_info, const ket::GateInfo&
     throw std::runtime_error {"UNREACHABLE: dev error, invalid Gate found in 'have_matching_indices_()'"};
 }
 
+/*
+    Two PAULI_ROT gates are equal if they have the same Pauli string, and their angles give the same rotation.
+*/
+auto is_pauli_rotation_gate_equal_(
+    const kp::EvaluatedParameterDataMap& left_param_map,
+    const ket::GateInfo& left_info,
+    const kp::EvaluatedParameterDataMap& right_param_map,
+    const ket::GateInfo& right_info,
+    double tol_sq
+) -> bool
+{
+    using G = ket::Gate;
+
+    if (left_info.gate != G::PAULI_ROT || right_info.gate != G::PAULI_ROT) {
+        return false;
+    }
+
+    if (!(*left_info.pauli_string_ptr == *right_info.pauli_string_ptr)) {
+        return false;
+    }
+
+    const auto left_angle = kpi::unpack_pauli_rotation_angle(left_param_map, left_info);
+    const auto right_angle = kpi::unpack_pauli_rotation_angle(right_param_map, right_info);
+
+    return ket::almost_eq(ket::angle_gate(G::RZ, left_angle), ket::angle_gate(G::RZ, right_angle), tol_sq);
+}
+
 auto all_remaining_elements_are_circuit_loggers_(const ket::QuantumCircuit& circuit, std::size_t i_start) -> bool
 {
     if (i_start >= circuit.n_circuit_elements()) {
@@ -178,6 +205,30 @@ auto almost_eq(  // NOLINT(misc-no-recursion, readability-function-cognitive-com
                     return false;
                 }
             }
+            else if (left_ctrl.is_repeat_statement() && right_ctrl.is_repeat_statement()) {
+                const auto& left_repeat_stmt = left_ctrl.get_repeat_statement();
+                const auto& right_repeat_stmt = right_ctrl.get_repeat_statement();
+
+                if (left_repeat_stmt.n_repetitions() != right_repeat_stmt.n_repetitions()) {
+                    return false;
+                }
+
+                if (!almost_eq(*left_repeat_stmt.circuit(), *right_repeat_stmt.circuit(), tol_sq)) {
+                    return false;
+                }
+            }
+            else if (left_ctrl.is_controlled_block() && right_ctrl.is_controlled_block()) {
+                const auto& left_block = left_ctrl.get_controlled_block();
+                const auto& right_block = right_ctrl.get_controlled_block();
+
+                if (left_block.control_qubits() != right_block.control_qubits()) {
+                    return false;
+                }
+
+                if (!almost_eq(*left_block.circuit(), *right_block.circuit(), tol_sq)) {
+                    return false;
+                }
+            }
             else {
                 return false;
             }
@@ -191,6 +242,11 @@ auto almost_eq(  // NOLINT(misc-no-recursion, readability-function-cognitive-com
                     return false;
                 }
             }
+            else if (left_gate.gate == Gate::PAULI_ROT || right_gate.gate == Gate::PAULI_ROT) {
+                if (!is_pauli_rotation_gate_equal_(left_param_map, left_gate, right_param_map, right_gate, tol_sq)) {
+                    return false;
+                }
+            }
             else if (left_gate.gate != Gate::M && right_gate.gate != Gate::M) {
                 const auto new_left_gate = as_u_gate_(left_param_map, left_gate);
                 const auto new_right_gate = as_u_gate_(right_param_map, right_gate);
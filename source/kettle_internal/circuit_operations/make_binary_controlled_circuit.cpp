@@ -54,8 +54,9 @@ auto make_binary_controlled_circuit_naive(
         const auto control = ket::internal::get_container_index(control_qubits, i);
         const auto n_iterations = 1UL << i;
 
+        // every iteration adds the same controlled subcircuit, so it only needs to be made once
+        const auto controlled_subcircuit = make_controlled_circuit(subcircuit, n_new_qubits, control, mapped_qubits);
         for (std::size_t i_iter {0}; i_iter < n_iterations; ++i_iter) {
-            const auto controlled_subcircuit = make_controlled_circuit(subcircuit, n_new_qubits, control, mapped_qubits);
             extend_circuit(new_circuit, controlled_subcircuit);
         }
     }
@@ -78,6 +79,51 @@ auto make_binary_controlled_circuit_naive<QubitIndicesIList>(
 ) -> ket::QuantumCircuit;
 
 
+template <QubitIndices Container>
+auto make_binary_controlled_block_circuit(
+    const QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const Container& control_qubits,
+    const Container& mapped_qubits
+) -> ket::QuantumCircuit
+{
+    auto new_circuit = QuantumCircuit {n_new_qubits};
+
+    const auto size = ket::internal::get_container_size(control_qubits);
+
+    for (std::size_t i {0}; i < size; ++i) {
+        const auto control = ket::internal::get_container_index(control_qubits, i);
+        const auto n_iterations = 1UL << i;
+
+        // the subcircuit is stored once, repeated without being copied, and applied only where the
+        // control qubit is 1, without rewriting any of its gates
+        auto repeated_subcircuit = QuantumCircuit {subcircuit.n_qubits(), subcircuit.n_bits()};
+        repeated_subcircuit.add_repeat_statement(n_iterations, subcircuit);
+
+        const auto controlled_subcircuit = make_controlled_block_circuit(
+            repeated_subcircuit, n_new_qubits, Container {control}, mapped_qubits
+        );
+        extend_circuit(new_circuit, controlled_subcircuit);
+    }
+
+    return new_circuit;
+}
+template
+auto make_binary_controlled_block_circuit<QubitIndicesVector>(
+    const QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const QubitIndicesVector& control_qubits,
+    const QubitIndicesVector& mapped_qubits
+) -> ket::QuantumCircuit;
+template
+auto make_binary_controlled_block_circuit<QubitIndicesIList>(
+    const QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const QubitIndicesIList& control_qubits,
+    const QubitIndicesIList& mapped_qubits
+) -> ket::QuantumCircuit;
+
+
 template <QubitIndices Container>
 auto make_binary_controlled_circuit_from_binary_powers(
     const std::vector<QuantumCircuit>& subcircuit_powers,
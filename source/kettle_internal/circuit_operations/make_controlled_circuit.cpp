@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <stdexcept>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "kettle/circuit/circuit.hpp"
 #include "kettle/circuit_operations/make_controlled_circuit.hpp"
@@ -8,10 +10,12 @@
 #include "kettle/gates/common_u_gates.hpp"
 #include "kettle/gates/multiplicity_controlled_u_gate.hpp"
 #include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
 
 #include "kettle_internal/gates/primitive_gate/gate_id.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_create.hpp"
 #include "kettle_internal/gates/primitive_gate_map.hpp"
+#include "kettle_internal/gates/pauli_rotation_gadget.hpp"
 
 
 namespace
@@ -92,6 +96,18 @@ void check_new_indices_fit_onto_new_circuit_(const Container& mapped_qubits, con
 }
 
 
+/*
+    The gates made here only take a fixed angle; rather than silently using the angle stored in a
+    parameterized PAULI_ROT gate and losing its parameter, such a gate is rejected.
+*/
+void check_pauli_rotation_not_parameterized_(const ket::GateInfo& gate_info)
+{
+    if (gate_info.param_expression_ptr) {
+        throw std::runtime_error {"ERROR: a parameterized 'PAULI_ROT' gate cannot be made controlled.\n"};
+    }
+}
+
+
 void make_one_target_gate_controlled(
     ket::QuantumCircuit& circuit,
     ket::Gate gate,
@@ -118,6 +134,171 @@ void make_one_target_one_angle_gate_controlled(
     (circuit.*controlled_gate_operation)(control, target, angle);
 }
 
+
+/*
+    Adds the change-of-basis and CX-ladder gates of a PAULI_ROT decomposition to `circuit`, without any
+    controls; only the RZ gate in the middle of the decomposition needs to be controlled, because these
+    gates undo each other when it is not applied.
+*/
+template <ket::QubitIndices Container = ket::QubitIndicesIList>
+void add_mapped_pauli_rotation_gadget_gates_(
+    ket::QuantumCircuit& circuit,
+    const std::vector<ket::GateInfo>& gates,
+    const Container& mapped_qubits
+)
+{
+    namespace gid = ket::internal::gate_id;
+    namespace cre = ket::internal::create;
+
+    for (const auto& gate_info : gates) {
+        if (gid::is_one_target_transform_gate(gate_info.gate)) {
+            const auto original_target = cre::unpack_one_target_gate(gate_info);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            const auto func = ket::internal::GATE_TO_FUNCTION_1T.at(gate_info.gate);
+            (circuit.*func)(new_target);
+        }
+        else if (gid::is_one_target_one_angle_transform_gate(gate_info.gate)) {
+            const auto [original_target, angle] = cre::unpack_one_target_one_angle_gate(gate_info);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            const auto func = ket::internal::GATE_TO_FUNCTION_1T1A.at(gate_info.gate);
+            (circuit.*func)(new_target, angle);
+        }
+        else if (gid::is_one_control_one_target_transform_gate(gate_info.gate)) {
+            const auto [original_control, original_target] = cre::unpack_one_control_one_target_gate(gate_info);
+            const auto new_control = ket::internal::get_container_index(mapped_qubits, original_control);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            const auto func = ket::internal::GATE_TO_FUNCTION_1C1T.at(gate_info.gate);
+            (circuit.*func)(new_control, new_target);
+        }
+        else {
+            throw std::runtime_error {"UNREACHABLE: dev error, invalid gate found in a Pauli rotation decomposition.\n"};
+        }
+    }
+}
+
+/*
+    Returns the indices in `qubits`, each mapped through `mapped_qubits`.
+*/
+template <ket::QubitIndices Container = ket::QubitIndicesIList>
+auto map_qubit_indices_(const std::vector<std::size_t>& qubits, const Container& mapped_qubits) -> std::vector<std::size_t>
+{
+    auto output = std::vector<std::size_t> {};
+    output.reserve(qubits.size());
+
+    for (auto qubit : qubits) {
+        output.push_back(ket::internal::get_container_index(mapped_qubits, qubit));
+    }
+
+    return output;
+}
+
+
+/*
+    Creates a copy of `subcircuit` on a circuit with `n_new_qubits` qubits, with each qubit moved to the
+    index given by `mapped_qubits`; none of the gates are made controlled.
+*/
+template <ket::QubitIndices Container = ket::QubitIndicesIList>
+auto map_circuit_qubits_(  // NOLINT(misc-no-recursion, readability-function-cognitive-complexity)
+    const ket::QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const Container& mapped_qubits
+) -> ket::QuantumCircuit
+{
+    namespace gid = ket::internal::gate_id;
+    namespace cre = ket::internal::create;
+    using G = ket::Gate;
+
+    auto new_circuit = ket::QuantumCircuit {n_new_qubits};
+
+    for (const auto& circuit_element : subcircuit) {
+        if (circuit_element.is_control_flow()) {
+            const auto& control_flow = circuit_element.get_control_flow();
+
+            if (control_flow.is_repeat_statement()) {
+                const auto& repeat_stmt = control_flow.get_repeat_statement();
+                auto mapped = map_circuit_qubits_(*repeat_stmt.circuit(), n_new_qubits, mapped_qubits);
+                new_circuit.add_repeat_statement(repeat_stmt.n_repetitions(), std::move(mapped));
+                continue;
+            }
+
+            if (control_flow.is_controlled_block()) {
+                const auto& block = control_flow.get_controlled_block();
+                const auto new_controls = map_qubit_indices_(block.control_qubits(), mapped_qubits);
+                auto mapped = map_circuit_qubits_(*block.circuit(), n_new_qubits, mapped_qubits);
+                new_circuit.add_controlled_block(new_controls, std::move(mapped));
+                continue;
+            }
+
+            throw std::runtime_error {"ERROR: classical control flow statement cannot be made controlled.\n"};
+        }
+
+        if (circuit_element.is_circuit_logger()) {
+            new_circuit.add_circuit_logger(circuit_element.get_circuit_logger());
+            continue;
+        }
+
+        const auto& gate_info = circuit_element.get_gate();
+
+        if (gid::is_one_target_transform_gate(gate_info.gate)) {
+            const auto original_target = cre::unpack_one_target_gate(gate_info);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            const auto func = ket::internal::GATE_TO_FUNCTION_1T.at(gate_info.gate);
+            (new_circuit.*func)(new_target);
+        }
+        else if (gid::is_one_target_one_angle_transform_gate(gate_info.gate)) {
+            const auto [original_target, angle] = cre::unpack_one_target_one_angle_gate(gate_info);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            const auto func = ket::internal::GATE_TO_FUNCTION_1T1A.at(gate_info.gate);
+            (new_circuit.*func)(new_target, angle);
+        }
+        else if (gid::is_one_control_one_target_transform_gate(gate_info.gate)) {
+            const auto [original_control, original_target] = cre::unpack_one_control_one_target_gate(gate_info);
+            const auto new_control = ket::internal::get_container_index(mapped_qubits, original_control);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            const auto func = ket::internal::GATE_TO_FUNCTION_1C1T.at(gate_info.gate);
+            (new_circuit.*func)(new_control, new_target);
+        }
+        else if (gid::is_one_control_one_target_one_angle_transform_gate(gate_info.gate)) {
+            const auto [original_control, original_target, angle] = cre::unpack_one_control_one_target_one_angle_gate(gate_info);
+            const auto new_control = ket::internal::get_container_index(mapped_qubits, original_control);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            const auto func = ket::internal::GATE_TO_FUNCTION_1C1T1A.at(gate_info.gate);
+            (new_circuit.*func)(new_control, new_target, angle);
+        }
+        else if (gate_info.gate == G::U) {
+            const auto [original_target, unitary_ptr] = cre::unpack_u_gate(gate_info);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            new_circuit.add_u_gate(*unitary_ptr, new_target);
+        }
+        else if (gate_info.gate == G::CU) {
+            const auto [original_control, original_target, unitary_ptr] = cre::unpack_cu_gate(gate_info);
+            const auto new_control = ket::internal::get_container_index(mapped_qubits, original_control);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
+            new_circuit.add_cu_gate(*unitary_ptr, new_control, new_target);
+        }
+        else if (gate_info.gate == G::PAULI_ROT) {
+            check_pauli_rotation_not_parameterized_(gate_info);
+            const auto& [pauli_string_ptr, angle] = cre::unpack_pauli_rotation_gate(gate_info);
+
+            auto new_terms = std::vector<std::pair<std::size_t, ket::PauliTerm>> {};
+            for (const auto& [original_qubit, term] : (*pauli_string_ptr).terms()) {
+                new_terms.emplace_back(ket::internal::get_container_index(mapped_qubits, original_qubit), term);
+            }
+
+            const auto new_pauli_string = ket::SparsePauliString {std::move(new_terms), n_new_qubits, (*pauli_string_ptr).phase()};
+            new_circuit.add_pauli_rotation_gate(new_pauli_string, angle);
+        }
+        else if (gate_info.gate == G::M) {
+            throw std::runtime_error {"Cannot make a measurement gate controlled.\n"};
+        }
+        else {
+            throw std::runtime_error {"UNREACHABLE: dev error, invalid gate found when making controlled circuit.\n"};
+        }
+    }
+
+    return new_circuit;
+}
+
 }  // namespace
 
 
@@ -145,6 +326,26 @@ auto make_controlled_circuit(
 
     for (const auto& circuit_element : subcircuit) {
         if (circuit_element.is_control_flow()) {
+            const auto& control_flow = circuit_element.get_control_flow();
+
+            // repeating the controlled subcircuit is the same as controlling the repeated subcircuit
+            if (control_flow.is_repeat_statement()) {
+                const auto& repeat_stmt = control_flow.get_repeat_statement();
+                auto controlled = make_controlled_circuit(*repeat_stmt.circuit(), n_new_qubits, control, mapped_qubits);
+                new_circuit.add_repeat_statement(repeat_stmt.n_repetitions(), std::move(controlled));
+                continue;
+            }
+
+            // a controlled block only needs one more control qubit; its gates are not rewritten
+            if (control_flow.is_controlled_block()) {
+                const auto& block = control_flow.get_controlled_block();
+                auto new_controls = map_qubit_indices_(block.control_qubits(), mapped_qubits);
+                new_controls.push_back(control);
+                auto mapped = map_circuit_qubits_(*block.circuit(), n_new_qubits, mapped_qubits);
+                new_circuit.add_controlled_block(new_controls, std::move(mapped));
+                continue;
+            }
+
             throw std::runtime_error {"ERROR: classical control flow statement cannot be made controlled.\n"};
         }
 
@@ -191,6 +392,15 @@ auto make_controlled_circuit(
             const auto new_target = ket::internal::get_container_index(mapped_qubits, original_target);
             new_circuit.add_ccu_gate(*unitary_ptr, control, new_control, new_target);
         }
+        else if (gate_info.gate == Gate::PAULI_ROT) {
+            check_pauli_rotation_not_parameterized_(gate_info);
+            const auto& [pauli_string_ptr, angle] = cre::unpack_pauli_rotation_gate(gate_info);
+            const auto gadget = ket::internal::pauli_rotation_gadget_(*pauli_string_ptr);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, gadget.rotation_qubit);
+            add_mapped_pauli_rotation_gadget_gates_(new_circuit, gadget.compute, mapped_qubits);
+            make_one_target_one_angle_gate_controlled(new_circuit, Gate::RZ, control, new_target, angle);
+            add_mapped_pauli_rotation_gadget_gates_(new_circuit, gadget.uncompute, mapped_qubits);
+        }
         else if (gate_info.gate == Gate::M) {
             throw std::runtime_error {"Cannot make a measurement gate controlled.\n"};
         }
@@ -243,6 +453,28 @@ auto make_multiplicity_controlled_circuit(
 
     for (const auto& circuit_element : subcircuit) {
         if (circuit_element.is_control_flow()) {
+            const auto& control_flow = circuit_element.get_control_flow();
+
+            // repeating the controlled subcircuit is the same as controlling the repeated subcircuit
+            if (control_flow.is_repeat_statement()) {
+                const auto& repeat_stmt = control_flow.get_repeat_statement();
+                auto controlled = make_multiplicity_controlled_circuit(*repeat_stmt.circuit(), n_new_qubits, control_qubits, mapped_qubits);
+                new_circuit.add_repeat_statement(repeat_stmt.n_repetitions(), std::move(controlled));
+                continue;
+            }
+
+            // a controlled block only needs more control qubits; its gates are not rewritten
+            if (control_flow.is_controlled_block()) {
+                const auto& block = control_flow.get_controlled_block();
+                const auto new_controls = ket::internal::extend_container_to_vector(
+                    map_qubit_indices_(block.control_qubits(), mapped_qubits),
+                    control_qubits
+                );
+                auto mapped = map_circuit_qubits_(*block.circuit(), n_new_qubits, mapped_qubits);
+                new_circuit.add_controlled_block(new_controls, std::move(mapped));
+                continue;
+            }
+
             throw std::runtime_error {"ERROR: classical control flow statement cannot be made controlled.\n"};
         }
 
@@ -294,6 +526,16 @@ auto make_multiplicity_controlled_circuit(
             const auto new_controls = ket::internal::extend_container_to_vector(control_qubits, {new_control});
             apply_multiplicity_controlled_u_gate(new_circuit, *unitary_ptr, new_target, new_controls);
         }
+        else if (gate_info.gate == Gate::PAULI_ROT) {
+            check_pauli_rotation_not_parameterized_(gate_info);
+            const auto& [pauli_string_ptr, angle] = cre::unpack_pauli_rotation_gate(gate_info);
+            const auto gadget = ket::internal::pauli_rotation_gadget_(*pauli_string_ptr);
+            const auto new_target = ket::internal::get_container_index(mapped_qubits, gadget.rotation_qubit);
+            const auto matrix = angle_gate(Gate::RZ, angle);
+            add_mapped_pauli_rotation_gadget_gates_(new_circuit, gadget.compute, mapped_qubits);
+            apply_multiplicity_controlled_u_gate(new_circuit, matrix, new_target, control_qubits);
+            add_mapped_pauli_rotation_gadget_gates_(new_circuit, gadget.uncompute, mapped_qubits);
+        }
         else if (gate_info.gate == Gate::M) {
             throw std::runtime_error {"Cannot make a measurement gate controlled.\n"};
         }
@@ -319,4 +561,40 @@ auto make_multiplicity_controlled_circuit<ket::QubitIndicesIList>(
     const ket::QubitIndicesIList& mapped_qubits
 ) -> ket::QuantumCircuit;
 
+
+
+template <QubitIndices Container>
+auto make_controlled_block_circuit(
+    const ket::QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const Container& control_qubits,
+    const Container& mapped_qubits
+) -> ket::QuantumCircuit
+{
+    check_valid_number_of_mapped_indices_(mapped_qubits, subcircuit);
+    check_all_indices_are_unique_(mapped_qubits);
+    check_all_indices_are_unique_(control_qubits);
+    check_no_overlap_(mapped_qubits, control_qubits);
+    check_new_indices_fit_onto_new_circuit_(mapped_qubits, control_qubits, n_new_qubits);
+
+    auto new_circuit = QuantumCircuit {n_new_qubits};
+    new_circuit.add_controlled_block(control_qubits, map_circuit_qubits_(subcircuit, n_new_qubits, mapped_qubits));
+
+    return new_circuit;
+}
+template
+auto make_controlled_block_circuit<ket::QubitIndicesVector>(
+    const ket::QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const ket::QubitIndicesVector& control_qubits,
+    const ket::QubitIndicesVector& mapped_qubits
+) -> ket::QuantumCircuit;
+template
+auto make_controlled_block_circuit<ket::QubitIndicesIList>(
+    const ket::QuantumCircuit& subcircuit,
+    std::size_t n_new_qubits,
+    const ket::QubitIndicesIList& control_qubits,
+    const ket::QubitIndicesIList& mapped_qubits
+) -> ket::QuantumCircuit;
+
 }  // namespace ket
@@ -0,0 +1,448 @@
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit_operations/optimize_circuit.hpp"
+#include "kettle/common/tolerance.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+
+#include "kettle_internal/circuit/circuit_access.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+
+
+namespace
+{
+
+namespace cre = ket::internal::create;
+namespace gid = ket::internal::gate_id;
+
+using G = ket::Gate;
+
+/*
+    Describes what a gate does to one of its qubits. Two gates commute if, on every qubit they share,
+    they both only apply functions of the same Pauli operator; for example, the control of a controlled
+    gate only applies functions of Z (the projectors onto |0> and |1>).
+*/
+enum class WireAction_ : std::uint8_t
+{
+    Z,
+    X,
+    Y,
+    OTHER
+};
+
+struct WireUse_
+{
+    std::size_t qubit;
+    WireAction_ action;
+};
+
+auto target_action_(G gate) -> WireAction_
+{
+    switch (gate)
+    {
+        case G::X : case G::SX : case G::SXDAG : case G::RX :
+        case G::CX : case G::CSX : case G::CSXDAG : case G::CRX : {
+            return WireAction_::X;
+        }
+        case G::Y : case G::RY : case G::CY : case G::CRY : {
+            return WireAction_::Y;
+        }
+        case G::Z : case G::S : case G::SDAG : case G::T : case G::TDAG : case G::RZ : case G::P :
+        case G::CZ : case G::CS : case G::CSDAG : case G::CT : case G::CTDAG : case G::CRZ : case G::CP : {
+            return WireAction_::Z;
+        }
+        default : {
+            return WireAction_::OTHER;
+        }
+    }
+}
+
+auto wire_uses_(const ket::GateInfo& info) -> std::vector<WireUse_>
+{
+    if (info.gate == G::PAULI_ROT) {
+        // exp(-i theta P / 2) = cos(theta / 2) I - i sin(theta / 2) P, which only applies functions of
+        // each qubit's Pauli term
+        auto output = std::vector<WireUse_> {};
+        for (const auto& [qubit, term] : (*info.pauli_string_ptr).terms()) {
+            if (term == ket::PauliTerm::X) {
+                output.push_back({.qubit=qubit, .action=WireAction_::X});
+            }
+            else if (term == ket::PauliTerm::Y) {
+                output.push_back({.qubit=qubit, .action=WireAction_::Y});
+            }
+            else if (term == ket::PauliTerm::Z) {
+                output.push_back({.qubit=qubit, .action=WireAction_::Z});
+            }
+        }
+
+        return output;
+    }
+    else if (info.gate == G::M) {
+        const auto [qubit, ignore] = cre::unpack_m_gate(info);
+        return {{.qubit=qubit, .action=WireAction_::OTHER}};
+    }
+    else if (gid::is_single_qubit_transform_gate(info.gate)) {
+        return {{.qubit=cre::unpack_single_qubit_gate_index(info), .action=target_action_(info.gate)}};
+    }
+    else if (gid::is_double_qubit_transform_gate(info.gate)) {
+        const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+        return {
+            {.qubit=control, .action=WireAction_::Z},
+            {.qubit=target, .action=target_action_(info.gate)}
+        };
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: invalid gate found in `optimize_circuit()`\n"};
+    }
+}
+
+/*
+    Returns `std::nullopt` if the gates do not share a qubit, and otherwise whether they commute.
+*/
+auto shared_wires_commute_(const std::vector<WireUse_>& left, const std::vector<WireUse_>& right) -> std::optional<bool>
+{
+    auto is_shared = false;
+    auto is_commuting = true;
+
+    for (const auto& left_use : left) {
+        for (const auto& right_use : right) {
+            if (left_use.qubit != right_use.qubit) {
+                continue;
+            }
+
+            is_shared = true;
+            if (left_use.action != right_use.action || left_use.action == WireAction_::OTHER) {
+                is_commuting = false;
+            }
+        }
+    }
+
+    if (!is_shared) {
+        return std::nullopt;
+    }
+
+    return is_commuting;
+}
+
+auto is_self_inverse_(G gate) -> bool
+{
+    return gate == G::H || gate == G::X || gate == G::Y || gate == G::Z
+        || gate == G::CH || gate == G::CX || gate == G::CY || gate == G::CZ;
+}
+
+auto inverse_of_(G gate) -> std::optional<G>
+{
+    if (is_self_inverse_(gate)) {
+        return gate;
+    }
+
+    constexpr auto inverse_pairs = std::array {
+        std::pair {G::S, G::SDAG},
+        std::pair {G::T, G::TDAG},
+        std::pair {G::SX, G::SXDAG},
+        std::pair {G::CS, G::CSDAG},
+        std::pair {G::CT, G::CTDAG},
+        std::pair {G::CSX, G::CSXDAG}
+    };
+
+    for (const auto& [first, second] : inverse_pairs) {
+        if (gate == first) {
+            return second;
+        }
+        if (gate == second) {
+            return first;
+        }
+    }
+
+    return std::nullopt;
+}
+
+auto is_mergeable_rotation_(G gate) -> bool
+{
+    return gid::is_angle_transform_gate(gate) || gate == G::PAULI_ROT;
+}
+
+/*
+    Checks if both gates act on the same qubits, in the same roles.
+*/
+auto same_qubits_(const ket::GateInfo& left, const ket::GateInfo& right) -> bool
+{
+    if (left.gate == G::PAULI_ROT) {
+        return *left.pauli_string_ptr == *right.pauli_string_ptr;
+    }
+    else if (gid::is_single_qubit_transform_gate(left.gate)) {
+        return cre::unpack_single_qubit_gate_index(left) == cre::unpack_single_qubit_gate_index(right);
+    }
+    else {
+        return cre::unpack_double_qubit_gate_indices(left) == cre::unpack_double_qubit_gate_indices(right);
+    }
+}
+
+auto with_angle_(const ket::GateInfo& info, double angle) -> ket::GateInfo
+{
+    if (info.gate == G::PAULI_ROT) {
+        return cre::create_pauli_rotation_gate(info.pauli_string_ptr, angle);
+    }
+    else if (gid::is_single_qubit_transform_gate(info.gate)) {
+        return cre::create_one_target_one_angle_gate(info.gate, cre::unpack_single_qubit_gate_index(info), angle);
+    }
+    else {
+        const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+        return cre::create_one_control_one_target_one_angle_gate(info.gate, control, target, angle);
+    }
+}
+
+auto is_zero_angle_(double angle) -> bool
+{
+    return std::fabs(angle) < ket::OPTIMIZE_CIRCUIT_ANGLE_TOLERANCE;
+}
+
+/*
+    An element of the circuit being built, which may have been removed by a later gate.
+*/
+struct PendingElement_
+{
+    std::optional<ket::CircuitElement> element;
+    std::vector<WireUse_> wires;
+};
+
+class PeepholePass_
+{
+public:
+    PeepholePass_(ket::CircuitOptimizationLevel level, ket::CircuitOptimizationStatistics& statistics)
+        : level_ {level}
+        , statistics_ {statistics}
+    {}
+
+    void add_barrier(const ket::CircuitElement& element)
+    {
+        pending_.push_back({.element=element, .wires={}});
+        i_barrier_ = pending_.size();
+    }
+
+    void add_gate(const ket::GateInfo& info)
+    {
+        if (is_mergeable_rotation_(info.gate) && !info.param_expression_ptr && is_zero_angle_(cre::unpack_gate_angle(info))) {
+            ++statistics_.n_removed_zero_rotations;
+            return;
+        }
+
+        auto wires = wire_uses_(info);
+
+        // walk backwards through the gates that this gate can be moved past
+        auto is_commuted = false;
+        for (auto i_pending {pending_.size()}; i_pending > i_barrier_; --i_pending) {
+            auto& previous = pending_[i_pending - 1];
+            if (!previous.element) {
+                continue;
+            }
+
+            const auto commutes = shared_wires_commute_(previous.wires, wires);
+            if (!commutes.has_value()) {
+                continue;
+            }
+
+            if (try_combine_(previous, info)) {
+                if (is_commuted) {
+                    ++statistics_.n_commuted_matches;
+                }
+                return;
+            }
+
+            if (!commutes.value() || level_ != ket::CircuitOptimizationLevel::COMMUTE) {
+                break;
+            }
+
+            is_commuted = true;
+        }
+
+        pending_.push_back({.element=ket::CircuitElement {info}, .wires=std::move(wires)});
+    }
+
+    [[nodiscard]]
+    auto take_elements() -> std::vector<ket::CircuitElement>
+    {
+        auto output = std::vector<ket::CircuitElement> {};
+        output.reserve(pending_.size());
+
+        for (auto& pending : pending_) {
+            if (pending.element) {
+                output.push_back(std::move(*pending.element));
+            }
+        }
+
+        return output;
+    }
+
+private:
+    ket::CircuitOptimizationLevel level_;
+    ket::CircuitOptimizationStatistics& statistics_;
+    std::vector<PendingElement_> pending_;
+    std::size_t i_barrier_ {0};
+
+    /*
+        Attempts to cancel or merge `info` with the earlier gate in `previous`; if this succeeds, then
+        `previous` holds the result.
+    */
+    auto try_combine_(PendingElement_& previous, const ket::GateInfo& info) -> bool
+    {
+        const auto& previous_info = (*previous.element).get_gate();
+
+        if (previous_info.param_expression_ptr || info.param_expression_ptr) {
+            return false;
+        }
+
+        if (inverse_of_(previous_info.gate) == info.gate && same_qubits_(previous_info, info)) {
+            previous.element = std::nullopt;
+            ++statistics_.n_cancelled_pairs;
+            return true;
+        }
+
+        if (is_mergeable_rotation_(info.gate) && previous_info.gate == info.gate && same_qubits_(previous_info, info)) {
+            const auto angle = cre::unpack_gate_angle(previous_info) + cre::unpack_gate_angle(info);
+            ++statistics_.n_merged_rotations;
+
+            if (is_zero_angle_(angle)) {
+                previous.element = std::nullopt;
+                ++statistics_.n_removed_zero_rotations;
+            }
+            else {
+                previous.element = ket::CircuitElement {with_angle_(previous_info, angle)};
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+};
+
+auto total_rewrites_(const ket::CircuitOptimizationStatistics& statistics) -> std::size_t
+{
+    return statistics.n_cancelled_pairs + statistics.n_merged_rotations + statistics.n_removed_zero_rotations;
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+auto optimize_circuit(const QuantumCircuit& circuit, CircuitOptimizationLevel level) -> QuantumCircuit
+{
+    auto statistics = CircuitOptimizationStatistics {};
+    return optimize_circuit(circuit, level, statistics);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion, readability-function-cognitive-complexity)
+auto optimize_circuit(
+    const QuantumCircuit& circuit,
+    CircuitOptimizationLevel level,
+    CircuitOptimizationStatistics& statistics
+) -> QuantumCircuit
+{
+    auto new_circuit = QuantumCircuit {circuit.n_qubits(), circuit.n_bits()};
+    CircuitAccess_::parameter_data(new_circuit) = circuit.parameter_data_map();
+    CircuitAccess_::parameter_count(new_circuit) = CircuitAccess_::parameter_count(circuit);
+
+    if (level == CircuitOptimizationLevel::NONE) {
+        CircuitAccess_::elements(new_circuit) = circuit.circuit_elements();
+        return new_circuit;
+    }
+
+    // the subcircuits are optimized once, up front
+    auto elements = std::vector<CircuitElement> {};
+    elements.reserve(circuit.n_circuit_elements());
+
+    for (const auto& circuit_element : circuit) {
+        if (!circuit_element.is_control_flow()) {
+            elements.push_back(circuit_element);
+            continue;
+        }
+
+        const auto& control_flow = circuit_element.get_control_flow();
+
+        if (control_flow.is_if_statement()) {
+            const auto& if_stmt = control_flow.get_if_statement();
+            auto optimized_subcircuit = optimize_circuit(*if_stmt.circuit(), level, statistics);
+
+            elements.emplace_back(ClassicalIfStatement {
+                if_stmt.predicate(),
+                std::make_unique<QuantumCircuit>(std::move(optimized_subcircuit))
+            });
+        }
+        else if (control_flow.is_if_else_statement()) {
+            const auto& if_else_stmt = control_flow.get_if_else_statement();
+            auto optimized_if_subcircuit = optimize_circuit(*if_else_stmt.if_circuit(), level, statistics);
+            auto optimized_else_subcircuit = optimize_circuit(*if_else_stmt.else_circuit(), level, statistics);
+
+            elements.emplace_back(ClassicalIfElseStatement {
+                if_else_stmt.predicate(),
+                std::make_unique<QuantumCircuit>(std::move(optimized_if_subcircuit)),
+                std::make_unique<QuantumCircuit>(std::move(optimized_else_subcircuit))
+            });
+        }
+        else if (control_flow.is_repeat_statement()) {
+            const auto& repeat_stmt = control_flow.get_repeat_statement();
+            auto optimized_subcircuit = optimize_circuit(*repeat_stmt.circuit(), level, statistics);
+
+            elements.emplace_back(RepeatStatement {
+                repeat_stmt.n_repetitions(),
+                std::make_unique<QuantumCircuit>(std::move(optimized_subcircuit))
+            });
+        }
+        else if (control_flow.is_controlled_block()) {
+            const auto& block = control_flow.get_controlled_block();
+            auto optimized_subcircuit = optimize_circuit(*block.circuit(), level, statistics);
+
+            elements.emplace_back(ControlledBlock {
+                block.control_qubits(),
+                std::make_unique<QuantumCircuit>(std::move(optimized_subcircuit))
+            });
+        }
+        else {
+            throw std::runtime_error {"DEV ERROR: invalid control flow element found in `optimize_circuit()`\n"};
+        }
+    }
+
+    // a merged rotation can expose a new pair with a gate before it, so the passes are repeated until
+    // nothing changes; every rewrite removes at least one gate, so this always ends
+    while (true) {
+        const auto n_rewrites_before = total_rewrites_(statistics);
+
+        auto pass = PeepholePass_ {level, statistics};
+        for (const auto& circuit_element : elements) {
+            if (circuit_element.is_gate()) {
+                pass.add_gate(circuit_element.get_gate());
+            }
+            else if (circuit_element.is_control_flow() || circuit_element.is_circuit_logger()) {
+                pass.add_barrier(circuit_element);
+            }
+            else {
+                throw std::runtime_error {"DEV ERROR: invalid circuit element found in `optimize_circuit()`\n"};
+            }
+        }
+
+        elements = pass.take_elements();
+
+        if (total_rewrites_(statistics) == n_rewrites_before) {
+            break;
+        }
+    }
+
+    CircuitAccess_::elements(new_circuit) = std::move(elements);
+
+    return new_circuit;
+}
+
+}  // namespace ket
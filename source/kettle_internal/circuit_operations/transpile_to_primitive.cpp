@@ -1,53 +1,173 @@
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "kettle/circuit/circuit.hpp"
 #include "kettle/circuit_operations/transpile_to_primitive.hpp"
 #include "kettle/gates/primitive_gate.hpp"
 
+#include "kettle_internal/circuit/circuit_access.hpp"
+#include "kettle_internal/circuit_operations/transpile_to_primitive_internal.hpp"
 #include "kettle_internal/gates/matrix2x2_gate_decomposition.hpp"
+#include "kettle_internal/gates/pauli_rotation_gadget.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_id.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
 
 
-namespace ket
+namespace
+{
+
+/*
+    Collects the subcircuits of the control flow statements in `circuit`, in order; the if-branch of an
+    if-else statement comes before the else-branch.
+*/
+auto collect_subcircuits_(const ket::QuantumCircuit& circuit) -> std::vector<const ket::QuantumCircuit*>
 {
+    auto output = std::vector<const ket::QuantumCircuit*> {};
+
+    for (const auto& circuit_element : circuit) {
+        if (!circuit_element.is_control_flow()) {
+            continue;
+        }
+
+        const auto& control_flow = circuit_element.get_control_flow();
+
+        if (control_flow.is_if_statement()) {
+            output.push_back(&*control_flow.get_if_statement().circuit());
+        }
+        else if (control_flow.is_if_else_statement()) {
+            const auto& if_else_stmt = control_flow.get_if_else_statement();
+            output.push_back(&*if_else_stmt.if_circuit());
+            output.push_back(&*if_else_stmt.else_circuit());
+        }
+        else if (control_flow.is_repeat_statement()) {
+            output.push_back(&*control_flow.get_repeat_statement().circuit());
+        }
+        else if (control_flow.is_controlled_block()) {
+            output.push_back(&*control_flow.get_controlled_block().circuit());
+        }
+        else {
+            throw std::runtime_error {"DEV ERROR: invalid control flow element found in `transpile_to_primitive()`\n"};
+        }
+    }
+
+    return output;
+}
+
+/*
+    Transpiling a handful of small subcircuits is much faster than launching threads for them; the
+    subcircuits are only split up between threads if they hold enough circuit elements in total.
+*/
+auto number_of_subcircuit_threads_(
+    const std::vector<const ket::QuantumCircuit*>& subcircuits,
+    std::size_t n_threads
+) -> std::size_t
+{
+    namespace ki = ket::internal;
+
+    auto n_elements = std::size_t {0};
+    for (const auto* subcircuit : subcircuits) {
+        n_elements += subcircuit->n_circuit_elements();
+    }
+
+    const auto n_useful_threads = std::max(std::size_t {1}, n_elements / ki::MINIMUM_WORK_ITEMS_PER_THREAD_);
+
+    return std::max(std::size_t {1}, std::min({n_threads, subcircuits.size(), n_useful_threads}));
+}
 
 // NOLINTNEXTLINE(misc-no-recursion)
-auto transpile_to_primitive(const QuantumCircuit& circuit, double tolerance_sq) -> QuantumCircuit
+auto transpile_subcircuits_(
+    const std::vector<const ket::QuantumCircuit*>& subcircuits,
+    ket::internal::DecompositionCache_& cache,
+    std::size_t n_threads
+) -> std::vector<ket::QuantumCircuit>
+{
+    namespace ki = ket::internal;
+
+    auto transpiled = std::vector<std::optional<ket::QuantumCircuit>>(subcircuits.size());
+    auto exceptions = std::vector<std::exception_ptr>(n_threads);
+
+    // NOLINTNEXTLINE(misc-no-recursion)
+    ki::parallel_for_(subcircuits.size(), n_threads, [&](const ki::FlatIndexPair& block, std::size_t i_thread) {
+        try {
+            for (auto i {block.i_lower}; i < block.i_upper; ++i) {
+                transpiled[i] = ki::transpile_to_primitive_(*subcircuits[i], cache, 1);
+            }
+        }
+        catch (...) {
+            exceptions[i_thread] = std::current_exception();
+        }
+    });
+
+    for (const auto& exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    auto output = std::vector<ket::QuantumCircuit> {};
+    output.reserve(transpiled.size());
+    for (auto& circuit : transpiled) {
+        output.push_back(std::move(*circuit));
+    }
+
+    return output;
+}
+
+}  // namespace
+
+
+namespace ket::internal
+{
+
+// NOLINTNEXTLINE(misc-no-recursion, readability-function-cognitive-complexity)
+auto transpile_to_primitive_(
+    const ket::QuantumCircuit& circuit,
+    DecompositionCache_& cache,
+    std::size_t n_threads
+) -> ket::QuantumCircuit
 {
     namespace gid = ket::internal::gate_id;
     namespace cre = ket::internal::create;
 
     auto new_circuit = QuantumCircuit {circuit.n_qubits(), circuit.n_bits()};
+    auto& new_elements = CircuitAccess_::elements(new_circuit);
 
-    const auto decomp_1t = ket::internal::decomp_to_one_target_primitive_gates_;
-    const auto decomp_1c_1t = ket::internal::decomp_to_one_control_one_target_primitive_gates_;
+    const auto subcircuits = collect_subcircuits_(circuit);
+    const auto n_subcircuit_threads = number_of_subcircuit_threads_(subcircuits, n_threads);
+    auto transpiled_subcircuits = transpile_subcircuits_(subcircuits, cache, n_subcircuit_threads);
+    auto i_subcircuit = std::size_t {0};
 
-    for (const auto& circuit_element : circuit.elements_) {
+    for (const auto& circuit_element : circuit) {
         if (circuit_element.is_circuit_logger()) {
-            new_circuit.elements_.emplace_back(circuit_element);
+            new_elements.emplace_back(circuit_element);
         }
         else if (circuit_element.is_control_flow()) {
             const auto& control_flow = circuit_element.get_control_flow();
 
             if (control_flow.is_if_statement()) {
                 const auto& if_stmt = control_flow.get_if_statement();
-                const auto& current_subcircuit = *if_stmt.circuit();
-                auto transpiled_subcircuit = transpile_to_primitive(current_subcircuit, tolerance_sq);
+                auto& transpiled_subcircuit = transpiled_subcircuits[i_subcircuit];
+                ++i_subcircuit;
 
                 auto cfi = ClassicalIfStatement {
                     if_stmt.predicate(),
                     std::make_unique<QuantumCircuit>(std::move(transpiled_subcircuit))
                 };
 
-                new_circuit.elements_.emplace_back(std::move(cfi));
+                new_elements.emplace_back(std::move(cfi));
             }
             else if (control_flow.is_if_else_statement()) {
                 const auto& if_else_stmt = control_flow.get_if_else_statement();
-                const auto& if_subcircuit = *if_else_stmt.if_circuit();
-                const auto& else_subcircuit = *if_else_stmt.else_circuit();
-                auto transpiled_if_subcircuit = transpile_to_primitive(if_subcircuit, tolerance_sq);
-                auto transpiled_else_subcircuit = transpile_to_primitive(else_subcircuit, tolerance_sq);
+                auto& transpiled_if_subcircuit = transpiled_subcircuits[i_subcircuit];
+                auto& transpiled_else_subcircuit = transpiled_subcircuits[i_subcircuit + 1];
+                i_subcircuit += 2;
 
                 auto cfi = ClassicalIfElseStatement {
                     if_else_stmt.predicate(),
@@ -55,7 +175,31 @@ auto transpile_to_primitive(const QuantumCircuit& circuit, double tolerance_sq)
                     std::make_unique<QuantumCircuit>(std::move(transpiled_else_subcircuit))
                 };
 
-                new_circuit.elements_.emplace_back(std::move(cfi));
+                new_elements.emplace_back(std::move(cfi));
+            }
+            else if (control_flow.is_repeat_statement()) {
+                const auto& repeat_stmt = control_flow.get_repeat_statement();
+                auto& transpiled_subcircuit = transpiled_subcircuits[i_subcircuit];
+                ++i_subcircuit;
+
+                auto cfi = RepeatStatement {
+                    repeat_stmt.n_repetitions(),
+                    std::make_unique<QuantumCircuit>(std::move(transpiled_subcircuit))
+                };
+
+                new_elements.emplace_back(std::move(cfi));
+            }
+            else if (control_flow.is_controlled_block()) {
+                const auto& block = control_flow.get_controlled_block();
+                auto& transpiled_subcircuit = transpiled_subcircuits[i_subcircuit];
+                ++i_subcircuit;
+
+                auto cfi = ControlledBlock {
+                    block.control_qubits(),
+                    std::make_unique<QuantumCircuit>(std::move(transpiled_subcircuit))
+                };
+
+                new_elements.emplace_back(std::move(cfi));
             }
             else {
                 throw std::runtime_error {"DEV ERROR: invalid control flow element found in `transpile_to_primitive()`\n"};
@@ -65,20 +209,26 @@ auto transpile_to_primitive(const QuantumCircuit& circuit, double tolerance_sq)
             const auto& gate_info = circuit_element.get_gate();
 
             if (gid::is_primitive_gate(gate_info.gate) || gate_info.gate == Gate::M) {
-                new_circuit.elements_.emplace_back(gate_info);
+                new_elements.emplace_back(gate_info);
             }
             else if (gate_info.gate == Gate::U) {
                 const auto [target, unitary_ptr] = cre::unpack_u_gate(gate_info);
-                const auto decomp_gates = decomp_1t(target, *unitary_ptr, tolerance_sq);
+                const auto decomp_gates = cache.one_target_gates(target, *unitary_ptr);
                 for (const auto& decomp_gate : decomp_gates) {
-                    new_circuit.elements_.emplace_back(decomp_gate);
+                    new_elements.emplace_back(decomp_gate);
                 }
             }
             else if (gate_info.gate == Gate::CU) {
                 const auto [control, target, unitary_ptr] = cre::unpack_cu_gate(gate_info);
-                const auto decomp_gates = decomp_1c_1t(control, target, *unitary_ptr, tolerance_sq);
+                const auto decomp_gates = cache.one_control_one_target_gates(control, target, *unitary_ptr);
+                for (const auto& decomp_gate : decomp_gates) {
+                    new_elements.emplace_back(decomp_gate);
+                }
+            }
+            else if (gate_info.gate == Gate::PAULI_ROT) {
+                const auto decomp_gates = ket::internal::decomp_pauli_rotation_gate_(gate_info);
                 for (const auto& decomp_gate : decomp_gates) {
-                    new_circuit.elements_.emplace_back(decomp_gate);
+                    new_elements.emplace_back(decomp_gate);
                 }
             }
         }
@@ -90,4 +240,20 @@ auto transpile_to_primitive(const QuantumCircuit& circuit, double tolerance_sq)
     return new_circuit;
 }
 
+}  // namespace ket::internal
+
+
+namespace ket
+{
+
+auto transpile_to_primitive(const QuantumCircuit& circuit, double tolerance_sq) -> QuantumCircuit
+{
+    namespace ki = ket::internal;
+
+    auto cache = ki::DecompositionCache_ {tolerance_sq};
+    const auto n_threads = static_cast<std::size_t>(std::max(1U, std::thread::hardware_concurrency()));
+
+    return ki::transpile_to_primitive_(circuit, cache, n_threads);
+}
+
 }  // namespace ket
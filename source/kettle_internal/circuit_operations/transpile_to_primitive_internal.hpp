@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+#include "kettle/circuit/circuit.hpp"
+
+#include "kettle_internal/gates/matrix2x2_gate_decomposition.hpp"
+
+
+namespace ket::internal
+{
+
+/*
+    The implementation of `transpile_to_primitive()`; the decompositions of the U and CU gates are
+    looked up in (and added to) `cache`, which is shared with all the subcircuits.
+
+    The subcircuits of the control flow statements directly inside `circuit` are independent of each
+    other, and are transpiled on up to `n_threads` threads if they are large enough to be worth it; the
+    subcircuits nested inside of those are transpiled on the same thread as their parent. The output
+    is the same for any number of threads.
+*/
+auto transpile_to_primitive_(
+    const ket::QuantumCircuit& circuit,
+    DecompositionCache_& cache,
+    std::size_t n_threads
+) -> ket::QuantumCircuit;
+
+}  // namespace ket::internal
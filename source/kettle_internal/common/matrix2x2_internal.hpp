@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "kettle/common/matrix2x2.hpp"
+
+namespace ket::internal
+{
+
+/*
+    The bits of the real and imaginary parts of the four elements of `mat`; two matrices have the same
+    bits only if they are exactly equal, so this can be used as the key of a container that must never
+    mix up matrices that are only almost equal.
+*/
+inline auto matrix2x2_bits_(const ket::Matrix2X2& mat) noexcept -> std::array<std::uint64_t, 8>
+{
+    const auto bits = [](double value) { return std::bit_cast<std::uint64_t>(value); };
+
+    return {
+        bits(mat.elem00.real()), bits(mat.elem00.imag()),
+        bits(mat.elem01.real()), bits(mat.elem01.imag()),
+        bits(mat.elem10.real()), bits(mat.elem10.imag()),
+        bits(mat.elem11.real()), bits(mat.elem11.imag())
+    };
+}
+
+}  // namespace ket::internal
@@ -1,5 +1,8 @@
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <optional>
 #include <vector>
 
@@ -7,6 +10,7 @@
 #include "kettle/gates/primitive_gate.hpp"
 #include "kettle/gates/common_u_gates.hpp"
 
+#include "kettle_internal/common/matrix2x2_internal.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_create.hpp"
 #include "kettle_internal/gates/primitive_gate_map.hpp"
 
@@ -144,15 +148,12 @@ auto decomp_to_primitive_gates_(
     }
 }
 
-auto decomp_to_one_target_primitive_gates_(
-    std::size_t target,
-    const ket::Matrix2X2& unitary,
-    double tolerance_sq
-) -> std::vector<ket::GateInfo>
+namespace
 {
-    namespace cre = ket::internal::create;
 
-    const auto primitives = decomp_to_primitive_gates_(unitary, tolerance_sq);
+auto one_target_gates_(std::size_t target, const std::vector<PrimitiveGateInfo_>& primitives) -> std::vector<ket::GateInfo>
+{
+    namespace cre = ket::internal::create;
 
     auto output = std::vector<ket::GateInfo> {};
     for (const auto& primitive : primitives) {
@@ -167,17 +168,14 @@ auto decomp_to_one_target_primitive_gates_(
     return output;
 }
 
-auto decomp_to_one_control_one_target_primitive_gates_(
+auto one_control_one_target_gates_(
     std::size_t control,
     std::size_t target,
-    const ket::Matrix2X2& unitary,
-    double tolerance_sq
+    const std::vector<PrimitiveGateInfo_>& primitives
 ) -> std::vector<ket::GateInfo>
 {
     namespace cre = ket::internal::create;
 
-    const auto primitives = decomp_to_primitive_gates_(unitary, tolerance_sq);
-
     auto output = std::vector<ket::GateInfo> {};
     for (const auto& primitive : primitives) {
         const auto ctrl_gate = ket::internal::UNCONTROLLED_TO_CONTROLLED_GATE.at(primitive.gate);
@@ -193,4 +191,96 @@ auto decomp_to_one_control_one_target_primitive_gates_(
     return output;
 }
 
+}  // namespace
+
+auto decomp_to_one_target_primitive_gates_(
+    std::size_t target,
+    const ket::Matrix2X2& unitary,
+    double tolerance_sq
+) -> std::vector<ket::GateInfo>
+{
+    return one_target_gates_(target, decomp_to_primitive_gates_(unitary, tolerance_sq));
+}
+
+auto decomp_to_one_control_one_target_primitive_gates_(
+    std::size_t control,
+    std::size_t target,
+    const ket::Matrix2X2& unitary,
+    double tolerance_sq
+) -> std::vector<ket::GateInfo>
+{
+    return one_control_one_target_gates_(control, target, decomp_to_primitive_gates_(unitary, tolerance_sq));
+}
+
+DecompositionCache_::DecompositionCache_(double tolerance_sq)
+    : tolerance_sq_ {tolerance_sq}
+{}
+
+auto DecompositionCache_::KeyHash_::operator()(const Key_& key) const noexcept -> std::size_t
+{
+    // the 64-bit FNV-1a offset basis and prime, applied to whole elements instead of bytes
+    auto output = std::size_t {14695981039346656037ULL};
+    for (auto value : key) {
+        output ^= static_cast<std::size_t>(value);
+        output *= std::size_t {1099511628211ULL};
+    }
+
+    return output;
+}
+
+auto DecompositionCache_::key_(const ket::Matrix2X2& unitary) noexcept -> Key_
+{
+    return matrix2x2_bits_(unitary);
+}
+
+auto DecompositionCache_::decompose(const ket::Matrix2X2& unitary) -> std::vector<PrimitiveGateInfo_>
+{
+    const auto key = key_(unitary);
+
+    {
+        auto lock = std::scoped_lock {mutex_};
+
+        if (const auto it = entries_.find(key); it != entries_.end()) {
+            ++n_hits_;
+            return it->second;
+        }
+    }
+
+    // the decomposition is done without holding the lock; if two threads decompose the same matrix at
+    // the same time, they get the same gates, so it does not matter which one is stored
+    auto primitives = decomp_to_primitive_gates_(unitary, tolerance_sq_);
+
+    auto lock = std::scoped_lock {mutex_};
+    ++n_misses_;
+    entries_.try_emplace(key, primitives);
+
+    return primitives;
+}
+
+auto DecompositionCache_::one_target_gates(std::size_t target, const ket::Matrix2X2& unitary) -> std::vector<ket::GateInfo>
+{
+    return one_target_gates_(target, decompose(unitary));
+}
+
+auto DecompositionCache_::one_control_one_target_gates(
+    std::size_t control,
+    std::size_t target,
+    const ket::Matrix2X2& unitary
+) -> std::vector<ket::GateInfo>
+{
+    return one_control_one_target_gates_(control, target, decompose(unitary));
+}
+
+auto DecompositionCache_::n_hits() const -> std::size_t
+{
+    auto lock = std::scoped_lock {mutex_};
+    return n_hits_;
+}
+
+auto DecompositionCache_::n_misses() const -> std::size_t
+{
+    auto lock = std::scoped_lock {mutex_};
+    return n_misses_;
+}
+
 }  // namespace ket::internal
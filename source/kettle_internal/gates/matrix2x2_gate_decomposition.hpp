@@ -1,6 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "kettle/common/matrix2x2.hpp"
@@ -69,4 +74,65 @@ auto decomp_to_one_control_one_target_primitive_gates_(
     double tolerance_sq = ket::COMPLEX_ALMOST_EQ_TOLERANCE_SQ
 ) -> std::vector<ket::GateInfo>;
 
+/*
+    Remembers the decompositions found by `decomp_to_primitive_gates_()`; circuits created by
+    `make_controlled_circuit()` and similar functions tend to hold the same few unitary matrices
+    thousands of times.
+
+    A stored decomposition is only reused for a matrix with exactly the same elements, so a lookup
+    always gives the same gates as decomposing the matrix directly; the output does not depend on
+    which matrices were decomposed first, or on which thread. Matrices that are only equal to within
+    the tolerance are decomposed separately.
+
+    All member functions are safe to call concurrently.
+*/
+class DecompositionCache_
+{
+public:
+    explicit DecompositionCache_(double tolerance_sq = ket::COMPLEX_ALMOST_EQ_TOLERANCE_SQ);
+
+    [[nodiscard]]
+    auto decompose(const ket::Matrix2X2& unitary) -> std::vector<PrimitiveGateInfo_>;
+
+    [[nodiscard]]
+    auto one_target_gates(std::size_t target, const ket::Matrix2X2& unitary) -> std::vector<ket::GateInfo>;
+
+    [[nodiscard]]
+    auto one_control_one_target_gates(
+        std::size_t control,
+        std::size_t target,
+        const ket::Matrix2X2& unitary
+    ) -> std::vector<ket::GateInfo>;
+
+    [[nodiscard]]
+    auto n_hits() const -> std::size_t;
+
+    [[nodiscard]]
+    auto n_misses() const -> std::size_t;
+
+    [[nodiscard]]
+    constexpr auto tolerance_sq() const noexcept -> double
+    {
+        return tolerance_sq_;
+    }
+
+private:
+    // the bits of the real and imaginary parts of the four elements
+    using Key_ = std::array<std::uint64_t, 8>;
+
+    struct KeyHash_
+    {
+        auto operator()(const Key_& key) const noexcept -> std::size_t;
+    };
+
+    double tolerance_sq_;
+    mutable std::mutex mutex_;
+    std::unordered_map<Key_, std::vector<PrimitiveGateInfo_>, KeyHash_> entries_;
+    std::size_t n_hits_ {0};
+    std::size_t n_misses_ {0};
+
+    [[nodiscard]]
+    static auto key_(const ket::Matrix2X2& unitary) noexcept -> Key_;
+};
+
 }  // namespace ket::internal
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+
+#include "kettle_internal/gates/pauli_rotation_gadget.hpp"
+
+namespace ket::internal
+{
+
+auto pauli_rotation_gadget_(const ket::SparsePauliString& pauli_string) -> PauliRotationGadget_
+{
+    using G = ket::Gate;
+    using PT = ket::PauliTerm;
+    namespace cre = ket::internal::create;
+
+    constexpr auto half_pi = std::numbers::pi / 2.0;
+
+    // the identity terms are not part of the gadget
+    auto terms = std::vector<std::pair<std::size_t, PT>> {};
+    std::ranges::copy_if(pauli_string.terms(), std::back_inserter(terms), [](const auto& pair) { return pair.second != PT::I; });
+    std::ranges::sort(terms, [](const auto& left, const auto& right) { return left.first < right.first; });
+
+    if (terms.empty()) {
+        throw std::runtime_error {"ERROR: cannot decompose a 'PAULI_ROT' gate whose Pauli string only has identity terms.\n"};
+    }
+
+    auto gadget = PauliRotationGadget_ {};
+    gadget.rotation_qubit = terms.back().first;
+
+    auto change_of_basis = std::vector<ket::GateInfo> {};
+    auto undo_change_of_basis = std::vector<ket::GateInfo> {};
+    for (const auto& [qubit, term] : terms) {
+        if (term == PT::X) {
+            change_of_basis.push_back(cre::create_one_target_gate(G::H, qubit));
+            undo_change_of_basis.push_back(cre::create_one_target_gate(G::H, qubit));
+        }
+        else if (term == PT::Y) {
+            change_of_basis.push_back(cre::create_one_target_one_angle_gate(G::RX, qubit, half_pi));
+            undo_change_of_basis.push_back(cre::create_one_target_one_angle_gate(G::RX, qubit, -half_pi));
+        }
+    }
+
+    auto ladder = std::vector<ket::GateInfo> {};
+    for (std::size_t i {1}; i < terms.size(); ++i) {
+        ladder.push_back(cre::create_one_control_one_target_gate(G::CX, terms[i - 1].first, terms[i].first));
+    }
+
+    gadget.compute = change_of_basis;
+    gadget.compute.insert(gadget.compute.end(), ladder.begin(), ladder.end());
+
+    if (pauli_string.phase() == ket::PauliPhase::MINUS_ONE) {
+        gadget.compute.push_back(cre::create_one_target_gate(G::X, gadget.rotation_qubit));
+        gadget.uncompute.push_back(cre::create_one_target_gate(G::X, gadget.rotation_qubit));
+    }
+
+    gadget.uncompute.insert(gadget.uncompute.end(), ladder.rbegin(), ladder.rend());
+    gadget.uncompute.insert(gadget.uncompute.end(), undo_change_of_basis.begin(), undo_change_of_basis.end());
+
+    return gadget;
+}
+
+auto decomp_pauli_rotation_gate_(const ket::GateInfo& info) -> std::vector<ket::GateInfo>
+{
+    namespace cre = ket::internal::create;
+
+    const auto gadget = pauli_rotation_gadget_(*info.pauli_string_ptr);
+
+    auto output = gadget.compute;
+
+    if (info.param_expression_ptr) {
+        const auto& [ignore, param_expression_ptr] = cre::unpack_pauli_rotation_parameter_gate(info);
+        output.push_back(cre::create_one_target_one_parameter_gate(ket::Gate::RZ, gadget.rotation_qubit, *param_expression_ptr));
+    }
+    else {
+        const auto& [ignore, angle] = cre::unpack_pauli_rotation_gate(info);
+        output.push_back(cre::create_one_target_one_angle_gate(ket::Gate::RZ, gadget.rotation_qubit, angle));
+    }
+
+    output.insert(output.end(), gadget.uncompute.begin(), gadget.uncompute.end());
+
+    return output;
+}
+
+}  // namespace ket::internal
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+
+/*
+    This header file contains functions for decomposing a PAULI_ROT gate, which applies exp(-i theta P / 2)
+    for a Pauli string P, into the usual "gadget" of primitive gates:
+      - a change of basis on each qubit with an X term (H) or a Y term (RX(pi/2))
+      - a ladder of CX gates that collects the parity of the qubits in P onto the highest qubit
+      - an RZ gate with angle theta on the highest qubit
+      - the same ladder and changes of basis in reverse, to undo them
+*/
+
+namespace ket::internal
+{
+
+/*
+    The gates that come before and after the RZ gate in the decomposition of a PAULI_ROT gate.
+
+    If the phase of the Pauli string is -1, then X gates are placed on either side of the RZ gate,
+    which flips the sign of the rotation without needing to change the angle.
+*/
+struct PauliRotationGadget_
+{
+    std::vector<ket::GateInfo> compute;
+    std::size_t rotation_qubit;
+    std::vector<ket::GateInfo> uncompute;
+};
+
+/*
+    Throws a `std::runtime_error` if `pauli_string` only has identity terms, because there is then no
+    qubit to place the RZ gate on.
+*/
+auto pauli_rotation_gadget_(const ket::SparsePauliString& pauli_string) -> PauliRotationGadget_;
+
+/*
+    Decompose a PAULI_ROT gate into primitive gates; if the angle of the gate is parameterized, then
+    the RZ gate in the decomposition holds a copy of the same parameter expression.
+*/
+auto decomp_pauli_rotation_gate_(const ket::GateInfo& info) -> std::vector<ket::GateInfo>;
+
+}  // namespace ket::internal
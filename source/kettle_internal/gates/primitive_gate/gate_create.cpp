@@ -5,6 +5,7 @@
 
 #include "kettle/common/clone_ptr.hpp"
 #include "kettle/common/matrix2x2.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
 
 #include "kettle/gates/primitive_gate.hpp"
 #include "kettle/parameter/parameter_expression.hpp"
@@ -20,13 +21,14 @@ namespace ket::internal::create
     Parameters indicating to the developer that a given gate does not use a certain data member in
     a ket::GateInfo instance.
 
-    Note that DUMMY_ARG3 cannot be constexpr, because ClonePtr holds `std::unique_ptr<T>`, which is
-    not constexpr in C++20 (only in C++23).
+    Note that DUMMY_ARG3, DUMMY_ARG4, and DUMMY_ARG5 cannot be constexpr, because ClonePtr holds
+    `std::unique_ptr<T>`, which is not constexpr in C++20 (only in C++23).
 */
 constexpr inline auto DUMMY_ARG1 = std::size_t {0};
 constexpr inline auto DUMMY_ARG2 = double {0.0};
 const inline auto DUMMY_ARG3 = ket::ClonePtr<ket::Matrix2X2> {nullptr};
 const inline auto DUMMY_ARG4 = ket::ClonePtr<ket::param::ParameterExpression> {nullptr};
+const inline auto DUMMY_ARG5 = ket::ClonePtr<ket::SparsePauliString> {nullptr};
 
 /*
     Create a single-qubit gate with no parameters.
@@ -37,7 +39,7 @@ auto create_one_target_gate(ket::Gate gate, std::size_t target_index) -> ket::Ga
         throw std::runtime_error {"DEV ERROR: invalid one-target gate provided.\n"};
     }
 
-    return {.gate=gate, .arg0=target_index, .arg1=DUMMY_ARG1, .arg2=DUMMY_ARG2, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4};
+    return {.gate=gate, .arg0=target_index, .arg1=DUMMY_ARG1, .arg2=DUMMY_ARG2, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4, .pauli_string_ptr=DUMMY_ARG5};
 }
 
 /*
@@ -57,7 +59,7 @@ auto create_one_target_one_angle_gate(ket::Gate gate, std::size_t target_index,
         throw std::runtime_error {"DEV ERROR: invalid one-target-one-angle gate provided.\n"};
     }
 
-    return {.gate=gate, .arg0=target_index, .arg1=DUMMY_ARG1, .arg2=theta, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4};
+    return {.gate=gate, .arg0=target_index, .arg1=DUMMY_ARG1, .arg2=theta, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4, .pauli_string_ptr=DUMMY_ARG5};
 }
 
 /*
@@ -83,7 +85,8 @@ auto create_one_target_one_parameter_gate(ket::Gate gate, std::size_t target_ind
         .arg1=DUMMY_ARG1,
         .arg2=DUMMY_ARG2,
         .unitary_ptr=DUMMY_ARG3,
-        .param_expression_ptr=ket::ClonePtr {std::move(param_expression)}
+        .param_expression_ptr=ket::ClonePtr {std::move(param_expression)},
+        .pauli_string_ptr=DUMMY_ARG5
     };
 }
 
@@ -104,7 +107,7 @@ auto create_one_control_one_target_gate(ket::Gate gate, std::size_t control_inde
         throw std::runtime_error {"DEV ERROR: invalid one-control-one-target gate provided.\n"};
     }
 
-    return {.gate=gate, .arg0=control_index, .arg1=target_index, .arg2=DUMMY_ARG2, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4};
+    return {.gate=gate, .arg0=control_index, .arg1=target_index, .arg2=DUMMY_ARG2, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4, .pauli_string_ptr=DUMMY_ARG5};
 }
 
 /*
@@ -124,7 +127,7 @@ auto create_one_control_one_target_one_angle_gate(ket::Gate gate, std::size_t co
         throw std::runtime_error {"DEV ERROR: invalid one-control-one-target-one-angle gate provided.\n"};
     }
 
-    return {.gate=gate, .arg0=control_index, .arg1=target_index, .arg2=theta, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4};
+    return {.gate=gate, .arg0=control_index, .arg1=target_index, .arg2=theta, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4, .pauli_string_ptr=DUMMY_ARG5};
 }
 
 /*
@@ -152,7 +155,8 @@ auto create_one_control_one_target_one_parameter_gate(
         .arg1=target_index,
         .arg2=DUMMY_ARG2,
         .unitary_ptr=DUMMY_ARG3,
-        .param_expression_ptr=ket::ClonePtr {std::move(param_expression)}
+        .param_expression_ptr=ket::ClonePtr {std::move(param_expression)},
+        .pauli_string_ptr=DUMMY_ARG5
     };
 }
 
@@ -167,7 +171,7 @@ auto unpack_one_control_one_target_one_parameter_gate(const ket::GateInfo& info)
 */
 auto create_u_gate(std::size_t target_index, ket::ClonePtr<ket::Matrix2X2> unitary) -> ket::GateInfo
 {
-    return {.gate=ket::Gate::U, .arg0=target_index, .arg1=DUMMY_ARG1, .arg2=DUMMY_ARG2, .unitary_ptr=std::move(unitary), .param_expression_ptr=DUMMY_ARG4};
+    return {.gate=ket::Gate::U, .arg0=target_index, .arg1=DUMMY_ARG1, .arg2=DUMMY_ARG2, .unitary_ptr=std::move(unitary), .param_expression_ptr=DUMMY_ARG4, .pauli_string_ptr=DUMMY_ARG5};
 }
 
 /*
@@ -184,7 +188,7 @@ auto unpack_u_gate(const ket::GateInfo& info) -> std::tuple<std::size_t, const k
 */
 auto create_cu_gate(std::size_t control_index, std::size_t target_index, ket::ClonePtr<ket::Matrix2X2> unitary) -> ket::GateInfo
 {
-    return {.gate=ket::Gate::CU, .arg0=control_index, .arg1=target_index, .arg2=DUMMY_ARG2, .unitary_ptr=std::move(unitary), .param_expression_ptr=DUMMY_ARG4};
+    return {.gate=ket::Gate::CU, .arg0=control_index, .arg1=target_index, .arg2=DUMMY_ARG2, .unitary_ptr=std::move(unitary), .param_expression_ptr=DUMMY_ARG4, .pauli_string_ptr=DUMMY_ARG5};
 }
 
 /*
@@ -195,12 +199,57 @@ auto unpack_cu_gate(const ket::GateInfo& info) -> std::tuple<std::size_t, std::s
     return {info.arg0, info.arg1, info.unitary_ptr};  // control index, target index, unitary_ptr
 }
 
+/*
+    Create a PAULI_ROT-gate, which applies exp(-i theta P / 2) for the Pauli string P in `pauli_string`.
+*/
+auto create_pauli_rotation_gate(ket::ClonePtr<ket::SparsePauliString> pauli_string, double theta) -> ket::GateInfo
+{
+    return {.gate=ket::Gate::PAULI_ROT, .arg0=DUMMY_ARG1, .arg1=DUMMY_ARG1, .arg2=theta, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4, .pauli_string_ptr=std::move(pauli_string)};
+}
+
+/*
+    Returns the `{pauli_string_ptr, angle}` of a PAULI_ROT-gate with a fixed angle.
+*/
+auto unpack_pauli_rotation_gate(const ket::GateInfo& info) -> std::tuple<const ket::ClonePtr<ket::SparsePauliString>&, double>
+{
+    return {info.pauli_string_ptr, info.arg2};  // pauli_string_ptr, angle
+}
+
+/*
+    Create a PAULI_ROT-gate with a parameterized angle.
+*/
+auto create_pauli_rotation_parameter_gate(
+    ket::ClonePtr<ket::SparsePauliString> pauli_string,
+    ket::param::ParameterExpression param_expression
+) -> ket::GateInfo
+{
+    return {
+        .gate=ket::Gate::PAULI_ROT,
+        .arg0=DUMMY_ARG1,
+        .arg1=DUMMY_ARG1,
+        .arg2=DUMMY_ARG2,
+        .unitary_ptr=DUMMY_ARG3,
+        .param_expression_ptr=ket::ClonePtr {std::move(param_expression)},
+        .pauli_string_ptr=std::move(pauli_string)
+    };
+}
+
+/*
+    Returns the `{pauli_string_ptr, param_expression_ptr}` of a PAULI_ROT-gate with a parameterized angle.
+*/
+auto unpack_pauli_rotation_parameter_gate(
+    const ket::GateInfo& info
+) -> std::tuple<const ket::ClonePtr<ket::SparsePauliString>&, const ket::ClonePtr<ket::param::ParameterExpression>&>
+{
+    return {info.pauli_string_ptr, info.param_expression_ptr};  // pauli_string_ptr, param_expression_ptr
+}
+
 /*
     Create an M-gate, which measures the qubit at `qubit_index`, and stores the result at `bit_index`.
 */
 auto create_m_gate(std::size_t qubit_index, std::size_t bit_index) -> ket::GateInfo
 {
-    return {.gate=ket::Gate::M, .arg0=qubit_index, .arg1=bit_index, .arg2=DUMMY_ARG2, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4};
+    return {.gate=ket::Gate::M, .arg0=qubit_index, .arg1=bit_index, .arg2=DUMMY_ARG2, .unitary_ptr=DUMMY_ARG3, .param_expression_ptr=DUMMY_ARG4, .pauli_string_ptr=DUMMY_ARG5};
 }
 
 /*
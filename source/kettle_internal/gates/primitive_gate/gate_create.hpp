@@ -6,6 +6,7 @@
 
 #include "kettle/common/clone_ptr.hpp"
 #include "kettle/common/matrix2x2.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
 #include "kettle/parameter/parameter_expression.hpp"
 
 #include "kettle/gates/primitive_gate.hpp"
@@ -96,6 +97,31 @@ auto create_cu_gate(std::size_t control_index, std::size_t target_index, ket::Cl
 */
 auto unpack_cu_gate(const ket::GateInfo& info) -> std::tuple<std::size_t, std::size_t, const ket::ClonePtr<ket::Matrix2X2>&>;
 
+/*
+    Create a PAULI_ROT-gate, which applies exp(-i theta P / 2) for the Pauli string P in `pauli_string`.
+*/
+auto create_pauli_rotation_gate(ket::ClonePtr<ket::SparsePauliString> pauli_string, double theta) -> ket::GateInfo;
+
+/*
+    Returns the `{pauli_string_ptr, angle}` of a PAULI_ROT-gate with a fixed angle.
+*/
+auto unpack_pauli_rotation_gate(const ket::GateInfo& info) -> std::tuple<const ket::ClonePtr<ket::SparsePauliString>&, double>;
+
+/*
+    Create a PAULI_ROT-gate with a parameterized angle.
+*/
+auto create_pauli_rotation_parameter_gate(
+    ket::ClonePtr<ket::SparsePauliString> pauli_string,
+    ket::param::ParameterExpression param_expression
+) -> ket::GateInfo;
+
+/*
+    Returns the `{pauli_string_ptr, param_expression_ptr}` of a PAULI_ROT-gate with a parameterized angle.
+*/
+auto unpack_pauli_rotation_parameter_gate(
+    const ket::GateInfo& info
+) -> std::tuple<const ket::ClonePtr<ket::SparsePauliString>&, const ket::ClonePtr<ket::param::ParameterExpression>&>;
+
 /*
     Create an M-gate, which measures the qubit at `qubit_index`, and stores the result at `bit_index`.
 */
@@ -32,7 +32,7 @@ const ket::internal::LinearBijectiveMap<G, G, 15> UNCONTROLLED_TO_CONTROLLED_GAT
 };
 
 // NOLINTNEXTLINE(cert-err58-cpp)
-const ket::internal::LinearBijectiveMap<G, std::string, 31> PRIMITIVE_GATES_TO_STRING = {
+const ket::internal::LinearBijectiveMap<G, std::string, 32> PRIMITIVE_GATES_TO_STRING = {
     std::pair {G::H, "H"},
     std::pair {G::X, "X"},
     std::pair {G::Y, "Y"},
@@ -63,6 +63,7 @@ const ket::internal::LinearBijectiveMap<G, std::string, 31> PRIMITIVE_GATES_TO_S
     std::pair {G::CP, "CP"},
     std::pair {G::U, "U"},
     std::pair {G::CU, "CU"},
+    std::pair {G::PAULI_ROT, "PAULI_ROT"},
     std::pair {G::M, "M"},
 };
 
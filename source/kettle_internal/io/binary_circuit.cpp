@@ -0,0 +1,1024 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/circuit_element.hpp"
+#include "kettle/circuit/compact_circuit.hpp"
+#include "kettle/circuit/control_flow.hpp"
+#include "kettle/circuit/control_flow_predicate.hpp"
+#include "kettle/circuit_loggers/circuit_logger.hpp"
+#include "kettle/common/clone_ptr.hpp"
+#include "kettle/common/matrix2x2.hpp"
+#include "kettle/common/utils.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/io/binary_circuit.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/parameter/parameter_expression.hpp"
+
+#include "kettle_internal/circuit/circuit_access.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+#include "kettle_internal/io/io_binary.hpp"
+
+namespace ki = ket::internal;
+
+
+namespace
+{
+
+constexpr auto BINARY_CIRCUIT_MAGIC_ = std::array<char, 8> {'K', 'E', 'T', 'C', 'I', 'R', 'C', 'T'};
+constexpr auto BINARY_COMPACT_CIRCUIT_MAGIC_ = std::array<char, 8> {'K', 'E', 'T', 'C', 'M', 'P', 'C', 'T'};
+constexpr auto BINARY_CIRCUIT_VERSION_ = std::uint32_t {1};
+constexpr auto BYTE_ORDER_MARK_ = std::uint32_t {0x01020304};
+
+struct BinaryCircuitHeader_
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t byte_order_mark;
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+};
+
+static_assert(sizeof(BinaryCircuitHeader_) == 32);
+
+/*
+    The first byte of each circuit element, which identifies what kind of element follows.
+*/
+enum class ElementTag_ : std::uint8_t
+{
+    GATE,
+    IF_STATEMENT,
+    IF_ELSE_STATEMENT,
+    REPEAT_STATEMENT,
+    CONTROLLED_BLOCK,
+    CLASSICAL_REGISTER_LOGGER,
+    STATEVECTOR_LOGGER
+};
+
+/*
+    The first byte of each node of a parameter expression.
+*/
+enum class ExpressionTag_ : std::uint8_t
+{
+    PARAMETER,
+    LITERAL,
+    BINARY
+};
+
+// the bits of the byte that records which of the optional parts of a gate follow it
+constexpr auto HAS_UNITARY_ = std::uint8_t {1};
+constexpr auto HAS_PARAMETER_EXPRESSION_ = std::uint8_t {2};
+constexpr auto HAS_PAULI_STRING_ = std::uint8_t {4};
+
+// the deepest nesting of control flow statements, and of parameter expressions, that can be loaded;
+// this keeps a corrupted file from overflowing the stack
+constexpr auto MAX_NESTING_DEPTH_ = std::size_t {256};
+
+// the most qubits or bits that a loaded circuit can have; this is far more than any circuit that can
+// be simulated, and keeps a corrupted file from making the Pauli strings allocate enormous masks
+constexpr auto MAX_CIRCUIT_SIZE_ = std::size_t {1} << 20;
+
+/* ----- writing ----- */
+
+template <typename T>
+void write_value_(std::vector<std::byte>& buffer, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    const auto bytes = std::as_bytes(std::span {&value, 1});
+    buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+}
+
+void write_size_(std::vector<std::byte>& buffer, std::size_t value)
+{
+    write_value_(buffer, static_cast<std::uint64_t>(value));
+}
+
+void write_string_(std::vector<std::byte>& buffer, const std::string& value)
+{
+    write_size_(buffer, value.size());
+
+    const auto bytes = std::as_bytes(std::span {value});
+    buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+}
+
+/*
+    Writes the number of values, followed by the bytes of all the values at once.
+*/
+template <typename T>
+void write_array_(std::vector<std::byte>& buffer, const std::vector<T>& values)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    write_size_(buffer, values.size());
+
+    const auto bytes = std::as_bytes(std::span {values});
+    buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+}
+
+void write_parameters_(std::vector<std::byte>& buffer, const ket::param::ParameterDataMap& parameter_data, std::size_t parameter_count)
+{
+    write_size_(buffer, parameter_data.size());
+    for (const auto& [id, data] : parameter_data) {
+        write_value_(buffer, id);
+        write_value_(buffer, static_cast<std::uint8_t>(data.value.has_value()));
+        write_value_(buffer, data.value.value_or(0.0));
+        write_size_(buffer, data.count);
+        write_string_(buffer, data.name);
+    }
+    write_size_(buffer, parameter_count);
+}
+
+void write_pauli_string_(std::vector<std::byte>& buffer, const ket::SparsePauliString& pauli_string)
+{
+    write_size_(buffer, pauli_string.n_qubits());
+    write_value_(buffer, pauli_string.phase());
+    write_size_(buffer, pauli_string.size());
+    for (const auto& [index, term] : pauli_string.terms()) {
+        write_size_(buffer, index);
+        write_value_(buffer, term);
+    }
+}
+
+void write_expression_(std::vector<std::byte>& buffer, const ket::param::ParameterExpression& expression)
+{
+    namespace kp = ket::param;
+
+    if (const auto* parameter = std::get_if<kp::Parameter>(&expression)) {
+        write_value_(buffer, ExpressionTag_::PARAMETER);
+        write_value_(buffer, parameter->id());
+        write_string_(buffer, parameter->name());
+    }
+    else if (const auto* literal = std::get_if<kp::LiteralExpression>(&expression)) {
+        write_value_(buffer, ExpressionTag_::LITERAL);
+        write_value_(buffer, literal->value);
+    }
+    else if (const auto* binary = std::get_if<kp::BinaryExpression>(&expression)) {
+        write_value_(buffer, ExpressionTag_::BINARY);
+        write_value_(buffer, binary->operation);
+        write_expression_(buffer, *binary->left);
+        write_expression_(buffer, *binary->right);
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: unknown parameter expression found in `write_expression_()`\n"};
+    }
+}
+
+void write_gate_(std::vector<std::byte>& buffer, const ket::GateInfo& info)
+{
+    auto flags = std::uint8_t {0};
+    flags |= info.unitary_ptr ? HAS_UNITARY_ : std::uint8_t {0};
+    flags |= info.param_expression_ptr ? HAS_PARAMETER_EXPRESSION_ : std::uint8_t {0};
+    flags |= info.pauli_string_ptr ? HAS_PAULI_STRING_ : std::uint8_t {0};
+
+    write_value_(buffer, ElementTag_::GATE);
+    write_value_(buffer, info.gate);
+    write_value_(buffer, flags);
+    write_size_(buffer, info.arg0);
+    write_size_(buffer, info.arg1);
+    write_value_(buffer, info.arg2);
+
+    if (info.unitary_ptr) {
+        write_value_(buffer, *info.unitary_ptr);
+    }
+
+    if (info.param_expression_ptr) {
+        write_expression_(buffer, *info.param_expression_ptr);
+    }
+
+    if (info.pauli_string_ptr) {
+        write_pauli_string_(buffer, *info.pauli_string_ptr);
+    }
+}
+
+void write_predicate_(std::vector<std::byte>& buffer, const ket::ControlFlowPredicate& predicate)
+{
+    write_size_(buffer, predicate.bit_indices_to_check().size());
+    for (auto index : predicate.bit_indices_to_check()) {
+        write_size_(buffer, index);
+    }
+
+    write_size_(buffer, predicate.expected_bits().size());
+    for (auto bit : predicate.expected_bits()) {
+        write_value_(buffer, static_cast<std::int32_t>(bit));
+    }
+
+    write_value_(buffer, predicate.control_kind());
+}
+
+void write_circuit_(std::vector<std::byte>& buffer, const ket::QuantumCircuit& circuit);
+
+// NOLINTNEXTLINE(misc-no-recursion)
+void write_control_flow_(std::vector<std::byte>& buffer, const ket::ClassicalControlFlowInstruction& instruction)
+{
+    if (instruction.is_if_statement()) {
+        const auto& stmt = instruction.get_if_statement();
+        write_value_(buffer, ElementTag_::IF_STATEMENT);
+        write_predicate_(buffer, stmt.predicate());
+        write_circuit_(buffer, *stmt.circuit());
+    }
+    else if (instruction.is_if_else_statement()) {
+        const auto& stmt = instruction.get_if_else_statement();
+        write_value_(buffer, ElementTag_::IF_ELSE_STATEMENT);
+        write_predicate_(buffer, stmt.predicate());
+        write_circuit_(buffer, *stmt.if_circuit());
+        write_circuit_(buffer, *stmt.else_circuit());
+    }
+    else if (instruction.is_repeat_statement()) {
+        const auto& stmt = instruction.get_repeat_statement();
+        write_value_(buffer, ElementTag_::REPEAT_STATEMENT);
+        write_size_(buffer, stmt.n_repetitions());
+        write_circuit_(buffer, *stmt.circuit());
+    }
+    else if (instruction.is_controlled_block()) {
+        const auto& stmt = instruction.get_controlled_block();
+        write_value_(buffer, ElementTag_::CONTROLLED_BLOCK);
+        write_size_(buffer, stmt.control_qubits().size());
+        for (auto qubit : stmt.control_qubits()) {
+            write_size_(buffer, qubit);
+        }
+        write_circuit_(buffer, *stmt.circuit());
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: unknown control flow instruction found in `write_control_flow_()`\n"};
+    }
+}
+
+void write_logger_(std::vector<std::byte>& buffer, const ket::CircuitLogger& logger)
+{
+    if (logger.is_classical_register_circuit_logger()) {
+        write_value_(buffer, ElementTag_::CLASSICAL_REGISTER_LOGGER);
+    }
+    else if (logger.is_statevector_circuit_logger()) {
+        write_value_(buffer, ElementTag_::STATEVECTOR_LOGGER);
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: unknown circuit logger found in `write_logger_()`\n"};
+    }
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+void write_circuit_(std::vector<std::byte>& buffer, const ket::QuantumCircuit& circuit)
+{
+    write_size_(buffer, circuit.n_qubits());
+    write_size_(buffer, circuit.n_bits());
+
+    write_parameters_(buffer, circuit.parameter_data_map(), ket::CircuitAccess_::parameter_count(circuit));
+
+    write_size_(buffer, circuit.n_circuit_elements());
+    for (const auto& element : circuit) {
+        if (element.is_gate()) {
+            write_gate_(buffer, element.get_gate());
+        }
+        else if (element.is_control_flow()) {
+            write_control_flow_(buffer, element.get_control_flow());
+        }
+        else if (element.is_circuit_logger()) {
+            write_logger_(buffer, element.get_circuit_logger());
+        }
+        else {
+            throw std::runtime_error {"DEV ERROR: unknown circuit element found in `write_circuit_()`\n"};
+        }
+    }
+}
+
+/*
+    The gates and the pools of a `CompactCircuit` are written as raw arrays, so that loading them is
+    little more than a copy; only the parameter expressions and Pauli strings, which own heap memory,
+    are written one at a time.
+*/
+void write_compact_circuit_(std::vector<std::byte>& buffer, const ket::CompactCircuit& circuit)
+{
+    write_size_(buffer, circuit.n_qubits());
+    write_size_(buffer, circuit.n_bits());
+    write_parameters_(buffer, circuit.parameter_data_map(), ket::CircuitAccess_::parameter_count(circuit));
+
+    write_array_(buffer, ket::CircuitAccess_::gates(circuit));
+    write_array_(buffer, circuit.angles());
+    write_array_(buffer, circuit.unitaries());
+
+    write_size_(buffer, circuit.parameter_expressions().size());
+    for (const auto& expression : circuit.parameter_expressions()) {
+        write_expression_(buffer, expression);
+    }
+
+    write_size_(buffer, circuit.pauli_strings().size());
+    for (const auto& pauli_string : circuit.pauli_strings()) {
+        write_pauli_string_(buffer, pauli_string);
+    }
+}
+
+/* ----- reading ----- */
+
+/*
+    Reads values out of `bytes`, starting at `position` and moving it forward; every read is
+    checked against the end of the bytes, so a truncated or corrupted circuit throws instead of
+    reading past the end.
+*/
+class ByteReader_
+{
+public:
+    ByteReader_(std::span<const std::byte> bytes, std::size_t& position)
+        : bytes_ {bytes}
+        , position_ {position}
+    {}
+
+    template <typename T>
+    auto read() -> T
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        check_remaining_(sizeof(T));
+
+        auto value = T {};
+        std::memcpy(&value, bytes_.data() + position_, sizeof(T));
+        position_ += sizeof(T);
+
+        return value;
+    }
+
+    /*
+        Reads an enum, and throws if its underlying value is greater than that of `last`.
+    */
+    template <typename Enum>
+    auto read_enum(Enum last) -> Enum
+    {
+        using Underlying = std::underlying_type_t<Enum>;
+
+        const auto value = read<Underlying>();
+        if (value > static_cast<Underlying>(last)) {
+            throw std::runtime_error {"ERROR: invalid value found in the binary circuit.\n"};
+        }
+
+        return static_cast<Enum>(value);
+    }
+
+    auto read_size() -> std::size_t
+    {
+        return static_cast<std::size_t>(read<std::uint64_t>());
+    }
+
+    /*
+        Reads the number of items in a container, where each item takes at least `min_item_size`
+        bytes; a count that cannot fit in the remaining bytes throws before anything is allocated.
+    */
+    auto read_count(std::size_t min_item_size) -> std::size_t
+    {
+        const auto count = read_size();
+        if (count > (bytes_.size() - position_) / min_item_size) {
+            throw_truncated_();
+        }
+
+        return count;
+    }
+
+    /*
+        Reads the number of values, followed by the bytes of all the values at once.
+    */
+    template <typename T>
+    auto read_array() -> std::vector<T>
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        const auto count = read_count(sizeof(T));
+
+        auto values = std::vector<T>(count);
+        if (count != 0) {
+            std::memcpy(values.data(), bytes_.data() + position_, count * sizeof(T));
+            position_ += count * sizeof(T);
+        }
+
+        return values;
+    }
+
+    auto read_string() -> std::string
+    {
+        const auto size = read_count(1);
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto output = std::string {reinterpret_cast<const char*>(bytes_.data() + position_), size};
+        position_ += size;
+
+        return output;
+    }
+
+private:
+    std::span<const std::byte> bytes_;
+    std::size_t& position_;
+
+    void check_remaining_(std::size_t size) const
+    {
+        if (size > bytes_.size() - position_) {
+            throw_truncated_();
+        }
+    }
+
+    [[noreturn]]
+    static void throw_truncated_()
+    {
+        throw std::runtime_error {"ERROR: the binary circuit ends unexpectedly.\n"};
+    }
+};
+
+/*
+    The parameters of a circuit, as read from the binary circuit; every parameter expression in the
+    gates of the circuit must refer to one of them.
+*/
+using ParameterDataMap_ = ket::param::ParameterDataMap;
+
+// NOLINTNEXTLINE(misc-no-recursion)
+auto read_expression_(ByteReader_& reader, const ParameterDataMap_& parameter_data, std::size_t depth) -> ket::param::ParameterExpression
+{
+    namespace kp = ket::param;
+
+    if (depth >= MAX_NESTING_DEPTH_) {
+        throw std::runtime_error {"ERROR: the parameter expressions in the binary circuit are nested too deeply.\n"};
+    }
+
+    const auto tag = reader.read_enum(ExpressionTag_::BINARY);
+
+    if (tag == ExpressionTag_::PARAMETER) {
+        const auto id = reader.read<kp::ParameterID>();
+        if (!parameter_data.contains(id)) {
+            throw std::runtime_error {"ERROR: a gate in the binary circuit uses a parameter that the circuit does not have.\n"};
+        }
+
+        return kp::Parameter {reader.read_string(), id};
+    }
+    else if (tag == ExpressionTag_::LITERAL) {
+        return kp::LiteralExpression {reader.read<double>()};
+    }
+    else {
+        const auto operation = reader.read_enum(kp::BinaryOperation::MUL);
+        auto left = read_expression_(reader, parameter_data, depth + 1);
+        auto right = read_expression_(reader, parameter_data, depth + 1);
+
+        return kp::BinaryExpression {
+            .operation=operation,
+            .left=ket::ClonePtr<kp::ParameterExpression> {std::move(left)},
+            .right=ket::ClonePtr<kp::ParameterExpression> {std::move(right)}
+        };
+    }
+}
+
+/*
+    Reads the Pauli string of a PAULI_ROT gate, and applies the same checks as
+    `QuantumCircuit::add_pauli_rotation_gate()`.
+*/
+auto read_pauli_string_(ByteReader_& reader, std::size_t circuit_n_qubits) -> ket::SparsePauliString
+{
+    // the size is checked before the Pauli string is built, because its masks are allocated for every qubit
+    const auto n_qubits = reader.read_size();
+    if (n_qubits != circuit_n_qubits) {
+        throw std::runtime_error {"ERROR: a Pauli string in the binary circuit does not act on the same number of qubits as the circuit.\n"};
+    }
+
+    const auto phase = reader.read_enum(ket::PauliPhase::MINUS_EYE);
+    if (phase != ket::PauliPhase::PLUS_ONE && phase != ket::PauliPhase::MINUS_ONE) {
+        throw std::runtime_error {"ERROR: a Pauli string in the binary circuit has a phase other than +1 or -1.\n"};
+    }
+
+    const auto n_terms = reader.read_count(sizeof(std::uint64_t) + sizeof(ket::PauliTerm));
+
+    auto terms = std::vector<std::pair<std::size_t, ket::PauliTerm>> {};
+    terms.reserve(n_terms);
+    for (std::size_t i {0}; i < n_terms; ++i) {
+        const auto index = reader.read_size();
+        terms.emplace_back(index, reader.read_enum(ket::PauliTerm::Z));
+    }
+
+    const auto is_identity = [](const auto& pair) { return pair.second == ket::PauliTerm::I; };
+    if (std::ranges::all_of(terms, is_identity)) {
+        throw std::runtime_error {"ERROR: a Pauli string in the binary circuit has no non-identity terms.\n"};
+    }
+
+    // the constructor throws for indices outside of the qubits, and for repeated indices
+    return ket::SparsePauliString {std::move(terms), n_qubits, phase};
+}
+
+/*
+    Reads a gate, and checks that the optional parts that follow it are the ones its kind of gate
+    needs, and that its qubit and bit indices are within `circuit`.
+*/
+auto read_gate_(ByteReader_& reader, const ket::QuantumCircuit& circuit, const ParameterDataMap_& parameter_data) -> ket::GateInfo
+{
+    namespace gid = ki::gate_id;
+    using G = ket::Gate;
+
+    const auto gate = reader.read_enum(G::M);
+    const auto flags = reader.read<std::uint8_t>();
+    const auto arg0 = reader.read_size();
+    const auto arg1 = reader.read_size();
+    const auto arg2 = reader.read<double>();
+
+    const auto has_unitary = (flags & HAS_UNITARY_) != 0;
+    const auto has_expression = (flags & HAS_PARAMETER_EXPRESSION_) != 0;
+    const auto has_pauli_string = (flags & HAS_PAULI_STRING_) != 0;
+
+    if ((flags & ~(HAS_UNITARY_ | HAS_PARAMETER_EXPRESSION_ | HAS_PAULI_STRING_)) != 0) {
+        throw std::runtime_error {"ERROR: a gate in the binary circuit has unknown flags.\n"};
+    }
+
+    if (has_unitary != (gate == G::U || gate == G::CU)) {
+        throw std::runtime_error {"ERROR: only the U and CU gates in the binary circuit can have (and must have) a unitary matrix.\n"};
+    }
+
+    if (has_pauli_string != (gate == G::PAULI_ROT)) {
+        throw std::runtime_error {"ERROR: only the PAULI_ROT gates in the binary circuit can have (and must have) a Pauli string.\n"};
+    }
+
+    if (has_expression && !(gid::is_angle_transform_gate(gate) || gate == G::PAULI_ROT)) {
+        throw std::runtime_error {"ERROR: a gate without an angle in the binary circuit has a parameter expression.\n"};
+    }
+
+    const auto check_qubit = [&](std::size_t qubit) {
+        if (qubit >= circuit.n_qubits()) {
+            throw std::runtime_error {"ERROR: a gate in the binary circuit acts on a qubit outside of the circuit.\n"};
+        }
+    };
+
+    if (gid::is_single_qubit_transform_gate(gate)) {
+        check_qubit(arg0);
+    }
+    else if (gid::is_double_qubit_transform_gate(gate)) {
+        check_qubit(arg0);
+        check_qubit(arg1);
+    }
+    else if (gate == G::M) {
+        check_qubit(arg0);
+        if (arg1 >= circuit.n_bits()) {
+            throw std::runtime_error {"ERROR: a measurement in the binary circuit writes to a bit outside of the circuit.\n"};
+        }
+    }
+
+    auto info = ket::GateInfo {
+        .gate=gate,
+        .arg0=arg0,
+        .arg1=arg1,
+        .arg2=arg2,
+        .unitary_ptr=ket::ClonePtr<ket::Matrix2X2> {nullptr},
+        .param_expression_ptr=ket::ClonePtr<ket::param::ParameterExpression> {nullptr},
+        .pauli_string_ptr=ket::ClonePtr<ket::SparsePauliString> {nullptr}
+    };
+
+    if (has_unitary) {
+        info.unitary_ptr = ket::ClonePtr<ket::Matrix2X2> {reader.read<ket::Matrix2X2>()};
+    }
+
+    if (has_expression) {
+        info.param_expression_ptr = ket::ClonePtr<ket::param::ParameterExpression> {read_expression_(reader, parameter_data, 0)};
+    }
+
+    if (has_pauli_string) {
+        info.pauli_string_ptr = ket::ClonePtr<ket::SparsePauliString> {read_pauli_string_(reader, circuit.n_qubits())};
+    }
+
+    return info;
+}
+
+auto read_predicate_(ByteReader_& reader) -> ket::ControlFlowPredicate
+{
+    const auto n_indices = reader.read_count(sizeof(std::uint64_t));
+    auto bit_indices = std::vector<std::size_t> {};
+    bit_indices.reserve(n_indices);
+    for (std::size_t i {0}; i < n_indices; ++i) {
+        bit_indices.push_back(reader.read_size());
+    }
+
+    const auto n_bits = reader.read_count(sizeof(std::int32_t));
+    auto expected_bits = std::vector<int> {};
+    expected_bits.reserve(n_bits);
+    for (std::size_t i {0}; i < n_bits; ++i) {
+        expected_bits.push_back(static_cast<int>(reader.read<std::int32_t>()));
+    }
+
+    const auto kind = reader.read_enum(ket::ControlFlowBooleanKind::IF_NOT);
+
+    // the constructor checks that the predicate is well-formed; the bit indices are checked against
+    // the circuit when the control flow statement is added to it
+    return ket::ControlFlowPredicate {std::move(bit_indices), std::move(expected_bits), kind};
+}
+
+auto read_parameters_(ByteReader_& reader) -> ParameterDataMap_
+{
+    // each parameter takes at least its id, the flag and value, its count, and the size of its name
+    constexpr auto min_parameter_size = sizeof(ket::param::ParameterID) + 1 + 3 * sizeof(std::uint64_t);
+
+    auto parameter_data = ParameterDataMap_ {};
+    const auto n_parameters = reader.read_count(min_parameter_size);
+    for (std::size_t i {0}; i < n_parameters; ++i) {
+        const auto id = reader.read<ket::param::ParameterID>();
+        const auto has_value = reader.read<std::uint8_t>() != 0;
+        const auto value = reader.read<double>();
+        const auto count = reader.read_size();
+        auto name = reader.read_string();
+
+        parameter_data.emplace(id, ket::param::ParameterData {
+            .value=has_value ? std::optional<double> {value} : std::nullopt,
+            .name=std::move(name),
+            .count=count
+        });
+    }
+
+    return parameter_data;
+}
+
+auto read_circuit_(std::span<const std::byte> bytes, std::size_t& position, std::size_t depth) -> ket::QuantumCircuit;
+
+/*
+    Reads the subcircuit of a control flow statement in `circuit`; the simulator assumes that every
+    subcircuit has the same qubits and bits as the circuit that holds it.
+*/
+// NOLINTNEXTLINE(misc-no-recursion)
+auto read_subcircuit_(
+    std::span<const std::byte> bytes,
+    std::size_t& position,
+    const ket::QuantumCircuit& circuit,
+    std::size_t depth
+) -> ket::QuantumCircuit
+{
+    if (depth + 1 >= MAX_NESTING_DEPTH_) {
+        throw std::runtime_error {"ERROR: the control flow statements in the binary circuit are nested too deeply.\n"};
+    }
+
+    auto subcircuit = read_circuit_(bytes, position, depth + 1);
+    if (subcircuit.n_qubits() != circuit.n_qubits() || subcircuit.n_bits() != circuit.n_bits()) {
+        throw std::runtime_error {"ERROR: a subcircuit in the binary circuit does not have the same number of qubits and bits as its circuit.\n"};
+    }
+
+    return subcircuit;
+}
+
+/*
+    Reads the next circuit element and adds it to `circuit`; the control flow statements are added
+    through the member functions of `QuantumCircuit`, so they go through the same checks as the
+    control flow statements of any other circuit.
+*/
+// NOLINTNEXTLINE(misc-no-recursion)
+void read_element_(
+    std::span<const std::byte> bytes,
+    std::size_t& position,
+    ket::QuantumCircuit& circuit,
+    const ParameterDataMap_& parameter_data,
+    std::size_t depth
+)
+{
+    auto reader = ByteReader_ {bytes, position};
+
+    switch (reader.read_enum(ElementTag_::STATEVECTOR_LOGGER))
+    {
+        case ElementTag_::GATE : {
+            ket::CircuitAccess_::elements(circuit).emplace_back(read_gate_(reader, circuit, parameter_data));
+            break;
+        }
+        case ElementTag_::IF_STATEMENT : {
+            auto predicate = read_predicate_(reader);
+            circuit.add_if_statement(std::move(predicate), read_subcircuit_(bytes, position, circuit, depth));
+            break;
+        }
+        case ElementTag_::IF_ELSE_STATEMENT : {
+            auto predicate = read_predicate_(reader);
+            auto if_circuit = read_subcircuit_(bytes, position, circuit, depth);
+            auto else_circuit = read_subcircuit_(bytes, position, circuit, depth);
+            circuit.add_if_else_statement(std::move(predicate), std::move(if_circuit), std::move(else_circuit));
+            break;
+        }
+        case ElementTag_::REPEAT_STATEMENT : {
+            const auto n_repetitions = reader.read_size();
+            circuit.add_repeat_statement(n_repetitions, read_subcircuit_(bytes, position, circuit, depth));
+            break;
+        }
+        case ElementTag_::CONTROLLED_BLOCK : {
+            const auto n_controls = reader.read_count(sizeof(std::uint64_t));
+            auto control_qubits = ket::QubitIndicesVector {};
+            control_qubits.reserve(n_controls);
+            for (std::size_t i {0}; i < n_controls; ++i) {
+                control_qubits.push_back(reader.read_size());
+            }
+            circuit.add_controlled_block(control_qubits, read_subcircuit_(bytes, position, circuit, depth));
+            break;
+        }
+        case ElementTag_::CLASSICAL_REGISTER_LOGGER : {
+            circuit.add_classical_register_circuit_logger();
+            break;
+        }
+        case ElementTag_::STATEVECTOR_LOGGER : {
+            circuit.add_statevector_circuit_logger();
+            break;
+        }
+        default : {
+            throw std::runtime_error {"DEV ERROR: unknown element tag found in `read_element_()`\n"};
+        }
+    }
+}
+
+/*
+    Reads a circuit that is nested inside `depth` control flow statements.
+*/
+// NOLINTNEXTLINE(misc-no-recursion)
+auto read_circuit_(std::span<const std::byte> bytes, std::size_t& position, std::size_t depth) -> ket::QuantumCircuit
+{
+    auto reader = ByteReader_ {bytes, position};
+
+    const auto n_qubits = reader.read_size();
+    const auto n_bits = reader.read_size();
+    if (n_qubits > MAX_CIRCUIT_SIZE_ || n_bits > MAX_CIRCUIT_SIZE_) {
+        throw std::runtime_error {"ERROR: the binary circuit has an unreasonable number of qubits or bits.\n"};
+    }
+
+    auto circuit = ket::QuantumCircuit {n_qubits, n_bits};
+
+    auto parameter_data = read_parameters_(reader);
+    const auto parameter_count = reader.read_size();
+
+    const auto n_elements = reader.read_count(1);
+    circuit.reserve_circuit_elements(n_elements);
+    for (std::size_t i {0}; i < n_elements; ++i) {
+        read_element_(bytes, position, circuit, parameter_data, depth);
+    }
+
+    // adding the control flow statements merged the parameters of their subcircuits into the circuit;
+    // the saved parameters must already include all of them, and they replace the merged ones
+    for (const auto& [id, data] : circuit.parameter_data_map()) {
+        if (!parameter_data.contains(id)) {
+            throw std::runtime_error {"ERROR: a subcircuit in the binary circuit uses a parameter that the circuit does not have.\n"};
+        }
+    }
+
+    ket::CircuitAccess_::parameter_data(circuit) = std::move(parameter_data);
+    ket::CircuitAccess_::parameter_count(circuit) = parameter_count;
+
+    return circuit;
+}
+
+/*
+    Checks that every record refers to qubits, bits, and pool entries that exist, and that each gate
+    only has the kind of payload it needs; the simulator trusts the records without any further checks.
+*/
+void check_compact_gates_(const ket::CompactCircuit& circuit)
+{
+    namespace gid = ki::gate_id;
+    using G = ket::Gate;
+
+    const auto check = [](bool condition) {
+        if (!condition) {
+            throw std::runtime_error {"ERROR: a gate in the binary compact circuit is invalid.\n"};
+        }
+    };
+
+    for (const auto& gate : circuit) {
+        check(static_cast<std::underlying_type_t<G>>(gate.gate) <= static_cast<std::underlying_type_t<G>>(G::M));
+
+        const auto has_angle = gid::is_angle_transform_gate(gate.gate) || gate.gate == G::PAULI_ROT;
+        check(!gate.is_parameterized || has_angle);
+
+        if (gate.is_parameterized) {
+            check(gate.payload < circuit.parameter_expressions().size());
+        }
+        else if (has_angle) {
+            check(gate.payload < circuit.angles().size());
+        }
+        else if (gate.gate == G::U || gate.gate == G::CU) {
+            check(gate.payload < circuit.unitaries().size());
+        }
+
+        if (gate.gate == G::PAULI_ROT) {
+            check(gate.arg0 < circuit.pauli_strings().size());
+        }
+        else if (gate.gate == G::M) {
+            check(gate.arg0 < circuit.n_qubits() && gate.arg1 < circuit.n_bits());
+        }
+        else if (gid::is_single_qubit_transform_gate(gate.gate)) {
+            check(gate.arg0 < circuit.n_qubits());
+        }
+        else {
+            check(gate.arg0 < circuit.n_qubits() && gate.arg1 < circuit.n_qubits());
+        }
+    }
+}
+
+auto read_compact_circuit_(std::span<const std::byte> bytes, std::size_t& position) -> ket::CompactCircuit
+{
+    using Access = ket::CircuitAccess_;
+
+    auto reader = ByteReader_ {bytes, position};
+
+    const auto n_qubits = reader.read_size();
+    const auto n_bits = reader.read_size();
+    if (n_qubits > MAX_CIRCUIT_SIZE_ || n_bits > MAX_CIRCUIT_SIZE_) {
+        throw std::runtime_error {"ERROR: the binary circuit has an unreasonable number of qubits or bits.\n"};
+    }
+
+    auto circuit = ket::CompactCircuit {n_qubits, n_bits};
+    Access::parameter_data(circuit) = read_parameters_(reader);
+    Access::parameter_count(circuit) = reader.read_size();
+
+    Access::gates(circuit) = reader.read_array<ket::CompactGate>();
+    Access::angles(circuit) = reader.read_array<double>();
+    Access::unitaries(circuit) = reader.read_array<ket::Matrix2X2>();
+    Access::index_unitaries(circuit);
+
+    // each expression and Pauli string takes at least its tag, or its number of qubits
+    auto& expressions = Access::parameter_expressions(circuit);
+    const auto n_expressions = reader.read_count(sizeof(ExpressionTag_));
+    expressions.reserve(n_expressions);
+    for (std::size_t i {0}; i < n_expressions; ++i) {
+        expressions.push_back(read_expression_(reader, circuit.parameter_data_map(), 0));
+    }
+
+    auto& pauli_strings = Access::pauli_strings(circuit);
+    const auto n_pauli_strings = reader.read_count(sizeof(std::uint64_t));
+    pauli_strings.reserve(n_pauli_strings);
+    for (std::size_t i {0}; i < n_pauli_strings; ++i) {
+        pauli_strings.push_back(read_pauli_string_(reader, n_qubits));
+    }
+
+    check_compact_gates_(circuit);
+
+    return circuit;
+}
+
+/*
+    The payload of a binary circuit file, written by `write(buffer)`, and the header that describes it.
+*/
+template <typename Write>
+auto make_payload_(const std::array<char, 8>& magic, Write&& write) -> std::pair<BinaryCircuitHeader_, std::vector<std::byte>>
+{
+    auto payload = std::vector<std::byte> {};
+    write(payload);
+
+    const auto header = BinaryCircuitHeader_ {
+        .magic=magic,
+        .version=BINARY_CIRCUIT_VERSION_,
+        .byte_order_mark=BYTE_ORDER_MARK_,
+        .payload_size=payload.size(),
+        .checksum=ki::checksum_(payload)
+    };
+
+    return {header, std::move(payload)};
+}
+
+void check_header_(const BinaryCircuitHeader_& header, const std::array<char, 8>& magic)
+{
+    if (header.magic != magic) {
+        throw std::runtime_error {"ERROR: the file is not a binary circuit file of the expected kind.\n"};
+    }
+
+    if (header.byte_order_mark != BYTE_ORDER_MARK_) {
+        throw std::runtime_error {"ERROR: the binary circuit file was written with a different byte order.\n"};
+    }
+
+    if (header.version != BINARY_CIRCUIT_VERSION_) {
+        throw std::runtime_error {"ERROR: unsupported version of the binary circuit file.\n"};
+    }
+}
+
+/*
+    Checks the payload against its header, and reads the circuit out of it with `read(payload, position)`.
+*/
+template <typename Read>
+auto circuit_from_payload_(const BinaryCircuitHeader_& header, std::span<const std::byte> payload, Read&& read)
+{
+    if (ki::checksum_(payload) != header.checksum) {
+        throw std::runtime_error {"ERROR: the checksum of the binary circuit file does not match its contents.\n"};
+    }
+
+    auto position = std::size_t {0};
+    auto circuit = read(payload, position);
+
+    if (position != payload.size()) {
+        throw std::runtime_error {"ERROR: the binary circuit file has unexpected bytes after the circuit.\n"};
+    }
+
+    return circuit;
+}
+
+template <typename Write>
+void save_binary_(std::ostream& outstream, const std::array<char, 8>& magic, Write&& write)
+{
+    const auto [header, payload] = make_payload_(magic, std::forward<Write>(write));
+    const auto header_bytes = std::as_bytes(std::span {&header, 1});
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    outstream.write(reinterpret_cast<const char*>(header_bytes.data()), static_cast<std::streamsize>(header_bytes.size()));
+    outstream.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+template <typename Write>
+void save_binary_(const std::filesystem::path& filepath, const std::array<char, 8>& magic, Write&& write)
+{
+    const auto [header, payload] = make_payload_(magic, std::forward<Write>(write));
+    const auto parts = std::array {std::as_bytes(std::span {&header, 1}), std::span<const std::byte> {payload}};
+    ki::write_binary_file_(filepath, parts);
+}
+
+template <typename Read>
+auto load_binary_(std::istream& instream, const std::array<char, 8>& magic, Read&& read)
+{
+    auto header = BinaryCircuitHeader_ {};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!instream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error {"ERROR: the binary circuit is too short to hold its header.\n"};
+    }
+
+    check_header_(header, magic);
+
+    auto payload = std::vector<std::byte> {};
+    if (!ki::read_stream_bytes_(instream, header.payload_size, payload)) {
+        throw std::runtime_error {"ERROR: the binary circuit is too short to hold the entire circuit.\n"};
+    }
+
+    return circuit_from_payload_(header, payload, std::forward<Read>(read));
+}
+
+template <typename Read>
+auto load_binary_(const std::filesystem::path& filepath, const std::array<char, 8>& magic, Read&& read)
+{
+    const auto file = ki::MappedFile {filepath};
+    const auto bytes = file.bytes();
+
+    if (bytes.size() < sizeof(BinaryCircuitHeader_)) {
+        throw std::runtime_error {"ERROR: the binary circuit is too short to hold its header.\n"};
+    }
+
+    auto header = BinaryCircuitHeader_ {};
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    check_header_(header, magic);
+
+    const auto payload = bytes.subspan(sizeof(header));
+    if (payload.size() != header.payload_size) {
+        throw std::runtime_error {"ERROR: the size of the binary circuit file does not match its header.\n"};
+    }
+
+    return circuit_from_payload_(header, payload, std::forward<Read>(read));
+}
+
+auto read_top_level_circuit_(std::span<const std::byte> bytes, std::size_t& position) -> ket::QuantumCircuit
+{
+    return read_circuit_(bytes, position, 0);
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+void save_circuit_binary(std::ostream& outstream, const QuantumCircuit& circuit)
+{
+    save_binary_(outstream, BINARY_CIRCUIT_MAGIC_, [&](auto& buffer) { write_circuit_(buffer, circuit); });
+}
+
+void save_circuit_binary(const std::filesystem::path& filepath, const QuantumCircuit& circuit)
+{
+    save_binary_(filepath, BINARY_CIRCUIT_MAGIC_, [&](auto& buffer) { write_circuit_(buffer, circuit); });
+}
+
+auto load_circuit_binary(std::istream& instream) -> QuantumCircuit
+{
+    return load_binary_(instream, BINARY_CIRCUIT_MAGIC_, read_top_level_circuit_);
+}
+
+auto load_circuit_binary(const std::filesystem::path& filepath) -> QuantumCircuit
+{
+    return load_binary_(filepath, BINARY_CIRCUIT_MAGIC_, read_top_level_circuit_);
+}
+
+void save_compact_circuit_binary(std::ostream& outstream, const CompactCircuit& circuit)
+{
+    save_binary_(outstream, BINARY_COMPACT_CIRCUIT_MAGIC_, [&](auto& buffer) { write_compact_circuit_(buffer, circuit); });
+}
+
+void save_compact_circuit_binary(const std::filesystem::path& filepath, const CompactCircuit& circuit)
+{
+    save_binary_(filepath, BINARY_COMPACT_CIRCUIT_MAGIC_, [&](auto& buffer) { write_compact_circuit_(buffer, circuit); });
+}
+
+auto load_compact_circuit_binary(std::istream& instream) -> CompactCircuit
+{
+    return load_binary_(instream, BINARY_COMPACT_CIRCUIT_MAGIC_, read_compact_circuit_);
+}
+
+auto load_compact_circuit_binary(const std::filesystem::path& filepath) -> CompactCircuit
+{
+    return load_binary_(filepath, BINARY_COMPACT_CIRCUIT_MAGIC_, read_compact_circuit_);
+}
+
+}  // namespace ket
@@ -0,0 +1,212 @@
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "kettle/io/binary_statevector.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/io/io_binary.hpp"
+
+namespace ki = ket::internal;
+
+
+namespace
+{
+
+constexpr auto BINARY_STATEVECTOR_MAGIC_ = std::array<char, 8> {'K', 'E', 'T', 'S', 'T', 'A', 'T', 'E'};
+constexpr auto BINARY_STATEVECTOR_VERSION_ = std::uint32_t {1};
+constexpr auto BYTE_ORDER_MARK_ = std::uint32_t {0x01020304};
+
+// the largest number of qubits whose payload size in bytes still fits in a `std::size_t`, with double precision
+constexpr auto MAX_N_QUBITS_ = std::uint32_t {59};
+
+struct BinaryStatevectorHeader_
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t byte_order_mark;
+    std::uint32_t n_qubits;
+    std::uint32_t bytes_per_real;
+    std::uint64_t checksum;
+};
+
+static_assert(sizeof(BinaryStatevectorHeader_) == 32);
+
+auto bytes_per_real_(ket::StatevectorPrecision precision) -> std::uint32_t
+{
+    using SP = ket::StatevectorPrecision;
+
+    if (precision == SP::DOUBLE) {
+        return sizeof(double);
+    }
+    else if (precision == SP::SINGLE) {
+        return sizeof(float);
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: invalid precision found in `bytes_per_real_()`\n"};
+    }
+}
+
+/*
+    The amplitudes of `state` with single precision; this is the only case where the amplitudes are
+    copied before being written out.
+*/
+auto single_precision_amplitudes_(const ket::QuantumState& state) -> std::vector<std::complex<float>>
+{
+    auto output = std::vector<std::complex<float>> {};
+    output.reserve(state.n_states());
+
+    for (std::size_t i {0}; i < state.n_states(); ++i) {
+        output.emplace_back(static_cast<float>(state[i].real()), static_cast<float>(state[i].imag()));
+    }
+
+    return output;
+}
+
+/*
+    Calls `func(header, payload)`, where `payload` holds the bytes of the amplitudes of `state` in
+    the requested precision, and `header` describes them.
+*/
+template <typename Function>
+void with_binary_statevector_(const ket::QuantumState& state, ket::StatevectorPrecision precision, Function&& func)
+{
+    const auto make_header = [&](std::span<const std::byte> payload) {
+        return BinaryStatevectorHeader_ {
+            .magic=BINARY_STATEVECTOR_MAGIC_,
+            .version=BINARY_STATEVECTOR_VERSION_,
+            .byte_order_mark=BYTE_ORDER_MARK_,
+            .n_qubits=static_cast<std::uint32_t>(state.n_qubits()),
+            .bytes_per_real=bytes_per_real_(precision),
+            .checksum=ki::checksum_(payload)
+        };
+    };
+
+    if (precision == ket::StatevectorPrecision::SINGLE) {
+        const auto amplitudes = single_precision_amplitudes_(state);
+        const auto payload = std::as_bytes(std::span {amplitudes});
+        func(make_header(payload), payload);
+    }
+    else {
+        const auto payload = std::as_bytes(std::span {&state[0], state.n_states()});
+        func(make_header(payload), payload);
+    }
+}
+
+/*
+    Checks the header of a binary statevector file, and returns the number of bytes in its amplitudes.
+*/
+auto checked_payload_size_(const BinaryStatevectorHeader_& header) -> std::size_t
+{
+    if (header.magic != BINARY_STATEVECTOR_MAGIC_) {
+        throw std::runtime_error {"ERROR: the file is not a binary statevector file.\n"};
+    }
+
+    if (header.byte_order_mark != BYTE_ORDER_MARK_) {
+        throw std::runtime_error {"ERROR: the binary statevector file was written with a different byte order.\n"};
+    }
+
+    if (header.version != BINARY_STATEVECTOR_VERSION_) {
+        throw std::runtime_error {"ERROR: unsupported version of the binary statevector file.\n"};
+    }
+
+    if (header.bytes_per_real != sizeof(double) && header.bytes_per_real != sizeof(float)) {
+        throw std::runtime_error {"ERROR: invalid precision found in the binary statevector file.\n"};
+    }
+
+    if (header.n_qubits == 0 || header.n_qubits > MAX_N_QUBITS_) {
+        throw std::runtime_error {"ERROR: invalid number of qubits found in the binary statevector file.\n"};
+    }
+
+    return (std::size_t {1} << header.n_qubits) * 2 * header.bytes_per_real;
+}
+
+void check_checksum_(const BinaryStatevectorHeader_& header, std::span<const std::byte> payload)
+{
+    if (ki::checksum_(payload) != header.checksum) {
+        throw std::runtime_error {"ERROR: the checksum of the binary statevector file does not match its amplitudes.\n"};
+    }
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+void save_statevector_binary(
+    std::ostream& outstream,
+    const QuantumState& state,
+    StatevectorPrecision precision
+)
+{
+    with_binary_statevector_(state, precision, [&](const BinaryStatevectorHeader_& header, std::span<const std::byte> payload) {
+        const auto header_bytes = std::as_bytes(std::span {&header, 1});
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+        outstream.write(reinterpret_cast<const char*>(header_bytes.data()), static_cast<std::streamsize>(header_bytes.size()));
+        outstream.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    });
+}
+
+void save_statevector_binary(
+    const std::filesystem::path& filepath,
+    const QuantumState& state,
+    StatevectorPrecision precision
+)
+{
+    with_binary_statevector_(state, precision, [&](const BinaryStatevectorHeader_& header, std::span<const std::byte> payload) {
+        const auto parts = std::array {std::as_bytes(std::span {&header, 1}), payload};
+        ki::write_binary_file_(filepath, parts);
+    });
+}
+
+auto load_statevector_binary(std::istream& instream) -> QuantumState
+{
+    auto header = BinaryStatevectorHeader_ {};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!instream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error {"ERROR: the binary statevector is too short to hold its header.\n"};
+    }
+
+    auto payload = std::vector<std::byte> {};
+    if (!ki::read_stream_bytes_(instream, checked_payload_size_(header), payload)) {
+        throw std::runtime_error {"ERROR: the binary statevector is too short to hold all its amplitudes.\n"};
+    }
+
+    check_checksum_(header, payload);
+
+    return QuantumState {ki::amplitudes_from_bytes_(payload, header.bytes_per_real)};
+}
+
+auto load_statevector_binary(const std::filesystem::path& filepath) -> QuantumState
+{
+    const auto file = ki::MappedFile {filepath};
+    const auto bytes = file.bytes();
+
+    if (bytes.size() < sizeof(BinaryStatevectorHeader_)) {
+        throw std::runtime_error {"ERROR: the binary statevector is too short to hold its header.\n"};
+    }
+
+    auto header = BinaryStatevectorHeader_ {};
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    const auto payload = bytes.subspan(sizeof(header));
+    if (payload.size() != checked_payload_size_(header)) {
+        throw std::runtime_error {"ERROR: the size of the binary statevector file does not match its header.\n"};
+    }
+
+    check_checksum_(header, payload);
+
+    return QuantumState {ki::amplitudes_from_bytes_(payload, header.bytes_per_real)};
+}
+
+}  // namespace ket
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cerrno>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <ios>
+#include <istream>
+#include <iterator>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "kettle_internal/io/io_binary.hpp"
+
+
+namespace
+{
+
+[[noreturn]]
+void throw_file_error_(const char* message, const std::filesystem::path& filepath)
+{
+    auto err_msg = std::stringstream {};
+    err_msg << "ERROR: " << message << ": \n";
+    err_msg << "'" << filepath << "'\n";
+    err_msg << std::strerror(errno) << '\n';  // NOLINT(concurrency-mt-unsafe)
+
+    throw std::ios::failure {err_msg.str()};
+}
+
+constexpr auto FNV_OFFSET_BASIS_ = std::uint64_t {0xcbf29ce484222325};
+constexpr auto FNV_PRIME_ = std::uint64_t {0x100000001b3};
+
+}  // namespace
+
+
+namespace ket::internal
+{
+
+FileDescriptor::~FileDescriptor()
+{
+    if (descriptor_ >= 0) {
+        ::close(descriptor_);
+    }
+}
+
+auto open_file_(const std::filesystem::path& filepath, int flags) -> FileDescriptor
+{
+    auto file = FileDescriptor {::open(filepath.c_str(), flags, 0644)};  // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (file.get() < 0) {
+        throw_file_error_("unable to open file", filepath);
+    }
+
+    return file;
+}
+
+MappedFile::MappedFile(const std::filesystem::path& filepath)
+{
+    const auto file = open_file_(filepath, O_RDONLY);
+
+    struct stat file_status {};
+    if (::fstat(file.get(), &file_status) != 0) {
+        throw_file_error_("unable to find the size of the file", filepath);
+    }
+
+    // `mmap()` rejects empty mappings, so an empty file is left unmapped
+    size_ = static_cast<std::size_t>(file_status.st_size);
+    if (size_ == 0) {
+        return;
+    }
+
+    data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file.get(), 0);
+    if (data_ == MAP_FAILED) {  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast, performance-no-int-to-ptr)
+        data_ = nullptr;
+        size_ = 0;
+        throw_file_error_("unable to memory map the file", filepath);
+    }
+
+    // the files are read from front to back
+    ::madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_ {std::exchange(other.data_, nullptr)}
+    , size_ {std::exchange(other.size_, 0)}
+{}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile&
+{
+    if (this != &other) {
+        unmap_();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap_();
+}
+
+void MappedFile::unmap_() noexcept
+{
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+void write_binary_file_(const std::filesystem::path& filepath, std::span<const std::span<const std::byte>> parts)
+{
+    const auto file = open_file_(filepath, O_WRONLY | O_CREAT | O_TRUNC);  // NOLINT(hicpp-signed-bitwise)
+
+    auto buffers = std::vector<::iovec> {};
+    buffers.reserve(parts.size());
+    for (const auto& part : parts) {
+        if (!part.empty()) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+            buffers.push_back(::iovec {.iov_base=const_cast<std::byte*>(part.data()), .iov_len=part.size()});
+        }
+    }
+
+    // a single `writev()` normally writes everything; the loop only handles the rare partial writes
+    auto remaining = std::span<::iovec> {buffers};
+    while (!remaining.empty()) {
+        const auto n_written = ::writev(file.get(), remaining.data(), static_cast<int>(remaining.size()));
+        if (n_written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_file_error_("unable to write to file", filepath);
+        }
+
+        auto n_left = static_cast<std::size_t>(n_written);
+        while (!remaining.empty() && n_left >= remaining.front().iov_len) {
+            n_left -= remaining.front().iov_len;
+            remaining = remaining.subspan(1);
+        }
+
+        if (!remaining.empty()) {
+            auto& front = remaining.front();
+            front.iov_base = static_cast<std::byte*>(front.iov_base) + n_left;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            front.iov_len -= n_left;
+        }
+    }
+}
+
+void read_exactly_at_(int descriptor, std::span<std::byte> bytes, std::size_t offset)
+{
+    while (!bytes.empty()) {
+        const auto n_read = ::pread(descriptor, bytes.data(), bytes.size(), static_cast<::off_t>(offset));
+        if (n_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n_read <= 0) {
+            throw std::ios::failure {"ERROR: unable to read the expected number of bytes from the file.\n"};
+        }
+
+        bytes = bytes.subspan(static_cast<std::size_t>(n_read));
+        offset += static_cast<std::size_t>(n_read);
+    }
+}
+
+void write_exactly_at_(int descriptor, std::span<const std::byte> bytes, std::size_t offset)
+{
+    while (!bytes.empty()) {
+        const auto n_written = ::pwrite(descriptor, bytes.data(), bytes.size(), static_cast<::off_t>(offset));
+        if (n_written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n_written <= 0) {
+            throw std::ios::failure {"ERROR: unable to write the expected number of bytes to the file.\n"};
+        }
+
+        bytes = bytes.subspan(static_cast<std::size_t>(n_written));
+        offset += static_cast<std::size_t>(n_written);
+    }
+}
+
+auto read_stream_bytes_(std::istream& instream, std::uint64_t n_bytes, std::vector<std::byte>& bytes) -> bool
+{
+    constexpr auto chunk_size = std::uint64_t {1} << 20;
+
+    bytes.clear();
+    while (bytes.size() < n_bytes) {
+        const auto i_begin = bytes.size();
+        const auto n_chunk_bytes = std::min(chunk_size, n_bytes - i_begin);
+        bytes.resize(i_begin + static_cast<std::size_t>(n_chunk_bytes));
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (!instream.read(reinterpret_cast<char*>(bytes.data() + i_begin), static_cast<std::streamsize>(n_chunk_bytes))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto checksum_(std::span<const std::byte> bytes) noexcept -> std::uint64_t
+{
+    auto hash = FNV_OFFSET_BASIS_;
+
+    const auto n_words = bytes.size() / sizeof(std::uint64_t);
+    for (std::size_t i {0}; i < n_words; ++i) {
+        auto word = std::uint64_t {};
+        std::memcpy(&word, bytes.data() + i * sizeof(std::uint64_t), sizeof(std::uint64_t));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+        hash = (hash ^ word) * FNV_PRIME_;
+    }
+
+    for (auto i {n_words * sizeof(std::uint64_t)}; i < bytes.size(); ++i) {
+        hash = (hash ^ static_cast<std::uint64_t>(bytes[i])) * FNV_PRIME_;
+    }
+
+    return hash;
+}
+
+auto amplitudes_from_bytes_(std::span<const std::byte> bytes, std::size_t bytes_per_real) -> std::vector<std::complex<double>>
+{
+    if (bytes_per_real == sizeof(double)) {
+        auto output = std::vector<std::complex<double>>(bytes.size() / sizeof(std::complex<double>));
+        std::memcpy(output.data(), bytes.data(), output.size() * sizeof(std::complex<double>));
+
+        return output;
+    }
+    else if (bytes_per_real == sizeof(float)) {
+        auto single = std::vector<std::complex<float>>(bytes.size() / sizeof(std::complex<float>));
+        std::memcpy(single.data(), bytes.data(), single.size() * sizeof(std::complex<float>));
+
+        auto output = std::vector<std::complex<double>> {};
+        output.reserve(single.size());
+        std::ranges::transform(single, std::back_inserter(output), [](const auto& amplitude) { return std::complex<double> {amplitude}; });
+
+        return output;
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: invalid number of bytes per real number in `amplitudes_from_bytes_()`\n"};
+    }
+}
+
+}  // namespace ket::internal
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+    This header file contains code for reading and writing binary files; the files are read
+    through memory maps, and written with a single system call.
+*/
+
+namespace ket::internal
+{
+
+/*
+    Owns a POSIX file descriptor, and closes it when the instance is destroyed; a negative
+    descriptor means that no file is open.
+*/
+class FileDescriptor
+{
+public:
+    explicit FileDescriptor(int descriptor)
+        : descriptor_ {descriptor}
+    {}
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    auto operator=(const FileDescriptor&) -> FileDescriptor& = delete;
+
+    FileDescriptor(FileDescriptor&& other) noexcept
+        : descriptor_ {std::exchange(other.descriptor_, -1)}
+    {}
+
+    auto operator=(FileDescriptor&& other) noexcept -> FileDescriptor&
+    {
+        std::swap(descriptor_, other.descriptor_);
+        return *this;
+    }
+
+    ~FileDescriptor();
+
+    [[nodiscard]]
+    auto get() const noexcept -> int
+    {
+        return descriptor_;
+    }
+
+    /*
+        Gives up ownership of the descriptor, which the caller must then close.
+    */
+    auto release() noexcept -> int
+    {
+        return std::exchange(descriptor_, -1);
+    }
+
+private:
+    int descriptor_;
+};
+
+/*
+    Opens the file at `filepath` with the `open()` flags in `flags`, or throws; files that are
+    created are given the permissions 0644.
+*/
+auto open_file_(const std::filesystem::path& filepath, int flags) -> FileDescriptor;
+
+/*
+    A read-only memory map of an entire file; the file is unmapped when the instance is destroyed.
+*/
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path& filepath);
+
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+    ~MappedFile();
+
+    [[nodiscard]]
+    auto bytes() const noexcept -> std::span<const std::byte>
+    {
+        return {static_cast<const std::byte*>(data_), size_};
+    }
+
+private:
+    void* data_ {nullptr};
+    std::size_t size_ {0};
+
+    void unmap_() noexcept;
+};
+
+/*
+    Writes the concatenation of `parts` to the file at `filepath`, replacing its contents; all the
+    parts are handed to the operating system at once, through `writev()`.
+*/
+void write_binary_file_(const std::filesystem::path& filepath, std::span<const std::span<const std::byte>> parts);
+
+/*
+    Reads exactly `bytes.size()` bytes starting at `offset` in the open file `descriptor`, or throws.
+*/
+void read_exactly_at_(int descriptor, std::span<std::byte> bytes, std::size_t offset);
+
+/*
+    Writes all of `bytes` starting at `offset` in the open file `descriptor`, or throws.
+*/
+void write_exactly_at_(int descriptor, std::span<const std::byte> bytes, std::size_t offset);
+
+/*
+    Reads exactly `n_bytes` bytes from `instream` into `bytes`, and returns whether the stream held
+    that many; the bytes are read in chunks, so a corrupted size in the header of a file cannot make
+    this allocate much more memory than the stream actually holds.
+*/
+auto read_stream_bytes_(std::istream& instream, std::uint64_t n_bytes, std::vector<std::byte>& bytes) -> bool;
+
+/*
+    Views the bytes of a file, such as the contents of a memory map, as text.
+*/
+inline auto text_from_bytes_(std::span<const std::byte> bytes) noexcept -> std::string_view
+{
+    return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+/*
+    A 64-bit FNV-1a hash of `bytes`, taken 8 bytes at a time; this is used to detect corrupted
+    files, and not for any cryptographic purpose.
+*/
+auto checksum_(std::span<const std::byte> bytes) noexcept -> std::uint64_t;
+
+/*
+    Converts the bytes of complex amplitudes, written with `bytes_per_real` bytes (8 or 4) per real
+    number, into double precision amplitudes.
+*/
+auto amplitudes_from_bytes_(std::span<const std::byte> bytes, std::size_t bytes_per_real) -> std::vector<std::complex<double>>;
+
+}  // namespace ket::internal
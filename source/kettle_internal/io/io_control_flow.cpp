@@ -1,5 +1,7 @@
 #include <cstddef>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -66,6 +68,16 @@ auto format_classical_if_else_statement_header_(
     return {if_part, else_part};
 }
 
+auto format_repeat_statement_header_(std::size_t n_repetitions) -> std::string
+{
+    return std::string {"REPEAT "} + std::to_string(n_repetitions);
+}
+
+auto format_controlled_block_header_(const std::vector<std::size_t>& control_qubits) -> std::string
+{
+    return std::string {"CONTROLLED "} + format_csv_integers_(control_qubits);
+}
+
 }  // namespace ket::internal::format
 
 
@@ -138,4 +150,27 @@ auto parse_control_flow_predicate_(std::stringstream& stream) -> ket::ControlFlo
     return ket::ControlFlowPredicate {std::move(bit_indices_to_check), std::move(expected_bits), control_kind};
 }
 
+auto parse_repeat_count_(std::stringstream& stream) -> std::size_t
+{
+    std::size_t n_repetitions;  // NOLINT(cppcoreguidelines-init-variables)
+    stream >> n_repetitions;
+
+    if (stream.fail()) {
+        throw std::runtime_error {"ERROR: invalid number of repetitions found in a 'REPEAT' statement\n"};
+    }
+
+    return n_repetitions;
+}
+
+auto parse_controlled_block_qubits_(std::stringstream& stream) -> std::vector<std::size_t>
+{
+    discard_until_char_(stream, '[');
+
+    if (stream.peek() != '[') {
+        throw std::runtime_error {"ERROR: no control qubits found in a 'CONTROLLED' statement\n"};
+    }
+
+    return parse_csv_in_brackets_<std::size_t>(stream);
+}
+
 }  // namespace ket::internal::parse
@@ -3,6 +3,7 @@
 #include <concepts>
 #include <cstddef>
 #include <sstream>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -33,6 +34,10 @@ auto format_classical_if_statement_header_(const ket::ControlFlowPredicate& pred
 
 auto format_classical_if_else_statement_header_(const ket::ControlFlowPredicate& predicate) -> std::tuple<std::string, std::string>;
 
+auto format_repeat_statement_header_(std::size_t n_repetitions) -> std::string;
+
+auto format_controlled_block_header_(const std::vector<std::size_t>& control_qubits) -> std::string;
+
 }  // namespace ket::internal::format
 
 
@@ -71,4 +76,18 @@ auto parse_comparison_sign_(std::stringstream& stream) -> ket::ControlFlowBoolea
 */
 auto parse_control_flow_predicate_(std::stringstream& stream) -> ket::ControlFlowPredicate;
 
+/*
+    Parse the number of repetitions that follows the 'REPEAT' keyword.
+
+    For example, "REPEAT 8" (with 'REPEAT' already removed) parses into 8.
+*/
+auto parse_repeat_count_(std::stringstream& stream) -> std::size_t;
+
+/*
+    Parse the control qubits that follow the 'CONTROLLED' keyword.
+
+    For example, "CONTROLLED [0, 3]" (with 'CONTROLLED' already removed) parses into std::vector {0, 3}.
+*/
+auto parse_controlled_block_qubits_(std::stringstream& stream) -> std::vector<std::size_t>;
+
 }  // namespace ket::internal::parse
@@ -1,12 +1,29 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
 #include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include "kettle/common/mathtools.hpp"
+#include "kettle/io/binary_statevector.hpp"
 #include "kettle/state/state.hpp"
 #include "kettle/io/numpy_statevector.hpp"
 
+#include "kettle_internal/io/io_binary.hpp"
+
+namespace ki = ket::internal;
+
 namespace
 {
 
@@ -26,6 +43,248 @@ auto read_complex_numpy_format_(std::istream& stream) -> std::complex<double>
     return {real, imag};
 }
 
+/*
+    The `.npy` format starts with the magic string, two bytes for the major and minor versions, and
+    the length of the header as a little endian integer; this is 2 bytes long in version 1.0, and 4
+    bytes long in versions 2.0 and 3.0.
+*/
+constexpr auto NPY_MAGIC_ = std::string_view {"\x93NUMPY"};
+constexpr auto NPY_PREAMBLE_SIZE_ = NPY_MAGIC_.size() + 2;
+constexpr auto NPY_HEADER_ALIGNMENT_ = std::size_t {64};
+
+constexpr auto NPY_DESCR_COMPLEX128_ = std::string_view {"<c16"};
+constexpr auto NPY_DESCR_COMPLEX64_ = std::string_view {"<c8"};
+
+// the largest number of qubits whose payload size in bytes still fits in a `std::size_t`, with double precision
+constexpr auto MAX_N_QUBITS_ = std::size_t {59};
+
+void check_little_endian_machine_()
+{
+    if constexpr (std::endian::native != std::endian::little) {
+        throw std::runtime_error {"ERROR: `.npy` files can only be read and written on little endian machines.\n"};
+    }
+}
+
+/*
+    Checks the magic string and version at the start of a `.npy` file, and returns the number of
+    bytes used to store the length of the header.
+*/
+auto npy_header_length_size_(std::string_view preamble) -> std::size_t
+{
+    if (preamble.size() < NPY_PREAMBLE_SIZE_ || !preamble.starts_with(NPY_MAGIC_)) {
+        throw std::runtime_error {"ERROR: the file is not a `.npy` file.\n"};
+    }
+
+    const auto major_version = static_cast<unsigned char>(preamble[NPY_MAGIC_.size()]);
+    if (major_version == 1) {
+        return 2;
+    }
+    else if (major_version == 2 || major_version == 3) {
+        return 4;
+    }
+    else {
+        throw std::runtime_error {"ERROR: unsupported version of the `.npy` file.\n"};
+    }
+}
+
+auto npy_header_length_(std::string_view length_bytes) -> std::size_t
+{
+    auto length = std::size_t {0};
+    for (auto i {length_bytes.size()}; i > 0; --i) {
+        length = (length << 8UL) | static_cast<unsigned char>(length_bytes[i - 1]);
+    }
+
+    return length;
+}
+
+/*
+    Returns the text that follows `'key':` in the python dictionary literal of the header, with the
+    leading whitespace removed.
+*/
+auto npy_header_value_(std::string_view header, std::string_view key) -> std::string_view
+{
+    auto quoted_key = std::string {};
+    quoted_key.reserve(key.size() + 3);
+    quoted_key += '\'';
+    quoted_key += key;
+    quoted_key += "':";
+
+    const auto i_key = header.find(quoted_key);
+    if (i_key == std::string_view::npos) {
+        throw std::runtime_error {"ERROR: the header of the `.npy` file is missing the key '" + std::string {key} + "'\n"};
+    }
+
+    auto value = header.substr(i_key + quoted_key.size());
+    value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+
+    return value;
+}
+
+/*
+    Parses the `shape` entry of the header, such as `(8,)` or `(2, 4)`, into the sizes of the dimensions.
+*/
+auto parse_npy_shape_(std::string_view shape) -> std::vector<std::size_t>
+{
+    if (!shape.starts_with('(') || shape.find(')') == std::string_view::npos) {
+        throw std::runtime_error {"ERROR: invalid shape found in the header of the `.npy` file.\n"};
+    }
+
+    shape = shape.substr(1, shape.find(')') - 1);
+
+    auto dimensions = std::vector<std::size_t> {};
+    while (true) {
+        shape.remove_prefix(std::min(shape.find_first_not_of(", "), shape.size()));
+        if (shape.empty()) {
+            break;
+        }
+
+        auto dimension = std::size_t {0};
+        const auto [ptr, ec] = std::from_chars(shape.data(), shape.data() + shape.size(), dimension);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (ec != std::errc {}) {
+            throw std::runtime_error {"ERROR: invalid shape found in the header of the `.npy` file.\n"};
+        }
+
+        dimensions.push_back(dimension);
+        shape.remove_prefix(static_cast<std::size_t>(ptr - shape.data()));
+    }
+
+    return dimensions;
+}
+
+struct NpyArrayInfo_
+{
+    std::size_t bytes_per_real;
+    std::size_t n_elements;
+};
+
+/*
+    Parses the python dictionary literal in the header of a `.npy` file, which looks like:
+      "{'descr': '<c16', 'fortran_order': False, 'shape': (8,), }"
+*/
+auto parse_npy_header_(std::string_view header) -> NpyArrayInfo_
+{
+    const auto descr = [&]() {
+        const auto value = npy_header_value_(header, "descr");
+        const auto i_end = value.find('\'', 1);
+        if (!value.starts_with('\'') || i_end == std::string_view::npos) {
+            throw std::runtime_error {"ERROR: invalid descr found in the header of the `.npy` file.\n"};
+        }
+
+        return value.substr(1, i_end - 1);
+    }();
+
+    const auto bytes_per_real = [&]() {
+        if (descr == NPY_DESCR_COMPLEX128_) {
+            return sizeof(double);
+        }
+        else if (descr == NPY_DESCR_COMPLEX64_) {
+            return sizeof(float);
+        }
+        else {
+            throw std::runtime_error {"ERROR: the `.npy` file must hold little endian complex128 or complex64 elements; found '" + std::string {descr} + "'\n"};
+        }
+    }();
+
+    const auto dimensions = parse_npy_shape_(npy_header_value_(header, "shape"));
+
+    // the number of elements is checked before the size of the payload is calculated from it, so a
+    // corrupted shape cannot overflow the size, or make the reader allocate an absurd amount of memory
+    const auto max_n_elements = std::size_t {1} << MAX_N_QUBITS_;
+    auto n_elements = std::size_t {1};
+    for (auto dimension : dimensions) {
+        if (dimension == 0 || dimension > max_n_elements / n_elements) {
+            throw std::runtime_error {"ERROR: the `.npy` file must hold between 2 and 2^59 elements.\n"};
+        }
+        n_elements *= dimension;
+    }
+
+    if (n_elements < 2 || !std::has_single_bit(n_elements)) {
+        throw std::runtime_error {"ERROR: the number of elements in the `.npy` file must be a power of 2.\n"};
+    }
+
+    // the order of the elements only matters when more than one dimension has a size greater than 1
+    const auto is_fortran_order = npy_header_value_(header, "fortran_order").starts_with("True");
+    const auto n_nontrivial_dimensions = std::ranges::count_if(dimensions, [](auto dimension) { return dimension > 1; });
+
+    if (is_fortran_order && n_nontrivial_dimensions > 1) {
+        throw std::runtime_error {"ERROR: the `.npy` file must hold its elements in C order.\n"};
+    }
+
+    return {.bytes_per_real=bytes_per_real, .n_elements=n_elements};
+}
+
+/*
+    Creates the preamble and header of a `.npy` file that holds a one-dimensional array; spaces are
+    added to the end of the header so that the data starts at a multiple of 64 bytes.
+*/
+auto format_npy_header_(std::string_view descr, std::size_t n_elements) -> std::string
+{
+    auto dictionary = std::string {"{'descr': '"};
+    dictionary += descr;
+    dictionary += "', 'fortran_order': False, 'shape': (";
+    dictionary += std::to_string(n_elements);
+    dictionary += ",), }";
+
+    // version 1.0 stores the length of the header in 2 bytes
+    const auto unpadded_size = NPY_PREAMBLE_SIZE_ + 2 + dictionary.size() + 1;
+    const auto padded_size = ((unpadded_size + NPY_HEADER_ALIGNMENT_ - 1) / NPY_HEADER_ALIGNMENT_) * NPY_HEADER_ALIGNMENT_;
+    dictionary.append(padded_size - unpadded_size, ' ');
+    dictionary += '\n';
+
+    auto output = std::string {NPY_MAGIC_};
+    output += static_cast<char>(1);
+    output += static_cast<char>(0);
+    output += static_cast<char>(dictionary.size() & 0xffUL);
+    output += static_cast<char>((dictionary.size() >> 8UL) & 0xffUL);
+    output += dictionary;
+
+    return output;
+}
+
+/*
+    Calls `func(header, payload)`, where `header` is the preamble and header of the `.npy` file, and
+    `payload` holds the bytes of the amplitudes of `state` in the requested precision and endianness.
+*/
+template <typename Function>
+void with_npy_statevector_(
+    const ket::QuantumState& state,
+    ket::StatevectorPrecision precision,
+    ket::QuantumStateEndian output_endian,
+    Function&& func
+)
+{
+    check_little_endian_machine_();
+
+    const auto n_states = state.n_states();
+    const auto index = [&](std::size_t i) {
+        return output_endian == ket::QuantumStateEndian::LITTLE ? i : ket::endian_flip(i, state.n_qubits());
+    };
+
+    if (precision == ket::StatevectorPrecision::SINGLE) {
+        auto amplitudes = std::vector<std::complex<float>> {};
+        amplitudes.reserve(n_states);
+        for (std::size_t i {0}; i < n_states; ++i) {
+            const auto& amplitude = state[index(i)];
+            amplitudes.emplace_back(static_cast<float>(amplitude.real()), static_cast<float>(amplitude.imag()));
+        }
+
+        func(format_npy_header_(NPY_DESCR_COMPLEX64_, n_states), std::as_bytes(std::span {amplitudes}));
+    }
+    else if (output_endian == ket::QuantumStateEndian::BIG) {
+        auto amplitudes = std::vector<std::complex<double>> {};
+        amplitudes.reserve(n_states);
+        for (std::size_t i {0}; i < n_states; ++i) {
+            amplitudes.push_back(state[index(i)]);
+        }
+
+        func(format_npy_header_(NPY_DESCR_COMPLEX128_, n_states), std::as_bytes(std::span {amplitudes}));
+    }
+    else {
+        // the amplitudes are written directly from the state, without any copies
+        func(format_npy_header_(NPY_DESCR_COMPLEX128_, n_states), std::as_bytes(std::span {&state[0], n_states}));
+    }
+}
+
 }  // namespace
 
 
@@ -75,4 +334,88 @@ auto read_numpy_statevector(
     return read_numpy_statevector(instream, input_endian);
 }
 
+auto read_npy_statevector(
+    std::istream& instream,
+    QuantumStateEndian input_endian
+) -> QuantumState
+{
+    check_little_endian_machine_();
+
+    // the header is at most a few kilobytes, but its length comes from the file; all the reads go
+    // through `read_stream_bytes_()` so that a corrupted length cannot cause a huge allocation
+    auto bytes = std::vector<std::byte> {};
+    const auto read_exactly = [&](std::size_t n_bytes) {
+        if (!ki::read_stream_bytes_(instream, n_bytes, bytes)) {
+            throw std::runtime_error {"ERROR: the `.npy` file ended unexpectedly.\n"};
+        }
+
+        return ki::text_from_bytes_(bytes);
+    };
+
+    const auto length_size = npy_header_length_size_(read_exactly(NPY_PREAMBLE_SIZE_));
+    const auto header_length = npy_header_length_(read_exactly(length_size));
+    const auto info = parse_npy_header_(read_exactly(header_length));
+
+    read_exactly(info.n_elements * 2 * info.bytes_per_real);
+
+    return QuantumState {ki::amplitudes_from_bytes_(bytes, info.bytes_per_real), input_endian};
+}
+
+auto read_npy_statevector(
+    const std::filesystem::path& filepath,
+    QuantumStateEndian input_endian
+) -> QuantumState
+{
+    check_little_endian_machine_();
+
+    const auto file = ki::MappedFile {filepath};
+    const auto bytes = file.bytes();
+
+    const auto length_size = npy_header_length_size_(ki::text_from_bytes_(bytes.first(std::min(bytes.size(), NPY_PREAMBLE_SIZE_))));
+    if (bytes.size() < NPY_PREAMBLE_SIZE_ + length_size) {
+        throw std::runtime_error {"ERROR: the `.npy` file ended unexpectedly.\n"};
+    }
+
+    const auto header_length = npy_header_length_(ki::text_from_bytes_(bytes.subspan(NPY_PREAMBLE_SIZE_, length_size)));
+    const auto i_data = NPY_PREAMBLE_SIZE_ + length_size + header_length;
+    if (bytes.size() < i_data) {
+        throw std::runtime_error {"ERROR: the `.npy` file ended unexpectedly.\n"};
+    }
+
+    const auto info = parse_npy_header_(ki::text_from_bytes_(bytes.subspan(NPY_PREAMBLE_SIZE_ + length_size, header_length)));
+
+    const auto payload_size = info.n_elements * 2 * info.bytes_per_real;
+    if (bytes.size() - i_data < payload_size) {
+        throw std::runtime_error {"ERROR: the `.npy` file ended unexpectedly.\n"};
+    }
+
+    return QuantumState {ki::amplitudes_from_bytes_(bytes.subspan(i_data, payload_size), info.bytes_per_real), input_endian};
+}
+
+void write_npy_statevector(
+    std::ostream& outstream,
+    const QuantumState& state,
+    StatevectorPrecision precision,
+    QuantumStateEndian output_endian
+)
+{
+    with_npy_statevector_(state, precision, output_endian, [&](const std::string& header, std::span<const std::byte> payload) {
+        outstream.write(header.data(), static_cast<std::streamsize>(header.size()));
+        outstream.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    });
+}
+
+void write_npy_statevector(
+    const std::filesystem::path& filepath,
+    const QuantumState& state,
+    StatevectorPrecision precision,
+    QuantumStateEndian output_endian
+)
+{
+    with_npy_statevector_(state, precision, output_endian, [&](const std::string& header, std::span<const std::byte> payload) {
+        const auto parts = std::array {std::as_bytes(std::span {header}), payload};
+        ki::write_binary_file_(filepath, parts);
+    });
+}
+
 }  // namespace ket
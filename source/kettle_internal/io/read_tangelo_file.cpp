@@ -1,16 +1,33 @@
+#include <charconv>
+#include <complex>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
-#include <fstream>
+#include <format>
+#include <iterator>
 #include <optional>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+
+#include <unistd.h>
 
 #include "kettle/gates/primitive_gate.hpp"
 #include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/compact_circuit.hpp"
+#include "kettle/circuit_operations/collapse_pauli_rotation_gadgets.hpp"
+#include "kettle/io/binary_circuit.hpp"
 #include "kettle/io/read_tangelo_file.hpp"
 
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_id.hpp"
 #include "kettle_internal/gates/primitive_gate_map.hpp"
+#include "kettle_internal/io/io_binary.hpp"
 #include "kettle_internal/io/io_control_flow.hpp"
 
 namespace
@@ -20,278 +37,465 @@ namespace
     Certain names of primitive gates do not match between the tangelo codebase and this codebase;
     this function converts tangelo-specific names to names used here.
 */
-auto tangelo_to_local_name_(const std::string& name) -> std::string
+auto tangelo_to_local_name_(std::string_view name) -> std::string
 {
     if (name == "CPHASE") {
         return "CP";
     }
-    else if (name == "CNOT") {
+    else if (name == "CNOT" || name == "CX") {
         return "CX";
     }
     else if (name == "PHASE") {
         return "P";
     }
     else {
-        return name;
+        return std::string {name};
     }
 }
 
-void parse_swap_gate_(ket::QuantumCircuit& circuit, std::stringstream& stream)
+/*
+    Walks through the text of a tangelo file one line at a time, without copying any of it.
+*/
+class LineReader_
 {
-    std::string dummy_str;
-    char dummy_ch;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t target_qubit0;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t target_qubit1;  // NOLINT(cppcoreguidelines-init-variables)
-
-    stream >> dummy_str;    // 'target'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> target_qubit0; // target qubit 0
-    stream >> dummy_ch;     // ','
-    stream >> target_qubit1; // target qubit 1
-    stream >> dummy_ch;     // ']'
+public:
+    explicit LineReader_(std::string_view text)
+        : text_ {text}
+    {}
+
+    [[nodiscard]]
+    auto at_end() const noexcept -> bool
+    {
+        return position_ >= text_.size();
+    }
 
-    circuit.add_swap_gate(target_qubit0, target_qubit1);
-}
+    [[nodiscard]]
+    auto position() const noexcept -> std::size_t
+    {
+        return position_;
+    }
+
+    void set_position(std::size_t position) noexcept
+    {
+        position_ = position;
+    }
+
+    /*
+        Returns the next line without its newline character, and moves past it.
+    */
+    auto next_line() noexcept -> std::string_view
+    {
+        const auto newline = text_.find('\n', position_);
+        const auto line_end = (newline == std::string_view::npos) ? text_.size() : newline;
+
+        const auto line = text_.substr(position_, line_end - position_);
+        position_ = (newline == std::string_view::npos) ? text_.size() : newline + 1;
+
+        return line;
+    }
+
+    [[nodiscard]]
+    auto count_remaining_lines() const noexcept -> std::size_t
+    {
+        // `find()` uses `memchr()`, which is much faster than comparing each character in turn
+        auto n_lines = std::size_t {1};
+        for (auto newline = text_.find('\n', position_); newline != std::string_view::npos; newline = text_.find('\n', newline + 1)) {
+            ++n_lines;
+        }
+
+        return n_lines;
+    }
 
-void parse_one_target_gate_(ket::Gate gate, ket::QuantumCircuit& circuit, std::stringstream& stream)
+private:
+    std::string_view text_;
+    std::size_t position_ {0};
+};
+
+/*
+    Reads the whitespace-separated tokens of a single line, in the same way that the tokens would
+    be read from a `std::stringstream` with `operator>>`, but without the overhead of a stream.
+
+    Any token that does not match what is expected throws an exception, rather than leaving the
+    stream in a failed state.
+*/
+class TokenScanner_
 {
-    std::string dummy_str;
-    char dummy_ch;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t target_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-
-    stream >> dummy_str;    // 'target'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> target_qubit; // target qubit
-    stream >> dummy_ch;     // ']'
-
-    const auto func = ket::internal::GATE_TO_FUNCTION_1T.at(gate);
-    (circuit.*func)(target_qubit);
-}
+public:
+    explicit TokenScanner_(std::string_view line)
+        : line_ {line}
+    {}
+
+    auto next_word() -> std::string_view
+    {
+        skip_whitespace_();
+
+        const auto begin = position_;
+        while (position_ < line_.size() && !is_whitespace_(line_[position_])) {
+            ++position_;
+        }
+
+        return line_.substr(begin, position_ - begin);
+    }
+
+    void expect(char expected)
+    {
+        skip_whitespace_();
+
+        if (position_ >= line_.size() || line_[position_] != expected) {
+            throw_parse_error_();
+        }
+
+        ++position_;
+    }
+
+    /*
+        Moves past a field name and the colon after it; for example, 'target :'
+    */
+    void expect_field(std::string_view field_name)
+    {
+        skip_whitespace_();
+
+        if (!line_.substr(position_).starts_with(field_name)) {
+            throw_parse_error_();
+        }
 
-void parse_one_control_one_target_gate_(ket::Gate gate, ket::QuantumCircuit& circuit, std::stringstream& stream)
+        position_ += field_name.size();
+        expect(':');
+    }
+
+    auto next_size() -> std::size_t
+    {
+        skip_whitespace_();
+
+        auto value = std::size_t {};
+        const auto [end, error] = std::from_chars(current_(), end_(), value);
+        if (error != std::errc {}) {
+            throw_parse_error_();
+        }
+
+        position_ = static_cast<std::size_t>(end - line_.data());
+        return value;
+    }
+
+    auto next_double() -> double
+    {
+        skip_whitespace_();
+
+        // `std::from_chars()` does not accept the leading '+' that `operator>>` does
+        if (position_ < line_.size() && line_[position_] == '+') {
+            ++position_;
+        }
+
+        auto value = double {};
+        const auto [end, error] = std::from_chars(current_(), end_(), value);
+        if (error != std::errc {}) {
+            throw_parse_error_();
+        }
+
+        position_ = static_cast<std::size_t>(end - line_.data());
+        return value;
+    }
+
+    /*
+        Reads a single qubit index in square brackets; for example, '[4]'
+    */
+    auto next_bracketed_size() -> std::size_t
+    {
+        expect('[');
+        const auto value = next_size();
+        expect(']');
+
+        return value;
+    }
+
+    /*
+        Reads a complex number written as its two components in square brackets; for example, '[0.5, -0.5]'
+    */
+    auto next_bracketed_complex() -> std::complex<double>
+    {
+        expect('[');
+        const auto real = next_double();
+        expect(',');
+        const auto imag = next_double();
+        expect(']');
+
+        return {real, imag};
+    }
+
+    [[nodiscard]]
+    auto remainder() const -> std::string_view
+    {
+        return line_.substr(position_);
+    }
+
+private:
+    std::string_view line_;
+    std::size_t position_ {0};
+
+    static constexpr auto is_whitespace_(char ch) noexcept -> bool
+    {
+        return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
+    }
+
+    void skip_whitespace_() noexcept
+    {
+        while (position_ < line_.size() && is_whitespace_(line_[position_])) {
+            ++position_;
+        }
+    }
+
+    [[nodiscard]]
+    auto current_() const noexcept -> const char*
+    {
+        return line_.data() + position_;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    [[nodiscard]]
+    auto end_() const noexcept -> const char*
+    {
+        return line_.data() + line_.size();  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    [[noreturn]]
+    void throw_parse_error_() const
+    {
+        auto err_msg = std::stringstream {};
+        err_msg << "ERROR: unable to parse the line in the tangelo circuit : '" << line_ << "'\n";
+
+        throw std::runtime_error {err_msg.str()};
+    }
+};
+
+auto parse_target_(TokenScanner_& tokens) -> std::size_t
 {
-    std::string dummy_str;
-    char dummy_ch;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t target_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t control_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-
-    stream >> dummy_str;    // 'target'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> target_qubit; // target qubit
-    stream >> dummy_ch;     // ']'
-    stream >> dummy_str;    // 'control'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> control_qubit; // control qubit
-    stream >> dummy_ch;     // ']'
-
-    const auto func = ket::internal::GATE_TO_FUNCTION_1C1T.at(gate);
-    (circuit.*func)(control_qubit, target_qubit);
+    tokens.expect_field("target");
+    return tokens.next_bracketed_size();
 }
 
-void parse_one_target_one_angle_gate_(ket::Gate gate, ket::QuantumCircuit& circuit, std::stringstream& stream)
+auto parse_target_and_control_(TokenScanner_& tokens) -> std::tuple<std::size_t, std::size_t>
 {
-    std::string dummy_str;
-    char dummy_ch;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t target_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-    double angle;  // NOLINT(cppcoreguidelines-init-variables)
-
-    stream >> dummy_str;    // 'target'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> target_qubit; // target qubit
-    stream >> dummy_ch;     // ']'
-    stream >> dummy_str;    // 'parameter'
-    stream >> dummy_str;    // ':'
-    stream >> angle;        // angle
-
-    const auto func = ket::internal::GATE_TO_FUNCTION_1T1A.at(gate);
-    (circuit.*func)(target_qubit, angle);
+    const auto target = parse_target_(tokens);
+
+    tokens.expect_field("control");
+    const auto control = tokens.next_bracketed_size();
+
+    return {target, control};
 }
 
-void parse_one_control_one_target_one_angle_gate_(ket::Gate gate, ket::QuantumCircuit& circuit, std::stringstream& stream)
+auto parse_angle_(TokenScanner_& tokens) -> double
 {
-    std::string dummy_str;
-    char dummy_ch;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t target_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t control_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-    double angle;  // NOLINT(cppcoreguidelines-init-variables)
-
-    stream >> dummy_str;    // 'target'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> target_qubit; // target qubit
-    stream >> dummy_ch;     // ']'
-    stream >> dummy_str;    // 'control'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> control_qubit; // control qubit
-    stream >> dummy_ch;     // ']'
-    stream >> dummy_str;    // 'parameter'
-    stream >> dummy_str;    // ':'
-    stream >> angle;        // angle
-
-    const auto func = ket::internal::GATE_TO_FUNCTION_1C1T1A.at(gate);
-    (circuit.*func)(control_qubit, target_qubit, angle);
+    tokens.expect_field("parameter");
+    return tokens.next_double();
 }
 
-void parse_m_gate_(ket::QuantumCircuit& circuit, std::stringstream& stream)
+auto parse_matrix2x2_(LineReader_& reader) -> ket::Matrix2X2
 {
-    std::string dummy_str;
-    char dummy_ch;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t qubit;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t bit;  // NOLINT(cppcoreguidelines-init-variables)
-
-    stream >> dummy_str;    // 'target'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> qubit;        // qubit
-    stream >> dummy_ch;     // ']'
-    stream >> dummy_str;    // 'bit'
-    stream >> dummy_str;    // ':'
-    stream >> dummy_ch;     // '['
-    stream >> bit;          // bit
-    stream >> dummy_ch;     // ']'
+    if (reader.at_end()) {
+        throw std::runtime_error {"ERROR: the tangelo circuit ends before the matrix elements of a 'U' or 'CU' gate.\n"};
+    }
+    auto first_row = TokenScanner_ {reader.next_line()};
 
-    circuit.add_m_gate(qubit, bit);
+    if (reader.at_end()) {
+        throw std::runtime_error {"ERROR: the tangelo circuit ends before the matrix elements of a 'U' or 'CU' gate.\n"};
+    }
+    auto second_row = TokenScanner_ {reader.next_line()};
+
+    const auto elem00 = first_row.next_bracketed_complex();
+    const auto elem01 = first_row.next_bracketed_complex();
+    const auto elem10 = second_row.next_bracketed_complex();
+    const auto elem11 = second_row.next_bracketed_complex();
+
+    return {.elem00=elem00, .elem01=elem01, .elem10=elem10, .elem11=elem11};
 }
 
-auto parse_complex_(std::stringstream& stream) -> std::complex<double>
+void parse_swap_gate_(ket::QuantumCircuit& circuit, TokenScanner_& tokens)
 {
-    char dummy_char;  // NOLINT(cppcoreguidelines-init-variables)
-    double real;  // NOLINT(cppcoreguidelines-init-variables)
-    double imag;  // NOLINT(cppcoreguidelines-init-variables)
-
-    stream >> dummy_char;    // '['
-    stream >> real;          // real component
-    stream >> dummy_char;    // ','
-    stream >> imag;          // imaginary component
-    stream >> dummy_char;    // ']'
+    tokens.expect_field("target");
+    tokens.expect('[');
+    const auto target_qubit0 = tokens.next_size();
+    tokens.expect(',');
+    const auto target_qubit1 = tokens.next_size();
+    tokens.expect(']');
 
-    return {real, imag};
+    circuit.add_swap_gate(target_qubit0, target_qubit1);
 }
 
-auto parse_matrix2x2_(std::istream& stream) -> ket::Matrix2X2
+void parse_m_gate_(ket::QuantumCircuit& circuit, TokenScanner_& tokens)
 {
-    std::string first_line;
-    std::string second_line;
+    const auto qubit = parse_target_(tokens);
+
+    tokens.expect_field("bit");
+    const auto bit = tokens.next_bracketed_size();
 
-    std::getline(stream, first_line);
+    circuit.add_m_gate(qubit, bit);
+}
 
-    auto sstream_first = std::stringstream {first_line};
+/*
+    Parses any gate that is not one of the gates handled by the fast path in `parse_circuit_()`.
+*/
+void parse_general_gate_(
+    std::string_view name,
+    ket::QuantumCircuit& circuit,
+    TokenScanner_& tokens,
+    LineReader_& reader
+)
+{
+    namespace gid = ket::internal::gate_id;
+    using G = ket::Gate;
 
-    std::getline(stream, second_line);
-    auto sstream_second = std::stringstream {second_line};
+    const auto local_name = tangelo_to_local_name_(name);
 
-    const auto elem00 = parse_complex_(sstream_first);
-    const auto elem01 = parse_complex_(sstream_first);
-    const auto elem10 = parse_complex_(sstream_second);
-    const auto elem11 = parse_complex_(sstream_second);
+    // handle the special cases where tangelo has primitive gates that don't exist in the local code
+    if (local_name == "SWAP") {
+        parse_swap_gate_(circuit, tokens);
+        return;
+    }
 
-    return {.elem00=elem00, .elem01=elem01, .elem10=elem10, .elem11=elem11};
-}
+    // attempt to parse the gate
+    const auto gate = [&]() {
+        try {
+            return ket::internal::PRIMITIVE_GATES_TO_STRING.at_reverse(local_name);
+        }
+        catch (const std::runtime_error& e) {
+            auto err_msg = std::stringstream {};
+            err_msg << "Unknown gate found in `read_tangelo_file()` : " << local_name << '\n';
+            throw std::runtime_error {err_msg.str()};
+        }
+    }();
 
-void parse_u_gate_(ket::QuantumCircuit& circuit, std::stringstream& gateline_stream, std::istream& circuit_stream)
-{
-    std::string dummy_str;
-    char dummy_ch;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t target_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-
-    gateline_stream >> dummy_str;    // 'target'
-    gateline_stream >> dummy_str;    // ':'
-    gateline_stream >> dummy_ch;     // '['
-    gateline_stream >> target_qubit; // target qubit
-    gateline_stream >> dummy_ch;     // ']'
-
-    const auto unitary = parse_matrix2x2_(circuit_stream);
-    circuit.add_u_gate(unitary, target_qubit);
-}
+    if (gid::is_one_target_transform_gate(gate)) {
+        const auto target = parse_target_(tokens);
 
-void parse_cu_gate_(ket::QuantumCircuit& circuit, std::stringstream& gateline_stream, std::istream& circuit_stream)
-{
-    std::string dummy_str;
-    char dummy_ch;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t target_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-    std::size_t control_qubit;  // NOLINT(cppcoreguidelines-init-variables)
-
-    gateline_stream >> dummy_str;    // 'target'
-    gateline_stream >> dummy_str;    // ':'
-    gateline_stream >> dummy_ch;     // '['
-    gateline_stream >> target_qubit; // target qubit
-    gateline_stream >> dummy_ch;     // ']'
-    gateline_stream >> dummy_str;    // 'control'
-    gateline_stream >> dummy_str;    // ':'
-    gateline_stream >> dummy_ch;     // '['
-    gateline_stream >> control_qubit; // control qubit
-    gateline_stream >> dummy_ch;     // ']'
-
-    const auto unitary = parse_matrix2x2_(circuit_stream);
-    circuit.add_cu_gate(unitary, control_qubit, target_qubit);
-}
+        const auto func = ket::internal::GATE_TO_FUNCTION_1T.at(gate);
+        (circuit.*func)(target);
+    }
+    else if (gid::is_one_control_one_target_transform_gate(gate)) {
+        const auto [target, control] = parse_target_and_control_(tokens);
 
-}  // namespace
+        const auto func = ket::internal::GATE_TO_FUNCTION_1C1T.at(gate);
+        (circuit.*func)(control, target);
+    }
+    else if (gid::is_one_target_one_angle_transform_gate(gate)) {
+        const auto target = parse_target_(tokens);
+        const auto angle = parse_angle_(tokens);
 
+        const auto func = ket::internal::GATE_TO_FUNCTION_1T1A.at(gate);
+        (circuit.*func)(target, angle);
+    }
+    else if (gid::is_one_control_one_target_one_angle_transform_gate(gate)) {
+        const auto [target, control] = parse_target_and_control_(tokens);
+        const auto angle = parse_angle_(tokens);
 
-namespace ket
-{
+        const auto func = ket::internal::GATE_TO_FUNCTION_1C1T1A.at(gate);
+        (circuit.*func)(control, target, angle);
+    }
+    else if (gate == G::M) {
+        parse_m_gate_(circuit, tokens);
+    }
+    else if (gate == G::U) {
+        const auto target = parse_target_(tokens);
+        circuit.add_u_gate(parse_matrix2x2_(reader), target);
+    }
+    else if (gate == G::CU) {
+        const auto [target, control] = parse_target_and_control_(tokens);
+        circuit.add_cu_gate(parse_matrix2x2_(reader), control, target);
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: A gate type with no implemented conversion has been encountered.\n"};
+    }
+}
 
-auto read_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-cognitive-complexity)
-    std::size_t n_qubits,
-    std::istream& stream,
-    std::size_t n_skip_lines,
+/*
+    Parses lines from `reader` into `circuit`, until either the text runs out, or a line is found
+    that does not start with `line_starts_with_spaces` spaces; in the latter case, `reader` is left
+    at the start of that line, so the enclosing circuit can continue from there.
+*/
+void parse_circuit_(  // NOLINT(misc-no-recursion, readability-function-cognitive-complexity)
+    ket::QuantumCircuit& circuit,
+    LineReader_& reader,
     std::optional<std::size_t> line_starts_with_spaces
-) -> QuantumCircuit
+)
 {
-    namespace gid = ket::internal::gate_id;
     namespace io_par = ket::internal::parse;
-    using G = ket::Gate;
 
-    constexpr auto n_whitespace = ket::internal::CONTROL_FLOW_WHITESPACE_DEFAULT;
+    // the subcircuits of control flow statements are indented one level further than the statement
+    const auto n_whitespace = line_starts_with_spaces.value_or(0) + ket::internal::CONTROL_FLOW_WHITESPACE_DEFAULT;
+    const auto n_qubits = circuit.n_qubits();
 
-    auto circuit = ket::QuantumCircuit {n_qubits};
+    const auto parse_subcircuit = [&]() {
+        auto subcircuit = ket::QuantumCircuit {n_qubits};
+        parse_circuit_(subcircuit, reader, n_whitespace);
 
-    std::string line;
+        return subcircuit;
+    };
 
-    for (std::size_t i {0}; i < n_skip_lines; ++i) {
-        std::getline(stream, line);
-    }
+    // the control flow headers are rare enough that they can go through the stream-based parsers
+    const auto header_stream = [](const TokenScanner_& tokens) {
+        return std::stringstream {std::string {tokens.remainder()}};
+    };
 
-    auto curr_pos = stream.tellg();
-    while (std::getline(stream, line)) {
-        auto gatestream = std::stringstream {line};
+    while (!reader.at_end()) {
+        const auto line_position = reader.position();
+        const auto line = reader.next_line();
 
         // if the start of the line needs to satisfy a certain condition, and it doesn't; break early
-        if (line_starts_with_spaces.has_value())
-        {
-            const auto whitespace = std::string(line_starts_with_spaces.value(), ' ');
+        if (line_starts_with_spaces.has_value()) {
+            const auto n_spaces = line_starts_with_spaces.value();
 
-            if (!line.starts_with(whitespace)) {
-                stream.seekg(curr_pos);
-                return circuit;
+            if (line.size() < n_spaces || line.substr(0, n_spaces).find_first_not_of(' ') != std::string_view::npos) {
+                reader.set_position(line_position);
+                break;
             }
         }
 
-        std::string name;
-        gatestream >> name;
+        auto tokens = TokenScanner_ {line};
+        const auto name = tokens.next_word();
 
-        if (name == "") {
+        if (name.empty()) {
             continue;
         }
 
-        if (name == "IF") {
-            auto predicate = io_par::parse_control_flow_predicate_(gatestream);
-            
-            auto if_circuit = read_tangelo_circuit(n_qubits, stream, 0, n_whitespace);
-            circuit.add_if_statement(std::move(predicate), std::move(if_circuit));
+        // the fast path, for the gates that make up almost all of the trotterized circuits produced by tangelo;
+        // tangelo writes CX gates as CNOT, and `write_tangelo_circuit()` writes them as CX
+        if (name == "CNOT" || name == "CX") {
+            const auto [target, control] = parse_target_and_control_(tokens);
+            circuit.add_cx_gate(control, target);
+        }
+        else if (name == "RZ") {
+            const auto target = parse_target_(tokens);
+            circuit.add_rz_gate(target, parse_angle_(tokens));
+        }
+        else if (name == "H") {
+            circuit.add_h_gate(parse_target_(tokens));
+        }
+        else if (name == "RX") {
+            const auto target = parse_target_(tokens);
+            circuit.add_rx_gate(target, parse_angle_(tokens));
+        }
+        else if (name == "IF") {
+            auto stream = header_stream(tokens);
+            auto predicate = io_par::parse_control_flow_predicate_(stream);
+
+            circuit.add_if_statement(std::move(predicate), parse_subcircuit());
+        }
+        else if (name == "REPEAT") {
+            auto stream = header_stream(tokens);
+            const auto n_repetitions = io_par::parse_repeat_count_(stream);
 
-            continue;
+            circuit.add_repeat_statement(n_repetitions, parse_subcircuit());
         }
+        else if (name == "CONTROLLED") {
+            auto stream = header_stream(tokens);
+            const auto control_qubits = io_par::parse_controlled_block_qubits_(stream);
 
-        if (name == "ELSE") {
+            circuit.add_controlled_block(control_qubits, parse_subcircuit());
+        }
+        else if (name == "ELSE") {
             const auto n_elements = circuit.n_circuit_elements();
+            if (n_elements == 0) {
+                throw std::runtime_error {"ERROR: encountered an 'ELSE' statement, but no previous matching 'IF' statement was found.\n"};
+            }
+
             const auto top_element = circuit[n_elements - 1];
             circuit.pop_back();
 
@@ -300,79 +504,326 @@ auto read_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-co
             }
 
             const auto& if_stmt = top_element.get_control_flow().get_if_statement();
-
-            auto else_circuit = read_tangelo_circuit(n_qubits, stream, 0, n_whitespace);
-            circuit.add_if_else_statement(if_stmt.predicate(), *if_stmt.circuit(), std::move(else_circuit));
-            continue;
+            circuit.add_if_else_statement(if_stmt.predicate(), *if_stmt.circuit(), parse_subcircuit());
+        }
+        else {
+            parse_general_gate_(name, circuit, tokens, reader);
         }
+    }
+}
 
-        const auto local_name = tangelo_to_local_name_(name);
+/*
+    Parses the text of an entire tangelo file into a circuit.
+*/
+auto parse_tangelo_text_(
+    std::size_t n_qubits,
+    std::string_view text,
+    std::size_t n_skip_lines,
+    std::optional<std::size_t> line_starts_with_spaces,
+    bool collapse_pauli_rotations
+) -> ket::QuantumCircuit
+{
+    auto reader = LineReader_ {text};
+    for (std::size_t i {0}; i < n_skip_lines && !reader.at_end(); ++i) {
+        reader.next_line();
+    }
 
-        // handle the special cases where tangelo has primitive gates that don't exist in the local code
-        if (local_name == "SWAP") {
-            parse_swap_gate_(circuit, gatestream);
-            continue;
-        }
+    // almost every line holds a single gate; reserving for all of them up front avoids any
+    // reallocation of the circuit elements while parsing
+    auto circuit = ket::QuantumCircuit {n_qubits};
+    circuit.reserve_circuit_elements(reader.count_remaining_lines());
 
-        // attempt to parse the gate
-        const auto gate = [&]() {
-            try {
-                return ket::internal::PRIMITIVE_GATES_TO_STRING.at_reverse(local_name);
-            }
-            catch (const std::runtime_error& e) {
-                auto err_msg = std::stringstream {};
-                err_msg << "Unknown gate found in `read_tangelo_file()` : " << local_name << '\n';
-                throw std::runtime_error {err_msg.str()};
-            }
-        }();
+    parse_circuit_(circuit, reader, line_starts_with_spaces);
 
-        if (gid::is_one_target_transform_gate(gate)) {
-            parse_one_target_gate_(gate, circuit, gatestream);
-        }
-        else if (gid::is_one_control_one_target_transform_gate(gate)) {
-            parse_one_control_one_target_gate_(gate, circuit, gatestream);
+    if (collapse_pauli_rotations) {
+        return ket::collapse_pauli_rotation_gadgets(circuit);
+    }
+
+    return circuit;
+}
+
+/*
+    Parses lines from `reader` straight into the records of `circuit`, until the text runs out; the gates
+    of the fast path never go through a `CircuitElement`. The rare gates that are not on the fast path are
+    parsed into `scratch` first, and then moved over.
+*/
+void parse_compact_circuit_(ket::CompactCircuit& circuit, LineReader_& reader)
+{
+    namespace cre = ket::internal::create;
+    using G = ket::Gate;
+
+    auto scratch = ket::QuantumCircuit {circuit.n_qubits()};
+
+    while (!reader.at_end()) {
+        auto tokens = TokenScanner_ {reader.next_line()};
+        const auto name = tokens.next_word();
+
+        if (name.empty()) {
+            continue;
         }
-        else if (gid::is_one_target_one_angle_transform_gate(gate)) {
-            parse_one_target_one_angle_gate_(gate, circuit, gatestream);
+
+        if (name == "CNOT" || name == "CX") {
+            const auto [target, control] = parse_target_and_control_(tokens);
+            circuit.push_back(cre::create_one_control_one_target_gate(G::CX, control, target));
         }
-        else if (gid::is_one_control_one_target_one_angle_transform_gate(gate)) {
-            parse_one_control_one_target_one_angle_gate_(gate, circuit, gatestream);
+        else if (name == "RZ") {
+            const auto target = parse_target_(tokens);
+            circuit.push_back(cre::create_one_target_one_angle_gate(G::RZ, target, parse_angle_(tokens)));
         }
-        else if (gate == G::M) {
-            parse_m_gate_(circuit, gatestream);
+        else if (name == "H") {
+            circuit.push_back(cre::create_one_target_gate(G::H, parse_target_(tokens)));
         }
-        else if (gate == G::U) {
-            parse_u_gate_(circuit, gatestream, stream);
+        else if (name == "RX") {
+            const auto target = parse_target_(tokens);
+            circuit.push_back(cre::create_one_target_one_angle_gate(G::RX, target, parse_angle_(tokens)));
         }
-        else if (gate == G::CU) {
-            parse_cu_gate_(circuit, gatestream, stream);
+        else if (name == "IF" || name == "ELSE" || name == "REPEAT" || name == "CONTROLLED") {
+            throw std::runtime_error {"ERROR: a `CompactCircuit` can only hold gates\n"};
         }
         else {
-            throw std::runtime_error {"DEV ERROR: A gate type with no implemented conversion has been encountered.\n"};
+            parse_general_gate_(name, scratch, tokens, reader);
+
+            for (const auto& element : scratch) {
+                circuit.push_back(element.get_gate());
+            }
+
+            while (scratch.n_circuit_elements() != 0) {
+                scratch.pop_back();
+            }
         }
+    }
+}
 
-        curr_pos = stream.tellg();
+/*
+    Parses the text left in `reader`, after skipping `n_skip_lines` lines, into a `CompactCircuit`.
+*/
+auto parse_compact_text_(std::size_t n_qubits, LineReader_& reader, std::size_t n_skip_lines) -> ket::CompactCircuit
+{
+    for (std::size_t i {0}; i < n_skip_lines && !reader.at_end(); ++i) {
+        reader.next_line();
     }
 
+    auto circuit = ket::CompactCircuit {n_qubits};
+    circuit.reserve(reader.count_remaining_lines());
+
+    parse_compact_circuit_(circuit, reader);
+
     return circuit;
 }
 
+// change this whenever the parser reads the same text into a different circuit, so that circuits
+// cached by an older parser are not loaded
+constexpr auto TANGELO_CACHE_VERSION_ = std::uint64_t {1};
+
+/*
+    Everything that decides which circuit `read_tangelo_circuit_cached()` produces; the name of the
+    cache file is a hash of this struct.
+*/
+struct TangeloCacheKey_
+{
+    std::uint64_t content_checksum;
+    std::uint64_t content_size;
+    std::uint64_t n_qubits;
+    std::uint64_t n_skip_lines;
+    std::uint64_t collapse_pauli_rotations;
+    std::uint64_t version;
+};
+
+/*
+    The path of the file in `cache_directory` that caches the circuit parsed from the file with the
+    contents `bytes`; circuits and compact circuits are cached under different extensions.
+*/
+auto cache_filepath_(
+    std::span<const std::byte> bytes,
+    std::size_t n_qubits,
+    std::size_t n_skip_lines,
+    bool collapse_pauli_rotations,
+    const std::filesystem::path& cache_directory,
+    std::string_view extension
+) -> std::filesystem::path
+{
+    const auto key = TangeloCacheKey_ {
+        .content_checksum=ket::internal::checksum_(bytes),
+        .content_size=bytes.size(),
+        .n_qubits=n_qubits,
+        .n_skip_lines=n_skip_lines,
+        .collapse_pauli_rotations=static_cast<std::uint64_t>(collapse_pauli_rotations),
+        .version=TANGELO_CACHE_VERSION_
+    };
+
+    const auto key_hash = ket::internal::checksum_(std::as_bytes(std::span {&key, 1}));
+    return cache_directory / std::format("{:016x}.{}", key_hash, extension);
+}
+
+template <typename Circuit>
+auto load_cached_circuit_(
+    const std::filesystem::path& cache_filepath,
+    std::size_t n_qubits,
+    Circuit (*load)(const std::filesystem::path&)
+) -> std::optional<Circuit>
+{
+    if (!std::filesystem::exists(cache_filepath)) {
+        return std::nullopt;
+    }
+
+    try {
+        auto circuit = load(cache_filepath);
+        if (circuit.n_qubits() != n_qubits) {
+            return std::nullopt;
+        }
+
+        return circuit;
+    }
+    catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+/*
+    Writes the circuit to a temporary file first, and then renames it to `cache_filepath`; another
+    process reading the same cache never sees a partially written file.
+*/
+template <typename Circuit>
+void store_cached_circuit_(
+    const std::filesystem::path& cache_filepath,
+    const Circuit& circuit,
+    void (*save)(const std::filesystem::path&, const Circuit&)
+)
+{
+    auto temporary_filepath = cache_filepath;
+    temporary_filepath += std::format(".{}.tmp", ::getpid());
+
+    try {
+        std::filesystem::create_directories(cache_filepath.parent_path());
+        save(temporary_filepath, circuit);
+        std::filesystem::rename(temporary_filepath, cache_filepath);
+    }
+    catch (const std::exception&) {
+        auto ec = std::error_code {};
+        std::filesystem::remove(temporary_filepath, ec);
+    }
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+auto read_tangelo_circuit(
+    std::size_t n_qubits,
+    std::istream& stream,
+    std::size_t n_skip_lines,
+    std::optional<std::size_t> line_starts_with_spaces,
+    bool collapse_pauli_rotations
+) -> QuantumCircuit
+{
+    if (!line_starts_with_spaces.has_value()) {
+        const auto text = std::string {std::istreambuf_iterator<char> {stream}, std::istreambuf_iterator<char> {}};
+        return parse_tangelo_text_(n_qubits, text, n_skip_lines, std::nullopt, collapse_pauli_rotations);
+    }
+
+    // the stream might not be seekable, so the line that ends the circuit cannot be read and then
+    // given back; instead, the indentation of each line is checked one character at a time, before
+    // the rest of the line is read
+    const auto n_spaces = line_starts_with_spaces.value();
+    auto text = std::string {};
+    auto line = std::string {};
+
+    for (std::size_t i {0}; i < n_skip_lines && std::getline(stream, line); ++i) {
+        text += line;
+        text += '\n';
+    }
+
+    while (stream.peek() != std::char_traits<char>::eof()) {
+        auto n_leading_spaces = std::size_t {0};
+        while (n_leading_spaces < n_spaces && stream.peek() == ' ') {
+            stream.get();
+            ++n_leading_spaces;
+        }
+
+        if (n_leading_spaces < n_spaces) {
+            break;
+        }
+
+        std::getline(stream, line);
+        text.append(n_spaces, ' ');
+        text += line;
+        text += '\n';
+    }
+
+    return parse_tangelo_text_(n_qubits, text, n_skip_lines, line_starts_with_spaces, collapse_pauli_rotations);
+}
+
 auto read_tangelo_circuit(
+    std::size_t n_qubits,
+    const std::filesystem::path& filepath,
+    std::size_t n_skip_lines,
+    bool collapse_pauli_rotations
+) -> QuantumCircuit
+{
+    const auto file = ket::internal::MappedFile {filepath};
+    const auto bytes = file.bytes();
+    const auto text = ket::internal::text_from_bytes_(bytes);
+
+    return parse_tangelo_text_(n_qubits, text, n_skip_lines, std::nullopt, collapse_pauli_rotations);
+}
+
+auto read_tangelo_compact_circuit(
     std::size_t n_qubits,
     const std::filesystem::path& filepath,
     std::size_t n_skip_lines
+) -> CompactCircuit
+{
+    const auto file = ket::internal::MappedFile {filepath};
+    auto reader = LineReader_ {ket::internal::text_from_bytes_(file.bytes())};
+
+    return parse_compact_text_(n_qubits, reader, n_skip_lines);
+}
+
+auto read_tangelo_circuit_cached(
+    std::size_t n_qubits,
+    const std::filesystem::path& filepath,
+    std::size_t n_skip_lines,
+    const std::filesystem::path& cache_directory,
+    bool collapse_pauli_rotations
 ) -> QuantumCircuit
 {
-    auto instream = std::ifstream {filepath};
+    const auto file = ket::internal::MappedFile {filepath};
+    const auto bytes = file.bytes();
 
-    if (!instream.is_open()) {
-        auto err_msg = std::stringstream {};
-        err_msg << "ERROR: unable to read tangelo circuit from : '" << filepath << "'\n";
+    const auto cache_filepath = cache_filepath_(bytes, n_qubits, n_skip_lines, collapse_pauli_rotations, cache_directory, "ketcirc");
+
+    if (auto cached = load_cached_circuit_<QuantumCircuit>(cache_filepath, n_qubits, ket::load_circuit_binary)) {
+        return std::move(*cached);
+    }
+
+    auto circuit = parse_tangelo_text_(n_qubits, ket::internal::text_from_bytes_(bytes), n_skip_lines, std::nullopt, collapse_pauli_rotations);
+    store_cached_circuit_<QuantumCircuit>(cache_filepath, circuit, ket::save_circuit_binary);
+
+    return circuit;
+}
+
+auto read_tangelo_compact_circuit_cached(
+    std::size_t n_qubits,
+    const std::filesystem::path& filepath,
+    std::size_t n_skip_lines,
+    const std::filesystem::path& cache_directory
+) -> CompactCircuit
+{
+    const auto file = ket::internal::MappedFile {filepath};
+    const auto bytes = file.bytes();
+    const auto cache_filepath = cache_filepath_(bytes, n_qubits, n_skip_lines, false, cache_directory, "ketcmpct");
 
-        throw std::ios::failure {err_msg.str()};
+    if (auto cached = load_cached_circuit_<CompactCircuit>(cache_filepath, n_qubits, ket::load_compact_circuit_binary)) {
+        return std::move(*cached);
     }
 
-    return read_tangelo_circuit(n_qubits, instream, n_skip_lines);
+    auto reader = LineReader_ {ket::internal::text_from_bytes_(bytes)};
+    auto circuit = parse_compact_text_(n_qubits, reader, n_skip_lines);
+    store_cached_circuit_<CompactCircuit>(cache_filepath, circuit, ket::save_compact_circuit_binary);
+
+    return circuit;
 }
 
 }  // namespace ket
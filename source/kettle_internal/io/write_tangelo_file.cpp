@@ -14,6 +14,7 @@
 #include "kettle_internal/gates/primitive_gate/gate_id.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_create.hpp"
 #include "kettle_internal/gates/primitive_gate_map.hpp"
+#include "kettle_internal/gates/pauli_rotation_gadget.hpp"
 #include "kettle_internal/io/io_control_flow.hpp"
 #include "kettle_internal/io/write_tangelo_file_internal.hpp"
 
@@ -106,6 +107,30 @@ auto format_cu_gate_(const ket::GateInfo& info, const ket::Matrix2X2& mat) -> st
     return output.str();
 }
 
+/*
+    Tangelo has no gate for a general Pauli rotation, so the PAULI_ROT gate is written out as the
+    primitive gates that it decomposes into.
+*/
+auto format_pauli_rotation_gate_(const ket::GateInfo& info, const std::string& whitespace) -> std::string
+{
+    namespace gid = ket::internal::gate_id;
+
+    auto output = std::stringstream {};
+    for (const auto& decomp_info : decomp_pauli_rotation_gate_(info)) {
+        if (gid::is_one_target_transform_gate(decomp_info.gate)) {
+            output << whitespace << format_one_target_gate_(decomp_info);
+        }
+        else if (gid::is_one_target_one_angle_transform_gate(decomp_info.gate)) {
+            output << whitespace << format_one_target_one_angle_gate_(decomp_info);
+        }
+        else {
+            output << whitespace << format_one_control_one_target_gate_(decomp_info);
+        }
+    }
+
+    return output.str();
+}
+
 }  // namespace ket::internal
 
 
@@ -115,8 +140,6 @@ namespace ket
 /*
     The underlying helper function for `write_tangelo_circuit()`, that takes an output stream `stream`
     as an argument instead of the path to the file.
-
-    MAYBE TODO: change to allow nested control flow?
 */
 void write_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-cognitive-complexity)
     const ket::QuantumCircuit& circuit,
@@ -129,7 +152,9 @@ void write_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-c
     using G = ket::Gate;
 
     const auto whitespace = std::string(n_leading_whitespace, ' ');
-    constexpr auto n_whitespace = ket::internal::CONTROL_FLOW_WHITESPACE_DEFAULT;
+
+    // the subcircuits of control flow statements are indented one level further than the statement
+    const auto n_whitespace = n_leading_whitespace + ket::internal::CONTROL_FLOW_WHITESPACE_DEFAULT;
 
     for (const auto& circuit_element : circuit) {
         if (circuit_element.is_circuit_logger()) {
@@ -141,17 +166,27 @@ void write_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-c
             if (control_flow.is_if_statement()) {
                 const auto& stmt = control_flow.get_if_statement();
                 const auto if_part = io_fmt::format_classical_if_statement_header_(stmt.predicate());
-                stream << if_part << '\n';
+                stream << whitespace << if_part << '\n';
                 write_tangelo_circuit(*stmt.circuit(), stream, n_whitespace);
             }
             else if (control_flow.is_if_else_statement()) {
                 const auto& stmt = control_flow.get_if_else_statement();
                 const auto [if_part, else_part] = io_fmt::format_classical_if_else_statement_header_(stmt.predicate());
-                stream << if_part << '\n';
+                stream << whitespace << if_part << '\n';
                 write_tangelo_circuit(*stmt.if_circuit(), stream, n_whitespace);
-                stream << else_part << '\n';
+                stream << whitespace << else_part << '\n';
                 write_tangelo_circuit(*stmt.else_circuit(), stream, n_whitespace);
             }
+            else if (control_flow.is_repeat_statement()) {
+                const auto& stmt = control_flow.get_repeat_statement();
+                stream << whitespace << io_fmt::format_repeat_statement_header_(stmt.n_repetitions()) << '\n';
+                write_tangelo_circuit(*stmt.circuit(), stream, n_whitespace);
+            }
+            else if (control_flow.is_controlled_block()) {
+                const auto& stmt = control_flow.get_controlled_block();
+                stream << whitespace << io_fmt::format_controlled_block_header_(stmt.control_qubits()) << '\n';
+                write_tangelo_circuit(*stmt.circuit(), stream, n_whitespace);
+            }
             else {
                 throw std::runtime_error {"DEV ERROR: invalid control flow statement encountered for write\n"};
             }
@@ -183,6 +218,9 @@ void write_tangelo_circuit(  // NOLINT(misc-no-recursion, readability-function-c
                 const auto& unitary_ptr = ket::internal::create::unpack_unitary_matrix(gate_info);
                 stream << whitespace << ket::internal::format_cu_gate_(gate_info, *unitary_ptr);
             }
+            else if (gate_info.gate == G::PAULI_ROT) {
+                stream << ket::internal::format_pauli_rotation_gate_(gate_info, whitespace);
+            }
             else {
                 throw std::runtime_error {"DEV ERROR: A gate type with no implemented output has been encountered.\n"};
             }
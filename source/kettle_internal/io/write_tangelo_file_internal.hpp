@@ -27,4 +27,6 @@ auto format_u_gate_(const ket::GateInfo& info, const ket::Matrix2X2& mat) -> std
 
 auto format_cu_gate_(const ket::GateInfo& info, const ket::Matrix2X2& mat) -> std::string;
 
+auto format_pauli_rotation_gate_(const ket::GateInfo& info, const std::string& whitespace) -> std::string;
+
 }  // namespace ket::internal
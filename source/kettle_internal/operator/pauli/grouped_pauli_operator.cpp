@@ -0,0 +1,109 @@
+#include <bit>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "kettle/operator/pauli/grouped_pauli_operator.hpp"
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/operator/pauli/pauli_operator_internal.hpp"
+
+namespace
+{
+
+/*
+    Calculates the sum of `weights[t] * conj(state[i ^ x_mask]) * state[i] * (-1)^(popcount(i & z_masks[t]))`
+    over the indices `i` in `block` and all terms `t` in the group, in a single pass over the amplitudes.
+*/
+auto group_expectation_value_(
+    const ket::PauliTermGroup& group,
+    const ket::QuantumState& state,
+    const ket::internal::FlatIndexPair& block
+) -> std::complex<double>
+{
+    const auto n_terms = group.z_masks.size();
+    auto sums = std::vector<std::complex<double>>(n_terms, std::complex<double> {});
+
+    for (auto i {block.i_lower}; i < block.i_upper; ++i) {
+        const auto product = std::conj(state[i ^ group.x_mask]) * state[i];
+
+        for (std::size_t i_term {0}; i_term < n_terms; ++i_term) {
+            if ((std::popcount(i & group.z_masks[i_term]) & 1) == 0) {
+                sums[i_term] += product;
+            }
+            else {
+                sums[i_term] -= product;
+            }
+        }
+    }
+
+    auto expval = std::complex<double> {};
+    for (std::size_t i_term {0}; i_term < n_terms; ++i_term) {
+        expval += group.weights[i_term] * sums[i_term];
+    }
+
+    return expval;
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+GroupedPauliOperator::GroupedPauliOperator(const PauliOperator& pauli_op)
+    : n_qubits_ {pauli_op.n_qubits()}
+    , n_terms_ {pauli_op.size()}
+{
+    namespace ki = ket::internal;
+
+    // the groups are kept in the order in which their X-masks first appear in the operator
+    auto group_indices = std::unordered_map<std::size_t, std::size_t> {};
+
+    for (const auto& [coeff, pauli_string] : pauli_op.weighted_pauli_strings()) {
+        const auto [x_mask, z_mask, phase] = ki::pauli_string_masks_(pauli_string);
+
+        const auto [it, is_new_group] = group_indices.try_emplace(x_mask, groups_.size());
+        if (is_new_group) {
+            groups_.push_back({.x_mask=x_mask, .z_masks={}, .weights={}});
+        }
+
+        auto& group = groups_[it->second];
+        group.z_masks.push_back(z_mask);
+        group.weights.push_back(coeff * phase);
+    }
+}
+
+auto expectation_value(const GroupedPauliOperator& grouped_op, const QuantumState& state) -> std::complex<double>
+{
+    if (grouped_op.n_qubits() != state.n_qubits()) {
+        throw std::runtime_error {
+            "ERROR: cannot take expectation value; GroupedPauliOperator and state have different number of qubits.\n"
+        };
+    }
+
+    namespace ki = ket::internal;
+
+    const auto& groups = grouped_op.groups();
+    const auto n_states = state.n_states();
+
+    const auto chunk_value = [&](std::size_t i_group, const ki::FlatIndexPair& chunk) {
+        return group_expectation_value_(groups[i_group], state, chunk);
+    };
+
+    const auto n_threads = ki::default_number_of_threads_(grouped_op.n_terms() * n_states);
+    const auto group_sums = ki::chunked_item_sums_(groups.size(), n_states, n_threads, chunk_value);
+
+    // the groups are always added in the same order, so the result does not depend on the number of threads
+    auto expval = std::complex<double> {};
+    for (const auto& group_sum : group_sums) {
+        expval += group_sum;
+    }
+
+    return expval;
+}
+
+}  // namespace ket
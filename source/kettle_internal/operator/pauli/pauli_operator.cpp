@@ -1,18 +1,59 @@
 #include <algorithm>
+#include <bit>
 #include <complex>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "kettle/common/mathtools.hpp"
 #include "kettle/operator/pauli/pauli_operator.hpp"
 #include "kettle/operator/pauli/sparse_pauli_string.hpp"
-#include "kettle/simulation/simulate_pauli.hpp"
 #include "kettle/state/state.hpp"
 
+#include "kettle_internal/operator/pauli/pauli_operator_internal.hpp"
+#include "kettle_internal/simulation/simulate_utils.hpp"
+
 /*
     This file contains the `PauliOperator` class for 
 */
 
+namespace
+{
+
+/*
+    The X-mask words followed by the Z-mask words of a Pauli string; two Pauli strings with the
+    same number of qubits are equal up to phase exactly when their keys are equal.
+*/
+using PauliMaskKey_ = std::vector<std::uint64_t>;
+
+auto pauli_mask_key_(const ket::SparsePauliString& pauli_string) -> PauliMaskKey_
+{
+    auto key = pauli_string.x_mask();
+    key.insert(key.end(), pauli_string.z_mask().begin(), pauli_string.z_mask().end());
+
+    return key;
+}
+
+struct PauliMaskKeyHash_
+{
+    auto operator()(const PauliMaskKey_& key) const noexcept -> std::size_t
+    {
+        // the same mixing step as boost::hash_combine
+        auto seed = std::size_t {key.size()};
+        for (auto word : key) {
+            seed ^= static_cast<std::size_t>(word) + 0x9e3779b97f4a7c15UL + (seed << 6) + (seed >> 2);
+        }
+
+        return seed;
+    }
+};
+
+}  // namespace
+
 namespace ket
 {
 
@@ -72,19 +113,86 @@ void PauliOperator::remove(std::size_t index)
     weighted_pauli_strings_.erase(std::next(weighted_pauli_strings_.begin(), position));
 }
 
+auto PauliOperator::simplify(double tolerance) -> std::size_t
+{
+    const auto original_size = weighted_pauli_strings_.size();
+
+    // combine the terms with the same Pauli string, with the phases folded into the coefficients
+    auto merged = std::vector<std::pair<PauliMaskKey_, std::complex<double>>> {};
+    auto merged_indices = std::unordered_map<PauliMaskKey_, std::size_t, PauliMaskKeyHash_> {};
+
+    for (const auto& [coeff, pauli_string] : weighted_pauli_strings_) {
+        if (pauli_string.n_qubits() != n_qubits_) {
+            throw std::runtime_error {"ERROR: cannot simplify a PauliOperator with terms of different numbers of qubits.\n"};
+        }
+
+        auto key = pauli_mask_key_(pauli_string);
+        const auto phased_coeff = coeff * PAULI_PHASE_MAP.at(pauli_string.phase());
+
+        const auto [it, is_new] = merged_indices.try_emplace(key, merged.size());
+        if (is_new) {
+            merged.emplace_back(std::move(key), phased_coeff);
+        }
+        else {
+            merged[it->second].second += phased_coeff;
+        }
+    }
+
+    std::erase_if(merged, [&](const auto& pair) { return std::abs(pair.second) <= tolerance; });
+
+    // the keys hold the X-mask words first, so this sorts by X-mask and then by Z-mask
+    std::ranges::sort(merged, [](const auto& left, const auto& right) { return left.first < right.first; });
+
+    // rebuild the Pauli strings from the masks, which also removes any stored identity terms
+    auto simplified = std::vector<WeightedPauliString> {};
+    simplified.reserve(merged.size());
+
+    for (const auto& [key, coeff] : merged) {
+        const auto middle = std::next(key.begin(), static_cast<std::ptrdiff_t>(key.size() / 2));
+        const auto x_mask = std::vector<std::uint64_t> {key.begin(), middle};
+        const auto z_mask = std::vector<std::uint64_t> {middle, key.end()};
+
+        simplified.emplace_back(coeff, pauli_string_from_masks(x_mask, z_mask, n_qubits_));
+    }
+
+    weighted_pauli_strings_ = std::move(simplified);
+
+    return original_size - weighted_pauli_strings_.size();
+}
+
 
 auto expectation_value(const PauliOperator& pauli_op, const QuantumState& state) -> std::complex<double>
 {
-    auto expval = std::complex<double> {};
+    namespace ki = ket::internal;
 
-    for (const auto& [coeff, sparse_pauli_string] : pauli_op.weighted_pauli_strings()) {
-        auto ket = state;
-        simulate(sparse_pauli_string, ket);
+    const auto& weighted_strings = pauli_op.weighted_pauli_strings();
+    const auto n_terms = weighted_strings.size();
+    const auto n_states = state.n_states();
 
-        const auto inner_prod = inner_product(state, ket);
-        const auto phase = PAULI_PHASE_MAP.at(sparse_pauli_string.phase());
+    auto term_masks = std::vector<ki::PauliStringMasks> {};
+    term_masks.reserve(n_terms);
 
-        expval += (coeff * phase * inner_prod);
+    for (const auto& [coeff, sparse_pauli_string] : weighted_strings) {
+        if (sparse_pauli_string.n_qubits() != state.n_qubits()) {
+            throw std::runtime_error {
+                "ERROR: cannot take expectation value; SparsePauliString and state have different number of qubits.\n"
+            };
+        }
+
+        term_masks.push_back(ki::pauli_string_masks_(sparse_pauli_string));
+    }
+
+    const auto chunk_value = [&](std::size_t i_term, const ki::FlatIndexPair& chunk) {
+        return ki::masked_expectation_sum_(state, term_masks[i_term].x_mask, term_masks[i_term].z_mask, chunk);
+    };
+
+    const auto n_threads = ki::default_number_of_threads_(n_terms * n_states);
+    const auto term_sums = ki::chunked_item_sums_(n_terms, n_states, n_threads, chunk_value);
+
+    // the terms are always added in the same order, so the result does not depend on the number of threads
+    auto expval = std::complex<double> {};
+    for (std::size_t i_term {0}; i_term < n_terms; ++i_term) {
+        expval += weighted_strings[i_term].coefficient * term_masks[i_term].phase * term_sums[i_term];
     }
 
     return expval;
@@ -93,15 +201,24 @@ auto expectation_value(const PauliOperator& pauli_op, const QuantumState& state)
 
 auto expectation_value(const SparsePauliString& sparse_pauli_string, const QuantumState& state) -> std::complex<double>
 {
-    auto ket = state;
-    simulate(sparse_pauli_string, ket);
+    namespace ki = ket::internal;
+
+    if (sparse_pauli_string.n_qubits() != state.n_qubits()) {
+        throw std::runtime_error {
+            "ERROR: cannot take expectation value; SparsePauliString and state have different number of qubits.\n"
+        };
+    }
+
+    const auto [x_mask, z_mask, phase] = ki::pauli_string_masks_(sparse_pauli_string);
 
-    const auto inner_prod = inner_product(state, ket);
-    const auto phase = PAULI_PHASE_MAP.at(sparse_pauli_string.phase());
+    const auto chunk_value = [&](std::size_t, const ki::FlatIndexPair& chunk) {
+        return ki::masked_expectation_sum_(state, x_mask, z_mask, chunk);
+    };
 
-    const auto expval = phase * inner_prod;
+    const auto n_threads = ki::default_number_of_threads_(state.n_states());
+    const auto sums = ki::chunked_item_sums_(1, state.n_states(), n_threads, chunk_value);
 
-    return expval;
+    return phase * sums[0];
 }
 
 auto almost_eq(
@@ -135,3 +252,51 @@ auto almost_eq(
 }
 
 }  // namespace ket
+
+namespace ket::internal
+{
+
+auto pauli_string_masks_(const ket::SparsePauliString& pauli_string) -> PauliStringMasks
+{
+    // any state that can be simulated has fewer than 64 qubits, so only the first word of each mask is needed
+    const auto x_mask = static_cast<std::size_t>(pauli_string.x_mask()[0]);
+    const auto z_mask = static_cast<std::size_t>(pauli_string.z_mask()[0]);
+    const auto n_y_terms = static_cast<std::size_t>(std::popcount(x_mask & z_mask));
+
+    // the `PauliPhase` enumerators are ordered as increasing powers of i
+    const auto power_of_i = (static_cast<std::size_t>(pauli_string.phase()) + n_y_terms) % 4;
+    const auto phase = ket::PAULI_PHASE_MAP.at(static_cast<ket::PauliPhase>(power_of_i));
+
+    return {.x_mask=x_mask, .z_mask=z_mask, .phase=phase};
+}
+
+auto masked_expectation_sum_(
+    const ket::QuantumState& state,
+    std::size_t x_mask,
+    std::size_t z_mask,
+    const FlatIndexPair& block
+) -> std::complex<double>
+{
+    // the sums for the positive and negative signs are kept separate, to avoid a multiplication
+    auto sum_plus = std::complex<double> {};
+    auto sum_minus = std::complex<double> {};
+
+    if (x_mask == 0) {
+        for (auto i {block.i_lower}; i < block.i_upper; ++i) {
+            const auto prob = std::norm(state[i]);
+            auto& sum = (std::popcount(i & z_mask) & 1) == 0 ? sum_plus : sum_minus;
+            sum += prob;
+        }
+    }
+    else {
+        for (auto i {block.i_lower}; i < block.i_upper; ++i) {
+            const auto product = std::conj(state[i ^ x_mask]) * state[i];
+            auto& sum = (std::popcount(i & z_mask) & 1) == 0 ? sum_plus : sum_minus;
+            sum += product;
+        }
+    }
+
+    return sum_plus - sum_minus;
+}
+
+}  // namespace ket::internal
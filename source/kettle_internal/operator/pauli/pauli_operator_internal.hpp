@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
+#include "kettle_internal/simulation/simulate_utils.hpp"
+
+/*
+    A Pauli string P acts on a computational basis state |j> as
+
+        P|j> = phase * i^(n_Y) * (-1)^(popcount(j & z_mask)) |j ^ x_mask>
+
+    where `x_mask` holds the qubits with an X or Y term, `z_mask` holds the qubits with a Z or Y term,
+    and `n_Y` is the number of Y terms (using Y = iXZ). This lets us work with the amplitudes of a state
+    directly, without having to apply each term of the Pauli string one at a time.
+*/
+
+namespace ket::internal
+{
+
+struct PauliStringMasks
+{
+    std::size_t x_mask;
+    std::size_t z_mask;
+    std::complex<double> phase;  // includes both the phase of the Pauli string, and the i^(n_Y) factor
+};
+
+auto pauli_string_masks_(const ket::SparsePauliString& pauli_string) -> PauliStringMasks;
+
+/*
+    Calculates the sum of `conj(state[i ^ x_mask]) * state[i] * (-1)^(popcount(i & z_mask))` over the indices
+    `i` in the half-open range [block.i_lower, block.i_upper), in a single read-only pass.
+*/
+auto masked_expectation_sum_(
+    const ket::QuantumState& state,
+    std::size_t x_mask,
+    std::size_t z_mask,
+    const FlatIndexPair& block
+) -> std::complex<double>;
+
+/*
+    The amplitudes of the state are split into chunks of this size when calculating expectation values;
+    the chunk boundaries never depend on the number of threads.
+*/
+constexpr inline auto EXPECTATION_VALUE_CHUNK_SIZE_ = std::size_t {1UL << 14};
+
+/*
+    Calculates `chunk_value(i_item, chunk)` for each of the `n_items` items and each of the fixed-size chunks
+    of [0, n_states), and returns the sum over the chunks for each item.
+
+    Each chunk value is calculated in the same way no matter how the work is split up, and the chunk values
+    of an item are always added in the order of the chunks; so the output does not change with `n_threads`.
+    When there are enough items, each thread handles whole items; otherwise, the items are processed one at
+    a time, with the threads splitting up the chunks.
+*/
+template <typename ChunkValue>
+auto chunked_item_sums_(
+    std::size_t n_items,
+    std::size_t n_states,
+    std::size_t n_threads,
+    const ChunkValue& chunk_value
+) -> std::vector<std::complex<double>>
+{
+    const auto n_chunks = (n_states + EXPECTATION_VALUE_CHUNK_SIZE_ - 1) / EXPECTATION_VALUE_CHUNK_SIZE_;
+    const auto chunk = [n_states](std::size_t i_chunk) {
+        const auto i_lower = i_chunk * EXPECTATION_VALUE_CHUNK_SIZE_;
+        const auto i_upper = std::min(i_lower + EXPECTATION_VALUE_CHUNK_SIZE_, n_states);
+        return FlatIndexPair {.i_lower=i_lower, .i_upper=i_upper};
+    };
+
+    auto item_sums = std::vector<std::complex<double>>(n_items, std::complex<double> {});
+
+    if (n_items >= n_threads || n_chunks < n_threads) {
+        parallel_for_(n_items, std::min(n_threads, n_items), [&](const FlatIndexPair& items, [[maybe_unused]] std::size_t i_thread) {
+            for (auto i_item {items.i_lower}; i_item < items.i_upper; ++i_item) {
+                for (std::size_t i_chunk {0}; i_chunk < n_chunks; ++i_chunk) {
+                    item_sums[i_item] += chunk_value(i_item, chunk(i_chunk));
+                }
+            }
+        });
+    }
+    else {
+        auto chunk_values = std::vector<std::complex<double>>(n_chunks);
+
+        for (std::size_t i_item {0}; i_item < n_items; ++i_item) {
+            parallel_for_(n_chunks, n_threads, [&](const FlatIndexPair& chunks, [[maybe_unused]] std::size_t i_thread) {
+                for (auto i_chunk {chunks.i_lower}; i_chunk < chunks.i_upper; ++i_chunk) {
+                    chunk_values[i_chunk] = chunk_value(i_item, chunk(i_chunk));
+                }
+            });
+
+            for (std::size_t i_chunk {0}; i_chunk < n_chunks; ++i_chunk) {
+                item_sums[i_item] += chunk_values[i_chunk];
+            }
+        }
+    }
+
+    return item_sums;
+}
+
+}  // namespace ket::internal
@@ -1,7 +1,10 @@
 #include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "kettle/operator/pauli/sparse_pauli_string.hpp"
@@ -9,20 +12,43 @@
 namespace
 {
 
-using PauliIndexedTerms = std::vector<std::pair<std::size_t, ket::PauliTerm>>;
+constexpr auto MASK_WORD_BITS_ = std::size_t {64};
 
-auto sorted_non_identity_paulis_(const PauliIndexedTerms& pauli_indexed_terms) -> PauliIndexedTerms
+constexpr auto n_mask_words_(std::size_t n_qubits) -> std::size_t
 {
-    auto output = PauliIndexedTerms {};
-    for (const auto& elem : pauli_indexed_terms) {
-        if (elem.second != ket::PauliTerm::I) {
-            output.emplace_back(elem);
-        }
-    }
+    return (n_qubits + MASK_WORD_BITS_ - 1) / MASK_WORD_BITS_;
+}
+
+constexpr auto mask_word_index_(std::size_t qubit_index) -> std::size_t
+{
+    return qubit_index / MASK_WORD_BITS_;
+}
+
+constexpr auto mask_word_bit_(std::size_t qubit_index) -> std::uint64_t
+{
+    return std::uint64_t {1} << (qubit_index % MASK_WORD_BITS_);
+}
 
-    std::ranges::sort(output, [](const auto& left, const auto& right) { return left.first < right.first; });
+/*
+    The Pauli term at bit `bit` of the given X-mask and Z-mask words, using Y = iXZ.
+*/
+constexpr auto term_from_mask_words_(std::uint64_t x_word, std::uint64_t z_word, std::uint64_t bit) -> ket::PauliTerm
+{
+    const auto has_x = (x_word & bit) != 0;
+    const auto has_z = (z_word & bit) != 0;
 
-    return output;
+    if (has_x && has_z) {
+        return ket::PauliTerm::Y;
+    }
+    else if (has_x) {
+        return ket::PauliTerm::X;
+    }
+    else if (has_z) {
+        return ket::PauliTerm::Z;
+    }
+    else {
+        return ket::PauliTerm::I;
+    }
 }
 
 }  // namespace
@@ -35,6 +61,7 @@ SparsePauliString::SparsePauliString(std::size_t n_qubits, PauliPhase phase)
     , phase_ {phase}
 {
     check_n_qubits_not_zero_();
+    build_masks_();
 }
 
 SparsePauliString::SparsePauliString(
@@ -47,6 +74,7 @@ SparsePauliString::SparsePauliString(
     , pauli_indexed_terms_ {std::move(pauli_indexed_terms)}
 {
     check_n_qubits_not_zero_();
+    build_masks_();
 }
 
 SparsePauliString::SparsePauliString(
@@ -61,6 +89,8 @@ SparsePauliString::SparsePauliString(
     for (std::size_t i {0}; i < pauli_terms.size(); ++i) {
         pauli_indexed_terms_.emplace_back(i, pauli_terms[i]);
     }
+
+    build_masks_();
 }
 
 SparsePauliString::SparsePauliString(
@@ -96,6 +126,7 @@ void SparsePauliString::add(std::size_t qubit_index, PauliTerm term)
     }
 
     pauli_indexed_terms_.emplace_back(qubit_index, term);
+    set_mask_bits_(qubit_index, term);
 }
 
 void SparsePauliString::overwrite(std::size_t qubit_index, PauliTerm term)
@@ -109,6 +140,8 @@ void SparsePauliString::overwrite(std::size_t qubit_index, PauliTerm term)
     } else {
         pauli_indexed_terms_.emplace_back(qubit_index, term);
     }
+
+    set_mask_bits_(qubit_index, term);
 }
 
 void SparsePauliString::remove(std::size_t qubit_index)
@@ -118,6 +151,7 @@ void SparsePauliString::remove(std::size_t qubit_index)
     if (vector_index) {
         const auto position = static_cast<std::ptrdiff_t>(vector_index.value());
         pauli_indexed_terms_.erase(std::next(pauli_indexed_terms_.begin(), position));
+        set_mask_bits_(qubit_index, PauliTerm::I);
     }
 }
 
@@ -162,6 +196,58 @@ void SparsePauliString::check_n_qubits_not_zero_() const
     }
 }
 
+void SparsePauliString::set_mask_bits_(std::size_t qubit_index, PauliTerm term) noexcept
+{
+    const auto i_word = mask_word_index_(qubit_index);
+    const auto bit = mask_word_bit_(qubit_index);
+
+    x_mask_[i_word] &= ~bit;
+    z_mask_[i_word] &= ~bit;
+
+    if (term == PauliTerm::X || term == PauliTerm::Y) {
+        x_mask_[i_word] |= bit;
+    }
+
+    if (term == PauliTerm::Z || term == PauliTerm::Y) {
+        z_mask_[i_word] |= bit;
+    }
+}
+
+void SparsePauliString::build_masks_()
+{
+    x_mask_.assign(n_mask_words_(n_qubits_), 0);
+    z_mask_.assign(n_mask_words_(n_qubits_), 0);
+
+    auto is_seen = std::vector<bool>(n_qubits_, false);
+
+    for (const auto& [qubit_index, term] : pauli_indexed_terms_) {
+        check_index_in_qubit_range_(qubit_index);
+
+        if (is_seen[qubit_index]) {
+            throw std::runtime_error {"ERROR: SparsePauliString cannot have more than one term on the same qubit.\n"};
+        }
+
+        is_seen[qubit_index] = true;
+        set_mask_bits_(qubit_index, term);
+    }
+}
+
+auto SparsePauliString::commutes_with(const SparsePauliString& other) const -> bool
+{
+    if (n_qubits_ != other.n_qubits_) {
+        throw std::runtime_error {"ERROR: cannot check commutation of SparsePauliStrings with different numbers of qubits.\n"};
+    }
+
+    // two single-qubit Pauli terms anticommute exactly when they are different and neither is I
+    auto n_anticommuting = std::size_t {0};
+    for (std::size_t i_word {0}; i_word < x_mask_.size(); ++i_word) {
+        const auto symplectic = (x_mask_[i_word] & other.z_mask_[i_word]) ^ (z_mask_[i_word] & other.x_mask_[i_word]);
+        n_anticommuting += static_cast<std::size_t>(std::popcount(symplectic));
+    }
+
+    return n_anticommuting % 2 == 0;
+}
+
 auto SparsePauliString::equal_up_to_phase(const SparsePauliString& other) const -> bool
 {
     if (n_qubits_ != other.n_qubits_) {
@@ -170,12 +256,9 @@ auto SparsePauliString::equal_up_to_phase(const SparsePauliString& other) const
 
     // NOTE: this object can store identity operators, which don't do anything and do not affect
     // whether one SparsePauliString is equal to another, but it does change the size; thus we
-    // cannot use the size as a comparison tool
+    // cannot use the size as a comparison tool; the masks only hold the non-identity terms
 
-    const auto left = sorted_non_identity_paulis_(pauli_indexed_terms_);
-    const auto right = sorted_non_identity_paulis_(other.pauli_indexed_terms_);
-
-    return left == right;
+    return x_mask_ == other.x_mask_ && z_mask_ == other.z_mask_;
 }
 
 auto operator==(const SparsePauliString& left, const SparsePauliString& right) -> bool
@@ -187,4 +270,67 @@ auto operator==(const SparsePauliString& left, const SparsePauliString& right) -
     return left.equal_up_to_phase(right);
 }
 
+auto pauli_string_from_masks(
+    const std::vector<std::uint64_t>& x_mask,
+    const std::vector<std::uint64_t>& z_mask,
+    std::size_t n_qubits,
+    PauliPhase phase
+) -> SparsePauliString
+{
+    const auto n_words = n_mask_words_(n_qubits);
+    if (x_mask.size() != n_words || z_mask.size() != n_words) {
+        throw std::runtime_error {"ERROR: the masks have the wrong number of words for a SparsePauliString.\n"};
+    }
+
+    auto terms = std::vector<std::pair<std::size_t, PauliTerm>> {};
+
+    for (std::size_t i_word {0}; i_word < n_words; ++i_word) {
+        auto nonidentity = x_mask[i_word] | z_mask[i_word];
+        while (nonidentity != 0) {
+            const auto i_bit = static_cast<std::size_t>(std::countr_zero(nonidentity));
+            const auto bit = std::uint64_t {1} << i_bit;
+            const auto qubit_index = (i_word * MASK_WORD_BITS_) + i_bit;
+
+            terms.emplace_back(qubit_index, term_from_mask_words_(x_mask[i_word], z_mask[i_word], bit));
+            nonidentity ^= bit;
+        }
+    }
+
+    return SparsePauliString {std::move(terms), n_qubits, phase};
+}
+
+auto operator*(const SparsePauliString& left, const SparsePauliString& right) -> SparsePauliString
+{
+    if (left.n_qubits() != right.n_qubits()) {
+        throw std::runtime_error {"ERROR: cannot multiply SparsePauliStrings with different numbers of qubits.\n"};
+    }
+
+    // with each single-qubit term written as i^(xz) X^x Z^z, moving Z^(z_left) past X^(x_right) gives a
+    // factor of (-1)^(z_left x_right), and the output term absorbs a factor of i^(x_out z_out); so the
+    // overall power of i is (x_left z_left) + (x_right z_right) - (x_out z_out) + 2 (z_left x_right)
+    const auto& x_left = left.x_mask();
+    const auto& z_left = left.z_mask();
+    const auto& x_right = right.x_mask();
+    const auto& z_right = right.z_mask();
+
+    auto power_of_i = static_cast<std::size_t>(left.phase()) + static_cast<std::size_t>(right.phase());
+    auto x_out = std::vector<std::uint64_t>(x_left.size());
+    auto z_out = std::vector<std::uint64_t>(x_left.size());
+
+    for (std::size_t i_word {0}; i_word < x_left.size(); ++i_word) {
+        x_out[i_word] = x_left[i_word] ^ x_right[i_word];
+        z_out[i_word] = z_left[i_word] ^ z_right[i_word];
+
+        power_of_i += static_cast<std::size_t>(std::popcount(x_left[i_word] & z_left[i_word]));
+        power_of_i += static_cast<std::size_t>(std::popcount(x_right[i_word] & z_right[i_word]));
+        power_of_i += 3 * static_cast<std::size_t>(std::popcount(x_out[i_word] & z_out[i_word]));  // -1 == 3 (mod 4)
+        power_of_i += 2 * static_cast<std::size_t>(std::popcount(z_left[i_word] & x_right[i_word]));
+    }
+
+    // the enumerators of `PauliPhase` are ordered as increasing powers of i
+    const auto phase = static_cast<PauliPhase>(power_of_i % 4);
+
+    return pauli_string_from_masks(x_out, z_out, left.n_qubits(), phase);
+}
+
 }  // namespace ket
@@ -0,0 +1,362 @@
+#include <bit>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/clone_ptr.hpp"
+#include "kettle/common/matrix2x2.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/optimize/adjoint_gradient.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+#include "kettle_internal/operator/pauli/pauli_operator_internal.hpp"
+#include "kettle_internal/parameter/parameter_expression_internal.hpp"
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
+#include "kettle_internal/simulation/simulate_internal.hpp"
+#include "kettle_internal/simulation/simulate_utils.hpp"
+
+
+namespace ki = ket::internal;
+namespace kp = ket::param;
+namespace kpi = ket::param::internal;
+
+namespace
+{
+
+/*
+    Each parameterized gate U(theta) satisfies dU/dtheta = -i (coefficient / 2) G U(theta), where the
+    Hermitian generator G is a product of a projector onto the control qubits being |1> and a Pauli
+    string; the Pauli string maps |j> to `phase * (-1)^(popcount(j & z_mask)) |j ^ x_mask>`.
+
+    For example, RX(theta) = exp(-i theta X / 2) has a coefficient of 1 and G = X, while
+    P(theta) = exp(i theta |1><1|) has a coefficient of -2 and G = |1><1|.
+*/
+struct GateGenerator_
+{
+    double coefficient;
+    std::size_t control_mask;
+    std::size_t x_mask;
+    std::size_t z_mask;
+    std::complex<double> phase;
+};
+
+auto single_qubit_generator_(ket::Gate gate, std::size_t target, std::size_t control_mask) -> GateGenerator_
+{
+    using G = ket::Gate;
+
+    const auto target_mask = std::size_t {1} << target;
+
+    switch (gate) {
+        case G::RX : {
+            return {.coefficient=1.0, .control_mask=control_mask, .x_mask=target_mask, .z_mask=0, .phase={1.0, 0.0}};
+        }
+        case G::RY : {
+            // Y = iXZ
+            return {.coefficient=1.0, .control_mask=control_mask, .x_mask=target_mask, .z_mask=target_mask, .phase={0.0, 1.0}};
+        }
+        case G::RZ : {
+            return {.coefficient=1.0, .control_mask=control_mask, .x_mask=0, .z_mask=target_mask, .phase={1.0, 0.0}};
+        }
+        case G::P : {
+            return {.coefficient=-2.0, .control_mask=control_mask | target_mask, .x_mask=0, .z_mask=0, .phase={1.0, 0.0}};
+        }
+        default : {
+            throw std::runtime_error {"DEV ERROR: invalid angle gate found in `single_qubit_generator_()`\n"};
+        }
+    }
+}
+
+auto gate_generator_(const ket::GateInfo& info) -> GateGenerator_
+{
+    namespace cre = ki::create;
+    namespace gid = ki::gate_id;
+    using G = ket::Gate;
+
+    if (gid::is_1t1a_gate(info.gate)) {
+        const auto target = cre::unpack_single_qubit_gate_index(info);
+        return single_qubit_generator_(info.gate, target, 0);
+    }
+    else if (gid::is_1c1t1a_gate(info.gate)) {
+        const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+        const auto control_mask = std::size_t {1} << control;
+
+        switch (info.gate) {
+            case G::CRX : return single_qubit_generator_(G::RX, target, control_mask);
+            case G::CRY : return single_qubit_generator_(G::RY, target, control_mask);
+            case G::CRZ : return single_qubit_generator_(G::RZ, target, control_mask);
+            default     : return single_qubit_generator_(G::P, target, control_mask);
+        }
+    }
+    else if (info.gate == G::PAULI_ROT) {
+        const auto masks = ki::pauli_string_masks_(*info.pauli_string_ptr);
+        return {.coefficient=1.0, .control_mask=0, .x_mask=masks.x_mask, .z_mask=masks.z_mask, .phase=masks.phase};
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: invalid parameterized gate found in `gate_generator_()`\n"};
+    }
+}
+
+/*
+    Calculates <left| G |right> for the generator G, in a single read-only pass over both states.
+*/
+auto generator_overlap_(
+    const ket::QuantumState& left,
+    const GateGenerator_& generator,
+    const ket::QuantumState& right
+) -> std::complex<double>
+{
+    const auto [coefficient, control_mask, x_mask, z_mask, phase] = generator;
+
+    const auto chunk_value = [&]([[maybe_unused]] std::size_t i_item, const ki::FlatIndexPair& chunk) {
+        auto sum = std::complex<double> {};
+        for (auto i {chunk.i_lower}; i < chunk.i_upper; ++i) {
+            if ((i & control_mask) != control_mask) {
+                continue;
+            }
+
+            const auto product = std::conj(left[i ^ x_mask]) * right[i];
+            sum += (std::popcount(i & z_mask) & 1) == 0 ? product : -product;
+        }
+
+        return sum;
+    };
+
+    const auto n_states = right.n_states();
+    const auto n_threads = ki::default_number_of_threads_(n_states);
+    const auto sums = ki::chunked_item_sums_(1, n_states, n_threads, chunk_value);
+
+    return phase * sums[0];
+}
+
+/*
+    Calculates pauli_op |state>, applying each term of the operator in a single pass.
+
+    The output is generally not normalized, so it is created by overwriting a copy of `state` rather
+    than through the constructor of `QuantumState`.
+*/
+auto apply_pauli_operator_(const ket::PauliOperator& pauli_op, const ket::QuantumState& state) -> ket::QuantumState
+{
+    const auto n_states = state.n_states();
+    const auto n_threads = ki::default_number_of_threads_(n_states);
+
+    auto output = state;
+    for (std::size_t i {0}; i < n_states; ++i) {
+        output[i] = std::complex<double> {};
+    }
+
+    for (const auto& [coefficient, pauli_string] : pauli_op.weighted_pauli_strings()) {
+        const auto [x_mask, z_mask, phase] = ki::pauli_string_masks_(pauli_string);
+        const auto factor = coefficient * phase;
+
+        // each output index i ^ x_mask is written to by exactly one input index i
+        ki::parallel_for_(n_states, n_threads, [&](const ki::FlatIndexPair& block, [[maybe_unused]] std::size_t i_thread) {
+            for (auto i {block.i_lower}; i < block.i_upper; ++i) {
+                const auto term = factor * state[i];
+                output[i ^ x_mask] += (std::popcount(i & z_mask) & 1) == 0 ? term : -term;
+            }
+        });
+    }
+
+    return output;
+}
+
+/*
+    Creates the inverse of a gate; the angles of parameterized gates are evaluated and fixed.
+*/
+auto inverse_gate_(  // NOLINT(readability-function-cognitive-complexity)
+    const kpi::MapVariant& parameter_values_map,
+    const ket::GateInfo& info
+) -> ket::GateInfo
+{
+    namespace cre = ki::create;
+    namespace gid = ki::gate_id;
+    using G = ket::Gate;
+
+    const auto inverse_of = [](G gate) {
+        switch (gate) {
+            case G::S      : return G::SDAG;
+            case G::SDAG   : return G::S;
+            case G::T      : return G::TDAG;
+            case G::TDAG   : return G::T;
+            case G::SX     : return G::SXDAG;
+            case G::SXDAG  : return G::SX;
+            case G::CS     : return G::CSDAG;
+            case G::CSDAG  : return G::CS;
+            case G::CT     : return G::CTDAG;
+            case G::CTDAG  : return G::CT;
+            case G::CSX    : return G::CSXDAG;
+            case G::CSXDAG : return G::CSX;
+            default        : return gate;  // H, X, Y, Z and their controlled versions are their own inverses
+        }
+    };
+
+    if (gid::is_1t_gate(info.gate)) {
+        return cre::create_one_target_gate(inverse_of(info.gate), cre::unpack_one_target_gate(info));
+    }
+    else if (gid::is_1c1t_gate(info.gate)) {
+        const auto [control, target] = cre::unpack_one_control_one_target_gate(info);
+        return cre::create_one_control_one_target_gate(inverse_of(info.gate), control, target);
+    }
+    else if (gid::is_1t1a_gate(info.gate)) {
+        const auto [target, angle] = kpi::unpack_target_and_angle(parameter_values_map, info);
+        return cre::create_one_target_one_angle_gate(info.gate, target, -angle);
+    }
+    else if (gid::is_1c1t1a_gate(info.gate)) {
+        const auto [control, target, angle] = kpi::unpack_control_target_and_angle(parameter_values_map, info);
+        return cre::create_one_control_one_target_one_angle_gate(info.gate, control, target, -angle);
+    }
+    else if (info.gate == G::U) {
+        const auto& [target, unitary_ptr] = cre::unpack_u_gate(info);
+        return cre::create_u_gate(target, ket::ClonePtr<ket::Matrix2X2> {ket::conjugate_transpose(*unitary_ptr)});
+    }
+    else if (info.gate == G::CU) {
+        const auto& [control, target, unitary_ptr] = cre::unpack_cu_gate(info);
+        return cre::create_cu_gate(control, target, ket::ClonePtr<ket::Matrix2X2> {ket::conjugate_transpose(*unitary_ptr)});
+    }
+    else if (info.gate == G::PAULI_ROT) {
+        const auto angle = kpi::unpack_pauli_rotation_angle(parameter_values_map, info);
+        return cre::create_pauli_rotation_gate(info.pauli_string_ptr, -angle);
+    }
+    else {
+        throw std::runtime_error {"ERROR: cannot calculate adjoint gradient of a circuit with measurement gates.\n"};
+    }
+}
+
+/*
+    Collects the gates of the circuit, in order; the adjoint method needs to walk through the gates
+    in reverse, which is not possible with classical control flow.
+*/
+auto collect_gates_(const ket::QuantumCircuit& circuit) -> std::vector<const ket::GateInfo*>
+{
+    auto gates = std::vector<const ket::GateInfo*> {};
+    gates.reserve(circuit.n_circuit_elements());
+
+    for (const auto& element : circuit) {
+        if (element.is_circuit_logger()) {
+            continue;
+        }
+        else if (element.is_control_flow()) {
+            throw std::runtime_error {"ERROR: cannot calculate adjoint gradient of a circuit with control flow.\n"};
+        }
+        else if (element.is_gate()) {
+            if (element.get_gate().gate == ket::Gate::M) {
+                throw std::runtime_error {"ERROR: cannot calculate adjoint gradient of a circuit with measurement gates.\n"};
+            }
+
+            gates.push_back(&element.get_gate());
+        }
+        else {
+            throw std::runtime_error {"DEV ERROR: invalid circuit element found in `adjoint_gradient()`\n"};
+        }
+    }
+
+    return gates;
+}
+
+void check_valid_inputs_(
+    const ket::QuantumCircuit& circuit,
+    const std::vector<kp::ParameterID>& parameter_ids,
+    const ket::PauliOperator& pauli_op,
+    const ket::QuantumState& initial_state
+)
+{
+    if (circuit.n_qubits() != initial_state.n_qubits()) {
+        throw std::runtime_error {"ERROR: cannot calculate adjoint gradient; circuit and state have different number of qubits.\n"};
+    }
+
+    for (const auto& [ignore, pauli_string] : pauli_op.weighted_pauli_strings()) {
+        if (pauli_string.n_qubits() != circuit.n_qubits()) {
+            throw std::runtime_error {
+                "ERROR: cannot calculate adjoint gradient; circuit and PauliOperator have different number of qubits.\n"
+            };
+        }
+    }
+
+    for (const auto& id : parameter_ids) {
+        if (!circuit.parameter_data_map().contains(id)) {
+            throw std::runtime_error {"ERROR: cannot calculate adjoint gradient; parameter not found in circuit.\n"};
+        }
+    }
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+auto adjoint_gradient(
+    const QuantumCircuit& circuit,
+    const std::vector<param::ParameterID>& parameter_ids,
+    const PauliOperator& pauli_op,
+    const QuantumState& initial_state
+) -> ExpectationValueAndGradient
+{
+    check_valid_inputs_(circuit, parameter_ids, pauli_op, initial_state);
+
+    const auto gates = collect_gates_(circuit);
+
+    const auto parameter_values = kpi::create_parameter_values_map(circuit.parameter_data_map());
+    const auto parameter_values_map = kpi::MapVariant {std::cref(parameter_values)};
+
+    // the forward pass; `psi` is the state after all the gates
+    auto psi = initial_state;
+    simulate(circuit, psi);
+
+    // the state that carries the derivative of the expectation value backwards through the circuit
+    auto lambda = apply_pauli_operator_(pauli_op, psi);
+
+    auto expectation_value = 0.0;
+    for (std::size_t i {0}; i < psi.n_states(); ++i) {
+        expectation_value += (std::conj(psi[i]) * lambda[i]).real();
+    }
+
+    // the backward pass; at the start of each iteration, `psi` is the state right after gate `i_gate`,
+    // and `lambda` is the operator applied to the final state, with every gate after `i_gate` undone
+    auto gradients = param::EvaluatedParameterDataMap {};
+
+    for (auto i_gate {gates.size()}; i_gate > 0; --i_gate) {
+        const auto& info = *gates[i_gate - 1];
+
+        if (info.param_expression_ptr) {
+            const auto generator = gate_generator_(info);
+            const auto angle_derivative = generator.coefficient * generator_overlap_(lambda, generator, psi).imag();
+
+            kpi::accumulate_expression_gradient(*info.param_expression_ptr, angle_derivative, parameter_values_map, gradients);
+        }
+
+        if (i_gate > 1) {
+            const auto inverse = inverse_gate_(parameter_values_map, info);
+            ki::simulate_single_gate_(parameter_values_map, psi, inverse);
+            ki::simulate_single_gate_(parameter_values_map, lambda, inverse);
+        }
+    }
+
+    auto gradient = std::vector<double> {};
+    gradient.reserve(parameter_ids.size());
+
+    for (const auto& id : parameter_ids) {
+        const auto it = gradients.find(id);
+        gradient.push_back(it == gradients.end() ? 0.0 : it->second);
+    }
+
+    return {.expectation_value=expectation_value, .gradient=std::move(gradient)};
+}
+
+auto adjoint_gradient(
+    const QuantumCircuit& circuit,
+    const std::vector<param::ParameterID>& parameter_ids,
+    const PauliOperator& pauli_op
+) -> ExpectationValueAndGradient
+{
+    return adjoint_gradient(circuit, parameter_ids, pauli_op, QuantumState {circuit.n_qubits()});
+}
+
+}  // namespace ket
@@ -0,0 +1,457 @@
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit_operations/append_circuits.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/optimize/parameter_shift_gradient.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+#include "kettle_internal/parameter/parameter_expression_internal.hpp"
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
+#include "kettle_internal/simulation/simulate_internal.hpp"
+#include "kettle_internal/simulation/simulate_utils.hpp"
+
+
+namespace ki = ket::internal;
+namespace kp = ket::param;
+namespace kpi = ket::param::internal;
+
+namespace
+{
+
+struct ShiftTerm_
+{
+    double shift;
+    double weight;
+};
+
+/*
+    The two-term rule is exact for gates whose generator has two distinct eigenvalues that differ by 1;
+    RX, RY, RZ and PAULI_ROT (eigenvalues +/- 1/2), and P and CP (eigenvalues 0 and 1).
+*/
+const auto TWO_TERM_RULE = std::vector<ShiftTerm_> {
+    {.shift= std::numbers::pi / 2.0, .weight= 0.5},
+    {.shift=-std::numbers::pi / 2.0, .weight=-0.5}
+};
+
+/*
+    The generators of CRX, CRY and CRZ have the eigenvalues {0, +/- 1/2}, and need the four-term rule.
+*/
+const auto FOUR_TERM_RULE = []() {
+    const auto plus = (std::numbers::sqrt2 + 1.0) / (4.0 * std::numbers::sqrt2);
+    const auto minus = (std::numbers::sqrt2 - 1.0) / (4.0 * std::numbers::sqrt2);
+
+    return std::vector<ShiftTerm_> {
+        {.shift= std::numbers::pi / 2.0,       .weight= plus},
+        {.shift=-std::numbers::pi / 2.0,       .weight=-plus},
+        {.shift= 3.0 * std::numbers::pi / 2.0, .weight=-minus},
+        {.shift=-3.0 * std::numbers::pi / 2.0, .weight= minus}
+    };
+}();
+
+/*
+    A single run of the circuit, starting from the state right before the circuit element at `i_start`;
+    if `i_shifted` has a value, the gate at that index is replaced by a copy with its angle fixed at
+    `angle`. The cost of the run gets multiplied by `weight` and added to the derivative of the angle
+    of occurrence `i_occurrence`.
+*/
+struct ShiftedRun_
+{
+    std::size_t i_start;
+    std::optional<std::size_t> i_shifted;
+    double angle;
+    std::size_t i_occurrence;
+    double weight;
+};
+
+// NOLINTNEXTLINE(misc-no-recursion)
+auto contains_parameterized_gate_(const ket::QuantumCircuit& circuit) -> bool
+{
+    for (const auto& element : circuit) {
+        if (element.is_gate() && element.get_gate().param_expression_ptr) {
+            return true;
+        }
+
+        if (element.is_control_flow()) {
+            const auto& control_flow = element.get_control_flow();
+
+            if (control_flow.is_if_statement()) {
+                if (contains_parameterized_gate_(*control_flow.get_if_statement().circuit())) {
+                    return true;
+                }
+            }
+            else if (control_flow.is_if_else_statement()) {
+                const auto& if_else_stmt = control_flow.get_if_else_statement();
+                if (contains_parameterized_gate_(*if_else_stmt.if_circuit()) || contains_parameterized_gate_(*if_else_stmt.else_circuit())) {
+                    return true;
+                }
+            }
+            else if (control_flow.is_repeat_statement()) {
+                if (contains_parameterized_gate_(*control_flow.get_repeat_statement().circuit())) {
+                    return true;
+                }
+            }
+            else if (control_flow.is_controlled_block()) {
+                if (contains_parameterized_gate_(*control_flow.get_controlled_block().circuit())) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/*
+    The index of the first measurement or control flow element; the circuit before this index is purely
+    unitary, so the state at any point before it can be calculated once and shared between runs.
+*/
+auto first_non_unitary_index_(const ket::QuantumCircuit& circuit) -> std::size_t
+{
+    const auto& elements = circuit.circuit_elements();
+    const auto it = std::ranges::find_if(elements, [](const auto& element) {
+        return element.is_control_flow() || (element.is_gate() && element.get_gate().gate == ket::Gate::M);
+    });
+
+    return static_cast<std::size_t>(std::distance(elements.begin(), it));
+}
+
+auto occurrence_angle_(const kpi::MapVariant& parameter_values_map, const ket::GateInfo& info) -> double
+{
+    namespace gid = ki::gate_id;
+
+    if (gid::is_1t1a_gate(info.gate)) {
+        return std::get<1>(kpi::unpack_target_and_angle(parameter_values_map, info));
+    }
+    else if (gid::is_1c1t1a_gate(info.gate)) {
+        return std::get<2>(kpi::unpack_control_target_and_angle(parameter_values_map, info));
+    }
+    else {
+        return kpi::unpack_pauli_rotation_angle(parameter_values_map, info);
+    }
+}
+
+/*
+    Creates a circuit with a single copy of the gate in `info`, with its angle fixed at `angle`.
+*/
+auto fixed_angle_gate_circuit_(const ket::QuantumCircuit& circuit, const ket::GateInfo& info, double angle) -> ket::QuantumCircuit
+{
+    namespace cre = ki::create;
+    using G = ket::Gate;
+
+    auto output = ket::QuantumCircuit {circuit.n_qubits(), circuit.n_bits()};
+
+    switch (info.gate) {
+        case G::RX : output.add_rx_gate(cre::unpack_single_qubit_gate_index(info), angle); break;
+        case G::RY : output.add_ry_gate(cre::unpack_single_qubit_gate_index(info), angle); break;
+        case G::RZ : output.add_rz_gate(cre::unpack_single_qubit_gate_index(info), angle); break;
+        case G::P  : output.add_p_gate(cre::unpack_single_qubit_gate_index(info), angle); break;
+        case G::CRX : {
+            const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+            output.add_crx_gate(control, target, angle);
+            break;
+        }
+        case G::CRY : {
+            const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+            output.add_cry_gate(control, target, angle);
+            break;
+        }
+        case G::CRZ : {
+            const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+            output.add_crz_gate(control, target, angle);
+            break;
+        }
+        case G::CP : {
+            const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+            output.add_cp_gate(control, target, angle);
+            break;
+        }
+        case G::PAULI_ROT : {
+            output.add_pauli_rotation_gate(*info.pauli_string_ptr, angle);
+            break;
+        }
+        default : {
+            throw std::runtime_error {"DEV ERROR: invalid parameterized gate found in `fixed_angle_gate_circuit_()`\n"};
+        }
+    }
+
+    return output;
+}
+
+/*
+    Creates the part of the circuit that a run has to simulate, starting from its starting state.
+*/
+auto run_circuit_(const ket::QuantumCircuit& circuit, const ShiftedRun_& run) -> ket::QuantumCircuit
+{
+    const auto n_elements = circuit.n_circuit_elements();
+
+    if (!run.i_shifted.has_value()) {
+        return ket::slice_circuit(circuit, run.i_start, n_elements);
+    }
+
+    const auto i_shifted = run.i_shifted.value();
+    const auto& info = circuit[i_shifted].get_gate();
+
+    auto output = ket::slice_circuit(circuit, run.i_start, i_shifted);
+    ket::extend_circuit(output, fixed_angle_gate_circuit_(circuit, info, run.angle));
+    ket::extend_circuit(output, ket::slice_circuit(circuit, i_shifted + 1, n_elements));
+
+    return output;
+}
+
+/*
+    Applies the unitary gates in [i_begin, i_end) to the state, one at a time.
+*/
+void advance_state_(
+    const kpi::MapVariant& parameter_values_map,
+    const ket::QuantumCircuit& circuit,
+    ket::QuantumState& state,
+    std::size_t i_begin,
+    std::size_t i_end
+)
+{
+    for (auto i {i_begin}; i < i_end; ++i) {
+        if (circuit[i].is_gate()) {
+            ki::simulate_single_gate_(parameter_values_map, state, circuit[i].get_gate());
+        }
+    }
+}
+
+void check_valid_inputs_(
+    const ket::QuantumCircuit& circuit,
+    const std::vector<kp::ParameterID>& parameter_ids,
+    const ket::QuantumState& initial_state
+)
+{
+    if (circuit.n_qubits() != initial_state.n_qubits()) {
+        throw std::runtime_error {"ERROR: cannot calculate parameter-shift gradient; circuit and state have different number of qubits.\n"};
+    }
+
+    for (const auto& id : parameter_ids) {
+        if (!circuit.parameter_data_map().contains(id)) {
+            throw std::runtime_error {"ERROR: cannot calculate parameter-shift gradient; parameter not found in circuit.\n"};
+        }
+    }
+
+    for (const auto& element : circuit) {
+        if (!element.is_control_flow()) {
+            continue;
+        }
+
+        const auto& control_flow = element.get_control_flow();
+        const auto has_parameters = [&]() {
+            if (control_flow.is_if_statement()) {
+                return contains_parameterized_gate_(*control_flow.get_if_statement().circuit());
+            }
+
+            if (control_flow.is_repeat_statement()) {
+                return contains_parameterized_gate_(*control_flow.get_repeat_statement().circuit());
+            }
+
+            if (control_flow.is_controlled_block()) {
+                return contains_parameterized_gate_(*control_flow.get_controlled_block().circuit());
+            }
+
+            const auto& if_else_stmt = control_flow.get_if_else_statement();
+            return contains_parameterized_gate_(*if_else_stmt.if_circuit()) || contains_parameterized_gate_(*if_else_stmt.else_circuit());
+        }();
+
+        if (has_parameters) {
+            throw std::runtime_error {
+                "ERROR: cannot calculate parameter-shift gradient; found parameterized gate inside control flow.\n"
+            };
+        }
+    }
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+auto parameter_shift_gradient(
+    const QuantumCircuit& circuit,
+    const std::vector<param::ParameterID>& parameter_ids,
+    const StateCostFunction& cost_function,
+    const QuantumState& initial_state,
+    std::optional<int> prng_seed,
+    std::optional<std::size_t> n_threads
+) -> ExpectationValueAndGradient
+{
+    namespace gid = ki::gate_id;
+
+    check_valid_inputs_(circuit, parameter_ids, initial_state);
+
+    const auto parameter_values = kpi::create_parameter_values_map(circuit.parameter_data_map());
+    const auto parameter_values_map = kpi::MapVariant {std::cref(parameter_values)};
+
+    const auto i_unitary_end = first_non_unitary_index_(circuit);
+
+    // every shifted run for every occurrence of a parameterized gate, ordered by where they start
+    auto occurrences = std::vector<std::size_t> {};
+    auto runs = std::vector<ShiftedRun_> {};
+
+    for (std::size_t i {0}; i < circuit.n_circuit_elements(); ++i) {
+        if (!circuit[i].is_gate() || !circuit[i].get_gate().param_expression_ptr) {
+            continue;
+        }
+
+        const auto& info = circuit[i].get_gate();
+        const auto angle = occurrence_angle_(parameter_values_map, info);
+        const auto& rule = gid::is_1c1t1a_gate(info.gate) && info.gate != Gate::CP ? FOUR_TERM_RULE : TWO_TERM_RULE;
+
+        for (const auto& [shift, weight] : rule) {
+            runs.push_back({
+                .i_start=std::min(i, i_unitary_end),
+                .i_shifted=i,
+                .angle=angle + shift,
+                .i_occurrence=occurrences.size(),
+                .weight=weight
+            });
+        }
+
+        occurrences.push_back(i);
+    }
+
+    // the unshifted run gives the value of the cost function itself
+    runs.push_back({.i_start=i_unitary_end, .i_shifted=std::nullopt, .angle=0.0, .i_occurrence=0, .weight=0.0});
+
+    const auto n_runs = runs.size();
+    const auto n_workers = std::max(std::size_t {1}, n_threads.value_or(std::thread::hardware_concurrency()));
+
+    auto costs = std::vector<double>(n_runs, 0.0);
+    auto exceptions = std::vector<std::exception_ptr>(n_workers);
+
+    // the runs are done in batches of `n_workers`, so at most `n_workers` starting states are kept at once
+    auto prefix_state = initial_state;
+    auto i_prefix = std::size_t {0};
+
+    for (std::size_t i_batch_begin {0}; i_batch_begin < n_runs; i_batch_begin += n_workers) {
+        const auto i_batch_end = std::min(i_batch_begin + n_workers, n_runs);
+
+        auto start_states = std::vector<QuantumState> {};
+        auto i_start_states = std::vector<std::size_t> {};
+
+        for (auto i_run {i_batch_begin}; i_run < i_batch_end; ++i_run) {
+            const auto i_start = runs[i_run].i_start;
+
+            if (start_states.empty() || i_start != i_prefix) {
+                advance_state_(parameter_values_map, circuit, prefix_state, i_prefix, i_start);
+                i_prefix = i_start;
+                start_states.push_back(prefix_state);
+            }
+
+            i_start_states.push_back(start_states.size() - 1);
+        }
+
+        // `parallel_for_()` runs everything on one thread if it is given more threads than work items,
+        // which would happen for small gradients and for the last batch of every gradient
+        const auto n_batch = i_batch_end - i_batch_begin;
+        ki::parallel_for_(n_batch, std::min(n_workers, n_batch), [&](const ki::FlatIndexPair& block, std::size_t i_thread) {
+            try {
+                for (auto i {block.i_lower}; i < block.i_upper; ++i) {
+                    const auto& run = runs[i_batch_begin + i];
+
+                    auto state = start_states[i_start_states[i]];
+                    simulate(run_circuit_(circuit, run), state, prng_seed);
+                    costs[i_batch_begin + i] = cost_function(state);
+                }
+            }
+            catch (...) {
+                exceptions[i_thread] = std::current_exception();
+            }
+        });
+
+        for (const auto& exception : exceptions) {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+    }
+
+    // combine the shifted costs into the derivative of each occurrence's angle
+    auto angle_derivatives = std::vector<double>(occurrences.size(), 0.0);
+    for (std::size_t i_run {0}; i_run < n_runs - 1; ++i_run) {
+        angle_derivatives[runs[i_run].i_occurrence] += runs[i_run].weight * costs[i_run];
+    }
+
+    auto gradients = param::EvaluatedParameterDataMap {};
+    for (std::size_t i_occ {0}; i_occ < occurrences.size(); ++i_occ) {
+        const auto& expression = *circuit[occurrences[i_occ]].get_gate().param_expression_ptr;
+        kpi::accumulate_expression_gradient(expression, angle_derivatives[i_occ], parameter_values_map, gradients);
+    }
+
+    auto gradient = std::vector<double> {};
+    gradient.reserve(parameter_ids.size());
+
+    for (const auto& id : parameter_ids) {
+        const auto it = gradients.find(id);
+        gradient.push_back(it == gradients.end() ? 0.0 : it->second);
+    }
+
+    return {.expectation_value=costs.back(), .gradient=std::move(gradient)};
+}
+
+auto parameter_shift_gradient(
+    const QuantumCircuit& circuit,
+    const std::vector<param::ParameterID>& parameter_ids,
+    const PauliOperator& pauli_op,
+    const QuantumState& initial_state,
+    std::optional<int> prng_seed,
+    std::optional<std::size_t> n_threads
+) -> ExpectationValueAndGradient
+{
+    const auto cost_function = [&pauli_op](const QuantumState& state) {
+        return expectation_value(pauli_op, state).real();
+    };
+
+    return parameter_shift_gradient(circuit, parameter_ids, cost_function, initial_state, prng_seed, n_threads);
+}
+
+auto parameter_shift_objective(const std::vector<double>& parameters, std::vector<double>& grad, void* data) -> double
+{
+    auto* objective = static_cast<ParameterShiftObjective*>(data);
+
+    if (parameters.size() != objective->parameter_ids.size()) {
+        throw std::runtime_error {"ERROR: the number of parameters does not match the number of parameter ids.\n"};
+    }
+
+    for (std::size_t i {0}; i < parameters.size(); ++i) {
+        objective->circuit.set_parameter_value(objective->parameter_ids[i], parameters[i]);
+    }
+
+    // nlopt only asks for the gradient when it needs it
+    if (grad.empty()) {
+        auto state = objective->initial_state;
+        simulate(objective->circuit, state, objective->prng_seed);
+        return objective->cost_function(state);
+    }
+
+    auto [cost, gradient] = parameter_shift_gradient(
+        objective->circuit,
+        objective->parameter_ids,
+        objective->cost_function,
+        objective->initial_state,
+        objective->prng_seed,
+        objective->n_threads
+    );
+
+    grad = std::move(gradient);
+
+    return cost;
+}
+
+}  // namespace ket
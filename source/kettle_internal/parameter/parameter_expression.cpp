@@ -81,6 +81,20 @@ auto unpack_control_target_and_angle(
     }
 }
 
+auto unpack_pauli_rotation_angle(
+    const MapVariant& parameter_values_map,
+    const ket::GateInfo& info
+) -> double
+{
+    if (info.param_expression_ptr) {
+        const auto& [pauli_string_ptr, param_expression_ptr] = ki::create::unpack_pauli_rotation_parameter_gate(info);
+        return Evaluator{}.evaluate(*param_expression_ptr, parameter_values_map);
+    } else {
+        const auto& [pauli_string_ptr, angle] = ki::create::unpack_pauli_rotation_gate(info);
+        return angle;
+    }
+}
+
 auto create_parameter_values_map(const ParameterDataMap& param_data_map) -> EvaluatedParameterDataMap
 {
     auto output = EvaluatedParameterDataMap {};
@@ -96,4 +110,39 @@ auto create_parameter_values_map(const ParameterDataMap& param_data_map) -> Eval
     return output;
 }
 
+// NOLINTNEXTLINE(misc-no-recursion)
+void accumulate_expression_gradient(
+    const ParameterExpression& expr,
+    double multiplier,
+    const MapVariant& parameter_values_map,
+    EvaluatedParameterDataMap& gradients
+)
+{
+    if (const auto* param = std::get_if<Parameter>(&expr)) {
+        gradients[param->id()] += multiplier;
+    }
+    else if (const auto* binary = std::get_if<BinaryExpression>(&expr)) {
+        switch (binary->operation)
+        {
+            case BinaryOperation::ADD : {
+                accumulate_expression_gradient(*binary->left, multiplier, parameter_values_map, gradients);
+                accumulate_expression_gradient(*binary->right, multiplier, parameter_values_map, gradients);
+                break;
+            }
+            case BinaryOperation::MUL : {
+                const auto left_value = Evaluator{}.evaluate(*binary->left, parameter_values_map);
+                const auto right_value = Evaluator{}.evaluate(*binary->right, parameter_values_map);
+                accumulate_expression_gradient(*binary->left, multiplier * right_value, parameter_values_map, gradients);
+                accumulate_expression_gradient(*binary->right, multiplier * left_value, parameter_values_map, gradients);
+                break;
+            }
+            default : {
+                throw std::runtime_error {"DEV ERROR: found invalid binary operation between parameter expressions\n"};
+            }
+        }
+    }
+
+    // a `LiteralExpression` does not depend on any parameters
+}
+
 }  // namespace ket::param::internal
@@ -45,10 +45,34 @@ auto unpack_control_target_and_angle(
     const ket::GateInfo& info
 ) -> std::tuple<std::size_t, std::size_t, double>;
 
+/*
+    Unpack the angle of a PAULI_ROT gate.
+
+    If the gate is parameterized, then the associated value from `parameter_values_map` is
+    used; otherwise, the fixed angle assigned to the gate is used.
+*/
+auto unpack_pauli_rotation_angle(
+    const MapVariant& parameter_values_map,
+    const ket::GateInfo& info
+) -> double;
+
 /*
     Evaluate all the `ParameterExpression` instances in `param_data_map`, to get the
     actual floating-point values for all the parameters.
 */
 auto create_parameter_values_map(const ParameterDataMap& param_data_map) -> EvaluatedParameterDataMap;
 
+/*
+    Adds `multiplier * d(expr)/d(param)` to `gradients[param.id()]` for each parameter `param` that
+    appears in `expr`, applying the chain rule through the ADD and MUL operations.
+
+    A parameter that appears more than once in `expr` has all of its contributions summed together.
+*/
+void accumulate_expression_gradient(
+    const ParameterExpression& expr,
+    double multiplier,
+    const MapVariant& parameter_values_map,
+    EvaluatedParameterDataMap& gradients
+);
+
 }  // namespace ket::param::internal
@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/parameter/parameter_expression.hpp"
+#include "kettle/parameter/parameter_slots.hpp"
+
+#include "kettle_internal/parameter/parameter_slots_internal.hpp"
+
+
+namespace kp = ket::param;
+namespace kpi = ket::param::internal;
+
+namespace
+{
+
+// most expressions are a single parameter, or a short chain of sums and products
+constexpr inline auto INLINE_STACK_SIZE_ = std::size_t {16};
+
+using SlotIndexMap_ = std::unordered_map<kp::ParameterID, std::size_t, kp::ParameterIdHash>;
+
+class SlotCompiler_
+{
+public:
+    // NOLINTNEXTLINE(misc-no-recursion)
+    void compile_expression(const kp::ParameterExpression& expr, std::vector<kpi::SlotInstruction>& instructions)
+    {
+        if (const auto* param = std::get_if<kp::Parameter>(&expr)) {
+            instructions.push_back({.operation=kpi::SlotOperation::PUSH_SLOT, .slot=slot_of_(param->id()), .literal=0.0});
+        }
+        else if (const auto* literal = std::get_if<kp::LiteralExpression>(&expr)) {
+            instructions.push_back({.operation=kpi::SlotOperation::PUSH_LITERAL, .slot=0, .literal=literal->value});
+        }
+        else {
+            const auto& binary = std::get<kp::BinaryExpression>(expr);
+            compile_expression(*binary.left, instructions);
+            compile_expression(*binary.right, instructions);
+
+            switch (binary.operation)
+            {
+                case kp::BinaryOperation::ADD : {
+                    instructions.push_back({.operation=kpi::SlotOperation::ADD, .slot=0, .literal=0.0});
+                    break;
+                }
+                case kp::BinaryOperation::MUL : {
+                    instructions.push_back({.operation=kpi::SlotOperation::MUL, .slot=0, .literal=0.0});
+                    break;
+                }
+                default : {
+                    throw std::runtime_error {"DEV ERROR: found invalid binary operation between parameter expressions\n"};
+                }
+            }
+        }
+    }
+
+    // NOLINTNEXTLINE(misc-no-recursion)
+    auto compile_circuit(const ket::QuantumCircuit& circuit) -> kpi::CompiledCircuitParameters
+    {
+        auto output = kpi::CompiledCircuitParameters {};
+        output.programs.reserve(circuit.n_circuit_elements());
+        output.i_subcircuits.reserve(circuit.n_circuit_elements());
+
+        for (const auto& element : circuit) {
+            output.i_subcircuits.push_back(output.subcircuits.size());
+
+            if (element.is_gate() && element.get_gate().param_expression_ptr) {
+                auto instructions = std::vector<kpi::SlotInstruction> {};
+                compile_expression(*element.get_gate().param_expression_ptr, instructions);
+                output.programs.emplace_back(std::move(instructions));
+                continue;
+            }
+
+            output.programs.emplace_back();
+
+            if (element.is_control_flow()) {
+                const auto& control_flow = element.get_control_flow();
+
+                if (control_flow.is_if_statement()) {
+                    output.subcircuits.push_back(compile_circuit(*control_flow.get_if_statement().circuit()));
+                }
+                else if (control_flow.is_if_else_statement()) {
+                    const auto& if_else_stmt = control_flow.get_if_else_statement();
+                    output.subcircuits.push_back(compile_circuit(*if_else_stmt.if_circuit()));
+                    output.subcircuits.push_back(compile_circuit(*if_else_stmt.else_circuit()));
+                }
+                else if (control_flow.is_repeat_statement()) {
+                    output.subcircuits.push_back(compile_circuit(*control_flow.get_repeat_statement().circuit()));
+                }
+                else if (control_flow.is_controlled_block()) {
+                    output.subcircuits.push_back(compile_circuit(*control_flow.get_controlled_block().circuit()));
+                }
+                else {
+                    throw std::runtime_error {"DEV ERROR: invalid control flow element found in `compile_parameter_slots()`\n"};
+                }
+            }
+        }
+
+        return output;
+    }
+
+    [[nodiscard]]
+    auto slot_ids() const -> const std::vector<kp::ParameterID>&
+    {
+        return slot_ids_;
+    }
+
+private:
+    SlotIndexMap_ slots_;
+    std::vector<kp::ParameterID> slot_ids_;
+
+    auto slot_of_(const kp::ParameterID& id) -> std::size_t
+    {
+        const auto [it, is_inserted] = slots_.insert({id, slot_ids_.size()});
+        if (is_inserted) {
+            slot_ids_.push_back(id);
+        }
+
+        return it->second;
+    }
+};
+
+auto compute_max_stack_size_(const std::vector<kpi::SlotInstruction>& instructions) -> std::size_t
+{
+    auto size = std::size_t {0};
+    auto max_size = std::size_t {0};
+
+    for (const auto& instruction : instructions) {
+        if (instruction.operation == kpi::SlotOperation::PUSH_LITERAL || instruction.operation == kpi::SlotOperation::PUSH_SLOT) {
+            ++size;
+        }
+        else {
+            --size;
+        }
+
+        max_size = std::max(max_size, size);
+    }
+
+    return max_size;
+}
+
+auto run_slot_program_(
+    const std::vector<kpi::SlotInstruction>& instructions,
+    std::span<const double> slot_values,
+    double* stack
+) -> double
+{
+    auto i_top = std::size_t {0};
+
+    for (const auto& instruction : instructions) {
+        switch (instruction.operation)
+        {
+            case kpi::SlotOperation::PUSH_LITERAL : {
+                stack[i_top] = instruction.literal;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                ++i_top;
+                break;
+            }
+            case kpi::SlotOperation::PUSH_SLOT : {
+                stack[i_top] = slot_values[instruction.slot];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                ++i_top;
+                break;
+            }
+            case kpi::SlotOperation::ADD : {
+                --i_top;
+                stack[i_top - 1] += stack[i_top];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                break;
+            }
+            case kpi::SlotOperation::MUL : {
+                --i_top;
+                stack[i_top - 1] *= stack[i_top];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                break;
+            }
+        }
+    }
+
+    return stack[0];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+}  // namespace
+
+
+namespace ket::param::internal
+{
+
+SlotProgram::SlotProgram(std::vector<SlotInstruction> instructions)
+    : instructions_ {std::move(instructions)}
+    , max_stack_size_ {compute_max_stack_size_(instructions_)}
+{}
+
+auto SlotProgram::evaluate(std::span<const double> slot_values) const -> double
+{
+    // the most common case by far is a gate that uses a single parameter directly
+    if (instructions_.size() == 1) {
+        const auto& instruction = instructions_[0];
+        return instruction.operation == SlotOperation::PUSH_SLOT ? slot_values[instruction.slot] : instruction.literal;
+    }
+
+    if (instructions_.empty()) {
+        throw std::runtime_error {"DEV ERROR: attempted to evaluate an empty slot program.\n"};
+    }
+
+    if (max_stack_size_ <= INLINE_STACK_SIZE_) {
+        auto stack = std::array<double, INLINE_STACK_SIZE_> {};
+        return run_slot_program_(instructions_, slot_values, stack.data());
+    }
+
+    auto stack = std::vector<double>(max_stack_size_);
+    return run_slot_program_(instructions_, slot_values, stack.data());
+}
+
+auto compile_parameter_slots(const ket::QuantumCircuit& circuit) -> CompiledParameterSlots
+{
+    auto compiler = SlotCompiler_ {};
+    auto compiled_circuit = compiler.compile_circuit(circuit);
+
+    return {.slot_ids=compiler.slot_ids(), .circuit=std::move(compiled_circuit)};
+}
+
+auto parameter_values_from_slots(
+    const ket::QuantumCircuit& circuit,
+    const std::vector<ParameterID>& slot_ids
+) -> std::vector<double>
+{
+    const auto& parameter_data = circuit.parameter_data_map();
+
+    auto values = std::vector<double> {};
+    values.reserve(slot_ids.size());
+
+    for (const auto& id : slot_ids) {
+        const auto it = parameter_data.find(id);
+        if (it == parameter_data.end()) {
+            throw std::runtime_error {"DEV ERROR: unable to find parameter during expression evaluation.\n"};
+        }
+
+        if (it->second.value == std::nullopt) {
+            throw std::runtime_error {"ERROR: cannot perform simulation with an uninitialized parameter value.\n"};
+        }
+
+        values.push_back(it->second.value.value());
+    }
+
+    return values;
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+auto has_parameterized_gates(const ket::QuantumCircuit& circuit) -> bool
+{
+    for (const auto& element : circuit) {
+        if (element.is_gate()) {
+            if (element.get_gate().param_expression_ptr) {
+                return true;
+            }
+        }
+        else if (element.is_control_flow()) {
+            const auto& control_flow = element.get_control_flow();
+
+            if (control_flow.is_if_statement()) {
+                if (has_parameterized_gates(*control_flow.get_if_statement().circuit())) {
+                    return true;
+                }
+            }
+            else if (control_flow.is_if_else_statement()) {
+                const auto& if_else_stmt = control_flow.get_if_else_statement();
+                if (has_parameterized_gates(*if_else_stmt.if_circuit()) || has_parameterized_gates(*if_else_stmt.else_circuit())) {
+                    return true;
+                }
+            }
+            else if (control_flow.is_repeat_statement()) {
+                if (has_parameterized_gates(*control_flow.get_repeat_statement().circuit())) {
+                    return true;
+                }
+            }
+            else if (control_flow.is_controlled_block()) {
+                if (has_parameterized_gates(*control_flow.get_controlled_block().circuit())) {
+                    return true;
+                }
+            }
+            else {
+                throw std::runtime_error {"DEV ERROR: invalid control flow element found in `has_parameterized_gates()`\n"};
+            }
+        }
+    }
+
+    return false;
+}
+
+}  // namespace ket::param::internal
+
+
+namespace ket::param
+{
+
+CompiledCircuit::CompiledCircuit(QuantumCircuit circuit)
+    : circuit_ {std::move(circuit)}
+    , compiled_ {std::make_unique<internal::CompiledParameterSlots>(internal::compile_parameter_slots(circuit_))}
+{}
+
+CompiledCircuit::CompiledCircuit(const CompiledCircuit& other) = default;
+CompiledCircuit::CompiledCircuit(CompiledCircuit&& other) noexcept = default;
+auto CompiledCircuit::operator=(const CompiledCircuit& other) -> CompiledCircuit& = default;
+auto CompiledCircuit::operator=(CompiledCircuit&& other) noexcept -> CompiledCircuit& = default;
+CompiledCircuit::~CompiledCircuit() = default;
+
+auto CompiledCircuit::slot_ids() const noexcept -> const std::vector<ParameterID>&
+{
+    return (*compiled_).slot_ids;
+}
+
+auto CompiledCircuit::n_slots() const noexcept -> std::size_t
+{
+    return (*compiled_).slot_ids.size();
+}
+
+auto CompiledCircuit::parameter_values() const -> std::vector<double>
+{
+    return internal::parameter_values_from_slots(circuit_, (*compiled_).slot_ids);
+}
+
+}  // namespace ket::param
+
+
+namespace ket
+{
+
+auto parameter_slot_ids(const QuantumCircuit& circuit) -> std::vector<param::ParameterID>
+{
+    return kpi::compile_parameter_slots(circuit).slot_ids;
+}
+
+auto parameter_slot_values(const QuantumCircuit& circuit) -> std::vector<double>
+{
+    return kpi::parameter_values_from_slots(circuit, parameter_slot_ids(circuit));
+}
+
+}  // namespace ket
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/parameter/parameter_expression.hpp"
+
+/*
+    A `ParameterExpression` is a tree of `ClonePtr` nodes, and evaluating it means visiting each node and
+    looking up each parameter by its 16-byte id in a hash map. This is done for every parameterized gate
+    in every simulation.
+
+    Instead, each parameter of a circuit is assigned a dense integer slot ahead of time, and each expression
+    is flattened into a short postfix program over the slots. Evaluating the program only reads from an
+    array of parameter values.
+*/
+
+namespace ket::param::internal
+{
+
+enum class SlotOperation : std::uint8_t
+{
+    PUSH_LITERAL,
+    PUSH_SLOT,
+    ADD,
+    MUL
+};
+
+struct SlotInstruction
+{
+    SlotOperation operation;
+    std::size_t slot;
+    double literal;
+};
+
+class SlotProgram
+{
+public:
+    SlotProgram() = default;
+
+    explicit SlotProgram(std::vector<SlotInstruction> instructions);
+
+    [[nodiscard]]
+    auto evaluate(std::span<const double> slot_values) const -> double;
+
+    [[nodiscard]]
+    constexpr auto instructions() const noexcept -> const std::vector<SlotInstruction>&
+    {
+        return instructions_;
+    }
+
+private:
+    std::vector<SlotInstruction> instructions_;
+    std::size_t max_stack_size_ {0};
+};
+
+/*
+    The compiled programs of a circuit, with the same structure as the circuit itself.
+
+    `programs[i]` is the program for the angle of the i-th circuit element, and is empty if the element is
+    not a parameterized gate. The subcircuits of the i-th circuit element, if it is a control flow statement,
+    are stored in `subcircuits` starting at `i_subcircuits[i]`; the if-branch comes before the else-branch.
+*/
+struct CompiledCircuitParameters
+{
+    std::vector<SlotProgram> programs;
+    std::vector<CompiledCircuitParameters> subcircuits;
+    std::vector<std::size_t> i_subcircuits;
+};
+
+struct CompiledParameterSlots
+{
+    std::vector<ParameterID> slot_ids;
+    CompiledCircuitParameters circuit;
+};
+
+/*
+    Assigns a slot to each parameter used by a gate in `circuit` (in the order described in
+    `kettle/parameter/parameter_slots.hpp`), and compiles the expression of every parameterized gate.
+*/
+auto compile_parameter_slots(const ket::QuantumCircuit& circuit) -> CompiledParameterSlots;
+
+/*
+    Checks if any gate in `circuit`, including the gates inside control flow subcircuits, is parameterized.
+*/
+auto has_parameterized_gates(const ket::QuantumCircuit& circuit) -> bool;
+
+/*
+    Looks up the current value of each parameter in `slot_ids`, from the parameters of `circuit`.
+*/
+auto parameter_values_from_slots(
+    const ket::QuantumCircuit& circuit,
+    const std::vector<ParameterID>& slot_ids
+) -> std::vector<double>;
+
+}  // namespace ket::param::internal
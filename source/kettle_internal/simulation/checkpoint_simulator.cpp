@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/simulation/checkpoint_simulator.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/parameter/parameter_slots_internal.hpp"
+#include "kettle_internal/simulation/simulate_internal.hpp"
+
+
+namespace ki = ket::internal;
+namespace kpi = ket::param::internal;
+
+namespace
+{
+
+/*
+    Returns the index of each gate in the circuit's elements; the gates are the only elements that
+    change the state.
+*/
+auto gate_element_indices_(const ket::QuantumCircuit& circuit) -> std::vector<std::size_t>
+{
+    auto output = std::vector<std::size_t> {};
+    output.reserve(circuit.n_circuit_elements());
+
+    for (std::size_t i {0}; i < circuit.n_circuit_elements(); ++i) {
+        const auto& element = circuit[i];
+
+        if (element.is_circuit_logger()) {
+            continue;
+        }
+        else if (element.is_control_flow()) {
+            throw std::runtime_error {"ERROR: the checkpoint simulator does not support circuits with control flow.\n"};
+        }
+        else if (element.is_gate()) {
+            if (element.get_gate().gate == ket::Gate::M) {
+                throw std::runtime_error {"ERROR: the checkpoint simulator does not support circuits with measurement gates.\n"};
+            }
+
+            output.push_back(i);
+        }
+        else {
+            throw std::runtime_error {"DEV ERROR: invalid circuit element found in `CheckpointSimulator`\n"};
+        }
+    }
+
+    return output;
+}
+
+/*
+    Returns the first gate that reads each slot of the compiled circuit.
+*/
+auto first_gate_of_each_slot_(
+    const kpi::CompiledParameterSlots& compiled,
+    const std::vector<std::size_t>& i_gate_elements
+) -> std::vector<std::size_t>
+{
+    constexpr auto NOT_FOUND = std::numeric_limits<std::size_t>::max();
+
+    auto output = std::vector<std::size_t>(compiled.slot_ids.size(), NOT_FOUND);
+
+    for (std::size_t i_gate {0}; i_gate < i_gate_elements.size(); ++i_gate) {
+        const auto& program = compiled.circuit.programs[i_gate_elements[i_gate]];
+
+        for (const auto& instruction : program.instructions()) {
+            if (instruction.operation == kpi::SlotOperation::PUSH_SLOT) {
+                output[instruction.slot] = std::min(output[instruction.slot], i_gate);
+            }
+        }
+    }
+
+    return output;
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+CheckpointSimulator::CheckpointSimulator(
+    QuantumCircuit circuit,
+    QuantumState initial_state,
+    std::size_t memory_budget_in_bytes
+)
+    : circuit_ {std::move(circuit)}
+    , initial_state_ {std::move(initial_state)}
+    , state_ {initial_state_}
+    , compiled_ {kpi::compile_parameter_slots(circuit_)}
+    , i_gate_elements_ {gate_element_indices_(circuit_)}
+    , i_first_gate_of_slot_ {first_gate_of_each_slot_(*compiled_, i_gate_elements_)}
+{
+    if (circuit_.n_qubits() != initial_state_.n_qubits()) {
+        throw std::runtime_error {"ERROR: the checkpoint simulator needs a circuit and state with the same number of qubits.\n"};
+    }
+
+    choose_checkpoints_(memory_budget_in_bytes);
+}
+
+CheckpointSimulator::CheckpointSimulator(const CheckpointSimulator& other) = default;
+CheckpointSimulator::CheckpointSimulator(CheckpointSimulator&& other) noexcept = default;
+auto CheckpointSimulator::operator=(const CheckpointSimulator& other) -> CheckpointSimulator& = default;
+auto CheckpointSimulator::operator=(CheckpointSimulator&& other) noexcept -> CheckpointSimulator& = default;
+CheckpointSimulator::~CheckpointSimulator() = default;
+
+void CheckpointSimulator::choose_checkpoints_(std::size_t memory_budget_in_bytes)
+{
+    // a run can only ever resume right before the first gate of a slot; resuming before the very first
+    // gate is the same as starting over, and needs no checkpoint
+    auto candidates = std::vector<std::size_t> {};
+    for (auto i_gate : i_first_gate_of_slot_) {
+        if (i_gate != 0) {
+            candidates.push_back(i_gate);
+        }
+    }
+
+    std::ranges::sort(candidates);
+    const auto [first, last] = std::ranges::unique(candidates);
+    candidates.erase(first, last);
+
+    const auto bytes_per_checkpoint = initial_state_.n_states() * sizeof(std::complex<double>);
+    const auto max_n_checkpoints = memory_budget_in_bytes / bytes_per_checkpoint;
+
+    if (candidates.size() <= max_n_checkpoints) {
+        i_checkpoint_gates_ = std::move(candidates);
+    }
+    else {
+        i_checkpoint_gates_.reserve(max_n_checkpoints);
+        for (std::size_t i {0}; i < max_n_checkpoints; ++i) {
+            i_checkpoint_gates_.push_back(candidates[(i * candidates.size()) / max_n_checkpoints]);
+        }
+    }
+
+    checkpoints_.resize(i_checkpoint_gates_.size());
+}
+
+auto CheckpointSimulator::run() -> const QuantumState&
+{
+    const auto parameter_values = kpi::parameter_values_from_slots(circuit_, (*compiled_).slot_ids);
+    return run(parameter_values);
+}
+
+auto CheckpointSimulator::run(std::span<const double> parameter_values) -> const QuantumState&
+{
+    const auto& compiled = *compiled_;
+    const auto n_gates = i_gate_elements_.size();
+
+    if (parameter_values.size() != compiled.slot_ids.size()) {
+        throw std::runtime_error {"ERROR: the number of parameter values does not match the number of parameter slots.\n"};
+    }
+
+    // everything before the first gate that reads a changed value is the same as in the previous run
+    auto i_first_changed_gate = std::size_t {0};
+    if (has_been_run_) {
+        i_first_changed_gate = n_gates;
+        for (std::size_t i_slot {0}; i_slot < parameter_values.size(); ++i_slot) {
+            if (parameter_values[i_slot] != previous_parameter_values_[i_slot]) {
+                i_first_changed_gate = std::min(i_first_changed_gate, i_first_gate_of_slot_[i_slot]);
+            }
+        }
+    }
+
+    // the checkpoints after the first changed gate hold states that are now out of date
+    auto i_start_gate = std::size_t {0};
+    auto i_resume_checkpoint = std::optional<std::size_t> {};
+
+    for (std::size_t i {0}; i < i_checkpoint_gates_.size(); ++i) {
+        if (i_checkpoint_gates_[i] > i_first_changed_gate) {
+            checkpoints_[i] = std::nullopt;
+        }
+        else if (checkpoints_[i]) {
+            i_start_gate = i_checkpoint_gates_[i];
+            i_resume_checkpoint = i;
+        }
+    }
+
+    if (has_been_run_ && i_first_changed_gate == n_gates) {
+        // nothing changed, so the state from the previous run is still correct
+        i_start_gate = n_gates;
+        ++statistics_.n_hits;
+    }
+    else if (i_resume_checkpoint) {
+        state_ = *checkpoints_[*i_resume_checkpoint];
+        ++statistics_.n_hits;
+    }
+    else {
+        state_ = initial_state_;
+        ++statistics_.n_misses;
+    }
+
+    statistics_.n_gates_skipped += i_start_gate;
+    statistics_.n_gates_simulated += n_gates - i_start_gate;
+
+    // the checkpoints are sorted, so the next one to fill is always the first one not yet passed
+    auto i_next_checkpoint = static_cast<std::size_t>(
+        std::ranges::upper_bound(i_checkpoint_gates_, i_start_gate) - i_checkpoint_gates_.begin()
+    );
+
+    for (auto i_gate {i_start_gate}; i_gate < n_gates; ++i_gate) {
+        if (i_next_checkpoint < i_checkpoint_gates_.size() && i_checkpoint_gates_[i_next_checkpoint] == i_gate) {
+            checkpoints_[i_next_checkpoint] = state_;
+            ++i_next_checkpoint;
+        }
+
+        const auto i_element = i_gate_elements_[i_gate];
+        const auto& gate_info = circuit_[i_element].get_gate();
+
+        const auto angle = gate_info.param_expression_ptr
+            ? compiled.circuit.programs[i_element].evaluate(parameter_values)
+            : 0.0;
+
+        ki::simulate_single_gate_(state_, gate_info, angle);
+    }
+
+    previous_parameter_values_.assign(parameter_values.begin(), parameter_values.end());
+    has_been_run_ = true;
+
+    return state_;
+}
+
+auto CheckpointSimulator::parameter_slot_ids() const -> const std::vector<param::ParameterID>&
+{
+    return (*compiled_).slot_ids;
+}
+
+auto CheckpointSimulator::n_checkpoints() const noexcept -> std::size_t
+{
+    return i_checkpoint_gates_.size();
+}
+
+void CheckpointSimulator::reset_statistics() noexcept
+{
+    statistics_ = CheckpointCacheStatistics {};
+}
+
+}  // namespace ket
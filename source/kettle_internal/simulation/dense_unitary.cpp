@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/mathtools.hpp"
+#include "kettle/common/utils.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/simulation/dense_unitary.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/common/mathtools_internal.hpp"
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
+#include "kettle_internal/simulation/simulate_utils.hpp"
+
+namespace ki = ket::internal;
+
+
+namespace
+{
+
+/*
+    The circuit of a dense unitary cannot contain measurements, nor the if statements that depend on them.
+*/
+void check_unitary_circuit_(const ket::QuantumCircuit& circuit)  // NOLINT(misc-no-recursion)
+{
+    for (const auto& element : circuit) {
+        if (element.is_control_flow()) {
+            const auto& control_flow = element.get_control_flow();
+
+            if (control_flow.is_repeat_statement()) {
+                check_unitary_circuit_(*control_flow.get_repeat_statement().circuit());
+            }
+            else if (control_flow.is_controlled_block()) {
+                check_unitary_circuit_(*control_flow.get_controlled_block().circuit());
+            }
+            else if (control_flow.is_if_statement() || control_flow.is_if_else_statement()) {
+                throw std::runtime_error {"ERROR: the circuit of a dense unitary cannot contain if statements.\n"};
+            }
+            else {
+                throw std::runtime_error {"DEV ERROR: unimplemented control flow in `check_unitary_circuit_()`\n"};
+            }
+        }
+        else if (element.is_gate() && element.get_gate().gate == ket::Gate::M) {
+            throw std::runtime_error {"ERROR: the circuit of a dense unitary cannot contain measurement gates.\n"};
+        }
+    }
+}
+
+/*
+    Rethrows the first exception caught by any of the worker threads.
+*/
+void rethrow_thread_exceptions_(const std::vector<std::exception_ptr>& exceptions)
+{
+    for (const auto& exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+/*
+    Spreads the bits of `index` over the positions that are not in `fixed_qubits` (which must be
+    sorted in increasing order), leaving the bits at the positions in `fixed_qubits` as `0`.
+*/
+auto insert_zero_bits_(std::size_t index, const std::vector<std::size_t>& fixed_qubits) noexcept -> std::size_t
+{
+    for (auto qubit : fixed_qubits) {
+        const auto lower_mask = ki::pow_2_int(qubit) - 1;
+        index = ((index & ~lower_mask) << 1UL) | (index & lower_mask);
+    }
+
+    return index;
+}
+
+/*
+    Applies `unitary` to the target qubits of `state` in every part of the state where all the
+    bits in `control_mask` are set.
+*/
+void apply_dense_unitary_(
+    ket::QuantumState& state,
+    const ket::DenseUnitary& unitary,
+    const std::vector<std::size_t>& control_qubits,
+    const std::vector<std::size_t>& target_qubits,
+    std::optional<std::size_t> n_threads
+)
+{
+    const auto n_qubits = state.n_qubits();
+
+    if (target_qubits.size() != unitary.n_qubits()) {
+        throw std::runtime_error {"ERROR: the number of target qubits must match the number of qubits of the dense unitary.\n"};
+    }
+
+    auto fixed_qubits = control_qubits;
+    fixed_qubits.insert(fixed_qubits.end(), target_qubits.begin(), target_qubits.end());
+    std::ranges::sort(fixed_qubits);
+
+    if (std::ranges::adjacent_find(fixed_qubits) != fixed_qubits.end()) {
+        throw std::runtime_error {"ERROR: the control and target qubits of a dense unitary must all be different.\n"};
+    }
+
+    if (!fixed_qubits.empty() && fixed_qubits.back() >= n_qubits) {
+        throw std::runtime_error {"ERROR: qubit index out of range when applying a dense unitary.\n"};
+    }
+
+    auto control_mask = std::size_t {0};
+    for (auto qubit : control_qubits) {
+        control_mask |= ki::pow_2_int(qubit);
+    }
+
+    // the offset of each row of the unitary from the index where all the target qubits are `0`
+    const auto size = unitary.size();
+    auto offsets = std::vector<std::size_t>(size, 0);
+    for (std::size_t row {0}; row < size; ++row) {
+        for (std::size_t j {0}; j < target_qubits.size(); ++j) {
+            if ((row >> j) & 1UL) {
+                offsets[row] |= ki::pow_2_int(target_qubits[j]);
+            }
+        }
+    }
+
+    // each work item applies the unitary to a different assignment of the qubits that are not fixed
+    const auto n_blocks = ki::pow_2_int(n_qubits - fixed_qubits.size());
+    const auto n_workers = std::min(n_blocks, std::max(std::size_t {1}, n_threads.value_or(ki::default_number_of_threads_(n_blocks * size * size))));
+
+    ki::parallel_for_(n_blocks, n_workers, [&](ki::FlatIndexPair pair, [[maybe_unused]] std::size_t i_thread) {
+        auto amplitudes = std::vector<std::complex<double>>(size);
+
+        for (auto i_block {pair.i_lower}; i_block < pair.i_upper; ++i_block) {
+            const auto i_base = insert_zero_bits_(i_block, fixed_qubits) | control_mask;
+
+            for (std::size_t col {0}; col < size; ++col) {
+                amplitudes[col] = state[i_base | offsets[col]];
+            }
+
+            for (std::size_t row {0}; row < size; ++row) {
+                auto amplitude = std::complex<double> {0.0, 0.0};
+                for (std::size_t col {0}; col < size; ++col) {
+                    amplitude += unitary(row, col) * amplitudes[col];
+                }
+
+                state[i_base | offsets[row]] = amplitude;
+            }
+        }
+    });
+}
+
+/*
+    The number of rows of the dense unitary on `n_qubits` qubits; this is checked before the matrix
+    is allocated, since the number of elements grows as 4^n_qubits.
+*/
+auto dense_unitary_size_(std::size_t n_qubits) -> std::size_t
+{
+    if (n_qubits > ket::MAX_DENSE_UNITARY_QUBITS) {
+        throw std::runtime_error {"ERROR: a dense unitary cannot act on more than `MAX_DENSE_UNITARY_QUBITS` qubits.\n"};
+    }
+
+    return ki::pow_2_int(n_qubits);
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+DenseUnitary::DenseUnitary(std::size_t n_qubits)
+    : n_qubits_ {n_qubits}
+    , size_ {dense_unitary_size_(n_qubits)}
+    , elements_(size_ * size_, std::complex<double> {0.0, 0.0})
+{
+    for (std::size_t i {0}; i < size_; ++i) {
+        elements_[i * size_ + i] = std::complex<double> {1.0, 0.0};
+    }
+}
+
+DenseUnitary::DenseUnitary(std::size_t n_qubits, std::vector<std::complex<double>> elements)
+    : n_qubits_ {n_qubits}
+    , size_ {dense_unitary_size_(n_qubits)}
+    , elements_ {std::move(elements)}
+{
+    if (elements_.size() != size_ * size_) {
+        throw std::runtime_error {"ERROR: the number of elements does not match the size of the dense unitary.\n"};
+    }
+}
+
+auto operator*(const DenseUnitary& left, const DenseUnitary& right) -> DenseUnitary
+{
+    if (left.n_qubits() != right.n_qubits()) {
+        throw std::runtime_error {"ERROR: cannot multiply dense unitaries with different numbers of qubits.\n"};
+    }
+
+    const auto size = left.size();
+    auto elements = std::vector<std::complex<double>>(size * size, std::complex<double> {0.0, 0.0});
+
+    // the (row, inner, col) loop order reads both matrices along their rows
+    for (std::size_t row {0}; row < size; ++row) {
+        for (std::size_t inner {0}; inner < size; ++inner) {
+            const auto left_elem = left(row, inner);
+            for (std::size_t col {0}; col < size; ++col) {
+                elements[row * size + col] += left_elem * right(inner, col);
+            }
+        }
+    }
+
+    return DenseUnitary {left.n_qubits(), std::move(elements)};
+}
+
+auto almost_eq(
+    const DenseUnitary& left,
+    const DenseUnitary& right,
+    double tolerance_sq
+) noexcept -> bool
+{
+    if (left.n_qubits() != right.n_qubits()) {
+        return false;
+    }
+
+    return std::ranges::equal(left.elements(), right.elements(), [&](const auto& lhs, const auto& rhs) {
+        return almost_eq(lhs, rhs, tolerance_sq);
+    });
+}
+
+auto make_dense_unitary(const QuantumCircuit& circuit, std::optional<std::size_t> n_threads) -> DenseUnitary
+{
+    check_unitary_circuit_(circuit);
+
+    const auto n_qubits = circuit.n_qubits();
+    const auto size = dense_unitary_size_(n_qubits);
+
+    // each work item is the simulation of an entire circuit, so the hardware threads are all worth using
+    const auto n_hardware_threads = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    const auto n_workers = std::min(size, std::max(std::size_t {1}, n_threads.value_or(n_hardware_threads)));
+
+    auto elements = std::vector<std::complex<double>>(size * size, std::complex<double> {0.0, 0.0});
+    auto exceptions = std::vector<std::exception_ptr>(n_workers);
+
+    ki::parallel_for_(size, n_workers, [&](ki::FlatIndexPair pair, std::size_t i_thread) {
+        try {
+            for (auto col {pair.i_lower}; col < pair.i_upper; ++col) {
+                auto state = QuantumState {n_qubits};
+                state[0] = std::complex<double> {0.0, 0.0};
+                state[col] = std::complex<double> {1.0, 0.0};
+
+                simulate(circuit, state);
+
+                for (std::size_t row {0}; row < size; ++row) {
+                    elements[row * size + col] = state[row];
+                }
+            }
+        }
+        catch (...) {
+            exceptions[i_thread] = std::current_exception();
+        }
+    });
+
+    rethrow_thread_exceptions_(exceptions);
+
+    return DenseUnitary {n_qubits, std::move(elements)};
+}
+
+auto dense_unitary_power_of_2(const DenseUnitary& unitary, std::size_t exponent) -> DenseUnitary
+{
+    auto output = unitary;
+    for (std::size_t i {0}; i < exponent; ++i) {
+        output = output * output;
+    }
+
+    return output;
+}
+
+template <QubitIndices Container>
+void apply_dense_unitary(
+    QuantumState& state,
+    const DenseUnitary& unitary,
+    const Container& target_qubits,
+    std::optional<std::size_t> n_threads
+)
+{
+    const auto targets = std::vector<std::size_t> (target_qubits.begin(), target_qubits.end());
+    apply_dense_unitary_(state, unitary, {}, targets, n_threads);
+}
+
+template <QubitIndices Container>
+void apply_controlled_dense_unitary(
+    QuantumState& state,
+    const DenseUnitary& unitary,
+    const Container& control_qubits,
+    const Container& target_qubits,
+    std::optional<std::size_t> n_threads
+)
+{
+    const auto controls = std::vector<std::size_t> (control_qubits.begin(), control_qubits.end());
+    const auto targets = std::vector<std::size_t> (target_qubits.begin(), target_qubits.end());
+    apply_dense_unitary_(state, unitary, controls, targets, n_threads);
+}
+
+template void apply_dense_unitary<QubitIndicesVector>(
+    QuantumState& state,
+    const DenseUnitary& unitary,
+    const QubitIndicesVector& target_qubits,
+    std::optional<std::size_t> n_threads
+);
+
+template void apply_dense_unitary<QubitIndicesIList>(
+    QuantumState& state,
+    const DenseUnitary& unitary,
+    const QubitIndicesIList& target_qubits,
+    std::optional<std::size_t> n_threads
+);
+
+template void apply_controlled_dense_unitary<QubitIndicesVector>(
+    QuantumState& state,
+    const DenseUnitary& unitary,
+    const QubitIndicesVector& control_qubits,
+    const QubitIndicesVector& target_qubits,
+    std::optional<std::size_t> n_threads
+);
+
+template void apply_controlled_dense_unitary<QubitIndicesIList>(
+    QuantumState& state,
+    const DenseUnitary& unitary,
+    const QubitIndicesIList& control_qubits,
+    const QubitIndicesIList& target_qubits,
+    std::optional<std::size_t> n_threads
+);
+
+}  // namespace ket
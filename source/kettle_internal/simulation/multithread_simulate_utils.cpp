@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include "kettle_internal/simulation/simulate_utils.hpp"
@@ -58,4 +60,12 @@ auto partial_sum_pairs_(std::size_t n_gate_pairs, std::size_t n_threads) -> std:
     return output;
 }
 
+auto default_number_of_threads_(std::size_t n_work_items) -> std::size_t
+{
+    const auto n_hardware_threads = std::max(std::size_t {1}, static_cast<std::size_t>(std::thread::hardware_concurrency()));
+    const auto n_useful_threads = std::max(std::size_t {1}, n_work_items / MINIMUM_WORK_ITEMS_PER_THREAD_);
+
+    return std::min(n_hardware_threads, n_useful_threads);
+}
+
 }  // namespace ket::internal
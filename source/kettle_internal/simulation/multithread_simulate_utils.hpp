@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <thread>
 #include <vector>
 
 #include "kettle_internal/simulation/simulate_utils.hpp"
@@ -17,4 +20,45 @@ auto partial_sums_from_zero_(const std::vector<std::size_t>& values) -> std::vec
 
 auto partial_sum_pairs_(std::size_t n_gate_pairs, std::size_t n_threads) -> std::vector<FlatIndexPair>;
 
+/*
+    Below this many work items per thread, the cost of launching the threads outweighs the
+    benefit of splitting up the work.
+*/
+constexpr inline auto MINIMUM_WORK_ITEMS_PER_THREAD_ = std::size_t {1UL << 14};
+
+/*
+    The number of threads to use for `n_work_items` independent work items; this is limited by both
+    the hardware concurrency and `MINIMUM_WORK_ITEMS_PER_THREAD_`, and is always at least 1.
+*/
+auto default_number_of_threads_(std::size_t n_work_items) -> std::size_t;
+
+/*
+    Splits the half-open range [0, n_work_items) into `n_threads` contiguous, load-balanced blocks,
+    and calls `func(FlatIndexPair block, std::size_t i_thread)` once for each block.
+
+    The block for `i_thread == 0` is processed on the calling thread, and the function only returns
+    once all blocks have been processed. The `func` must not throw.
+*/
+template <typename Function>
+void parallel_for_(std::size_t n_work_items, std::size_t n_threads, Function&& func)
+{
+    if (n_threads <= 1 || n_work_items < n_threads) {
+        func(FlatIndexPair {0, n_work_items}, std::size_t {0});
+        return;
+    }
+
+    const auto blocks = partial_sum_pairs_(n_work_items, n_threads);
+
+    {
+        auto threads = std::vector<std::jthread> {};
+        threads.reserve(n_threads - 1);
+
+        for (std::size_t i_thread {1}; i_thread < n_threads; ++i_thread) {
+            threads.emplace_back(std::cref(func), blocks[i_thread], i_thread);
+        }
+
+        func(blocks[0], std::size_t {0});
+    }  // all threads join here
+}
+
 }  // namespace ket::internal
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/matrix2x2.hpp"
+#include "kettle/gates/common_u_gates.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+
+#include "kettle_internal/common/mathtools_internal.hpp"
+#include "kettle_internal/gates/pauli_rotation_gadget.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+#include "kettle_internal/parameter/parameter_expression_internal.hpp"
+#include "kettle_internal/simulation/out_of_core_schedule.hpp"
+
+namespace ki = ket::internal;
+namespace kpi = ket::param::internal;
+
+
+namespace
+{
+
+using G = ket::Gate;
+
+/*
+    Assigns each gate, in order, to the earliest pass that it can join. This gives the same passes as
+    sweeping through the remaining gates over and over, and taking every gate that fits into the next
+    pass, but each gate is only looked at once.
+
+    A gate must be in the same pass as, or a later pass than, every earlier gate that shares a qubit
+    with it; for each qubit, `frontier_` holds the latest pass of the gates that act on it. A gate on a
+    high qubit can only join a pass that has no high target yet, or has the same one.
+*/
+class PassScheduler_
+{
+public:
+    explicit PassScheduler_(std::size_t n_chunk_qubits)
+        : n_chunk_qubits_ {n_chunk_qubits}
+    {}
+
+    void add(const ki::OutOfCoreGate_& gate)
+    {
+        const auto qubit_mask = gate.control_mask | ki::pow_2_int(gate.target);
+
+        auto earliest = std::size_t {0};
+        for_each_qubit_(qubit_mask, [&](std::size_t qubit) { earliest = std::max(earliest, frontier_[qubit]); });
+
+        const auto i_pass = gate.target < n_chunk_qubits_ ? earliest : first_pass_for_high_target_(gate.target, earliest);
+        if (i_pass == passes_.size()) {
+            passes_.emplace_back();
+            passes_without_high_target_.insert(i_pass);
+        }
+
+        auto& pass = passes_[i_pass];
+        if (gate.target >= n_chunk_qubits_ && !pass.high_target) {
+            pass.high_target = gate.target;
+            passes_without_high_target_.erase(i_pass);
+            passes_by_high_target_[gate.target].insert(i_pass);
+        }
+
+        pass.gates.push_back(gate);
+        for_each_qubit_(qubit_mask, [&](std::size_t qubit) { frontier_[qubit] = i_pass; });
+    }
+
+    /*
+        Returns the passes of all the gates added so far, and starts over with no gates.
+    */
+    auto take_passes() -> std::vector<ki::OutOfCorePass_>
+    {
+        frontier_.fill(0);
+        passes_without_high_target_.clear();
+        passes_by_high_target_.clear();
+
+        return std::exchange(passes_, {});
+    }
+
+private:
+    std::size_t n_chunk_qubits_;
+    std::vector<ki::OutOfCorePass_> passes_;
+    std::array<std::size_t, std::numeric_limits<std::size_t>::digits> frontier_ {};
+    std::set<std::size_t> passes_without_high_target_;
+    std::unordered_map<std::size_t, std::set<std::size_t>> passes_by_high_target_;
+
+    template <typename Function>
+    static void for_each_qubit_(std::size_t qubit_mask, Function&& func)
+    {
+        while (qubit_mask != 0) {
+            func(static_cast<std::size_t>(std::countr_zero(qubit_mask)));
+            qubit_mask &= qubit_mask - 1;
+        }
+    }
+
+    /*
+        The index of the earliest pass, no earlier than `earliest`, that a gate on the high qubit
+        `high_target` can join; this is one past the last pass if no existing pass fits.
+    */
+    auto first_pass_for_high_target_(std::size_t high_target, std::size_t earliest) const -> std::size_t
+    {
+        auto output = passes_.size();
+
+        const auto it_open = passes_without_high_target_.lower_bound(earliest);
+        if (it_open != passes_without_high_target_.end()) {
+            output = *it_open;
+        }
+
+        const auto it_target = passes_by_high_target_.find(high_target);
+        if (it_target != passes_by_high_target_.end()) {
+            const auto it_same = it_target->second.lower_bound(earliest);
+            if (it_same != it_target->second.end()) {
+                output = std::min(output, *it_same);
+            }
+        }
+
+        return output;
+    }
+};
+
+void add_out_of_core_gate_(  // NOLINT(misc-no-recursion)
+    const kpi::MapVariant& parameter_values_map,
+    const ket::GateInfo& info,
+    std::size_t control_mask,
+    PassScheduler_& scheduler
+)
+{
+    namespace gid = ki::gate_id;
+    namespace cre = ki::create;
+
+    const auto add_gate = [&](const ket::Matrix2X2& matrix, std::size_t target, std::size_t mask) {
+        scheduler.add(ki::OutOfCoreGate_ {.matrix=matrix, .target=target, .control_mask=mask});
+    };
+
+    if (info.gate == G::U) {
+        const auto& [target, unitary_ptr] = cre::unpack_u_gate(info);
+        add_gate(*unitary_ptr, target, control_mask);
+    }
+    else if (info.gate == G::CU) {
+        const auto& [control, target, unitary_ptr] = cre::unpack_cu_gate(info);
+        add_gate(*unitary_ptr, target, control_mask | ki::pow_2_int(control));
+    }
+    else if (gid::is_1t_gate(info.gate)) {
+        add_gate(ket::non_angle_gate(info.gate), cre::unpack_one_target_gate(info), control_mask);
+    }
+    else if (gid::is_1t1a_gate(info.gate)) {
+        const auto [target, angle] = kpi::unpack_target_and_angle(parameter_values_map, info);
+        add_gate(ket::angle_gate(info.gate, angle), target, control_mask);
+    }
+    else if (gid::is_1c1t_gate(info.gate)) {
+        const auto [control, target] = cre::unpack_one_control_one_target_gate(info);
+        add_gate(ket::non_angle_gate(info.gate), target, control_mask | ki::pow_2_int(control));
+    }
+    else if (gid::is_1c1t1a_gate(info.gate)) {
+        const auto [control, target, angle] = kpi::unpack_control_target_and_angle(parameter_values_map, info);
+        add_gate(ket::angle_gate(info.gate, angle), target, control_mask | ki::pow_2_int(control));
+    }
+    else if (info.gate == G::PAULI_ROT) {
+        for (const auto& decomp_info : ki::decomp_pauli_rotation_gate_(info)) {
+            add_out_of_core_gate_(parameter_values_map, decomp_info, control_mask, scheduler);
+        }
+    }
+    else if (info.gate == G::M) {
+        throw std::runtime_error {"ERROR: the out-of-core simulation does not support measurement gates.\n"};
+    }
+    else {
+        throw std::runtime_error {"DEV ERROR: unimplemented gate found in `add_out_of_core_gate_()`\n"};
+    }
+}
+
+void append_passes_(std::vector<ki::OutOfCorePass_> passes, std::vector<ki::OutOfCoreStep_>& steps)
+{
+    for (auto& pass : passes) {
+        steps.emplace_back(std::move(pass));
+    }
+}
+
+/*
+    Adds the gates of `circuit` to `scheduler`. The passes of the gates before each repeat statement
+    are moved into `steps` before the steps of the repeat statement itself, which are scheduled apart
+    from everything else.
+*/
+void schedule_circuit_(  // NOLINT(misc-no-recursion)
+    const kpi::MapVariant& parameter_values_map,
+    const ket::QuantumCircuit& circuit,
+    std::size_t control_mask,
+    std::size_t n_chunk_qubits,
+    PassScheduler_& scheduler,
+    std::vector<ki::OutOfCoreStep_>& steps
+)
+{
+    for (const auto& element : circuit) {
+        if (element.is_gate()) {
+            add_out_of_core_gate_(parameter_values_map, element.get_gate(), control_mask, scheduler);
+        }
+        else if (element.is_control_flow()) {
+            const auto& control_flow = element.get_control_flow();
+
+            if (control_flow.is_repeat_statement()) {
+                const auto& repeat_stmt = control_flow.get_repeat_statement();
+                const auto n_repetitions = repeat_stmt.n_repetitions();
+
+                if (n_repetitions == 0) {
+                    continue;
+                }
+
+                // a single repetition is no different from the gates being written out in place
+                if (n_repetitions == 1) {
+                    schedule_circuit_(parameter_values_map, *repeat_stmt.circuit(), control_mask, n_chunk_qubits, scheduler, steps);
+                    continue;
+                }
+
+                auto body_scheduler = PassScheduler_ {n_chunk_qubits};
+                auto body_steps = std::vector<ki::OutOfCoreStep_> {};
+                schedule_circuit_(parameter_values_map, *repeat_stmt.circuit(), control_mask, n_chunk_qubits, body_scheduler, body_steps);
+                append_passes_(body_scheduler.take_passes(), body_steps);
+
+                if (body_steps.empty()) {
+                    continue;
+                }
+
+                append_passes_(scheduler.take_passes(), steps);
+
+                // a body that fits in a single pass is repeated while each chunk is in memory, so the
+                // file is still only read and written once
+                if (body_steps.size() == 1 && std::holds_alternative<ki::OutOfCorePass_>(body_steps[0])) {
+                    auto& pass = std::get<ki::OutOfCorePass_>(body_steps[0]);
+                    pass.n_repetitions *= n_repetitions;
+                    steps.push_back(std::move(body_steps[0]));
+                }
+                else {
+                    steps.emplace_back(ki::OutOfCoreLoop_ {.n_repetitions=n_repetitions, .steps=std::move(body_steps)});
+                }
+            }
+            else if (control_flow.is_controlled_block()) {
+                const auto& block = control_flow.get_controlled_block();
+
+                auto block_mask = control_mask;
+                for (auto qubit : block.control_qubits()) {
+                    block_mask |= ki::pow_2_int(qubit);
+                }
+
+                schedule_circuit_(parameter_values_map, *block.circuit(), block_mask, n_chunk_qubits, scheduler, steps);
+            }
+            else if (control_flow.is_if_statement() || control_flow.is_if_else_statement()) {
+                throw std::runtime_error {"ERROR: the out-of-core simulation does not support classical if statements.\n"};
+            }
+            else {
+                throw std::runtime_error {"DEV ERROR: unimplemented control flow in `schedule_circuit_()`\n"};
+            }
+        }
+        else {
+            throw std::runtime_error {"ERROR: the out-of-core simulation does not support circuit loggers.\n"};
+        }
+    }
+}
+
+}  // namespace
+
+
+namespace ket::internal
+{
+
+auto schedule_out_of_core_(const ket::QuantumCircuit& circuit, std::size_t n_chunk_qubits) -> std::vector<OutOfCoreStep_>
+{
+    const auto parameter_values = kpi::create_parameter_values_map(circuit.parameter_data_map());
+    const auto parameter_values_map = kpi::MapVariant {std::cref(parameter_values)};
+
+    auto scheduler = PassScheduler_ {n_chunk_qubits};
+    auto steps = std::vector<OutOfCoreStep_> {};
+    schedule_circuit_(parameter_values_map, circuit, 0, n_chunk_qubits, scheduler, steps);
+    append_passes_(scheduler.take_passes(), steps);
+
+    return steps;
+}
+
+auto schedule_out_of_core_passes_(
+    const std::vector<OutOfCoreGate_>& gates,
+    std::size_t n_chunk_qubits
+) -> std::vector<OutOfCorePass_>
+{
+    auto scheduler = PassScheduler_ {n_chunk_qubits};
+    for (const auto& gate : gates) {
+        scheduler.add(gate);
+    }
+
+    return scheduler.take_passes();
+}
+
+}  // namespace ket::internal
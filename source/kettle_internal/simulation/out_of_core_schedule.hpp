@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/matrix2x2.hpp"
+
+/*
+    This header file contains the code that decides the order in which the gates of a circuit are
+    applied to a `DiskQuantumState`, which only ever holds one or two of its chunks in memory.
+
+    A gate whose target qubit lies within a chunk (a "low" qubit) can be applied to each chunk on its
+    own; its control qubits outside the chunk (the "high" qubits) have the same value everywhere in
+    the chunk, and only decide whether the gate applies to that chunk. A gate whose target is a high
+    qubit mixes the amplitudes of pairs of chunks, which must be in memory at the same time.
+*/
+
+namespace ket::internal
+{
+
+/*
+    Every gate that the out-of-core simulation supports is a 2x2 unitary on a target qubit, applied
+    where all the qubits in `control_mask` are set.
+*/
+struct OutOfCoreGate_
+{
+    ket::Matrix2X2 matrix;
+    std::size_t target;
+    std::size_t control_mask;
+};
+
+/*
+    The gates applied during a single pass over the file. If `high_target` is empty, the pass applies
+    every gate to one chunk at a time; otherwise, the pass streams through the pairs of chunks that
+    differ only in the qubit `high_target`, and every gate targets either that qubit or a low qubit.
+
+    The gates are applied, in order, `n_repetitions` times to each chunk (or pair of chunks) while it
+    is in memory; this is how the body of a repeat statement that fits in a single pass is run.
+*/
+struct OutOfCorePass_
+{
+    std::optional<std::size_t> high_target;
+    std::vector<OutOfCoreGate_> gates;
+    std::size_t n_repetitions {1};
+};
+
+struct OutOfCoreLoop_;
+
+/*
+    Each step of an out-of-core simulation is either a pass over the file, or a loop over other steps.
+*/
+using OutOfCoreStep_ = std::variant<OutOfCorePass_, OutOfCoreLoop_>;
+
+/*
+    Steps that are run `n_repetitions` times in a row; this is how the body of a repeat statement that
+    needs more than one pass is run, so that its passes are only scheduled (and stored) once.
+*/
+struct OutOfCoreLoop_
+{
+    std::size_t n_repetitions;
+    std::vector<OutOfCoreStep_> steps;
+};
+
+/*
+    Schedules the gates of `circuit` into steps. The controls of its controlled blocks are added to
+    their gates, its Pauli rotation gates are decomposed, and the angles of its parameterized gates
+    are evaluated.
+
+    Repeat statements are kept as loops rather than unrolled, so the schedule takes as much memory as
+    the gates written in the circuit, no matter how many times they are repeated. The gates before and
+    after a repeat statement (with more than one repetition) are never moved across it.
+
+    Measurements, classical if statements, and circuit loggers are not supported.
+*/
+auto schedule_out_of_core_(const ket::QuantumCircuit& circuit, std::size_t n_chunk_qubits) -> std::vector<OutOfCoreStep_>;
+
+/*
+    Splits `gates` into passes; within each pass, gates may be moved ahead of earlier gates that
+    act on entirely different qubits, so that as many gates as possible share the same pass.
+
+    Each gate joins the earliest pass it can, which takes a logarithmic time in the number of passes.
+*/
+auto schedule_out_of_core_passes_(
+    const std::vector<OutOfCoreGate_>& gates,
+    std::size_t n_chunk_qubits
+) -> std::vector<OutOfCorePass_>;
+
+}  // namespace ket::internal
@@ -1,21 +1,35 @@
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <complex>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
 #include <vector>
 
 #include "kettle/circuit/classical_register.hpp"
 #include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/compact_circuit.hpp"
 #include "kettle/circuit_loggers/circuit_logger.hpp"
+#include "kettle/common/clone_ptr.hpp"
 #include "kettle/common/matrix2x2.hpp"
 #include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/parameter/parameter_slots.hpp"
 #include "kettle/state/state.hpp"
 
 #include "kettle/simulation/simulate.hpp"
 
+#include "kettle_internal/common/mathtools_internal.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+#include "kettle_internal/operator/pauli/pauli_operator_internal.hpp"
 #include "kettle_internal/parameter/parameter_expression_internal.hpp"
+#include "kettle_internal/parameter/parameter_slots_internal.hpp"
 #include "kettle_internal/simulation/gate_pair_generator.hpp"
 #include "kettle_internal/simulation/measure.hpp"
+#include "kettle_internal/simulation/simulate_internal.hpp"
 #include "kettle_internal/simulation/simulate_utils.hpp"
 #include "kettle_internal/simulation/operations.hpp"
 
@@ -36,25 +50,95 @@ struct gate_always_false : std::false_type
 
 constexpr inline auto MEASURING_THREAD_ID = int {0};
 
+/*
+    Shrinks a range of flat indices over the pairs of an uncontrolled gate, into the matching range
+    over the pairs of the same gate inside a controlled block with the control qubits in `control_mask`.
+
+    Each control qubit halves the number of pairs, so ranges that split up the pairs of an uncontrolled
+    gate between threads also split up the pairs of the controlled gate.
+*/
+auto controlled_pair_(const ki::FlatIndexPair& pair, std::size_t control_mask) -> ki::FlatIndexPair
+{
+    const auto n_controls = std::popcount(control_mask);
+    return {.i_lower=pair.i_lower >> n_controls, .i_upper=pair.i_upper >> n_controls};
+}
+
+
+template <typename Generator, typename Function>
+void for_each_pair_(Generator pair_iterator, const ki::FlatIndexPair& pair, Function&& apply)
+{
+    pair_iterator.set_state(pair.i_lower);
+
+    for (std::size_t i {pair.i_lower}; i < pair.i_upper; ++i) {
+        const auto [state0_index, state1_index] = pair_iterator.next();
+        apply(state0_index, state1_index);
+    }
+}
+
+
+/*
+    Calls `apply(state0_index, state1_index)` for the pairs of indices that a single-qubit gate on
+    `target_index` mixes; if `control_mask` is not zero, the gate is inside a controlled block, and
+    only the pairs where all of its control qubits are 1 are visited.
+*/
+template <typename Function>
+void for_each_single_qubit_gate_pair_(
+    std::size_t target_index,
+    std::size_t control_mask,
+    std::size_t n_qubits,
+    const ki::FlatIndexPair& pair,
+    Function&& apply
+)
+{
+    if (control_mask == 0) {
+        for_each_pair_(ki::SingleQubitGatePairGenerator {target_index, n_qubits}, pair, apply);
+    }
+    else {
+        const auto pair_iterator = ki::ControlledGatePairGenerator {target_index, control_mask, n_qubits};
+        for_each_pair_(pair_iterator, controlled_pair_(pair, control_mask), apply);
+    }
+}
+
+
+/*
+    Same as above, for a gate with one control qubit; inside a controlled block, the control qubit
+    of the gate is treated as one more control qubit of the block.
+*/
+template <typename Function>
+void for_each_double_qubit_gate_pair_(
+    std::size_t control_index,
+    std::size_t target_index,
+    std::size_t control_mask,
+    std::size_t n_qubits,
+    const ki::FlatIndexPair& pair,
+    Function&& apply
+)
+{
+    if (control_mask == 0) {
+        for_each_pair_(ki::DoubleQubitGatePairGenerator {control_index, target_index, n_qubits}, pair, apply);
+    }
+    else {
+        const auto gate_control_mask = control_mask | ki::pow_2_int(control_index);
+        const auto pair_iterator = ki::ControlledGatePairGenerator {target_index, gate_control_mask, n_qubits};
+        for_each_pair_(pair_iterator, controlled_pair_(pair, control_mask), apply);
+    }
+}
+
+
 template <ket::Gate GateType>
 void simulate_one_target_gate_(
     ket::QuantumState& state,
     const ket::GateInfo& info,
-    const ki::FlatIndexPair& pair
+    const ki::FlatIndexPair& pair,
+    std::size_t control_mask
 )
 {
     namespace cre = ki::create;
     using Gate = ket::Gate;
 
     const auto target_index = cre::unpack_single_qubit_gate_index(info);
-    const auto n_qubits = state.n_qubits();
-
-    auto pair_iterator = ki::SingleQubitGatePairGenerator {target_index, n_qubits};
-    pair_iterator.set_state(pair.i_lower);
-
-    for (std::size_t i {pair.i_lower}; i < pair.i_upper; ++i) {
-        const auto [state0_index, state1_index] = pair_iterator.next();
 
+    const auto apply = [&state](std::size_t state0_index, std::size_t state1_index) {
         if constexpr (GateType == Gate::H) {
             ki::apply_h_gate(state, state0_index, state1_index);
         }
@@ -88,29 +172,26 @@ void simulate_one_target_gate_(
         else {
             static_assert(gate_always_false<GateType>::value, "Invalid one target gate.");
         }
-    }
+    };
+
+    for_each_single_qubit_gate_pair_(target_index, control_mask, state.n_qubits(), pair, apply);
 }
 
 
 template <ket::Gate GateType>
 void simulate_one_target_one_angle_gate_(
-    const kpi::MapVariant& parameter_values_map,
     ket::QuantumState& state,
     const ket::GateInfo& info,
-    const ki::FlatIndexPair& pair
+    double theta,
+    const ki::FlatIndexPair& pair,
+    std::size_t control_mask
 )
 {
     using Gate = ket::Gate;
 
-    const auto [target_index, theta] = kpi::unpack_target_and_angle(parameter_values_map, info);
-    const auto n_qubits = state.n_qubits();
-
-    auto pair_iterator = ki::SingleQubitGatePairGenerator {target_index, n_qubits};
-    pair_iterator.set_state(pair.i_lower);
-
-    for (std::size_t i {pair.i_lower}; i < pair.i_upper; ++i) {
-        const auto [state0_index, state1_index] = pair_iterator.next();
+    const auto target_index = ki::create::unpack_single_qubit_gate_index(info);
 
+    const auto apply = [&state, theta](std::size_t state0_index, std::size_t state1_index) {
         if constexpr (GateType == Gate::RX) {
             ki::apply_rx_gate(state, state0_index, state1_index, theta);
         }
@@ -126,7 +207,9 @@ void simulate_one_target_one_angle_gate_(
         else {
             static_assert(gate_always_false<GateType>::value, "Invalid one target one angle gate.");
         }
-    }
+    };
+
+    for_each_single_qubit_gate_pair_(target_index, control_mask, state.n_qubits(), pair, apply);
 }
 
 
@@ -134,18 +217,17 @@ void simulate_u_gate_(
     ket::QuantumState& state,
     const ket::GateInfo& info,
     const ket::Matrix2X2& mat,
-    const ki::FlatIndexPair& pair
+    const ki::FlatIndexPair& pair,
+    std::size_t control_mask
 )
 {
     const auto target_index = ki::create::unpack_single_qubit_gate_index(info);
-    const auto n_qubits = state.n_qubits();
-    auto pair_iterator = ki::SingleQubitGatePairGenerator {target_index, n_qubits};
-    pair_iterator.set_state(pair.i_lower);
 
-    for (std::size_t i {pair.i_lower}; i < pair.i_upper; ++i) {
-        const auto [state0_index, state1_index] = pair_iterator.next();
+    const auto apply = [&state, &mat](std::size_t state0_index, std::size_t state1_index) {
         ki::apply_u_gate(state, state0_index, state1_index, mat);
-    }
+    };
+
+    for_each_single_qubit_gate_pair_(target_index, control_mask, state.n_qubits(), pair, apply);
 }
 
 
@@ -153,21 +235,16 @@ template <ket::Gate GateType>
 void simulate_one_control_one_target_gate_(
     ket::QuantumState& state,
     const ket::GateInfo& info,
-    const ki::FlatIndexPair& pair
+    const ki::FlatIndexPair& pair,
+    std::size_t control_mask
 )
 {
     namespace cre = ki::create;
     using Gate = ket::Gate;
 
     const auto [control_index, target_index] = cre::unpack_double_qubit_gate_indices(info);
-    const auto n_qubits = state.n_qubits();
-
-    auto pair_iterator = ki::DoubleQubitGatePairGenerator {control_index, target_index, n_qubits};
-    pair_iterator.set_state(pair.i_lower);
-
-    for (std::size_t i {pair.i_lower}; i < pair.i_upper; ++i) {
-        [[maybe_unused]] const auto [state0_index, state1_index] = pair_iterator.next();
 
+    const auto apply = [&state]([[maybe_unused]] std::size_t state0_index, std::size_t state1_index) {
         if constexpr (GateType == Gate::CH) {
             ki::apply_h_gate(state, state0_index, state1_index);
         }
@@ -201,29 +278,26 @@ void simulate_one_control_one_target_gate_(
         else {
             static_assert(gate_always_false<GateType>::value, "Invalid one control one target gate.");
         }
-    }
+    };
+
+    for_each_double_qubit_gate_pair_(control_index, target_index, control_mask, state.n_qubits(), pair, apply);
 }
 
 
 template <ket::Gate GateType>
 void simulate_one_control_one_target_one_angle_gate_(
-    const kpi::MapVariant& parameter_values_map,
     ket::QuantumState& state,
     const ket::GateInfo& info,
-    const ki::FlatIndexPair& pair
+    double theta,
+    const ki::FlatIndexPair& pair,
+    std::size_t control_mask
 )
 {
     using Gate = ket::Gate;
 
-    const auto [control_index, target_index, theta] = kpi::unpack_control_target_and_angle(parameter_values_map, info);
-    const auto n_qubits = state.n_qubits();
-
-    auto pair_iterator = ki::DoubleQubitGatePairGenerator {control_index, target_index, n_qubits};
-    pair_iterator.set_state(pair.i_lower);
-
-    for (std::size_t i {pair.i_lower}; i < pair.i_upper; ++i) {
-        [[maybe_unused]] const auto [state0_index, state1_index] = pair_iterator.next();
+    const auto [control_index, target_index] = ki::create::unpack_double_qubit_gate_indices(info);
 
+    const auto apply = [&state, theta]([[maybe_unused]] std::size_t state0_index, std::size_t state1_index) {
         if constexpr (GateType == Gate::CRX) {
             ki::apply_rx_gate(state, state0_index, state1_index, theta);
         }
@@ -239,7 +313,9 @@ void simulate_one_control_one_target_one_angle_gate_(
         else {
             static_assert(gate_always_false<GateType>::value, "Invalid one control one target one angle gate.");
         }
-    }
+    };
+
+    for_each_double_qubit_gate_pair_(control_index, target_index, control_mask, state.n_qubits(), pair, apply);
 }
 
 
@@ -247,27 +323,94 @@ void simulate_cu_gate_(
     ket::QuantumState& state,
     const ket::GateInfo& info,
     const ket::Matrix2X2& mat,
-    const ki::FlatIndexPair& pair
+    const ki::FlatIndexPair& pair,
+    std::size_t control_mask
 )
 {
     const auto [control_index, target_index] = ki::create::unpack_double_qubit_gate_indices(info);
-    const auto n_qubits = state.n_qubits();
-    auto pair_iterator = ki::DoubleQubitGatePairGenerator {control_index, target_index, n_qubits};
-    pair_iterator.set_state(pair.i_lower);
 
-    for (std::size_t i {pair.i_lower}; i < pair.i_upper; ++i) {
-        const auto [state0_index, state1_index] = pair_iterator.next();
+    const auto apply = [&state, &mat](std::size_t state0_index, std::size_t state1_index) {
         ki::apply_u_gate(state, state0_index, state1_index, mat);
+    };
+
+    for_each_double_qubit_gate_pair_(control_index, target_index, control_mask, state.n_qubits(), pair, apply);
+}
+
+
+/*
+    Applies exp(-i theta P / 2) = cos(theta / 2) I - i sin(theta / 2) P in a single pass over the state.
+
+    The Pauli string P only mixes the amplitudes at `j` and `j ^ x_mask`, so the pairs are generated by
+    treating the highest qubit in the X-mask as the target of a single-qubit gate; each pair is then
+    visited exactly once. If the X-mask is empty, then P is diagonal, and both indices of each pair are
+    only multiplied by a phase; the pairs are then generated with the lowest qubit that is not one of
+    the control qubits of a surrounding controlled block as the target.
+*/
+void simulate_pauli_rotation_gate_(
+    ket::QuantumState& state,
+    const ket::SparsePauliString& pauli_string,
+    double theta,
+    const ki::FlatIndexPair& pair,
+    std::size_t control_mask
+)
+{
+    const auto [x_mask, z_mask, phase] = ki::pauli_string_masks_(pauli_string);
+    const auto n_qubits = state.n_qubits();
+
+    const auto cost = std::cos(theta / 2.0);
+    const auto mixing = std::complex<double> {0.0, -std::sin(theta / 2.0)} * phase;
+
+    const auto parity_sign = [z_mask](std::size_t i) {
+        return (std::popcount(i & z_mask) % 2 == 0) ? 1.0 : -1.0;
+    };
+
+    if (x_mask == 0) {
+        const auto apply = [&](std::size_t state0_index, std::size_t state1_index) {
+            state[state0_index] *= cost + (mixing * parity_sign(state0_index));
+            state[state1_index] *= cost + (mixing * parity_sign(state1_index));
+        };
+
+        const auto target_index = static_cast<std::size_t>(std::countr_one(control_mask));
+        for_each_single_qubit_gate_pair_(target_index, control_mask, n_qubits, pair, apply);
+
+        return;
     }
+
+    const auto apply = [&, x_mask](std::size_t state0_index, [[maybe_unused]] std::size_t ignore) {
+        const auto state1_index = state0_index ^ x_mask;
+
+        const auto state0 = state[state0_index];
+        const auto state1 = state[state1_index];
+
+        state[state0_index] = (cost * state0) + (mixing * parity_sign(state1_index) * state1);
+        state[state1_index] = (cost * state1) + (mixing * parity_sign(state0_index) * state0);
+    };
+
+    const auto target_index = static_cast<std::size_t>(std::bit_width(x_mask) - 1);
+    for_each_single_qubit_gate_pair_(target_index, control_mask, n_qubits, pair, apply);
 }
 
 
-void simulate_gate_info_(
-    const kpi::MapVariant& parameter_values_map,
+/*
+    The `angle` is only used by the gates that take an angle; for parameterized gates, it is the value
+    of the gate's parameter expression, which the caller is responsible for evaluating.
+
+    Only the gate and the qubit and bit indices of `gate_info` are used; the matrix of a U or CU gate is
+    `unitary`, and the Pauli string of a PAULI_ROT gate is `pauli_string`, so that the gates of a
+    `CompactCircuit` can be simulated without building their matrices and Pauli strings again.
+
+    The `control_mask` holds the control qubits of all the controlled blocks that the gate is inside of;
+    it is zero for gates that are not inside a controlled block.
+*/
+void simulate_gate_(
     ket::QuantumState& state,
     const ki::FlatIndexPair& single_pair,
     const ki::FlatIndexPair& double_pair,
     const ket::GateInfo& gate_info,
+    double angle,
+    const ket::Matrix2X2* unitary,
+    const ket::SparsePauliString* pauli_string,
+    std::size_t control_mask,
     int thread_id,
     std::optional<int> prng_seed,
     ket::ClassicalRegister& c_register
@@ -278,125 +421,127 @@ void simulate_gate_info_(
 
     switch (gate_info.gate) {
         case G::H : {
-            simulate_one_target_gate_<G::H>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::H>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::X : {
-            simulate_one_target_gate_<G::X>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::X>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::Y : {
-            simulate_one_target_gate_<G::Y>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::Y>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::Z : {
-            simulate_one_target_gate_<G::Z>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::Z>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::S : {
-            simulate_one_target_gate_<G::S>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::S>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::SDAG : {
-            simulate_one_target_gate_<G::SDAG>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::SDAG>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::T : {
-            simulate_one_target_gate_<G::T>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::T>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::TDAG : {
-            simulate_one_target_gate_<G::TDAG>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::TDAG>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::SX : {
-            simulate_one_target_gate_<G::SX>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::SX>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::SXDAG : {
-            simulate_one_target_gate_<G::SXDAG>(state, gate_info, single_pair);
+            simulate_one_target_gate_<G::SXDAG>(state, gate_info, single_pair, control_mask);
             break;
         }
         case G::RX : {
-            simulate_one_target_one_angle_gate_<G::RX>(parameter_values_map, state, gate_info, single_pair);
+            simulate_one_target_one_angle_gate_<G::RX>(state, gate_info, angle, single_pair, control_mask);
             break;
         }
         case G::RY : {
-            simulate_one_target_one_angle_gate_<G::RY>(parameter_values_map, state, gate_info, single_pair);
+            simulate_one_target_one_angle_gate_<G::RY>(state, gate_info, angle, single_pair, control_mask);
             break;
         }
         case G::RZ : {
-            simulate_one_target_one_angle_gate_<G::RZ>(parameter_values_map, state, gate_info, single_pair);
+            simulate_one_target_one_angle_gate_<G::RZ>(state, gate_info, angle, single_pair, control_mask);
             break;
         }
         case G::P : {
-            simulate_one_target_one_angle_gate_<G::P>(parameter_values_map, state, gate_info, single_pair);
+            simulate_one_target_one_angle_gate_<G::P>(state, gate_info, angle, single_pair, control_mask);
             break;
         }
         case G::CH : {
-            simulate_one_control_one_target_gate_<G::CH>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CH>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CX : {
-            simulate_one_control_one_target_gate_<G::CX>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CX>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CY : {
-            simulate_one_control_one_target_gate_<G::CY>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CY>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CZ : {
-            simulate_one_control_one_target_gate_<G::CZ>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CZ>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CS : {
-            simulate_one_control_one_target_gate_<G::CS>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CS>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CSDAG : {
-            simulate_one_control_one_target_gate_<G::CSDAG>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CSDAG>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CT : {
-            simulate_one_control_one_target_gate_<G::CT>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CT>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CTDAG : {
-            simulate_one_control_one_target_gate_<G::CTDAG>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CTDAG>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CSX : {
-            simulate_one_control_one_target_gate_<G::CSX>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CSX>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CSXDAG : {
-            simulate_one_control_one_target_gate_<G::CSXDAG>(state, gate_info, double_pair);
+            simulate_one_control_one_target_gate_<G::CSXDAG>(state, gate_info, double_pair, control_mask);
             break;
         }
         case G::CRX : {
-            simulate_one_control_one_target_one_angle_gate_<G::CRX>(parameter_values_map, state, gate_info, double_pair);
+            simulate_one_control_one_target_one_angle_gate_<G::CRX>(state, gate_info, angle, double_pair, control_mask);
             break;
         }
         case G::CRY : {
-            simulate_one_control_one_target_one_angle_gate_<G::CRY>(parameter_values_map, state, gate_info, double_pair);
+            simulate_one_control_one_target_one_angle_gate_<G::CRY>(state, gate_info, angle, double_pair, control_mask);
             break;
         }
         case G::CRZ : {
-            simulate_one_control_one_target_one_angle_gate_<G::CRZ>(parameter_values_map, state, gate_info, double_pair);
+            simulate_one_control_one_target_one_angle_gate_<G::CRZ>(state, gate_info, angle, double_pair, control_mask);
             break;
         }
         case G::CP : {
-            simulate_one_control_one_target_one_angle_gate_<G::CP>(parameter_values_map, state, gate_info, double_pair);
+            simulate_one_control_one_target_one_angle_gate_<G::CP>(state, gate_info, angle, double_pair, control_mask);
             break;
         }
         case G::U : {
-            const auto& unitary_ptr = cre::unpack_unitary_matrix(gate_info);
-            simulate_u_gate_(state, gate_info, *unitary_ptr, single_pair);
+            simulate_u_gate_(state, gate_info, *unitary, single_pair, control_mask);
             break;
         }
         case G::CU : {
-            const auto& unitary_ptr = cre::unpack_unitary_matrix(gate_info);
-            simulate_cu_gate_(state, gate_info, *unitary_ptr, double_pair);
+            simulate_cu_gate_(state, gate_info, *unitary, double_pair, control_mask);
+            break;
+        }
+        case G::PAULI_ROT : {
+            simulate_pauli_rotation_gate_(state, *pauli_string, angle, single_pair, control_mask);
             break;
         }
         case G::M : {
@@ -414,8 +559,61 @@ void simulate_gate_info_(
     }
 }
 
+void simulate_gate_info_(
+    ket::QuantumState& state,
+    const ki::FlatIndexPair& single_pair,
+    const ki::FlatIndexPair& double_pair,
+    const ket::GateInfo& gate_info,
+    double angle,
+    std::size_t control_mask,
+    int thread_id,
+    std::optional<int> prng_seed,
+    ket::ClassicalRegister& c_register
+)
+{
+    const auto* unitary = gate_info.unitary_ptr ? &(*gate_info.unitary_ptr) : nullptr;
+    const auto* pauli_string = gate_info.pauli_string_ptr ? &(*gate_info.pauli_string_ptr) : nullptr;
+
+    simulate_gate_(
+        state,
+        single_pair,
+        double_pair,
+        gate_info,
+        angle,
+        unitary,
+        pauli_string,
+        control_mask,
+        thread_id,
+        prng_seed,
+        c_register
+    );
+}
+
+/*
+    The compiled parameters of a subcircuit of the element at `i_element`, or a null pointer if the
+    enclosing circuit was not compiled; `offset` is 1 for the else-branch of an if-else statement.
+*/
+auto compiled_subcircuit_(
+    const kpi::CompiledCircuitParameters* compiled,
+    std::size_t i_element,
+    std::size_t offset = 0
+) -> const kpi::CompiledCircuitParameters*
+{
+    if (compiled == nullptr) {
+        return nullptr;
+    }
+
+    return &compiled->subcircuits[compiled->i_subcircuits[i_element] + offset];
+}
+
+/*
+    The `compiled_circuit` is a null pointer if the circuit has no parameterized gates, so that it
+    does not have to be compiled.
+*/
 auto simulate_loop_body_iterative_(  // NOLINT(readability-function-cognitive-complexity)
     const ket::QuantumCircuit& circuit,
+    const kpi::CompiledCircuitParameters* compiled_circuit,
+    std::span<const double> parameter_values,
     ket::QuantumState& state,
     const ki::FlatIndexPair& single_pair,
     const ki::FlatIndexPair& double_pair,
@@ -429,22 +627,43 @@ auto simulate_loop_body_iterative_(  // NOLINT(readability-function-cognitive-co
     auto elements_stack = std::vector<Elements> {};
     elements_stack.push_back(std::ref(circuit.circuit_elements()));
 
+    // the compiled parameter expressions of each circuit in `elements_stack`
+    auto compiled_stack = std::vector<const kpi::CompiledCircuitParameters*> {};
+    compiled_stack.push_back(compiled_circuit);
+
     auto instruction_pointers = std::vector<std::size_t> {};
     instruction_pointers.push_back(0);
 
-    auto circuit_loggers = std::vector<ket::CircuitLogger> {};
+    // the number of times each circuit in `elements_stack` still has to be run after the current run;
+    // only the bodies of repeat statements are run more than once
+    auto remaining_repetitions = std::vector<std::size_t> {};
+    remaining_repetitions.push_back(0);
 
-    const auto& parameter_values_map = kpi::create_parameter_values_map(circuit.parameter_data_map());
+    // the control qubits of all the controlled blocks that each circuit in `elements_stack` is inside of
+    auto control_masks = std::vector<std::size_t> {};
+    control_masks.push_back(0);
+
+    auto circuit_loggers = std::vector<ket::CircuitLogger> {};
 
     while (elements_stack.size() != 0) {
         const auto& elements = elements_stack.back();
+        const auto* compiled = compiled_stack.back();
         const auto i_ptr = instruction_pointers.back();
 
         ++instruction_pointers.back();
 
         if (i_ptr >= elements.get().size()) {
+            if (remaining_repetitions.back() != 0) {
+                --remaining_repetitions.back();
+                instruction_pointers.back() = 0;
+                continue;
+            }
+
             elements_stack.pop_back();
+            compiled_stack.pop_back();
             instruction_pointers.pop_back();
+            remaining_repetitions.pop_back();
+            control_masks.pop_back();
             continue;
         }
 
@@ -476,15 +695,22 @@ auto simulate_loop_body_iterative_(  // NOLINT(readability-function-cognitive-co
                 if (if_stmt(cregister)) {
                     const auto& subcircuit = *if_stmt.circuit();
                     elements_stack.push_back(std::ref(subcircuit.circuit_elements()));
+                    compiled_stack.push_back(compiled_subcircuit_(compiled, i_ptr));
                     instruction_pointers.push_back(0);
+                    remaining_repetitions.push_back(0);
+                    control_masks.push_back(control_masks.back());
                 }
             }
             else if (control_flow.is_if_else_statement()) {
                 const auto& if_else_stmt = control_flow.get_if_else_statement();
 
+                // the compiled if-branch comes right before the compiled else-branch
+                const auto is_if_branch = if_else_stmt(cregister);
+                const auto i_branch = std::size_t {is_if_branch ? 0UL : 1UL};
+
                 // NOTE: omitting the return type here causes a dangling reference
                 const auto& subcircuit = [&]() -> const ket::QuantumCircuit& {
-                    if (if_else_stmt(cregister)) {
+                    if (is_if_branch) {
                         return *if_else_stmt.if_circuit();
                     } else {
                         return *if_else_stmt.else_circuit();
@@ -492,21 +718,61 @@ auto simulate_loop_body_iterative_(  // NOLINT(readability-function-cognitive-co
                 }();
 
                 elements_stack.push_back(std::ref(subcircuit.circuit_elements()));
+                compiled_stack.push_back(compiled_subcircuit_(compiled, i_ptr, i_branch));
                 instruction_pointers.push_back(0);
+                remaining_repetitions.push_back(0);
+                control_masks.push_back(control_masks.back());
+            }
+            else if (control_flow.is_repeat_statement()) {
+                const auto& repeat_stmt = control_flow.get_repeat_statement();
+
+                if (repeat_stmt.n_repetitions() != 0) {
+                    const auto& subcircuit = *repeat_stmt.circuit();
+                    elements_stack.push_back(std::ref(subcircuit.circuit_elements()));
+                    compiled_stack.push_back(compiled_subcircuit_(compiled, i_ptr));
+                    instruction_pointers.push_back(0);
+                    remaining_repetitions.push_back(repeat_stmt.n_repetitions() - 1);
+                    control_masks.push_back(control_masks.back());
+                }
+            }
+            else if (control_flow.is_controlled_block()) {
+                const auto& block = control_flow.get_controlled_block();
+
+                auto control_mask = control_masks.back();
+                for (auto control : block.control_qubits()) {
+                    control_mask |= ki::pow_2_int(control);
+                }
+
+                const auto& subcircuit = *block.circuit();
+                elements_stack.push_back(std::ref(subcircuit.circuit_elements()));
+                compiled_stack.push_back(compiled_subcircuit_(compiled, i_ptr));
+                instruction_pointers.push_back(0);
+                remaining_repetitions.push_back(0);
+                control_masks.push_back(control_mask);
             }
             else {
                 throw std::runtime_error {"DEV ERROR: unimplemented control flow in `simulate_loop_body_iterative_()`\n"};
             }
         }
         else if (element.is_gate()) {
-            const auto gate_info = element.get_gate();
+            const auto& gate_info = element.get_gate();
+
+            if (gate_info.param_expression_ptr && compiled == nullptr) {
+                throw std::runtime_error {"DEV ERROR: found a parameterized gate in a circuit that was not compiled\n"};
+            }
+
+            // the angle of a parameterized gate comes from its compiled program; this only reads from arrays
+            const auto angle = gate_info.param_expression_ptr
+                ? compiled->programs[i_ptr].evaluate(parameter_values)
+                : ki::create::unpack_gate_angle(gate_info);
 
             simulate_gate_info_(
-                parameter_values_map,
                 state,
                 single_pair,
                 double_pair,
                 gate_info,
+                angle,
+                control_masks.back(),
                 thread_id,
                 prng_seed,
                 cregister
@@ -520,7 +786,79 @@ auto simulate_loop_body_iterative_(  // NOLINT(readability-function-cognitive-co
     return circuit_loggers;
 }
 
-void check_valid_number_of_qubits_(const ket::QuantumCircuit& circuit, const ket::QuantumState& state)
+/*
+    Simulates the gates of `circuit` in order, reading the angles and matrices straight out of its pools;
+    `parameter_angles` holds the value of each parameter expression in the pool of the circuit.
+*/
+void simulate_compact_gates_(
+    const ket::CompactCircuit& circuit,
+    std::span<const double> parameter_angles,
+    ket::QuantumState& state,
+    const ki::FlatIndexPair& single_pair,
+    const ki::FlatIndexPair& double_pair,
+    std::optional<int> prng_seed,
+    ket::ClassicalRegister& cregister
+)
+{
+    namespace gid = ki::gate_id;
+    using G = ket::Gate;
+
+    const auto& angles = circuit.angles();
+    const auto& unitaries = circuit.unitaries();
+    const auto& pauli_strings = circuit.pauli_strings();
+
+    // only the gate and the indices of this instance are read, so the same instance is reused for every gate
+    auto gate_info = ket::GateInfo {
+        .gate=G::H,
+        .arg0=0,
+        .arg1=0,
+        .arg2=0.0,
+        .unitary_ptr=ket::ClonePtr<ket::Matrix2X2> {nullptr},
+        .param_expression_ptr=ket::ClonePtr<ket::param::ParameterExpression> {nullptr},
+        .pauli_string_ptr=ket::ClonePtr<ket::SparsePauliString> {nullptr}
+    };
+
+    for (const auto& gate : circuit) {
+        gate_info.gate = gate.gate;
+        gate_info.arg0 = gate.arg0;
+        gate_info.arg1 = gate.arg1;
+
+        auto angle = 0.0;
+        const ket::Matrix2X2* unitary = nullptr;
+        const ket::SparsePauliString* pauli_string = nullptr;
+
+        if (gate.gate == G::U || gate.gate == G::CU) {
+            unitary = &unitaries[gate.payload];
+        }
+        else if (gate.is_parameterized) {
+            angle = parameter_angles[gate.payload];
+        }
+        else if (gid::is_angle_transform_gate(gate.gate) || gate.gate == G::PAULI_ROT) {
+            angle = angles[gate.payload];
+        }
+
+        if (gate.gate == G::PAULI_ROT) {
+            pauli_string = &pauli_strings[gate.arg0];
+        }
+
+        simulate_gate_(
+            state,
+            single_pair,
+            double_pair,
+            gate_info,
+            angle,
+            unitary,
+            pauli_string,
+            0,
+            MEASURING_THREAD_ID,
+            prng_seed,
+            cregister
+        );
+    }
+}
+
+template <typename Circuit>
+void check_valid_number_of_qubits_(const Circuit& circuit, const ket::QuantumState& state)
 {
     if (circuit.n_qubits() != state.n_qubits()) {
         throw std::runtime_error {"Invalid simulation; circuit and state have different number of qubits."};
@@ -533,10 +871,89 @@ void check_valid_number_of_qubits_(const ket::QuantumCircuit& circuit, const ket
 
 }  // namespace
 
+namespace ket::internal
+{
+
+void simulate_single_gate_(
+    const kpi::MapVariant& parameter_values_map,
+    ket::QuantumState& state,
+    const ket::GateInfo& gate_info
+)
+{
+    const auto angle = gate_info.param_expression_ptr
+        ? kpi::Evaluator {}.evaluate(*gate_info.param_expression_ptr, parameter_values_map)
+        : 0.0;
+
+    simulate_single_gate_(state, gate_info, angle);
+}
+
+void simulate_single_gate_(ket::QuantumState& state, const ket::GateInfo& gate_info, double angle)
+{
+    if (gate_info.gate == ket::Gate::M) {
+        throw std::runtime_error {"DEV ERROR: cannot simulate a measurement gate without a classical register\n"};
+    }
+
+    const auto single_pair = FlatIndexPair {.i_lower=0, .i_upper=number_of_single_qubit_gate_pairs_(state.n_qubits())};
+    const auto double_pair = FlatIndexPair {.i_lower=0, .i_upper=number_of_double_qubit_gate_pairs_(state.n_qubits())};
+
+    // never used, because measurement gates are rejected above
+    auto unused_cregister = ket::ClassicalRegister {0};
+
+    const auto gate_angle = gate_info.param_expression_ptr ? angle : create::unpack_gate_angle(gate_info);
+
+    simulate_gate_info_(
+        state,
+        single_pair,
+        double_pair,
+        gate_info,
+        gate_angle,
+        0,
+        MEASURING_THREAD_ID,
+        std::nullopt,
+        unused_cregister
+    );
+}
+
+}  // namespace ket::internal
+
 namespace ket
 {
 
 void StatevectorSimulator::run(const QuantumCircuit& circuit, QuantumState& state, std::optional<int> prng_seed)
+{
+    // most circuits have no parameterized gates at all, and there is nothing to compile
+    if (!kpi::has_parameterized_gates(circuit)) {
+        run_compiled_(circuit, nullptr, {}, state, prng_seed);
+        return;
+    }
+
+    const auto compiled = kpi::compile_parameter_slots(circuit);
+    const auto parameter_values = kpi::parameter_values_from_slots(circuit, compiled.slot_ids);
+
+    run_compiled_(circuit, &compiled.circuit, parameter_values, state, prng_seed);
+}
+
+void StatevectorSimulator::run(
+    const param::CompiledCircuit& compiled,
+    QuantumState& state,
+    std::span<const double> parameter_values,
+    std::optional<int> prng_seed
+)
+{
+    if (parameter_values.size() != compiled.n_slots()) {
+        throw std::runtime_error {"ERROR: the number of parameter values does not match the number of parameter slots.\n"};
+    }
+
+    run_compiled_(compiled.circuit(), &(*compiled.compiled_).circuit, parameter_values, state, prng_seed);
+}
+
+void StatevectorSimulator::run_compiled_(
+    const QuantumCircuit& circuit,
+    const param::internal::CompiledCircuitParameters* compiled_circuit,
+    std::span<const double> parameter_values,
+    QuantumState& state,
+    std::optional<int> prng_seed
+)
 {
     namespace ki = ket::internal;
 
@@ -554,7 +971,48 @@ void StatevectorSimulator::run(const QuantumCircuit& circuit, QuantumState& stat
     // code, and certain operations are only done on the thread with thread id 0
     const auto thread_id = MEASURING_THREAD_ID;
 
-    circuit_loggers_ = simulate_loop_body_iterative_(circuit, state, single_pair, double_pair, thread_id, prng_seed, *cregister_);
+    circuit_loggers_ = simulate_loop_body_iterative_(
+        circuit,
+        compiled_circuit,
+        parameter_values,
+        state,
+        single_pair,
+        double_pair,
+        thread_id,
+        prng_seed,
+        *cregister_
+    );
+
+    has_been_run_ = true;
+}
+
+void StatevectorSimulator::run(const CompactCircuit& circuit, QuantumState& state, std::optional<int> prng_seed)
+{
+    namespace ki = ket::internal;
+
+    check_valid_number_of_qubits_(circuit, state);
+
+    // each parameter expression is evaluated once for the entire run, instead of once for each gate
+    auto parameter_angles = std::vector<double> {};
+    if (!circuit.parameter_expressions().empty()) {
+        const auto parameter_values = kpi::create_parameter_values_map(circuit.parameter_data_map());
+
+        parameter_angles.reserve(circuit.parameter_expressions().size());
+        for (const auto& expression : circuit.parameter_expressions()) {
+            parameter_angles.push_back(kpi::Evaluator {}.evaluate(expression, parameter_values));
+        }
+    }
+
+    const auto n_single_gate_pairs = ki::number_of_single_qubit_gate_pairs_(circuit.n_qubits());
+    const auto single_pair = ki::FlatIndexPair {.i_lower=0, .i_upper=n_single_gate_pairs};
+
+    const auto n_double_gate_pairs = ki::number_of_double_qubit_gate_pairs_(circuit.n_qubits());
+    const auto double_pair = ki::FlatIndexPair {.i_lower=0, .i_upper=n_double_gate_pairs};
+
+    cregister_ = ket::ClonePtr<ClassicalRegister> {ClassicalRegister {circuit.n_bits()}};
+    circuit_loggers_.clear();
+
+    simulate_compact_gates_(circuit, parameter_angles, state, single_pair, double_pair, prng_seed, *cregister_);
 
     has_been_run_ = true;
 }
@@ -596,6 +1054,23 @@ void simulate(const QuantumCircuit& circuit, QuantumState& state, std::optional<
     simulator.run(circuit, state, prng_seed);
 }
 
+void simulate(
+    const param::CompiledCircuit& compiled,
+    QuantumState& state,
+    std::span<const double> parameter_values,
+    std::optional<int> prng_seed
+)
+{
+    auto simulator = StatevectorSimulator {};
+    simulator.run(compiled, state, parameter_values, prng_seed);
+}
+
+void simulate(const CompactCircuit& circuit, QuantumState& state, std::optional<int> prng_seed)
+{
+    auto simulator = StatevectorSimulator {};
+    simulator.run(circuit, state, prng_seed);
+}
+
 
 }  // namespace ket
 
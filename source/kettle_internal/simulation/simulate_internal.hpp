@@ -0,0 +1,30 @@
+#pragma once
+
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/parameter/parameter_expression_internal.hpp"
+
+
+namespace ket::internal
+{
+
+/*
+    Applies a single gate to every amplitude of the state, on the calling thread.
+
+    This is used by code that needs to step through a circuit one gate at a time, rather than run
+    the entire circuit at once. Measurement gates need a classical register, and are not allowed.
+*/
+void simulate_single_gate_(
+    const ket::param::internal::MapVariant& parameter_values_map,
+    ket::QuantumState& state,
+    const ket::GateInfo& gate_info
+);
+
+/*
+    Same as above, with the angle of a parameterized gate already evaluated; `angle` is ignored for gates
+    that are not parameterized.
+*/
+void simulate_single_gate_(ket::QuantumState& state, const ket::GateInfo& gate_info, double angle);
+
+}  // namespace ket::internal
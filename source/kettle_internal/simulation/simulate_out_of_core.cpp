@@ -0,0 +1,223 @@
+#include <complex>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/matrix2x2.hpp"
+#include "kettle/simulation/simulate_out_of_core.hpp"
+#include "kettle/state/disk_state.hpp"
+
+#include "kettle_internal/common/mathtools_internal.hpp"
+#include "kettle_internal/simulation/gate_pair_generator.hpp"
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
+#include "kettle_internal/simulation/out_of_core_schedule.hpp"
+
+namespace ki = ket::internal;
+
+
+namespace
+{
+
+/*
+    A gate of a pass, with its qubits mapped onto the chunk (or pair of chunks) held in memory.
+*/
+struct BufferGate_
+{
+    const ket::Matrix2X2* matrix;
+    std::size_t target;
+    std::size_t control_mask;
+};
+
+void apply_buffer_gate_(
+    std::span<std::complex<double>> buffer,
+    std::size_t n_buffer_qubits,
+    const BufferGate_& gate,
+    std::optional<std::size_t> n_threads
+)
+{
+    const auto generator = ki::ControlledGatePairGenerator {gate.target, gate.control_mask, n_buffer_qubits};
+    const auto n_workers = n_threads.value_or(ki::default_number_of_threads_(generator.size()));
+    const auto& mat = *gate.matrix;
+
+    ki::parallel_for_(generator.size(), n_workers, [&](ki::FlatIndexPair pair, [[maybe_unused]] std::size_t i_thread) {
+        auto pair_generator = generator;
+        pair_generator.set_state(pair.i_lower);
+
+        for (auto i {pair.i_lower}; i < pair.i_upper; ++i) {
+            const auto [state0_index, state1_index] = pair_generator.next();
+
+            const auto state0 = buffer[state0_index];
+            const auto state1 = buffer[state1_index];
+
+            buffer[state0_index] = mat.elem00 * state0 + mat.elem01 * state1;
+            buffer[state1_index] = mat.elem10 * state0 + mat.elem11 * state1;
+        }
+    });
+}
+
+/*
+    Applies every gate of the pass (as many times as the pass is repeated) to one chunk at a time. The control qubits outside of the chunk
+    decide whether a gate applies to the chunk at all, and chunks that no gate applies to are
+    never read in.
+*/
+void run_chunk_pass_(
+    ket::DiskQuantumState& state,
+    const ki::OutOfCorePass_& pass,
+    std::vector<std::complex<double>>& buffer,
+    std::optional<std::size_t> n_threads
+)
+{
+    const auto n_chunk_qubits = state.n_chunk_qubits();
+    const auto low_mask = state.n_chunk_states() - 1;
+    const auto chunk = std::span {buffer}.first(state.n_chunk_states());
+
+    auto buffer_gates = std::vector<BufferGate_> {};
+
+    for (std::size_t i_chunk {0}; i_chunk < state.n_chunks(); ++i_chunk) {
+        const auto high_bits = i_chunk << n_chunk_qubits;
+
+        buffer_gates.clear();
+        for (const auto& gate : pass.gates) {
+            const auto high_controls = gate.control_mask & ~low_mask;
+            if ((high_bits & high_controls) == high_controls) {
+                buffer_gates.push_back({.matrix=&gate.matrix, .target=gate.target, .control_mask=gate.control_mask & low_mask});
+            }
+        }
+
+        if (buffer_gates.empty()) {
+            continue;
+        }
+
+        state.read_chunk(i_chunk, chunk);
+        for (std::size_t i_rep {0}; i_rep < pass.n_repetitions; ++i_rep) {
+            for (const auto& gate : buffer_gates) {
+                apply_buffer_gate_(chunk, n_chunk_qubits, gate, n_threads);
+            }
+        }
+        state.write_chunk(i_chunk, chunk);
+    }
+}
+
+/*
+    Applies every gate of the pass to each pair of chunks that differ only in the qubit `high_target`.
+    The pair is held in memory as a single buffer with one more qubit than a chunk, where that extra
+    qubit stands in for `high_target`.
+*/
+void run_chunk_pair_pass_(
+    ket::DiskQuantumState& state,
+    const ki::OutOfCorePass_& pass,
+    std::size_t high_target,
+    std::vector<std::complex<double>>& buffer,
+    std::optional<std::size_t> n_threads
+)
+{
+    const auto n_chunk_qubits = state.n_chunk_qubits();
+    const auto low_mask = state.n_chunk_states() - 1;
+    const auto high_target_bit = ki::pow_2_int(high_target);
+    const auto chunk_pair_bit = ki::pow_2_int(high_target - n_chunk_qubits);
+
+    const auto lower_chunk = std::span {buffer}.first(state.n_chunk_states());
+    const auto upper_chunk = std::span {buffer}.last(state.n_chunk_states());
+
+    const auto to_buffer_qubit = [&](std::size_t qubit) {
+        return qubit == high_target ? n_chunk_qubits : qubit;
+    };
+
+    auto buffer_gates = std::vector<BufferGate_> {};
+
+    for (std::size_t i_chunk {0}; i_chunk < state.n_chunks(); ++i_chunk) {
+        if ((i_chunk & chunk_pair_bit) != 0) {
+            continue;
+        }
+
+        const auto high_bits = i_chunk << n_chunk_qubits;
+
+        buffer_gates.clear();
+        for (const auto& gate : pass.gates) {
+            const auto other_high_controls = gate.control_mask & ~low_mask & ~high_target_bit;
+            if ((high_bits & other_high_controls) != other_high_controls) {
+                continue;
+            }
+
+            auto control_mask = gate.control_mask & low_mask;
+            if ((gate.control_mask & high_target_bit) != 0) {
+                control_mask |= ki::pow_2_int(n_chunk_qubits);
+            }
+
+            buffer_gates.push_back({.matrix=&gate.matrix, .target=to_buffer_qubit(gate.target), .control_mask=control_mask});
+        }
+
+        if (buffer_gates.empty()) {
+            continue;
+        }
+
+        const auto i_partner_chunk = i_chunk | chunk_pair_bit;
+
+        state.read_chunk(i_chunk, lower_chunk);
+        state.read_chunk(i_partner_chunk, upper_chunk);
+
+        for (std::size_t i_rep {0}; i_rep < pass.n_repetitions; ++i_rep) {
+            for (const auto& gate : buffer_gates) {
+                apply_buffer_gate_(buffer, n_chunk_qubits + 1, gate, n_threads);
+            }
+        }
+
+        state.write_chunk(i_chunk, lower_chunk);
+        state.write_chunk(i_partner_chunk, upper_chunk);
+    }
+}
+
+void run_steps_(  // NOLINT(misc-no-recursion)
+    ket::DiskQuantumState& state,
+    const std::vector<ki::OutOfCoreStep_>& steps,
+    std::vector<std::complex<double>>& buffer,
+    std::optional<std::size_t> n_threads
+)
+{
+    for (const auto& step : steps) {
+        if (const auto* pass = std::get_if<ki::OutOfCorePass_>(&step)) {
+            if (pass->high_target) {
+                run_chunk_pair_pass_(state, *pass, *pass->high_target, buffer, n_threads);
+            }
+            else {
+                run_chunk_pass_(state, *pass, buffer, n_threads);
+            }
+        }
+        else {
+            const auto& loop = std::get<ki::OutOfCoreLoop_>(step);
+            for (std::size_t i {0}; i < loop.n_repetitions; ++i) {
+                run_steps_(state, loop.steps, buffer, n_threads);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+void simulate_out_of_core(
+    const QuantumCircuit& circuit,
+    DiskQuantumState& state,
+    std::optional<std::size_t> n_threads
+)
+{
+    if (circuit.n_qubits() != state.n_qubits()) {
+        throw std::runtime_error {"ERROR: Invalid simulation; circuit and state have different number of qubits.\n"};
+    }
+
+    const auto steps = ki::schedule_out_of_core_(circuit, state.n_chunk_qubits());
+
+    // room for a pair of chunks; a pass over single chunks only uses the first half
+    auto buffer = std::vector<std::complex<double>>(2 * state.n_chunk_states());
+
+    run_steps_(state, steps, buffer, n_threads);
+}
+
+}  // namespace ket
@@ -1,13 +1,14 @@
+#include <bit>
+#include <complex>
+#include <cstddef>
 #include <stdexcept>
-#include <type_traits>
 
 #include "kettle/operator/pauli/sparse_pauli_string.hpp"
 #include "kettle/simulation/simulate_pauli.hpp"
 #include "kettle/state/state.hpp"
 
-#include "kettle_internal/simulation/gate_pair_generator.hpp"
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
 #include "kettle_internal/simulation/simulate_utils.hpp"
-#include "kettle_internal/simulation/operations.hpp"
 
 
 namespace ki = ket::internal;
@@ -16,72 +17,42 @@ namespace
 {
 
 /*
-    Helper struct for the static_assert(), to see what ket::PauliTerm instance is passed that causes
-    the template instantiation to fail.
-*/
-template <ket::PauliTerm Pauli>
-struct pauli_always_false : std::false_type
-{};
-
+    Applies all the terms of the Pauli string at once, as a permutation of the amplitudes followed by
+    a phase; the Pauli string maps |i> to `factor * (-1)^(popcount(i & z_mask)) |i ^ x_mask>`.
 
-template <ket::PauliTerm Pauli>
-void simulate_pauli_gate_(
+    If `x_mask` is non-zero, the indices in `block` are the indices of the pairs (i, i ^ x_mask) of
+    amplitudes that get swapped; otherwise, they are the indices of the amplitudes themselves.
+*/
+void simulate_pauli_string_(
     ket::QuantumState& state,
-    std::size_t target_index,
-    const ki::FlatIndexPair& pair
+    std::size_t x_mask,
+    std::size_t z_mask,
+    std::complex<double> factor,
+    const ki::FlatIndexPair& block
 )
 {
-    const auto n_qubits = state.n_qubits();
-
-    auto pair_iterator = ki::SingleQubitGatePairGenerator {target_index, n_qubits};
-    pair_iterator.set_state(pair.i_lower);
+    const auto sign = [z_mask](std::size_t i) { return (std::popcount(i & z_mask) & 1) == 0 ? 1.0 : -1.0; };
 
-    for (std::size_t i {pair.i_lower}; i < pair.i_upper; ++i) {
-        const auto [state0_index, state1_index] = pair_iterator.next();
-
-        if constexpr (Pauli == ket::PauliTerm::X) {
-            ki::apply_x_gate(state, state0_index, state1_index);
-        }
-        else if constexpr (Pauli == ket::PauliTerm::Y) {
-            ki::apply_y_gate(state, state0_index, state1_index);
-        }
-        else if constexpr (Pauli == ket::PauliTerm::Z) {
-            ki::apply_z_gate(state, state1_index);
-        }
-        else {
-            static_assert(pauli_always_false<Pauli>::value, "Invalid Pauli term.");
+    if (x_mask == 0) {
+        for (auto i {block.i_lower}; i < block.i_upper; ++i) {
+            state[i] *= sign(i) * factor;
         }
+
+        return;
     }
-}
 
+    // each pair is found by inserting a 0 at the position of the highest bit of the X-mask
+    const auto i_top_bit = static_cast<std::size_t>(std::bit_width(x_mask) - 1);
+    const auto lower_mask = (std::size_t {1} << i_top_bit) - 1;
 
-void simulate_pauli_gates_(
-    ket::QuantumState& state,
-    const ki::FlatIndexPair& single_pair,
-    const ket::SparsePauliString& pauli_string
-)
-{
-    using PT = ket::PauliTerm;
-
-    for (const auto& [target_index, pauli_term] : pauli_string.terms())
-    {
-        switch(pauli_term) {
-            case PT::X : {
-                simulate_pauli_gate_<PT::X>(state, target_index, single_pair);
-                break;
-            }
-            case PT::Y : {
-                simulate_pauli_gate_<PT::Y>(state, target_index, single_pair);
-                break;
-            }
-            case PT::Z : {
-                simulate_pauli_gate_<PT::Z>(state, target_index, single_pair);
-                break;
-            }
-            default : {
-                continue;
-            }
-        }
+    for (auto i_pair {block.i_lower}; i_pair < block.i_upper; ++i_pair) {
+        const auto i0 = ((i_pair & ~lower_mask) << 1) | (i_pair & lower_mask);
+        const auto i1 = i0 ^ x_mask;
+
+        const auto amplitude0 = state[i0];
+        const auto amplitude1 = state[i1];
+        state[i1] = sign(i0) * factor * amplitude0;
+        state[i0] = sign(i1) * factor * amplitude1;
     }
 }
 
@@ -107,10 +78,18 @@ void StatevectorPauliStringSimulator::run(const SparsePauliString& pauli_string,
 
     check_valid_number_of_qubits_(pauli_string, state);
 
-    const auto n_single_gate_pairs = ki::number_of_single_qubit_gate_pairs_(pauli_string.n_qubits());
-    const auto single_pair = ki::FlatIndexPair {.i_lower=0, .i_upper=n_single_gate_pairs};
+    // the phase of the Pauli string itself is not applied; only the factors of i from the Y terms
+    const auto x_mask = static_cast<std::size_t>(pauli_string.x_mask()[0]);
+    const auto z_mask = static_cast<std::size_t>(pauli_string.z_mask()[0]);
+    const auto n_y_terms = static_cast<std::size_t>(std::popcount(x_mask & z_mask));
+    const auto factor = PAULI_PHASE_MAP.at(static_cast<PauliPhase>(n_y_terms % 4));
+
+    const auto n_work_items = x_mask == 0 ? state.n_states() : state.n_states() / 2;
+    const auto n_threads = ki::default_number_of_threads_(n_work_items);
 
-    simulate_pauli_gates_(state, single_pair, pauli_string);
+    ki::parallel_for_(n_work_items, n_threads, [&](const ki::FlatIndexPair& block, [[maybe_unused]] std::size_t i_thread) {
+        simulate_pauli_string_(state, x_mask, z_mask, factor, block);
+    });
 
     has_been_run_ = true;
 }
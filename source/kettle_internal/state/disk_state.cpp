@@ -0,0 +1,182 @@
+#include <bit>
+#include <complex>
+#include <cstddef>
+#include <filesystem>
+#include <ios>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "kettle/state/disk_state.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/io/io_binary.hpp"
+
+namespace ki = ket::internal;
+
+
+namespace
+{
+
+constexpr auto BYTES_PER_AMPLITUDE_ = sizeof(std::complex<double>);
+
+// the largest number of qubits whose file size in bytes still fits in a `std::size_t`
+constexpr auto MAX_N_QUBITS_ = std::size_t {59};
+
+void check_n_qubits_(std::size_t n_qubits, std::size_t n_chunk_qubits)
+{
+    if (n_qubits == 0 || n_qubits > MAX_N_QUBITS_) {
+        throw std::runtime_error {"ERROR: invalid number of qubits for a `DiskQuantumState`.\n"};
+    }
+
+    if (n_chunk_qubits == 0 || n_chunk_qubits > n_qubits) {
+        throw std::runtime_error {"ERROR: the number of chunk qubits must be between 1 and the number of qubits.\n"};
+    }
+}
+
+/*
+    Creates an empty file at `filepath` that is large enough to hold `n_qubits` qubits; the file
+    reads back as all zeros.
+*/
+auto create_state_file_(const std::filesystem::path& filepath, std::size_t n_qubits) -> ki::FileDescriptor
+{
+    auto file = ki::open_file_(filepath, O_RDWR | O_CREAT | O_TRUNC);  // NOLINT(hicpp-signed-bitwise)
+
+    const auto n_bytes = (std::size_t {1} << n_qubits) * BYTES_PER_AMPLITUDE_;
+    if (::ftruncate(file.get(), static_cast<::off_t>(n_bytes)) != 0) {
+        throw std::ios::failure {"ERROR: unable to set the size of the file for a `DiskQuantumState`.\n"};
+    }
+
+    return file;
+}
+
+}  // namespace
+
+
+namespace ket
+{
+
+DiskQuantumState::DiskQuantumState(const std::filesystem::path& filepath, std::size_t n_qubits, std::size_t n_chunk_qubits)
+    : filepath_ {filepath}
+    , n_qubits_ {n_qubits}
+    , n_chunk_qubits_ {n_chunk_qubits}
+{
+    check_n_qubits_(n_qubits, n_chunk_qubits);
+
+    auto file = create_state_file_(filepath, n_qubits);
+
+    const auto amplitude = std::complex<double> {1.0, 0.0};
+    ki::write_exactly_at_(file.get(), std::as_bytes(std::span {&amplitude, 1}), 0);
+
+    descriptor_ = file.release();
+}
+
+DiskQuantumState::DiskQuantumState(const std::filesystem::path& filepath, const QuantumState& state, std::size_t n_chunk_qubits)
+    : filepath_ {filepath}
+    , n_qubits_ {state.n_qubits()}
+    , n_chunk_qubits_ {n_chunk_qubits}
+{
+    check_n_qubits_(n_qubits_, n_chunk_qubits);
+
+    auto file = create_state_file_(filepath, n_qubits_);
+
+    const auto amplitudes = std::span {&state[0], state.n_states()};
+    for (std::size_t i_chunk {0}; i_chunk < n_chunks(); ++i_chunk) {
+        const auto chunk = amplitudes.subspan(i_chunk * n_chunk_states(), n_chunk_states());
+        ki::write_exactly_at_(file.get(), std::as_bytes(chunk), i_chunk * n_chunk_states() * BYTES_PER_AMPLITUDE_);
+    }
+
+    descriptor_ = file.release();
+}
+
+DiskQuantumState::DiskQuantumState(const std::filesystem::path& filepath, std::size_t n_chunk_qubits)
+    : filepath_ {filepath}
+    , n_qubits_ {0}
+    , n_chunk_qubits_ {n_chunk_qubits}
+{
+    auto file = ki::open_file_(filepath, O_RDWR);
+
+    struct stat file_status {};
+    if (::fstat(file.get(), &file_status) != 0) {
+        throw std::ios::failure {"ERROR: unable to find the size of the file for a `DiskQuantumState`.\n"};
+    }
+
+    const auto n_bytes = static_cast<std::size_t>(file_status.st_size);
+    if (n_bytes % BYTES_PER_AMPLITUDE_ != 0 || !std::has_single_bit(n_bytes / BYTES_PER_AMPLITUDE_)) {
+        throw std::runtime_error {"ERROR: the size of the file does not match the size of a state.\n"};
+    }
+
+    n_qubits_ = static_cast<std::size_t>(std::countr_zero(n_bytes / BYTES_PER_AMPLITUDE_));
+    check_n_qubits_(n_qubits_, n_chunk_qubits);
+
+    descriptor_ = file.release();
+}
+
+DiskQuantumState::DiskQuantumState(DiskQuantumState&& other) noexcept
+    : filepath_ {std::move(other.filepath_)}
+    , n_qubits_ {other.n_qubits_}
+    , n_chunk_qubits_ {other.n_chunk_qubits_}
+    , descriptor_ {std::exchange(other.descriptor_, -1)}
+{}
+
+auto DiskQuantumState::operator=(DiskQuantumState&& other) noexcept -> DiskQuantumState&
+{
+    if (this != &other) {
+        // the descriptor of this instance is closed when `other` is destroyed
+        std::swap(filepath_, other.filepath_);
+        std::swap(n_qubits_, other.n_qubits_);
+        std::swap(n_chunk_qubits_, other.n_chunk_qubits_);
+        std::swap(descriptor_, other.descriptor_);
+    }
+
+    return *this;
+}
+
+DiskQuantumState::~DiskQuantumState()
+{
+    if (descriptor_ >= 0) {
+        ::close(descriptor_);
+    }
+}
+
+void DiskQuantumState::read_chunk(std::size_t i_chunk, std::span<std::complex<double>> chunk) const
+{
+    check_chunk_(i_chunk, chunk.size());
+    ki::read_exactly_at_(descriptor_, std::as_writable_bytes(chunk), i_chunk * n_chunk_states() * BYTES_PER_AMPLITUDE_);
+}
+
+void DiskQuantumState::write_chunk(std::size_t i_chunk, std::span<const std::complex<double>> chunk)
+{
+    check_chunk_(i_chunk, chunk.size());
+    ki::write_exactly_at_(descriptor_, std::as_bytes(chunk), i_chunk * n_chunk_states() * BYTES_PER_AMPLITUDE_);
+}
+
+auto DiskQuantumState::to_state() const -> QuantumState
+{
+    auto amplitudes = std::vector<std::complex<double>>(n_states());
+    ki::read_exactly_at_(descriptor_, std::as_writable_bytes(std::span {amplitudes}), 0);
+
+    return QuantumState {std::move(amplitudes)};
+}
+
+void DiskQuantumState::check_chunk_(std::size_t i_chunk, std::size_t chunk_size) const
+{
+    if (descriptor_ < 0) {
+        throw std::runtime_error {"ERROR: the `DiskQuantumState` has been moved from.\n"};
+    }
+
+    if (i_chunk >= n_chunks()) {
+        throw std::runtime_error {"ERROR: chunk index out of range for the `DiskQuantumState`.\n"};
+    }
+
+    if (chunk_size != n_chunk_states()) {
+        throw std::runtime_error {"ERROR: the size of the chunk does not match the chunk size of the `DiskQuantumState`.\n"};
+    }
+}
+
+}  // namespace ket
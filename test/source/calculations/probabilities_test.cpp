@@ -1,4 +1,6 @@
 #include <cmath>
+#include <cstddef>
+#include <stdexcept>
 #include <random>
 #include <string>
 #include <map>
@@ -12,9 +14,11 @@
 #include "kettle/calculations/probabilities.hpp"
 #include "kettle/circuit/circuit.hpp"
 #include "kettle/simulation/simulate.hpp"
+#include "kettle/state/random.hpp"
 #include "kettle/state/state.hpp"
 
 #include "kettle_internal/calculations/measurements_internal.hpp"
+#include "kettle_internal/calculations/probabilities_internal.hpp"
 
 static constexpr auto RELATIVE_TOL = 1.0e-6;
 
@@ -162,3 +166,150 @@ TEST_CASE("probabilities")
         }
     }
 }
+
+TEST_CASE("apply_noise_fused_()")
+{
+    // the sizes cover a partial first group, an exact first group, and one or two later groups
+    const auto n_qubits = GENERATE(std::size_t {1}, std::size_t {3}, std::size_t {12}, std::size_t {13}, std::size_t {17}, std::size_t {22});
+
+    auto prng = std::mt19937 {std::mt19937::default_seed};
+    auto distrib = std::uniform_real_distribution<double> {0.0, 1.0};
+
+    auto noise_per_qubit = std::vector<double> {};
+    for (std::size_t i_qubit {0}; i_qubit < n_qubits; ++i_qubit) {
+        // leave some qubits noiseless, to check that they are skipped correctly
+        noise_per_qubit.push_back(i_qubit % 4 == 1 ? 0.0 : 0.5 * distrib(prng));
+    }
+
+    auto expected = std::vector<double> {};
+    for (std::size_t i_state {0}; i_state < (1UL << n_qubits); ++i_state) {
+        expected.push_back(distrib(prng));
+    }
+    auto actual = expected;
+
+    for (std::size_t i_qubit {0}; i_qubit < n_qubits; ++i_qubit) {
+        ket::internal::apply_noise_(noise_per_qubit[i_qubit], i_qubit, n_qubits, expected);
+    }
+    ket::internal::apply_noise_fused_(noise_per_qubit, actual);
+
+    REQUIRE_THAT(actual, Catch::Matchers::Approx(expected));
+}
+
+TEST_CASE("QubitBitGatherer")
+{
+    struct TestCase
+    {
+        std::vector<std::size_t> qubit_indices;
+        std::size_t input;
+        std::size_t expected;
+    };
+
+    auto testcase = GENERATE(
+        TestCase {{}, 0b1011, 0b0},
+        TestCase {{0}, 0b1011, 0b1},
+        TestCase {{2}, 0b1011, 0b0},
+        TestCase {{0, 1, 2, 3}, 0b1011, 0b1011},
+        TestCase {{3, 2, 1, 0}, 0b1011, 0b1101},
+        TestCase {{1, 3}, 0b1010, 0b11},
+        TestCase {{9, 0}, 0b10'0000'0001, 0b11},
+        TestCase {{8, 2}, 0b01'0000'0000, 0b01}
+    );
+
+    const auto gatherer = ket::internal::QubitBitGatherer {testcase.qubit_indices, 10};
+    REQUIRE(gatherer.gather(testcase.input) == testcase.expected);
+}
+
+TEST_CASE("calculate_marginal_probabilities()")
+{
+    // the marginal distribution calculated directly from the bits of each state index
+    const auto brute_force_marginal = [](const ket::QuantumState& state, const std::vector<std::size_t>& qubit_indices) {
+        auto output = std::vector<double>(1UL << qubit_indices.size(), 0.0);
+        for (std::size_t i_state {0}; i_state < state.n_states(); ++i_state) {
+            auto i_bin = std::size_t {0};
+            for (std::size_t k {0}; k < qubit_indices.size(); ++k) {
+                i_bin |= ((i_state >> qubit_indices[k]) & 1UL) << k;
+            }
+            output[i_bin] += std::norm(state[i_state]);
+        }
+
+        return output;
+    };
+
+    SECTION("computational basis")
+    {
+        using QSE = ket::QuantumStateEndian;
+        const auto state = ket::QuantumState {"0110", QSE::LITTLE};
+
+        REQUIRE_THAT(ket::calculate_marginal_probabilities(state, {0}), Catch::Matchers::Approx(std::vector<double> {1.0, 0.0}));
+        REQUIRE_THAT(ket::calculate_marginal_probabilities(state, {1}), Catch::Matchers::Approx(std::vector<double> {0.0, 1.0}));
+        REQUIRE_THAT(ket::calculate_marginal_probabilities(state, {1, 3}), Catch::Matchers::Approx(std::vector<double> {0.0, 1.0, 0.0, 0.0}));
+        REQUIRE_THAT(ket::calculate_marginal_probabilities(state, {3, 1}), Catch::Matchers::Approx(std::vector<double> {0.0, 0.0, 1.0, 0.0}));
+    }
+
+    SECTION("no qubits kept")
+    {
+        const auto state = ket::generate_random_state(3, 42);
+        const auto actual = ket::calculate_marginal_probabilities(state, {});
+
+        REQUIRE_THAT(actual, Catch::Matchers::Approx(std::vector<double> {1.0}));
+    }
+
+    SECTION("all qubits kept matches the raw probabilities")
+    {
+        const auto state = ket::generate_random_state(5, 123);
+        const auto actual = ket::calculate_marginal_probabilities(state, {0, 1, 2, 3, 4});
+        const auto expected = ket::calculate_probabilities_raw(state);
+
+        REQUIRE_THAT(actual, Catch::Matchers::Approx(expected));
+    }
+
+    SECTION("random states")
+    {
+        // the larger state is big enough to be split among several threads
+        const auto n_qubits = GENERATE(std::size_t {4}, std::size_t {18});
+        const auto qubit_indices = GENERATE(
+            std::vector<std::size_t> {0},
+            std::vector<std::size_t> {3},
+            std::vector<std::size_t> {1, 2},
+            std::vector<std::size_t> {2, 0, 3}
+        );
+
+        const auto state = ket::generate_random_state(n_qubits, 987);
+        const auto actual = ket::calculate_marginal_probabilities(state, qubit_indices);
+        const auto expected = brute_force_marginal(state, qubit_indices);
+
+        REQUIRE_THAT(actual, Catch::Matchers::Approx(expected));
+    }
+
+    SECTION("with noise on the kept and traced out qubits")
+    {
+        const auto state = ket::generate_random_state(4, 555);
+
+        auto noise = ket::QuantumNoise {4};
+        noise.set(0, 0.1);
+        noise.set(1, 0.2);
+        noise.set(2, 0.3);
+        noise.set(3, 0.05);
+
+        const auto qubit_indices = std::vector<std::size_t> {2, 0};
+        const auto noisy_raw = ket::calculate_probabilities_raw(state, &noise);
+
+        auto expected = std::vector<double>(4, 0.0);
+        for (std::size_t i_state {0}; i_state < state.n_states(); ++i_state) {
+            const auto i_bin = ((i_state >> 2) & 1UL) | (((i_state >> 0) & 1UL) << 1);
+            expected[i_bin] += noisy_raw[i_state];
+        }
+
+        const auto actual = ket::calculate_marginal_probabilities(state, qubit_indices, &noise);
+
+        REQUIRE_THAT(actual, Catch::Matchers::Approx(expected));
+    }
+
+    SECTION("throws for invalid qubit indices")
+    {
+        const auto state = ket::QuantumState {"000"};
+
+        REQUIRE_THROWS_AS(ket::calculate_marginal_probabilities(state, {3}), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::calculate_marginal_probabilities(state, {0, 1, 0}), std::runtime_error);
+    }
+}
@@ -0,0 +1,198 @@
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/circuit_dag.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+
+
+namespace
+{
+
+using Indices = std::vector<std::size_t>;
+
+/*
+    Checks that `dag` matches a `CircuitDag` newly built from `circuit`.
+*/
+void require_same_as_rebuilt_(const ket::CircuitDag& dag, const ket::QuantumCircuit& circuit)
+{
+    const auto rebuilt = ket::CircuitDag {circuit};
+
+    REQUIRE(dag.n_nodes() == rebuilt.n_nodes());
+    REQUIRE(dag.n_layers() == rebuilt.n_layers());
+
+    for (std::size_t i_node {0}; i_node < dag.n_nodes(); ++i_node) {
+        REQUIRE(dag.predecessors(i_node) == rebuilt.predecessors(i_node));
+        REQUIRE(dag.successors(i_node) == rebuilt.successors(i_node));
+        REQUIRE(dag.layer(i_node) == rebuilt.layer(i_node));
+    }
+
+    for (std::size_t i_layer {0}; i_layer < dag.n_layers(); ++i_layer) {
+        REQUIRE(dag.layer_nodes(i_layer) == rebuilt.layer_nodes(i_layer));
+    }
+
+    for (std::size_t qubit {0}; qubit < dag.n_qubits(); ++qubit) {
+        REQUIRE(dag.qubit_wire(qubit) == rebuilt.qubit_wire(qubit));
+    }
+
+    for (std::size_t bit {0}; bit < dag.n_bits(); ++bit) {
+        REQUIRE(dag.bit_wire(bit) == rebuilt.bit_wire(bit));
+    }
+}
+
+}  // namespace
+
+
+TEST_CASE("CircuitDag")
+{
+    SECTION("empty circuit")
+    {
+        const auto dag = ket::CircuitDag {ket::QuantumCircuit {2}};
+
+        REQUIRE(dag.n_nodes() == 0);
+        REQUIRE(dag.n_layers() == 0);
+        REQUIRE(dag.qubit_wire(0).empty());
+    }
+
+    SECTION("gates on separate qubits share a layer")
+    {
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);          // 0
+        circuit.add_x_gate(1);          // 1
+        circuit.add_cx_gate(0, 1);      // 2
+        circuit.add_rz_gate(2, 0.5);    // 3
+        circuit.add_cz_gate(2, 1);      // 4
+        circuit.add_h_gate(0);          // 5
+
+        const auto dag = ket::CircuitDag {circuit};
+
+        REQUIRE(dag.n_nodes() == 6);
+        REQUIRE(dag.n_layers() == 3);
+
+        REQUIRE(dag.layer_nodes(0) == Indices {0, 1, 3});
+        REQUIRE(dag.layer_nodes(1) == Indices {2});
+        REQUIRE(dag.layer_nodes(2) == Indices {4, 5});
+
+        REQUIRE(dag.qubit_wire(0) == Indices {0, 2, 5});
+        REQUIRE(dag.qubit_wire(1) == Indices {1, 2, 4});
+        REQUIRE(dag.qubit_wire(2) == Indices {3, 4});
+
+        REQUIRE(dag.predecessors(2) == Indices {0, 1});
+        REQUIRE(dag.predecessors(4) == Indices {2, 3});
+        REQUIRE(dag.successors(2) == Indices {4, 5});
+        REQUIRE(dag.successors(5).empty());
+    }
+
+    SECTION("pauli rotation gates act on the qubits of their non-identity terms")
+    {
+        using PT = ket::PauliTerm;
+
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);
+        circuit.add_h_gate(1);
+        circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::I, PT::Z}}, 0.5);
+
+        const auto dag = ket::CircuitDag {circuit};
+
+        REQUIRE(dag.predecessors(2) == Indices {0});
+        REQUIRE(dag.layer(2) == 1);
+        REQUIRE(dag.qubit_wire(1) == Indices {1});
+        REQUIRE(dag.qubit_wire(2) == Indices {2});
+    }
+
+    SECTION("measurement gates act on their classical bits")
+    {
+        auto circuit = ket::QuantumCircuit {2, 1};
+        circuit.add_m_gate(0, 0);
+        circuit.add_m_gate(1, 0);
+
+        const auto dag = ket::CircuitDag {circuit};
+
+        REQUIRE(dag.bit_wire(0) == Indices {0, 1});
+        REQUIRE(dag.predecessors(1) == Indices {0});
+        REQUIRE(dag.n_layers() == 2);
+    }
+
+    SECTION("control flow statements and circuit loggers separate the layers")
+    {
+        auto subcircuit = ket::QuantumCircuit {3};
+        subcircuit.add_x_gate(2);
+
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);
+        circuit.add_m_gate(0);
+        circuit.add_if_statement(0, subcircuit);
+        circuit.add_h_gate(1);
+        circuit.add_statevector_circuit_logger();
+        circuit.add_h_gate(2);
+
+        const auto dag = ket::CircuitDag {circuit};
+
+        REQUIRE(dag.layer(2) == 2);
+        REQUIRE(dag.predecessors(2) == Indices {1});
+        REQUIRE(dag.layer(3) == 3);
+        REQUIRE(dag.predecessors(4) == Indices {2, 3});
+        REQUIRE(dag.predecessors(5) == Indices {4});
+        REQUIRE(dag.n_layers() == 6);
+    }
+
+    SECTION("sync() follows gates added to and removed from the circuit")
+    {
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);
+        circuit.add_cx_gate(0, 1);
+
+        auto dag = ket::CircuitDag {circuit};
+
+        circuit.add_x_gate(2);
+        circuit.add_cz_gate(1, 2);
+        circuit.add_rx_gate(0, 0.25);
+        dag.sync(circuit);
+        require_same_as_rebuilt_(dag, circuit);
+
+        circuit.pop_back();
+        circuit.pop_back();
+        dag.sync(circuit);
+        require_same_as_rebuilt_(dag, circuit);
+        REQUIRE(dag.n_layers() == 2);
+
+        circuit.add_m_gate(1);
+        circuit.add_h_gate(1);
+        dag.sync(circuit);
+        require_same_as_rebuilt_(dag, circuit);
+    }
+
+    SECTION("sync() detects an element that was removed and replaced by another")
+    {
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);
+        circuit.add_cx_gate(0, 1);
+
+        auto dag = ket::CircuitDag {circuit};
+
+        circuit.pop_back();
+        circuit.add_cx_gate(1, 2);
+        dag.sync(circuit);
+        require_same_as_rebuilt_(dag, circuit);
+        REQUIRE(dag.qubit_wire(0) == std::vector<std::size_t> {0});
+        REQUIRE(dag.qubit_wire(2) == std::vector<std::size_t> {1});
+        REQUIRE(dag.n_layers() == 1);
+    }
+
+    SECTION("throws for invalid inputs")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_h_gate(0);
+
+        auto dag = ket::CircuitDag {circuit};
+
+        REQUIRE_THROWS_AS(dag.qubit_wire(2), std::runtime_error);
+        REQUIRE_THROWS_AS(dag.bit_wire(2), std::runtime_error);
+        REQUIRE_THROWS_AS(dag.predecessors(1), std::runtime_error);
+        REQUIRE_THROWS_AS(dag.layer_nodes(1), std::runtime_error);
+        REQUIRE_THROWS_AS(dag.sync(ket::QuantumCircuit {3}), std::runtime_error);
+    }
+}
@@ -0,0 +1,210 @@
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit/compact_circuit.hpp"
+#include "kettle/circuit_operations/append_circuits.hpp"
+#include "kettle/circuit_operations/compare_circuits.hpp"
+#include "kettle/gates/common_u_gates.hpp"
+#include "kettle/gates/primitive_gate.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+
+namespace
+{
+
+using PT = ket::PauliTerm;
+
+/*
+    A circuit that uses every kind of gate that a `CompactCircuit` stores differently.
+*/
+auto mixed_circuit_() -> ket::QuantumCircuit
+{
+    auto circuit = ket::QuantumCircuit {3};
+    circuit.add_h_gate(0);
+    circuit.add_rx_gate(1, 0.25);
+    circuit.add_cx_gate(0, 2);
+    circuit.add_crz_gate(2, 1, -0.75);
+    circuit.add_u_gate(ket::sx_gate(), 2);
+    circuit.add_cu_gate(ket::y_gate(), 1, 0);
+    circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::Y, PT::Z}}, 0.5);
+    circuit.add_m_gate(1, 2);
+
+    return circuit;
+}
+
+auto simulated_(const ket::QuantumCircuit& circuit) -> ket::QuantumState
+{
+    auto state = ket::generate_random_state(circuit.n_qubits(), 42);
+    ket::simulate(circuit, state);
+
+    return state;
+}
+
+}  // namespace
+
+
+TEST_CASE("CompactCircuit")
+{
+    SECTION("gate records are 16 bytes")
+    {
+        STATIC_REQUIRE(sizeof(ket::CompactGate) == 16);
+    }
+
+    SECTION("round trip through a QuantumCircuit")
+    {
+        const auto circuit = mixed_circuit_();
+        const auto compact = ket::CompactCircuit {circuit};
+
+        REQUIRE(compact.n_qubits() == 3);
+        REQUIRE(compact.n_bits() == 3);
+        REQUIRE(compact.n_gates() == circuit.n_circuit_elements());
+        REQUIRE(ket::almost_eq(compact.to_circuit(), circuit));
+    }
+
+    SECTION("the pools hold the data that does not fit in the records")
+    {
+        const auto compact = ket::CompactCircuit {mixed_circuit_()};
+
+        REQUIRE(compact[1].gate == ket::Gate::RX);
+        REQUIRE(compact[1].arg0 == 1);
+        REQUIRE(compact.angle(compact[1]) == 0.25);
+
+        REQUIRE(compact[3].arg0 == 2);
+        REQUIRE(compact[3].arg1 == 1);
+        REQUIRE(compact.angle(compact[3]) == -0.75);
+
+        REQUIRE(ket::almost_eq(compact.unitary(compact[4]), ket::sx_gate()));
+        REQUIRE(ket::almost_eq(compact.unitary(compact[5]), ket::y_gate()));
+        REQUIRE(compact.pauli_string(compact[6]) == ket::SparsePauliString {{PT::X, PT::Y, PT::Z}});
+        REQUIRE(compact.angle(compact[6]) == 0.5);
+
+        REQUIRE(compact[7].gate == ket::Gate::M);
+        REQUIRE(compact[7].arg1 == 2);
+
+        REQUIRE_THROWS_AS(compact.angle(compact[0]), std::runtime_error);
+        REQUIRE_THROWS_AS(compact.unitary(compact[1]), std::runtime_error);
+        REQUIRE_THROWS_AS(compact.pauli_string(compact[1]), std::runtime_error);
+        REQUIRE_THROWS_AS(compact.parameter_expression(compact[1]), std::runtime_error);
+    }
+
+    SECTION("parameterized gates keep their parameters")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        const auto id = circuit.add_ry_gate(0, 0.3, ket::param::parameterized {});
+        circuit.add_crx_gate(0, 1, id);
+        circuit.add_h_gate(1);
+
+        const auto compact = ket::CompactCircuit {circuit};
+        REQUIRE(compact[0].is_parameterized);
+        REQUIRE(compact.parameter_data_map().at(id).count == 2);
+
+        const auto restored = compact.to_circuit();
+        REQUIRE(restored.parameter_data_map().at(id).count == 2);
+        REQUIRE(ket::almost_eq(simulated_(restored), simulated_(circuit)));
+    }
+
+    SECTION("extend_circuit() shifts the pool indices")
+    {
+        auto left = ket::CompactCircuit {mixed_circuit_()};
+        const auto right = ket::CompactCircuit {mixed_circuit_()};
+
+        extend_circuit(left, right);
+
+        const auto expected = ket::append_circuits(mixed_circuit_(), mixed_circuit_());
+        REQUIRE(left.n_gates() == 16);
+        REQUIRE(ket::almost_eq(left.to_circuit(), expected));
+
+        const auto appended = ket::append_circuits(ket::CompactCircuit {mixed_circuit_()}, right);
+        REQUIRE(ket::almost_eq(appended.to_circuit(), expected));
+    }
+
+    SECTION("a matrix is only stored once")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_u_gate(ket::sx_gate(), 0);
+        circuit.add_cu_gate(ket::sx_gate(), 0, 1);
+        circuit.add_u_gate(ket::y_gate(), 1);
+
+        // a matrix that is only almost equal is a different matrix
+        auto nearby_sx = ket::sx_gate();
+        nearby_sx.elem00 += std::complex<double> {1.0e-12, 0.0};
+        circuit.add_u_gate(nearby_sx, 1);
+
+        auto compact = ket::CompactCircuit {circuit};
+        REQUIRE(compact.unitaries().size() == 3);
+        REQUIRE(compact[0].payload == compact[1].payload);
+        REQUIRE(compact[0].payload != compact[3].payload);
+
+        extend_circuit(compact, ket::CompactCircuit {circuit});
+        REQUIRE(compact.unitaries().size() == 3);
+        REQUIRE(ket::almost_eq(compact.to_circuit(), ket::append_circuits(circuit, circuit)));
+    }
+
+    SECTION("simulate() runs the compact records directly")
+    {
+        auto circuit = mixed_circuit_();
+        circuit.pop_back();  // the measurement
+
+        const auto id = circuit.add_ry_gate(0, 0.3, ket::param::parameterized {});
+        circuit.add_crx_gate(0, 1, id);
+        circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::Z, PT::I, PT::X}}, id);
+
+        const auto compact = ket::CompactCircuit {circuit};
+
+        auto state = ket::generate_random_state(circuit.n_qubits(), 42);
+        ket::simulate(compact, state);
+
+        REQUIRE(ket::almost_eq(state, simulated_(circuit)));
+    }
+
+    SECTION("simulate() measures into the classical register")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_x_gate(1);
+        circuit.add_m_gate(1, 0);
+
+        auto state = ket::QuantumState {2};
+        auto simulator = ket::StatevectorSimulator {};
+        simulator.run(ket::CompactCircuit {circuit}, state);
+
+        REQUIRE(simulator.classical_register().get(0) == 1);
+    }
+
+    SECTION("push_back()")
+    {
+        auto compact = ket::CompactCircuit {2};
+        const auto circuit = mixed_circuit_();
+        const auto& gate_info = circuit[2].get_gate();  // CX(0, 2)
+
+        REQUIRE_THROWS_AS(compact.push_back(gate_info), std::runtime_error);
+
+        auto reference = ket::QuantumCircuit {2};
+        reference.add_cu_gate(ket::h_gate(), 1, 0);
+        reference.add_rz_gate(1, 0.125);
+        for (const auto& element : reference) {
+            compact.push_back(element.get_gate());
+        }
+
+        REQUIRE(ket::almost_eq(compact.to_circuit(), reference));
+
+        auto parameterized = ket::QuantumCircuit {2};
+        parameterized.add_rz_gate(0, 0.5, ket::param::parameterized {});
+        REQUIRE_THROWS_AS(compact.push_back(parameterized[0].get_gate()), std::runtime_error);
+    }
+
+    SECTION("throws for control flow and circuit loggers")
+    {
+        auto circuit = ket::QuantumCircuit {1};
+        circuit.add_statevector_circuit_logger();
+
+        REQUIRE_THROWS_AS(ket::CompactCircuit {circuit}, std::runtime_error);
+    }
+}
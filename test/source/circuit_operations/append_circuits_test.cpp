@@ -1,4 +1,8 @@
+#include <cstddef>
+#include <stdexcept>
+
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
 #include "kettle/circuit/circuit.hpp"
 #include "kettle/gates/common_u_gates.hpp"
@@ -227,3 +231,39 @@ TEST_CASE("extend_circuit() with control flow")
         }
     }
 }
+
+
+TEST_CASE("slice_circuit()")
+{
+    auto circuit = ket::QuantumCircuit {3};
+    circuit.add_h_gate(0);
+    const auto id = circuit.add_rx_gate(1, 0.25, ket::param::parameterized {});
+    circuit.add_cx_gate(0, 2);
+    circuit.add_ry_gate(2, id);
+
+    SECTION("slices join back into the original circuit")
+    {
+        const auto i_split = static_cast<std::size_t>(GENERATE(0, 1, 2, 3, 4));
+
+        auto left = ket::slice_circuit(circuit, 0, i_split);
+        const auto right = ket::slice_circuit(circuit, i_split, circuit.n_circuit_elements());
+        ket::extend_circuit(left, right);
+
+        REQUIRE(left.n_circuit_elements() == circuit.n_circuit_elements());
+        REQUIRE(ket::almost_eq(left, circuit));
+    }
+
+    SECTION("parameters are kept")
+    {
+        const auto sliced = ket::slice_circuit(circuit, 3, 4);
+
+        REQUIRE(sliced.n_circuit_elements() == 1);
+        REQUIRE(sliced.parameter_data_map().contains(id));
+    }
+
+    SECTION("invalid ranges throw")
+    {
+        REQUIRE_THROWS_AS(ket::slice_circuit(circuit, 2, 1), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::slice_circuit(circuit, 0, 5), std::runtime_error);
+    }
+}
@@ -1,3 +1,7 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 #include <catch2/generators/catch_generators_range.hpp>
@@ -38,6 +42,52 @@ TEST_CASE("make_binary_controlled_circuit()")
     ket::simulate(binary_made_circuit, state1);
 
     REQUIRE(ket::almost_eq(state0, state1));
+
+    // the naive circuit only holds gates, so that it works with the tools that only accept gates
+    for (const auto& element : binary_made_circuit) {
+        REQUIRE(element.is_gate());
+    }
+}
+
+TEST_CASE("make_binary_controlled_block_circuit()")
+{
+    const auto init_bitstring = std::string {
+        GENERATE(
+            "0000", "1000", "0100", "1100", "0010", "1010", "0110", "1110",
+            "0001", "1001", "0101", "1101", "0011", "1011", "0111", "1111"
+        )
+    };
+
+    const auto angle = M_PI_4;
+
+    auto subcircuit = ket::QuantumCircuit {1};
+    subcircuit.add_u_gate(ket::p_gate(angle), 0);
+
+    const auto naive_circuit = ket::make_binary_controlled_circuit_naive(subcircuit, 4, {0, 1, 2}, {3});
+    const auto block_circuit = ket::make_binary_controlled_block_circuit(subcircuit, 4, {0, 1, 2}, {3});
+
+    // one controlled block per control qubit, each holding a single repeat statement of the subcircuit
+    REQUIRE(block_circuit.n_circuit_elements() == 3);
+    for (std::size_t i {0}; i < 3; ++i) {
+        const auto& element = block_circuit[i];
+        REQUIRE(element.is_control_flow());
+        REQUIRE(element.get_control_flow().is_controlled_block());
+
+        const auto& block = element.get_control_flow().get_controlled_block();
+        REQUIRE(block.control_qubits() == std::vector<std::size_t> {i});
+
+        const auto& block_subcircuit = *block.circuit();
+        REQUIRE(block_subcircuit.n_circuit_elements() == 1);
+        REQUIRE(block_subcircuit[0].get_control_flow().get_repeat_statement().n_repetitions() == (1UL << i));
+    }
+
+    auto state0 = ket::QuantumState {init_bitstring};
+    auto state1 = ket::QuantumState {init_bitstring};
+
+    ket::simulate(naive_circuit, state0);
+    ket::simulate(block_circuit, state1);
+
+    REQUIRE(ket::almost_eq(state0, state1));
 }
 
 TEST_CASE("make_binary_controlled_circuit_from_binary_powers() for single qubit gate")
@@ -10,6 +10,8 @@
 #include "kettle/circuit_operations/append_circuits.hpp"
 #include "kettle/circuit_operations/make_controlled_circuit.hpp"
 #include "kettle/circuit_operations/compare_circuits.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/state/random.hpp"
 
 TEST_CASE("make_controlled_circuit()")
 {
@@ -514,3 +516,66 @@ TEST_CASE("controlled circuits with circuit logger")
         REQUIRE(logger_position(append_then_control) == logger_position(control_then_append));
     }
 }
+
+TEST_CASE("make_controlled_block_circuit()")
+{
+    auto subcircuit = ket::QuantumCircuit {3};
+    subcircuit.add_h_gate(0);
+    subcircuit.add_ry_gate(1, 0.375);
+    subcircuit.add_cx_gate(0, 2);
+    subcircuit.add_cp_gate(2, 1, -1.25);
+    subcircuit.add_u_gate(ket::sx_gate(), 2);
+    subcircuit.add_cu_gate(ket::y_gate(), 1, 0);
+    subcircuit.add_pauli_rotation_gate(ket::SparsePauliString {{ket::PauliTerm::X, ket::PauliTerm::Y, ket::PauliTerm::Z}}, 0.5);
+
+    SECTION("one control qubit")
+    {
+        const auto block_circuit = ket::make_controlled_block_circuit(subcircuit, 4, {2}, {3, 0, 1});
+        const auto expected_circuit = ket::make_controlled_circuit(subcircuit, 4, 2, {3, 0, 1});
+
+        REQUIRE(block_circuit.n_circuit_elements() == 1);
+
+        auto block_state = ket::generate_random_state(4, 42);
+        auto expected_state = block_state;
+        ket::simulate(block_circuit, block_state);
+        ket::simulate(expected_circuit, expected_state);
+
+        REQUIRE(ket::almost_eq(block_state, expected_state));
+    }
+
+    SECTION("two control qubits")
+    {
+        const auto block_circuit = ket::make_controlled_block_circuit(subcircuit, 5, {0, 3}, {4, 1, 2});
+        const auto expected_circuit = ket::make_multiplicity_controlled_circuit(subcircuit, 5, {0, 3}, {4, 1, 2});
+
+        auto block_state = ket::generate_random_state(5, 42);
+        auto expected_state = block_state;
+        ket::simulate(block_circuit, block_state);
+        ket::simulate(expected_circuit, expected_state);
+
+        REQUIRE(ket::almost_eq(block_state, expected_state));
+    }
+
+    SECTION("make_controlled_circuit() adds a control qubit to a controlled block")
+    {
+        const auto block_circuit = ket::make_controlled_block_circuit(subcircuit, 4, {0}, {1, 2, 3});
+        const auto controlled_block = ket::make_controlled_circuit(block_circuit, 5, 4, {0, 1, 2, 3});
+        const auto expected_circuit = ket::make_multiplicity_controlled_circuit(subcircuit, 5, {0, 4}, {1, 2, 3});
+
+        auto block_state = ket::generate_random_state(5, 42);
+        auto expected_state = block_state;
+        ket::simulate(controlled_block, block_state);
+        ket::simulate(expected_circuit, expected_state);
+
+        REQUIRE(ket::almost_eq(block_state, expected_state));
+    }
+}
+
+TEST_CASE("making a parameterized PAULI_ROT gate controlled throws")
+{
+    auto subcircuit = ket::QuantumCircuit {2};
+    subcircuit.add_pauli_rotation_gate(ket::SparsePauliString {{ket::PauliTerm::X, ket::PauliTerm::Z}}, 0.5, ket::param::parameterized {});
+
+    REQUIRE_THROWS_AS(ket::make_controlled_circuit(subcircuit, 3, 0, {1, 2}), std::runtime_error);
+    REQUIRE_THROWS_AS(ket::make_multiplicity_controlled_circuit(subcircuit, 4, {0, 1}, {2, 3}), std::runtime_error);
+}
@@ -0,0 +1,224 @@
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit_operations/optimize_circuit.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+
+namespace
+{
+
+using Level = ket::CircuitOptimizationLevel;
+using PT = ket::PauliTerm;
+
+auto simulated_(const ket::QuantumCircuit& circuit, const ket::QuantumState& initial_state) -> ket::QuantumState
+{
+    auto state = initial_state;
+    ket::simulate(circuit, state, 0);
+
+    return state;
+}
+
+/*
+    Creates a circuit from a small set of gates and angles, so that many of the gates cancel or merge.
+*/
+auto random_circuit_(std::size_t n_gates, int seed) -> ket::QuantumCircuit
+{
+    constexpr auto n_qubits = std::size_t {3};
+    constexpr auto n_kinds = int {20};
+
+    auto prng = std::mt19937 {static_cast<std::mt19937::result_type>(seed)};
+    auto kind_dist = std::uniform_int_distribution<int> {0, n_kinds - 1};
+    auto qubit_dist = std::uniform_int_distribution<std::size_t> {0, n_qubits - 1};
+    auto angle_dist = std::uniform_int_distribution<int> {-2, 2};
+
+    auto circuit = ket::QuantumCircuit {n_qubits};
+
+    while (circuit.n_circuit_elements() < n_gates) {
+        const auto q0 = qubit_dist(prng);
+        const auto q1 = qubit_dist(prng);
+        const auto angle = 0.25 * static_cast<double>(angle_dist(prng));
+
+        switch (kind_dist(prng))
+        {
+            case 0  : circuit.add_h_gate(q0); break;
+            case 1  : circuit.add_x_gate(q0); break;
+            case 2  : circuit.add_y_gate(q0); break;
+            case 3  : circuit.add_z_gate(q0); break;
+            case 4  : circuit.add_s_gate(q0); break;
+            case 5  : circuit.add_sdag_gate(q0); break;
+            case 6  : circuit.add_t_gate(q0); break;
+            case 7  : circuit.add_sx_gate(q0); break;
+            case 8  : circuit.add_sxdag_gate(q0); break;
+            case 9  : circuit.add_rx_gate(q0, angle); break;
+            case 10 : circuit.add_ry_gate(q0, angle); break;
+            case 11 : circuit.add_rz_gate(q0, angle); break;
+            case 12 : circuit.add_p_gate(q0, angle); break;
+            case 13 : if (q0 != q1) { circuit.add_cx_gate(q0, q1); } break;
+            case 14 : if (q0 != q1) { circuit.add_cz_gate(q0, q1); } break;
+            case 15 : if (q0 != q1) { circuit.add_cy_gate(q0, q1); } break;
+            case 16 : if (q0 != q1) { circuit.add_crx_gate(q0, q1, angle); } break;
+            case 17 : if (q0 != q1) { circuit.add_cp_gate(q0, q1, angle); } break;
+            case 18 : if (q0 != q1) { circuit.add_cs_gate(q0, q1); } break;
+            default : circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::I, PT::Z}}, angle); break;
+        }
+    }
+
+    return circuit;
+}
+
+}  // namespace
+
+
+TEST_CASE("optimize_circuit()")
+{
+    SECTION("adjacent inverse pairs cancel")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_h_gate(0);
+        circuit.add_cx_gate(0, 1);
+        circuit.add_cx_gate(0, 1);
+        circuit.add_h_gate(0);
+        circuit.add_s_gate(1);
+        circuit.add_sdag_gate(1);
+
+        auto statistics = ket::CircuitOptimizationStatistics {};
+        const auto optimized = ket::optimize_circuit(circuit, Level::CANCEL, statistics);
+
+        REQUIRE(optimized.n_circuit_elements() == 0);
+        REQUIRE(statistics.n_cancelled_pairs == 3);
+    }
+
+    SECTION("rotations merge, and vanish when their angles add up to zero")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_rz_gate(0, 0.3);
+        circuit.add_rz_gate(0, 0.4);
+        circuit.add_crx_gate(0, 1, 1.2);
+        circuit.add_crx_gate(0, 1, -1.2);
+        circuit.add_ry_gate(1, 0.0);
+
+        auto statistics = ket::CircuitOptimizationStatistics {};
+        const auto optimized = ket::optimize_circuit(circuit, Level::CANCEL, statistics);
+
+        REQUIRE(optimized.n_circuit_elements() == 1);
+        REQUIRE(statistics.n_merged_rotations == 2);
+        REQUIRE(statistics.n_removed_zero_rotations == 2);
+
+        const auto initial_state = ket::generate_random_state(2, 42);
+        REQUIRE(ket::almost_eq(simulated_(optimized, initial_state), simulated_(circuit, initial_state)));
+    }
+
+    SECTION("gates on other qubits do not separate a pair")
+    {
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_x_gate(0);
+        circuit.add_h_gate(1);
+        circuit.add_cz_gate(1, 2);
+        circuit.add_x_gate(0);
+
+        const auto optimized = ket::optimize_circuit(circuit, Level::CANCEL);
+        REQUIRE(optimized.n_circuit_elements() == 2);
+    }
+
+    SECTION("commuting exposes more cancellations")
+    {
+        // the RZ gates commute with the control of the CX gate, and the RX gates with its target
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_rz_gate(0, 0.5);
+        circuit.add_rx_gate(1, 0.7);
+        circuit.add_cx_gate(0, 1);
+        circuit.add_rz_gate(0, -0.5);
+        circuit.add_rx_gate(1, -0.7);
+
+        auto cancel_statistics = ket::CircuitOptimizationStatistics {};
+        const auto cancelled = ket::optimize_circuit(circuit, Level::CANCEL, cancel_statistics);
+        REQUIRE(cancelled.n_circuit_elements() == 5);
+
+        auto commute_statistics = ket::CircuitOptimizationStatistics {};
+        const auto commuted = ket::optimize_circuit(circuit, Level::COMMUTE, commute_statistics);
+        REQUIRE(commuted.n_circuit_elements() == 1);
+        REQUIRE(commute_statistics.n_commuted_matches == 2);
+    }
+
+    SECTION("gates do not commute past a non-commuting gate")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_rz_gate(1, 0.5);
+        circuit.add_cx_gate(0, 1);
+        circuit.add_rz_gate(1, -0.5);
+
+        const auto optimized = ket::optimize_circuit(circuit, Level::COMMUTE);
+        REQUIRE(optimized.n_circuit_elements() == 3);
+    }
+
+    SECTION("measurements and control flow are respected")
+    {
+        auto subcircuit = ket::QuantumCircuit {2};
+        subcircuit.add_y_gate(1);
+        subcircuit.add_y_gate(1);
+        subcircuit.add_z_gate(0);
+
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_h_gate(0);
+        circuit.add_m_gate(0);
+        circuit.add_h_gate(0);
+        circuit.add_x_gate(1);
+        circuit.add_if_statement(0, subcircuit);
+        circuit.add_x_gate(1);
+
+        auto statistics = ket::CircuitOptimizationStatistics {};
+        const auto optimized = ket::optimize_circuit(circuit, Level::COMMUTE, statistics);
+
+        REQUIRE(optimized.n_circuit_elements() == 6);
+        REQUIRE(optimized[4].is_control_flow());
+        REQUIRE((*optimized[4].get_control_flow().get_if_statement().circuit()).n_circuit_elements() == 1);
+        REQUIRE(statistics.n_cancelled_pairs == 1);
+    }
+
+    SECTION("parameterized gates are kept")
+    {
+        auto circuit = ket::QuantumCircuit {1};
+        const auto id = circuit.add_rz_gate(0, 0.5, ket::param::parameterized {});
+        circuit.add_rz_gate(0, id);
+        circuit.add_z_gate(0);
+        circuit.add_rz_gate(0, id);
+        circuit.add_z_gate(0);
+
+        const auto optimized = ket::optimize_circuit(circuit, Level::COMMUTE);
+        REQUIRE(optimized.n_circuit_elements() == 3);
+        REQUIRE(optimized.parameter_data_map().at(id).count == 3);
+    }
+
+    SECTION("the level NONE leaves the circuit unchanged")
+    {
+        auto circuit = ket::QuantumCircuit {1};
+        circuit.add_x_gate(0);
+        circuit.add_x_gate(0);
+
+        REQUIRE(ket::optimize_circuit(circuit, Level::NONE).n_circuit_elements() == 2);
+    }
+
+    SECTION("random circuits keep their effect on the state")
+    {
+        const auto seed = GENERATE(1, 2, 3, 4, 5, 6, 7, 8);
+        const auto level = GENERATE(Level::CANCEL, Level::COMMUTE);
+
+        const auto circuit = random_circuit_(200, seed);
+        const auto optimized = ket::optimize_circuit(circuit, level);
+
+        REQUIRE(optimized.n_circuit_elements() < circuit.n_circuit_elements());
+
+        const auto initial_state = ket::generate_random_state(3, seed);
+        REQUIRE(ket::almost_eq(simulated_(optimized, initial_state), simulated_(circuit, initial_state)));
+    }
+}
@@ -1,5 +1,8 @@
+#include <complex>
+#include <cstddef>
 #include <string>
 #include <optional>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
@@ -9,9 +12,12 @@
 #include "kettle/circuit_operations/transpile_to_primitive.hpp"
 #include "kettle/gates/common_u_gates.hpp"
 #include "kettle/simulation/simulate.hpp"
+#include "kettle/state/random.hpp"
 
 #include "kettle_internal/gates/primitive_gate/gate_id.hpp"
+#include "kettle_internal/circuit_operations/transpile_to_primitive_internal.hpp"
 #include "kettle_internal/gates/matrix2x2_gate_decomposition.hpp"
+#include "kettle_internal/simulation/multithread_simulate_utils.hpp"
 
 using G = ket::Gate;
 using Matrices = std::vector<ket::Matrix2X2>;
@@ -267,3 +273,99 @@ TEST_CASE("transpile_to_primitive() with control flow if_else_statement()")
         REQUIRE(ket::almost_eq(state0, state1));
     }
 }
+
+TEST_CASE("transpile_to_primitive() with many repeated unitaries and subcircuits")
+{
+    // the same few matrices are repeated many times, across several independent subcircuits
+    const auto unitary0 = make_matrix({{G::H}, {G::RZ, 0.432}, {G::P, 2.232}});
+    const auto unitary1 = make_matrix({{G::X}, {G::RX, 1.2345}, {G::RZ, -2.341}});
+
+    auto original = ket::QuantumCircuit {3};
+    original.add_h_gate(0);
+    original.add_m_gate(0, 0);
+
+    for (std::size_t i_subcircuit {0}; i_subcircuit < 6; ++i_subcircuit) {
+        auto if_subcircuit = ket::QuantumCircuit {3};
+        auto else_subcircuit = ket::QuantumCircuit {3};
+
+        for (std::size_t i {0}; i < 20; ++i) {
+            if_subcircuit.add_u_gate(unitary0, 1);
+            if_subcircuit.add_cu_gate(unitary1, 1, 2);
+            else_subcircuit.add_cu_gate(unitary0, 2, 1);
+        }
+
+        if (i_subcircuit % 2 == 0) {
+            original.add_if_statement(0, if_subcircuit);
+        }
+        else {
+            original.add_if_else_statement(0, if_subcircuit, else_subcircuit);
+        }
+
+        original.add_u_gate(unitary1, 2);
+    }
+
+    const auto transpiled = ket::transpile_to_primitive(original);
+
+    for (const auto& element : transpiled) {
+        if (element.is_gate()) {
+            REQUIRE(element.get_gate().gate != G::U);
+        }
+    }
+
+    const auto prng_seed = GENERATE(1, 2, 3);
+    auto state0 = ket::generate_random_state(3, prng_seed);
+    auto state1 = state0;
+
+    ket::simulate(original, state0, prng_seed);
+    ket::simulate(transpiled, state1, prng_seed);
+
+    REQUIRE(ket::almost_eq(state0, state1));
+}
+
+TEST_CASE("transpile_to_primitive() gives the same output on any number of threads")
+{
+    namespace ki = ket::internal;
+
+    // the two matrices are equal to within the tolerance, but are not the same matrix
+    const auto unitary = make_matrix({{G::H}, {G::RZ, 0.432}, {G::P, 2.232}});
+    auto nearby_unitary = unitary;
+    nearby_unitary.elem01 += std::complex<double> {1.0e-12, 0.0};
+
+    // enough gates in the subcircuits to be split up between threads
+    const auto n_gates_per_subcircuit = 2 * ki::MINIMUM_WORK_ITEMS_PER_THREAD_;
+
+    auto original = ket::QuantumCircuit {2};
+    for (std::size_t i_subcircuit {0}; i_subcircuit < 4; ++i_subcircuit) {
+        auto subcircuit = ket::QuantumCircuit {2};
+        for (std::size_t i {0}; i < n_gates_per_subcircuit; ++i) {
+            subcircuit.add_u_gate((i + i_subcircuit) % 2 == 0 ? unitary : nearby_unitary, i % 2);
+        }
+
+        original.add_repeat_statement(1, std::move(subcircuit));
+    }
+
+    const auto gates_of = [](const ket::QuantumCircuit& circuit) {
+        auto output = std::vector<ket::GateInfo> {};
+        for (const auto& element : circuit) {
+            const auto& subcircuit = *element.get_control_flow().get_repeat_statement().circuit();
+            for (const auto& sub_element : subcircuit) {
+                output.push_back(sub_element.get_gate());
+            }
+        }
+
+        return output;
+    };
+
+    auto single_thread_cache = ki::DecompositionCache_ {};
+    auto multi_thread_cache = ki::DecompositionCache_ {};
+    const auto single_thread_gates = gates_of(ki::transpile_to_primitive_(original, single_thread_cache, 1));
+    const auto multi_thread_gates = gates_of(ki::transpile_to_primitive_(original, multi_thread_cache, 4));
+
+    REQUIRE(single_thread_gates.size() == multi_thread_gates.size());
+    for (std::size_t i {0}; i < single_thread_gates.size(); ++i) {
+        REQUIRE(single_thread_gates[i].gate == multi_thread_gates[i].gate);
+        REQUIRE(single_thread_gates[i].arg0 == multi_thread_gates[i].arg0);
+        REQUIRE(single_thread_gates[i].arg1 == multi_thread_gates[i].arg1);
+        REQUIRE(single_thread_gates[i].arg2 == multi_thread_gates[i].arg2);
+    }
+}
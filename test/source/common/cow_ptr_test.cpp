@@ -0,0 +1,72 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/common/cow_ptr.hpp"
+
+
+TEST_CASE("CowPtr")
+{
+    SECTION("copies share the data")
+    {
+        const auto original = ket::CowPtr<std::vector<int>> {std::vector<int> {1, 2, 3}};
+        const auto copy = original;  // NOLINT(performance-unnecessary-copy-initialization)
+
+        REQUIRE(copy.shares_data_with(original));
+        REQUIRE(&*copy == &*original);
+    }
+
+    SECTION("modifying a copy does not affect the original")
+    {
+        const auto original = ket::CowPtr<std::vector<int>> {std::vector<int> {1, 2, 3}};
+        auto copy = original;
+
+        (*copy).push_back(4);
+
+        REQUIRE(!copy.shares_data_with(original));
+        REQUIRE(*original == std::vector<int> {1, 2, 3});
+        REQUIRE(*copy == std::vector<int> {1, 2, 3, 4});
+    }
+
+    SECTION("modifying unshared data does not copy it")
+    {
+        auto ptr = ket::CowPtr<std::vector<int>> {std::make_unique<std::vector<int>>(std::vector<int> {1})};
+        const auto* address = &*std::as_const(ptr);
+
+        (*ptr).push_back(2);
+
+        REQUIRE(&*std::as_const(ptr) == address);
+        REQUIRE(*std::as_const(ptr) == std::vector<int> {1, 2});
+    }
+
+    SECTION("null pointer")
+    {
+        const auto ptr = ket::CowPtr<int> {std::unique_ptr<int> {nullptr}};
+        REQUIRE(!ptr);
+    }
+
+    SECTION("copies of a circuit share the subcircuits of its control flow statements")
+    {
+        auto subcircuit = ket::QuantumCircuit {2};
+        subcircuit.add_x_gate(0);
+
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_m_gate(1);
+        circuit.add_if_statement(1, subcircuit);
+        circuit.add_if_else_statement(1, subcircuit, subcircuit);
+
+        const auto copy = circuit;  // NOLINT(performance-unnecessary-copy-initialization)
+
+        const auto& if_stmt = circuit[1].get_control_flow().get_if_statement();
+        const auto& copy_if_stmt = copy[1].get_control_flow().get_if_statement();
+        REQUIRE(copy_if_stmt.circuit().shares_data_with(if_stmt.circuit()));
+
+        const auto& if_else_stmt = circuit[2].get_control_flow().get_if_else_statement();
+        const auto& copy_if_else_stmt = copy[2].get_control_flow().get_if_else_statement();
+        REQUIRE(copy_if_else_stmt.if_circuit().shares_data_with(if_else_stmt.if_circuit()));
+        REQUIRE(copy_if_else_stmt.else_circuit().shares_data_with(if_else_stmt.else_circuit()));
+    }
+}
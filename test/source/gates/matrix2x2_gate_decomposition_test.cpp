@@ -1,3 +1,4 @@
+#include <complex>
 #include <optional>
 
 #include <catch2/catch_test_macros.hpp>
@@ -10,6 +11,7 @@
 #include "kettle/simulation/simulate.hpp"
 #include "kettle/gates/common_u_gates.hpp"
 #include "kettle/gates/primitive_gate.hpp"
+#include "kettle/gates/random_u_gates.hpp"
 
 #include "kettle_internal/gates/matrix2x2_gate_decomposition.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_create.hpp"
@@ -189,3 +191,78 @@ TEST_CASE("decompose to primtive gates; general")
         REQUIRE(ket::almost_eq(state0, state1));
     }
 }
+
+
+TEST_CASE("DecompositionCache_")
+{
+    auto cache = ket::internal::DecompositionCache_ {};
+
+    const auto unitary = ket::generate_random_unitary2x2(42);
+    const auto other_unitary = ket::generate_random_unitary2x2(43);
+
+    SECTION("repeated matrices are only decomposed once")
+    {
+        const auto first = cache.decompose(unitary);
+        const auto second = cache.decompose(unitary);
+        const auto other = cache.decompose(other_unitary);
+
+        REQUIRE(cache.n_misses() == 2);
+        REQUIRE(cache.n_hits() == 1);
+
+        const auto expected = ket::internal::decomp_to_primitive_gates_(unitary);
+        REQUIRE(first.size() == expected.size());
+        REQUIRE(second.size() == expected.size());
+        for (std::size_t i {0}; i < expected.size(); ++i) {
+            REQUIRE(first[i].gate == expected[i].gate);
+            REQUIRE(second[i].gate == expected[i].gate);
+            REQUIRE(first[i].parameter == expected[i].parameter);
+            REQUIRE(second[i].parameter == expected[i].parameter);
+        }
+
+        REQUIRE(other.size() == ket::internal::decomp_to_primitive_gates_(other_unitary).size());
+    }
+
+    SECTION("matrices that are only almost equal are decomposed separately")
+    {
+        auto nearby_unitary = unitary;
+        nearby_unitary.elem00 += std::complex<double> {1.0e-12, 0.0};
+
+        // the output of each lookup must not depend on which of the two matrices was decomposed first
+        const auto nearby = cache.decompose(nearby_unitary);
+        const auto first = cache.decompose(unitary);
+
+        REQUIRE(cache.n_misses() == 2);
+        REQUIRE(cache.n_hits() == 0);
+
+        const auto expected_nearby = ket::internal::decomp_to_primitive_gates_(nearby_unitary);
+        const auto expected = ket::internal::decomp_to_primitive_gates_(unitary);
+        REQUIRE(nearby.size() == expected_nearby.size());
+        REQUIRE(first.size() == expected.size());
+
+        for (std::size_t i {0}; i < expected.size(); ++i) {
+            REQUIRE(nearby[i].gate == expected_nearby[i].gate);
+            REQUIRE(nearby[i].parameter == expected_nearby[i].parameter);
+            REQUIRE(first[i].gate == expected[i].gate);
+            REQUIRE(first[i].parameter == expected[i].parameter);
+        }
+    }
+
+    SECTION("the gates are placed on the requested qubits")
+    {
+        const auto single = cache.one_target_gates(1, unitary);
+        const auto controlled = cache.one_control_one_target_gates(2, 0, unitary);
+
+        REQUIRE(cache.n_hits() == 1);
+        REQUIRE(single.size() == controlled.size());
+
+        for (const auto& info : single) {
+            REQUIRE(cre::unpack_single_qubit_gate_index(info) == 1);
+        }
+
+        for (const auto& info : controlled) {
+            const auto [control, target] = cre::unpack_double_qubit_gate_indices(info);
+            REQUIRE(control == 2);
+            REQUIRE(target == 0);
+        }
+    }
+}
@@ -0,0 +1,578 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <kettle/circuit/circuit.hpp>
+#include <kettle/circuit/compact_circuit.hpp>
+#include <kettle/circuit_operations/compare_circuits.hpp>
+#include <kettle/gates/common_u_gates.hpp>
+#include <kettle/io/binary_circuit.hpp>
+#include <kettle/io/read_tangelo_file.hpp>
+#include <kettle/io/write_tangelo_file.hpp>
+#include <kettle/operator/pauli/sparse_pauli_string.hpp>
+#include <kettle/parameter/parameter.hpp>
+#include <kettle/simulation/simulate.hpp>
+#include <kettle/state/state.hpp>
+
+#include "kettle_internal/io/io_binary.hpp"
+
+
+namespace
+{
+
+/*
+    A path in the temporary directory that is removed, along with everything inside it, when the
+    instance goes out of scope.
+*/
+class TemporaryFilepath_
+{
+public:
+    explicit TemporaryFilepath_(const std::string& filename)
+        : filepath_ {std::filesystem::temp_directory_path() / filename}
+    {}
+
+    TemporaryFilepath_(const TemporaryFilepath_&) = delete;
+    auto operator=(const TemporaryFilepath_&) -> TemporaryFilepath_& = delete;
+    TemporaryFilepath_(TemporaryFilepath_&&) = delete;
+    auto operator=(TemporaryFilepath_&&) -> TemporaryFilepath_& = delete;
+
+    ~TemporaryFilepath_()
+    {
+        std::filesystem::remove_all(filepath_);
+    }
+
+    [[nodiscard]]
+    auto path() const -> const std::filesystem::path&
+    {
+        return filepath_;
+    }
+
+private:
+    std::filesystem::path filepath_;
+};
+
+auto example_circuit_() -> ket::QuantumCircuit
+{
+    using PT = ket::PauliTerm;
+
+    auto circuit = ket::QuantumCircuit {4, 2};
+    circuit.add_h_gate({0, 1, 2, 3});
+    circuit.add_cx_gate(0, 3);
+    circuit.add_rx_gate(1, 0.25);
+    circuit.add_ry_gate(2, 0.5, ket::param::parameterized {});
+    circuit.add_crz_gate(3, 1, -0.75, ket::param::parameterized {});
+    circuit.add_u_gate(ket::sx_gate(), 2);
+    circuit.add_cu_gate(ket::h_gate(), 1, 0);
+    circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::I, PT::Y, PT::Z}}, 0.8);
+    circuit.add_classical_register_circuit_logger();
+    circuit.add_statevector_circuit_logger();
+
+    auto body = ket::QuantumCircuit {4, 2};
+    body.add_ry_gate(3, 0.3);
+    body.add_cx_gate(1, 0);
+    circuit.add_repeat_statement(3, body);
+
+    auto block = ket::QuantumCircuit {4, 2};
+    block.add_y_gate(3);
+    block.add_cx_gate(2, 0);
+    circuit.add_controlled_block({1}, block);
+
+    circuit.add_m_gate(0, 0);
+    circuit.add_m_gate(1, 1);
+
+    auto if_circuit = ket::QuantumCircuit {4, 2};
+    if_circuit.add_x_gate(2);
+
+    auto else_circuit = ket::QuantumCircuit {4, 2};
+    else_circuit.add_z_gate(3);
+
+    circuit.add_if_statement(0, if_circuit);
+    circuit.add_if_not_else_statement(1, if_circuit, else_circuit);
+
+    return circuit;
+}
+
+void require_same_circuits_(const ket::QuantumCircuit& left, const ket::QuantumCircuit& right)
+{
+    REQUIRE(left.n_qubits() == right.n_qubits());
+    REQUIRE(left.n_bits() == right.n_bits());
+    REQUIRE(left.n_circuit_elements() == right.n_circuit_elements());
+    REQUIRE(ket::almost_eq(left, right));
+
+    // `almost_eq()` ignores the loggers
+    for (std::size_t i {0}; i < left.n_circuit_elements(); ++i) {
+        REQUIRE(left[i].is_circuit_logger() == right[i].is_circuit_logger());
+    }
+
+    // the parameters must still be usable after the round trip
+    REQUIRE(left.parameter_data_map().size() == right.parameter_data_map().size());
+    for (const auto& [id, data] : left.parameter_data_map()) {
+        REQUIRE(right.parameter_data_map().contains(id));
+        REQUIRE(right.parameter_data_map().at(id).value == data.value);
+        REQUIRE(right.parameter_data_map().at(id).name == data.name);
+        REQUIRE(right.parameter_data_map().at(id).count == data.count);
+    }
+
+    auto left_state = ket::QuantumState {"0000"};
+    auto right_state = ket::QuantumState {"0000"};
+    ket::simulate(left, left_state, 42);
+    ket::simulate(right, right_state, 42);
+    REQUIRE(ket::almost_eq(left_state, right_state));
+}
+
+// the offsets of the payload size and the checksum in the header, and the size of the header
+constexpr auto PAYLOAD_SIZE_OFFSET_ = std::size_t {16};
+constexpr auto CHECKSUM_OFFSET_ = std::size_t {24};
+constexpr auto HEADER_SIZE_ = std::size_t {32};
+
+// the circuit starts with its number of qubits and bits, its number of parameters, its parameter count,
+// and its number of elements; for a circuit without parameters, its first element starts right after
+constexpr auto FIRST_ELEMENT_OFFSET_ = std::size_t {40};
+
+// each gate starts with its tag, kind, and flags, followed by its two indices
+constexpr auto GATE_KIND_OFFSET_ = std::size_t {1};
+constexpr auto GATE_ARG0_OFFSET_ = std::size_t {3};
+
+auto save_to_string_(const ket::QuantumCircuit& circuit) -> std::string
+{
+    auto stream = std::stringstream {};
+    ket::save_circuit_binary(stream, circuit);
+
+    return stream.str();
+}
+
+/*
+    Applies `modify` to the payload of the binary circuit in `contents`, and then fixes the payload size
+    and checksum in the header; the modified circuit can only be rejected by checking what it contains.
+*/
+auto with_modified_payload_(
+    const std::string& contents,
+    const std::function<void(std::vector<std::byte>&)>& modify
+) -> std::string
+{
+    auto payload = std::vector<std::byte>(contents.size() - HEADER_SIZE_);
+    std::memcpy(payload.data(), contents.data() + HEADER_SIZE_, payload.size());
+
+    modify(payload);
+
+    const auto payload_size = static_cast<std::uint64_t>(payload.size());
+    const auto checksum = ket::internal::checksum_(payload);
+
+    auto output = contents.substr(0, HEADER_SIZE_);
+    std::memcpy(output.data() + PAYLOAD_SIZE_OFFSET_, &payload_size, sizeof(payload_size));
+    std::memcpy(output.data() + CHECKSUM_OFFSET_, &checksum, sizeof(checksum));
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    output.append(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+    return output;
+}
+
+void write_u64_(std::vector<std::byte>& payload, std::size_t offset, std::uint64_t value)
+{
+    std::memcpy(payload.data() + offset, &value, sizeof(value));
+}
+
+void append_u64_(std::vector<std::byte>& payload, std::uint64_t value)
+{
+    payload.resize(payload.size() + sizeof(value));
+    write_u64_(payload, payload.size() - sizeof(value), value);
+}
+
+void require_load_throws_(const std::string& contents)
+{
+    auto stream = std::stringstream {contents};
+    REQUIRE_THROWS_AS(ket::load_circuit_binary(stream), std::runtime_error);
+}
+
+}  // namespace
+
+
+TEST_CASE("binary circuit round trip")
+{
+    const auto circuit = example_circuit_();
+
+    SECTION("through a stream")
+    {
+        auto stream = std::stringstream {};
+        ket::save_circuit_binary(stream, circuit);
+
+        const auto loaded = ket::load_circuit_binary(stream);
+        require_same_circuits_(circuit, loaded);
+    }
+
+    SECTION("through a file")
+    {
+        const auto filepath = TemporaryFilepath_ {"kettle_binary_circuit_test.bin"};
+        ket::save_circuit_binary(filepath.path(), circuit);
+
+        const auto loaded = ket::load_circuit_binary(filepath.path());
+        require_same_circuits_(circuit, loaded);
+    }
+
+    SECTION("empty circuit")
+    {
+        auto stream = std::stringstream {};
+        ket::save_circuit_binary(stream, ket::QuantumCircuit {3});
+
+        const auto loaded = ket::load_circuit_binary(stream);
+        REQUIRE(loaded.n_qubits() == 3);
+        REQUIRE(loaded.n_circuit_elements() == 0);
+    }
+}
+
+TEST_CASE("load_circuit_binary() throws for invalid files")
+{
+    auto stream = std::stringstream {};
+    ket::save_circuit_binary(stream, example_circuit_());
+    const auto contents = stream.str();
+
+    SECTION("corrupted contents")
+    {
+        auto corrupted = contents;
+        corrupted[corrupted.size() / 2] ^= 0x5a;
+
+        auto corrupted_stream = std::stringstream {corrupted};
+        REQUIRE_THROWS_AS(ket::load_circuit_binary(corrupted_stream), std::runtime_error);
+    }
+
+    SECTION("truncated contents")
+    {
+        auto truncated_stream = std::stringstream {contents.substr(0, contents.size() - 10)};
+        REQUIRE_THROWS_AS(ket::load_circuit_binary(truncated_stream), std::runtime_error);
+    }
+
+    SECTION("wrong magic string")
+    {
+        auto wrong_magic = contents;
+        wrong_magic[0] = 'X';
+
+        auto wrong_magic_stream = std::stringstream {wrong_magic};
+        REQUIRE_THROWS_AS(ket::load_circuit_binary(wrong_magic_stream), std::runtime_error);
+    }
+}
+
+TEST_CASE("load_circuit_binary() throws for invalid circuits with a valid checksum")
+{
+    SECTION("unmodified payload loads")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_h_gate(0);
+
+        auto stream = std::stringstream {with_modified_payload_(save_to_string_(circuit), [](auto&) {})};
+        REQUIRE(ket::almost_eq(ket::load_circuit_binary(stream), circuit));
+    }
+
+    SECTION("U gate without a unitary matrix")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_h_gate(0);
+
+        require_load_throws_(with_modified_payload_(save_to_string_(circuit), [](auto& payload) {
+            payload[FIRST_ELEMENT_OFFSET_ + GATE_KIND_OFFSET_] = static_cast<std::byte>(ket::Gate::U);
+        }));
+    }
+
+    SECTION("CU gate without a unitary matrix")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_cx_gate(0, 1);
+
+        require_load_throws_(with_modified_payload_(save_to_string_(circuit), [](auto& payload) {
+            payload[FIRST_ELEMENT_OFFSET_ + GATE_KIND_OFFSET_] = static_cast<std::byte>(ket::Gate::CU);
+        }));
+    }
+
+    SECTION("PAULI_ROT gate without a Pauli string")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_rz_gate(0, 0.5);
+
+        require_load_throws_(with_modified_payload_(save_to_string_(circuit), [](auto& payload) {
+            payload[FIRST_ELEMENT_OFFSET_ + GATE_KIND_OFFSET_] = static_cast<std::byte>(ket::Gate::PAULI_ROT);
+        }));
+    }
+
+    SECTION("gate on a qubit outside of the circuit")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_h_gate(0);
+
+        require_load_throws_(with_modified_payload_(save_to_string_(circuit), [](auto& payload) {
+            write_u64_(payload, FIRST_ELEMENT_OFFSET_ + GATE_ARG0_OFFSET_, 2);
+        }));
+    }
+
+    SECTION("subcircuit with a different number of qubits")
+    {
+        auto body = ket::QuantumCircuit {2};
+        body.add_x_gate(1);
+
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_repeat_statement(3, body);
+
+        // the repeat statement has its tag and number of repetitions before its subcircuit
+        const auto subcircuit_offset = FIRST_ELEMENT_OFFSET_ + 1 + sizeof(std::uint64_t);
+
+        require_load_throws_(with_modified_payload_(save_to_string_(circuit), [&](auto& payload) {
+            write_u64_(payload, subcircuit_offset, 3);
+        }));
+    }
+
+    SECTION("controlled block whose subcircuit acts on its control qubit")
+    {
+        auto body = ket::QuantumCircuit {2};
+        body.add_x_gate(1);
+
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_controlled_block({0}, body);
+
+        // the controlled block has its tag and number of controls before its first control qubit
+        const auto control_offset = FIRST_ELEMENT_OFFSET_ + 1 + sizeof(std::uint64_t);
+
+        require_load_throws_(with_modified_payload_(save_to_string_(circuit), [&](auto& payload) {
+            write_u64_(payload, control_offset, 1);
+        }));
+    }
+
+    SECTION("control flow nested far too deeply")
+    {
+        // a chain of repeat statements, each holding the next, that would overflow the stack if the
+        // loader followed all of it
+        constexpr auto n_levels = std::size_t {100'000};
+
+        require_load_throws_(with_modified_payload_(save_to_string_(ket::QuantumCircuit {1}), [&](auto& payload) {
+            payload.clear();
+            for (std::size_t i {0}; i < n_levels; ++i) {
+                append_u64_(payload, 1);  // qubits
+                append_u64_(payload, 1);  // bits
+                append_u64_(payload, 0);  // parameters
+                append_u64_(payload, 0);  // parameter count
+                append_u64_(payload, 1);  // elements
+                payload.push_back(std::byte {3});  // `ElementTag_::REPEAT_STATEMENT`
+                append_u64_(payload, 1);  // repetitions
+            }
+        }));
+    }
+}
+
+TEST_CASE("read_tangelo_circuit_cached()")
+{
+    const auto directory = TemporaryFilepath_ {"kettle_read_tangelo_circuit_cached_test"};
+    const auto circuit_filepath = directory.path() / "circuit.dat";
+    const auto cache_directory = directory.path() / "cache";
+    std::filesystem::create_directories(directory.path());
+
+    auto circuit = ket::QuantumCircuit {3};
+    circuit.add_h_gate(0);
+    circuit.add_cx_gate(0, 2);
+    circuit.add_rz_gate(1, 0.125);
+    ket::write_tangelo_circuit(circuit, circuit_filepath);
+
+    const auto n_cache_files = [&]() {
+        if (!std::filesystem::exists(cache_directory)) {
+            return std::ptrdiff_t {0};
+        }
+        return std::distance(std::filesystem::directory_iterator {cache_directory}, std::filesystem::directory_iterator {});
+    };
+
+    SECTION("the first read fills the cache, and later reads load from it")
+    {
+        const auto first = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+        REQUIRE(ket::almost_eq(first, circuit));
+        REQUIRE(n_cache_files() == 1);
+
+        const auto second = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+        REQUIRE(ket::almost_eq(second, circuit));
+        REQUIRE(n_cache_files() == 1);
+    }
+
+    SECTION("a cache hit does not parse the file")
+    {
+        std::ignore = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+
+        // replace the cached circuit, to tell a circuit loaded from the cache apart from a parsed one
+        auto other = ket::QuantumCircuit {3};
+        other.add_y_gate(1);
+
+        const auto cache_filepath = std::filesystem::directory_iterator {cache_directory}->path();
+        ket::save_circuit_binary(cache_filepath, other);
+
+        const auto cached = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+        REQUIRE(ket::almost_eq(cached, other));
+    }
+
+    SECTION("an edited file is parsed again")
+    {
+        std::ignore = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+
+        circuit.add_x_gate(2);
+        ket::write_tangelo_circuit(circuit, circuit_filepath);
+
+        const auto edited = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+        REQUIRE(ket::almost_eq(edited, circuit));
+        REQUIRE(n_cache_files() == 2);
+    }
+
+    SECTION("a corrupted cache file is ignored")
+    {
+        std::ignore = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+
+        const auto cache_filepath = std::filesystem::directory_iterator {cache_directory}->path();
+        {
+            auto cache_file = std::ofstream {cache_filepath, std::ios::binary | std::ios::trunc};
+            cache_file << "not a circuit";
+        }
+
+        const auto reread = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+        REQUIRE(ket::almost_eq(reread, circuit));
+    }
+}
+
+TEST_CASE("binary compact circuit round trip")
+{
+    using PT = ket::PauliTerm;
+
+    const auto original = []() {
+        auto circuit = ket::QuantumCircuit {4, 2};
+        circuit.add_h_gate({0, 1, 2, 3});
+        circuit.add_cx_gate(0, 3);
+        circuit.add_rx_gate(1, 0.25);
+        circuit.add_ry_gate(2, 0.5, ket::param::parameterized {});
+        circuit.add_crz_gate(3, 1, -0.75, ket::param::parameterized {});
+        circuit.add_u_gate(ket::sx_gate(), 2);
+        circuit.add_cu_gate(ket::h_gate(), 1, 0);
+        circuit.add_u_gate(ket::sx_gate(), 3);
+        circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::I, PT::Y, PT::Z}}, 0.8);
+        circuit.add_m_gate(0, 0);
+        circuit.add_m_gate(1, 1);
+
+        return ket::CompactCircuit {circuit};
+    }();
+
+    const auto require_same = [&](const ket::CompactCircuit& loaded) {
+        REQUIRE(loaded.n_gates() == original.n_gates());
+        REQUIRE(loaded.unitaries().size() == original.unitaries().size());
+        require_same_circuits_(original.to_circuit(), loaded.to_circuit());
+    };
+
+    SECTION("through a stream")
+    {
+        auto stream = std::stringstream {};
+        ket::save_compact_circuit_binary(stream, original);
+
+        require_same(ket::load_compact_circuit_binary(stream));
+    }
+
+    SECTION("through a file")
+    {
+        const auto filepath = TemporaryFilepath_ {"kettle_binary_compact_circuit_test.ketcmpct"};
+        ket::save_compact_circuit_binary(filepath.path(), original);
+
+        require_same(ket::load_compact_circuit_binary(filepath.path()));
+    }
+
+    SECTION("a loaded circuit still stores each matrix once")
+    {
+        auto stream = std::stringstream {};
+        ket::save_compact_circuit_binary(stream, original);
+
+        auto loaded = ket::load_compact_circuit_binary(stream);
+        loaded.push_back(original.gate_info(8));
+        REQUIRE(loaded.unitaries().size() == original.unitaries().size());
+    }
+}
+
+TEST_CASE("load_compact_circuit_binary() throws for invalid records with a valid checksum")
+{
+    // the circuit starts with its number of qubits and bits, its number of parameters, its parameter
+    // count, and its number of gates; for a circuit without parameters, its first record starts right after
+    constexpr auto first_record_offset = std::size_t {40};
+    constexpr auto record_arg0_offset = std::size_t {4};
+    constexpr auto record_payload_offset = std::size_t {12};
+
+    auto circuit = ket::QuantumCircuit {2};
+    circuit.add_u_gate(ket::sx_gate(), 1);
+
+    auto stream = std::stringstream {};
+    ket::save_compact_circuit_binary(stream, ket::CompactCircuit {circuit});
+    const auto contents = stream.str();
+
+    const auto require_compact_load_throws = [](const std::string& modified) {
+        auto modified_stream = std::stringstream {modified};
+        REQUIRE_THROWS_AS(ket::load_compact_circuit_binary(modified_stream), std::runtime_error);
+    };
+
+    SECTION("unmodified payload loads")
+    {
+        auto unmodified_stream = std::stringstream {with_modified_payload_(contents, [](auto&) {})};
+        REQUIRE(ket::almost_eq(ket::load_compact_circuit_binary(unmodified_stream).to_circuit(), circuit));
+    }
+
+    SECTION("gate on a qubit outside of the circuit")
+    {
+        require_compact_load_throws(with_modified_payload_(contents, [&](auto& payload) {
+            payload[first_record_offset + record_arg0_offset] = std::byte {2};
+        }));
+    }
+
+    SECTION("matrix outside of the pool")
+    {
+        require_compact_load_throws(with_modified_payload_(contents, [&](auto& payload) {
+            payload[first_record_offset + record_payload_offset] = std::byte {1};
+        }));
+    }
+
+    SECTION("unknown gate")
+    {
+        require_compact_load_throws(with_modified_payload_(contents, [&](auto& payload) {
+            payload[first_record_offset] = std::byte {0xff};
+        }));
+    }
+
+    SECTION("a binary circuit file is not a compact circuit file")
+    {
+        require_compact_load_throws(save_to_string_(circuit));
+    }
+}
+
+TEST_CASE("read_tangelo_compact_circuit_cached()")
+{
+    const auto directory = TemporaryFilepath_ {"kettle_read_tangelo_compact_circuit_cached_test"};
+    const auto circuit_filepath = directory.path() / "circuit.dat";
+    const auto cache_directory = directory.path() / "cache";
+    std::filesystem::create_directories(directory.path());
+
+    auto circuit = ket::QuantumCircuit {3};
+    circuit.add_h_gate(0);
+    circuit.add_cx_gate(0, 2);
+    circuit.add_rz_gate(1, 0.125);
+    ket::write_tangelo_circuit(circuit, circuit_filepath);
+
+    const auto n_cache_files = [&]() {
+        return std::distance(std::filesystem::directory_iterator {cache_directory}, std::filesystem::directory_iterator {});
+    };
+
+    const auto first = ket::read_tangelo_compact_circuit_cached(3, circuit_filepath, 0, cache_directory);
+    REQUIRE(ket::almost_eq(first.to_circuit(), circuit));
+    REQUIRE(n_cache_files() == 1);
+
+    const auto second = ket::read_tangelo_compact_circuit_cached(3, circuit_filepath, 0, cache_directory);
+    REQUIRE(ket::almost_eq(second.to_circuit(), circuit));
+    REQUIRE(n_cache_files() == 1);
+
+    // the compact circuits and the circuits of `read_tangelo_circuit_cached()` are cached separately
+    std::ignore = ket::read_tangelo_circuit_cached(3, circuit_filepath, 0, cache_directory);
+    REQUIRE(n_cache_files() == 2);
+}
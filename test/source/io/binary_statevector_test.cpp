@@ -0,0 +1,147 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <kettle/io/binary_statevector.hpp>
+#include <kettle/state/random.hpp>
+#include <kettle/state/state.hpp>
+
+
+namespace
+{
+
+/*
+    A path in the temporary directory that is removed when the instance goes out of scope.
+*/
+class TemporaryFilepath_
+{
+public:
+    explicit TemporaryFilepath_(const std::string& filename)
+        : filepath_ {std::filesystem::temp_directory_path() / filename}
+    {}
+
+    TemporaryFilepath_(const TemporaryFilepath_&) = delete;
+    auto operator=(const TemporaryFilepath_&) -> TemporaryFilepath_& = delete;
+    TemporaryFilepath_(TemporaryFilepath_&&) = delete;
+    auto operator=(TemporaryFilepath_&&) -> TemporaryFilepath_& = delete;
+
+    ~TemporaryFilepath_()
+    {
+        std::filesystem::remove(filepath_);
+    }
+
+    [[nodiscard]]
+    auto path() const -> const std::filesystem::path&
+    {
+        return filepath_;
+    }
+
+private:
+    std::filesystem::path filepath_;
+};
+
+}  // namespace
+
+
+TEST_CASE("binary statevector")
+{
+    const auto state = ket::generate_random_state(5, 42);
+
+    SECTION("round trip through a stream")
+    {
+        auto stream = std::stringstream {};
+        ket::save_statevector_binary(stream, state);
+
+        REQUIRE(stream.str().size() == 32 + 32 * 16);
+
+        const auto loaded = ket::load_statevector_binary(stream);
+        REQUIRE(ket::almost_eq(state, loaded, 1.0e-24));
+    }
+
+    SECTION("round trip through a file")
+    {
+        const auto file = TemporaryFilepath_ {"kettle_binary_statevector_test.bin"};
+        ket::save_statevector_binary(file.path(), state);
+
+        REQUIRE(std::filesystem::file_size(file.path()) == 32 + 32 * 16);
+
+        const auto loaded = ket::load_statevector_binary(file.path());
+        REQUIRE(ket::almost_eq(state, loaded, 1.0e-24));
+    }
+
+    SECTION("single precision")
+    {
+        const auto file = TemporaryFilepath_ {"kettle_binary_statevector_test_single.bin"};
+        ket::save_statevector_binary(file.path(), state, ket::StatevectorPrecision::SINGLE);
+
+        REQUIRE(std::filesystem::file_size(file.path()) == 32 + 32 * 8);
+
+        const auto loaded = ket::load_statevector_binary(file.path());
+        REQUIRE(ket::almost_eq(state, loaded, 1.0e-12));
+    }
+
+    SECTION("throws for a corrupted file")
+    {
+        auto stream = std::stringstream {};
+        ket::save_statevector_binary(stream, state);
+
+        auto contents = stream.str();
+        contents[100] = static_cast<char>(contents[100] ^ 1);  // NOLINT(hicpp-signed-bitwise)
+
+        auto corrupted = std::stringstream {contents};
+        REQUIRE_THROWS_AS(ket::load_statevector_binary(corrupted), std::runtime_error);
+    }
+
+    SECTION("throws for a file that is not a binary statevector")
+    {
+        auto text = std::stringstream {"ENDIANNESS: LITTLE\nNUMBER OF STATES: 2\n 1.0   0.0\n 0.0   0.0\n"};
+        REQUIRE_THROWS_AS(ket::load_statevector_binary(text), std::runtime_error);
+    }
+
+    SECTION("throws for a truncated file")
+    {
+        const auto file = TemporaryFilepath_ {"kettle_binary_statevector_test_truncated.bin"};
+        ket::save_statevector_binary(file.path(), state);
+        std::filesystem::resize_file(file.path(), 100);
+
+        REQUIRE_THROWS_AS(ket::load_statevector_binary(file.path()), std::runtime_error);
+    }
+
+    SECTION("throws for a header with too many qubits for the payload size to fit in a std::size_t")
+    {
+        auto stream = std::stringstream {};
+        ket::save_statevector_binary(stream, state);
+
+        // the number of qubits is bytes [16, 20) of the header
+        const auto n_qubits = static_cast<std::uint32_t>(GENERATE(60, 61, 63));
+
+        auto contents = stream.str();
+        std::memcpy(contents.data() + 16, &n_qubits, sizeof(n_qubits));
+
+        auto corrupted = std::stringstream {contents};
+        REQUIRE_THROWS_AS(ket::load_statevector_binary(corrupted), std::runtime_error);
+    }
+
+    SECTION("a stream that is much shorter than its header claims throws instead of allocating the claimed size")
+    {
+        auto stream = std::stringstream {};
+        ket::save_statevector_binary(stream, state);
+
+        // 16 TiB of amplitudes, which cannot be allocated
+        const auto n_qubits = std::uint32_t {40};
+
+        auto contents = stream.str();
+        std::memcpy(contents.data() + 16, &n_qubits, sizeof(n_qubits));
+
+        auto corrupted = std::stringstream {contents};
+        REQUIRE_THROWS_AS(ket::load_statevector_binary(corrupted), std::runtime_error);
+    }
+}
@@ -1,10 +1,14 @@
 #include <cstddef>
+#include <filesystem>
 #include <numeric>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <kettle/state/random.hpp>
 #include <kettle/state/state.hpp>
 #include <kettle/io/numpy_statevector.hpp>
 
@@ -47,3 +51,102 @@ TEST_CASE("read_numpy_statevector()")
 
     REQUIRE(ket::almost_eq(actual, expected));
 }
+
+TEST_CASE("write_npy_statevector()")
+{
+    const auto state = ket::generate_random_state(3, 42);
+
+    auto stream = std::stringstream {};
+    ket::write_npy_statevector(stream, state);
+    const auto contents = stream.str();
+
+    SECTION("the header matches the one written by numpy.save()")
+    {
+        const auto preamble = std::string {"\x93NUMPY\x01\x00\x76\x00", 10};
+        const auto dictionary = std::string {"{'descr': '<c16', 'fortran_order': False, 'shape': (8,), }"};
+
+        REQUIRE(contents.size() == 128 + 8 * 16);
+        REQUIRE(contents.substr(0, 10) == preamble);
+        REQUIRE(contents.substr(10, dictionary.size()) == dictionary);
+        REQUIRE(contents[127] == '\n');
+    }
+
+    SECTION("round trip")
+    {
+        const auto loaded = ket::read_npy_statevector(stream);
+        REQUIRE(ket::almost_eq(state, loaded, 1.0e-24));
+    }
+
+    SECTION("round trip through a file, with single precision and big endian")
+    {
+        const auto filepath = std::filesystem::temp_directory_path() / "kettle_write_npy_statevector_test.npy";
+        ket::write_npy_statevector(filepath, state, ket::StatevectorPrecision::SINGLE, ket::QuantumStateEndian::BIG);
+
+        const auto loaded = ket::read_npy_statevector(filepath, ket::QuantumStateEndian::BIG);
+        std::filesystem::remove(filepath);
+
+        REQUIRE(ket::almost_eq(state, loaded, 1.0e-12));
+    }
+}
+
+TEST_CASE("read_npy_statevector()")
+{
+    // a version 2.0 file holding a (2, 2) array of complex64 elements, in C order
+    const auto dictionary = std::string {"{'descr': '<c8', 'fortran_order': False, 'shape': (2, 2), }         \n"};
+
+    auto contents = std::string {"\x93NUMPY\x02\x00", 8};
+    contents += static_cast<char>(dictionary.size());
+    contents += std::string (3, '\0');
+    contents += dictionary;
+
+    const auto values = std::vector<float> {0.5F, 0.0F, 0.0F, 0.5F, -0.5F, 0.0F, 0.0F, -0.5F};
+    contents += std::string {reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float)};  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    SECTION("reads the amplitudes")
+    {
+        auto stream = std::stringstream {contents};
+        const auto actual = ket::read_npy_statevector(stream);
+
+        const auto expected = ket::QuantumState {{{0.5, 0.0}, {0.0, 0.5}, {-0.5, 0.0}, {0.0, -0.5}}};
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+
+    SECTION("throws for unsupported element types")
+    {
+        auto modified = contents;
+        modified.replace(modified.find("<c8"), 3, "<f8");
+
+        auto stream = std::stringstream {modified};
+        REQUIRE_THROWS_AS(ket::read_npy_statevector(stream), std::runtime_error);
+    }
+
+    SECTION("throws for a truncated file")
+    {
+        auto stream = std::stringstream {contents.substr(0, contents.size() - 4)};
+        REQUIRE_THROWS_AS(ket::read_npy_statevector(stream), std::runtime_error);
+    }
+
+    SECTION("throws for a number of elements that is not a power of 2")
+    {
+        auto modified = contents;
+        modified.replace(modified.find("(2, 2)"), 6, "(2, 3)");
+
+        auto stream = std::stringstream {modified};
+        REQUIRE_THROWS_AS(ket::read_npy_statevector(stream), std::runtime_error);
+    }
+
+    SECTION("throws for a shape whose size in bytes would overflow")
+    {
+        auto modified = contents;
+        modified.replace(modified.find("(2, 2)"), 6, "(4294967296, 4294967296)");
+
+        auto stream = std::stringstream {modified};
+        REQUIRE_THROWS_AS(ket::read_npy_statevector(stream), std::runtime_error);
+    }
+
+    SECTION("throws for a file that is not a `.npy` file")
+    {
+        auto stream = std::stringstream {"3\n (1.0+0.0j)\n"};
+        REQUIRE_THROWS_AS(ket::read_npy_statevector(stream), std::runtime_error);
+    }
+}
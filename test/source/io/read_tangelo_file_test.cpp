@@ -1,5 +1,10 @@
+#include <filesystem>
 #include <functional>
 #include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <utility>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
@@ -212,6 +217,33 @@ TEST_CASE("read_tangelo_file()")
     }
 }
 
+TEST_CASE("read_tangelo_file() with Pauli rotations collapsed")
+{
+    using PT = ket::PauliTerm;
+
+    auto stream = std::stringstream {
+        "H         target : [0]   \n"
+        "RX        target : [2]   parameter : 1.5707963267948966\n"
+        "CNOT      target : [2]   control : [0]   \n"
+        "CNOT      target : [3]   control : [2]   \n"
+        "RZ        target : [3]   parameter : 0.7853981633974483\n"
+        "CNOT      target : [3]   control : [2]   \n"
+        "CNOT      target : [2]   control : [0]   \n"
+        "H         target : [0]   \n"
+        "RX        target : [2]   parameter : -1.5707963267948966\n"
+        "X         target : [1]   \n"
+    };
+
+    const auto actual = ket::read_tangelo_circuit(4, stream, 0, std::nullopt, true);
+
+    auto expected = ket::QuantumCircuit {4};
+    expected.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::I, PT::Y, PT::Z}}, 0.7853981633974483);
+    expected.add_x_gate(1);
+
+    REQUIRE(number_of_elements(actual) == 2);
+    REQUIRE(ket::almost_eq(actual, expected));
+}
+
 TEST_CASE("read_tangelo_file() with control flow")
 {
     const auto x_and_x_subcircuit = []()
@@ -265,3 +297,147 @@ TEST_CASE("read_tangelo_file() with control flow")
 
     REQUIRE(ket::almost_eq(original, reconstructed));
 }
+
+TEST_CASE("read_tangelo_file() from a file")
+{
+    const auto original = []() {
+        auto body = ket::QuantumCircuit {4};
+        body.add_cu_gate(ket::Matrix2X2 {.elem00={0.0, 1.0}, .elem01={0.0, 0.0}, .elem10={0.0, 0.0}, .elem11={0.0, -1.0}}, 3, 1);
+        body.add_crx_gate(0, 2, -0.125);
+
+        auto circuit = ket::QuantumCircuit {4};
+        circuit.add_h_gate({0, 1, 2, 3});
+        circuit.add_u_gate(ket::Matrix2X2 {.elem00={0.0, 0.0}, .elem01={1.0, 0.0}, .elem10={1.0, 0.0}, .elem11={0.0, 0.0}}, 2);
+        circuit.add_rz_gate(1, 0.75);
+        circuit.add_repeat_statement(3, body);
+        circuit.add_cx_gate(3, 0);
+
+        return circuit;
+    }();
+
+    const auto filepath = std::filesystem::temp_directory_path() / "kettle_read_tangelo_file_test.dat";
+    ket::write_tangelo_circuit(original, filepath);
+
+    const auto reconstructed = ket::read_tangelo_circuit(4, filepath, 0);
+    std::filesystem::remove(filepath);
+
+    REQUIRE(ket::almost_eq(original, reconstructed));
+}
+
+TEST_CASE("read_tangelo_compact_circuit()")
+{
+    const auto filepath = std::filesystem::temp_directory_path() / "kettle_read_tangelo_compact_circuit_test.dat";
+
+    SECTION("reads the same gates as read_tangelo_circuit()")
+    {
+        const auto original = []() {
+            auto circuit = ket::QuantumCircuit {4};
+            circuit.add_h_gate({0, 1, 2, 3});
+            circuit.add_u_gate(ket::Matrix2X2 {.elem00={0.0, 0.0}, .elem01={1.0, 0.0}, .elem10={1.0, 0.0}, .elem11={0.0, 0.0}}, 2);
+            circuit.add_rz_gate(1, 0.75);
+            circuit.add_cx_gate(3, 0);
+            circuit.add_rx_gate(2, -1.25);
+            circuit.add_cu_gate(ket::Matrix2X2 {.elem00={0.0, 1.0}, .elem01={0.0, 0.0}, .elem10={0.0, 0.0}, .elem11={0.0, -1.0}}, 3, 1);
+            circuit.add_crx_gate(0, 2, -0.125);
+            circuit.add_swap_gate(1, 3);
+            circuit.add_m_gate(2);
+
+            return circuit;
+        }();
+
+        ket::write_tangelo_circuit(original, filepath);
+        const auto expected = ket::read_tangelo_circuit(4, filepath, 0);
+        const auto actual = ket::read_tangelo_compact_circuit(4, filepath, 0);
+        std::filesystem::remove(filepath);
+
+        REQUIRE(actual.n_gates() == expected.n_circuit_elements());
+        REQUIRE(ket::almost_eq(actual.to_circuit(), expected));
+    }
+
+    SECTION("throws for control flow statements")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_h_gate(0);
+        circuit.add_repeat_statement(2, circuit);
+
+        ket::write_tangelo_circuit(circuit, filepath);
+        REQUIRE_THROWS_AS(ket::read_tangelo_compact_circuit(2, filepath, 0), std::runtime_error);
+        std::filesystem::remove(filepath);
+    }
+}
+
+TEST_CASE("read_tangelo_file() stops at a line with less indentation")
+{
+    auto stream = std::stringstream {
+        "    H         target : [0]\n"
+        "    CNOT      target : [1]   control : [0]\n"
+        "X         target : [1]\n"
+    };
+
+    const auto indented = ket::read_tangelo_circuit(2, stream, 0, 4);
+    REQUIRE(number_of_elements(indented) == 2);
+
+    const auto rest = ket::read_tangelo_circuit(2, stream, 0);
+    REQUIRE(number_of_elements(rest) == 1);
+    REQUIRE(comp::is_1t_gate_equal(rest[0].get_gate(), cre::create_one_target_gate(G::X, 1)));
+}
+
+/*
+    A stream buffer that cannot be repositioned, like the buffer of a pipe.
+*/
+class UnseekableBuffer : public std::streambuf
+{
+public:
+    explicit UnseekableBuffer(std::string contents)
+        : contents_ {std::move(contents)}
+    {
+        setg(contents_.data(), contents_.data(), contents_.data() + contents_.size());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+protected:
+    auto seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) -> pos_type override
+    {
+        return pos_type(off_type(-1));
+    }
+
+    auto seekpos(pos_type, std::ios_base::openmode) -> pos_type override
+    {
+        return pos_type(off_type(-1));
+    }
+
+private:
+    std::string contents_;
+};
+
+TEST_CASE("read_tangelo_file() stops at a line with less indentation in a stream that cannot be repositioned")
+{
+    auto buffer = UnseekableBuffer {
+        "    H         target : [0]\n"
+        "    CNOT      target : [1]   control : [0]\n"
+        "  X         target : [1]\n"
+        "Z         target : [0]\n"
+    };
+    auto stream = std::istream {&buffer};
+
+    const auto indented = ket::read_tangelo_circuit(2, stream, 0, 4);
+    REQUIRE(number_of_elements(indented) == 2);
+
+    const auto rest = ket::read_tangelo_circuit(2, stream, 0);
+    REQUIRE(number_of_elements(rest) == 2);
+    REQUIRE(comp::is_1t_gate_equal(rest[0].get_gate(), cre::create_one_target_gate(G::X, 1)));
+    REQUIRE(comp::is_1t_gate_equal(rest[1].get_gate(), cre::create_one_target_gate(G::Z, 0)));
+}
+
+TEST_CASE("read_tangelo_file() throws for malformed lines")
+{
+    const auto line = GENERATE(
+        std::string {"H         target : 4\n"},
+        std::string {"CNOT      target : [1]\n"},
+        std::string {"RZ        target : [1]   parameter : angle\n"},
+        std::string {"U         target : [1]\n"},
+        std::string {"NOTAGATE  target : [1]\n"}
+    );
+
+    auto stream = std::stringstream {line};
+    REQUIRE_THROWS_AS(ket::read_tangelo_circuit(2, stream, 0), std::runtime_error);
+}
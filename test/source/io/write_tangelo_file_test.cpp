@@ -1,9 +1,13 @@
 #include <sstream>
+#include <string>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit_operations/compare_circuits.hpp"
 #include "kettle/gates/primitive_gate.hpp"
+#include "kettle/io/read_tangelo_file.hpp"
 #include "kettle/io/write_tangelo_file.hpp"
 #include "kettle_internal/gates/primitive_gate/gate_create.hpp"
 #include "kettle_internal/io/write_tangelo_file_internal.hpp"
@@ -177,3 +181,70 @@ TEST_CASE("write_tangelo_file() ignores circuit loggers")
 
     REQUIRE(without_stream.str() == with_stream.str());
 }
+
+TEST_CASE("write_tangelo_file() and read_tangelo_file() round trip with repeat statements")
+{
+    auto inner = ket::QuantumCircuit {2};
+    inner.add_h_gate(0);
+    inner.add_m_gate(0);
+    inner.add_if_statement(0, [] {
+        auto subcircuit = ket::QuantumCircuit {2};
+        subcircuit.add_x_gate(1);
+        return subcircuit;
+    }());
+
+    auto body = ket::QuantumCircuit {2};
+    body.add_cx_gate(1, 0);
+    body.add_repeat_statement(3, inner);
+
+    auto circuit = ket::QuantumCircuit {2};
+    circuit.add_x_gate(0);
+    circuit.add_repeat_statement(4, body);
+    circuit.add_rz_gate(1, 0.25);
+
+    auto stream = std::stringstream {};
+    ket::write_tangelo_circuit(circuit, stream);
+
+    const auto expected_text = std::string {
+        "X         target : [0]\n"
+        "REPEAT 4\n"
+        "    CX        target : [0]   control : [1]\n"
+        "    REPEAT 3\n"
+        "        H         target : [0]\n"
+        "        M         target : [0]   bit : [0]\n"
+        "        IF BITS[0] == [1]\n"
+        "            X         target : [1]\n"
+        "RZ        target : [1]   parameter : 0.2500000000000000\n"
+    };
+    REQUIRE(stream.str() == expected_text);
+
+    const auto read_circuit = ket::read_tangelo_circuit(2, stream, 0);
+    REQUIRE(ket::almost_eq(read_circuit, circuit));
+}
+
+TEST_CASE("write_tangelo_file() and read_tangelo_file() round trip with controlled blocks")
+{
+    auto inner = ket::QuantumCircuit {3};
+    inner.add_x_gate(1);
+
+    auto body = ket::QuantumCircuit {3};
+    body.add_h_gate(1);
+    body.add_repeat_statement(2, inner);
+
+    auto circuit = ket::QuantumCircuit {3};
+    circuit.add_controlled_block({0, 2}, body);
+
+    auto stream = std::stringstream {};
+    ket::write_tangelo_circuit(circuit, stream);
+
+    const auto expected_text = std::string {
+        "CONTROLLED [0, 2]\n"
+        "    H         target : [1]\n"
+        "    REPEAT 2\n"
+        "        X         target : [1]\n"
+    };
+    REQUIRE(stream.str() == expected_text);
+
+    const auto read_circuit = ket::read_tangelo_circuit(3, stream, 0);
+    REQUIRE(ket::almost_eq(read_circuit, circuit));
+}
@@ -0,0 +1,97 @@
+#include <complex>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "kettle/common/mathtools.hpp"
+#include "kettle/operator/pauli/grouped_pauli_operator.hpp"
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+
+using PT = ket::PauliTerm;
+using PP = ket::PauliPhase;
+
+
+TEST_CASE("GroupedPauliOperator groups terms by X-mask")
+{
+    // the terms that flip qubit 0 are {X, I}, {Y, Z}, and {X, Z}; the terms that flip no qubits are {Z, I} and {Z, Z}
+    const auto pauli_op = ket::PauliOperator {
+        {.coefficient={1.0, 0.0}, .pauli_string={PT::X, PT::I}},
+        {.coefficient={2.0, 0.0}, .pauli_string={PT::Z, PT::I}},
+        {.coefficient={3.0, 0.0}, .pauli_string={PT::Y, PT::Z}},
+        {.coefficient={4.0, 0.0}, .pauli_string={PT::Z, PT::Z}},
+        {.coefficient={5.0, 0.0}, .pauli_string={PT::X, PT::Z}},
+        {.coefficient={6.0, 0.0}, .pauli_string={PT::I, PT::Y}},
+    };
+
+    const auto grouped_op = ket::GroupedPauliOperator {pauli_op};
+
+    REQUIRE(grouped_op.n_qubits() == 2);
+    REQUIRE(grouped_op.n_terms() == 6);
+    REQUIRE(grouped_op.n_groups() == 3);
+
+    const auto& groups = grouped_op.groups();
+    REQUIRE(groups[0].x_mask == 0b01);
+    REQUIRE(groups[0].z_masks == std::vector<std::size_t> {0b00, 0b11, 0b10});
+    REQUIRE(groups[1].x_mask == 0b00);
+    REQUIRE(groups[1].z_masks == std::vector<std::size_t> {0b01, 0b11});
+    REQUIRE(groups[2].x_mask == 0b10);
+    REQUIRE(groups[2].z_masks == std::vector<std::size_t> {0b10});
+
+    // the Y terms pick up a factor of i
+    REQUIRE(ket::almost_eq(groups[0].weights[1], {0.0, 3.0}));
+    REQUIRE(ket::almost_eq(groups[2].weights[0], {0.0, 6.0}));
+}
+
+TEST_CASE("expectation value of GroupedPauliOperator")
+{
+    const auto n_qubits = GENERATE(std::size_t {1}, std::size_t {2}, std::size_t {5});
+
+    auto prng = std::mt19937 {std::mt19937::default_seed};
+    auto term_distrib = std::uniform_int_distribution<int> {0, 3};
+    auto coeff_distrib = std::uniform_real_distribution<double> {-1.0, 1.0};
+
+    // with few qubits and many terms, most of the groups contain several terms
+    auto pauli_op = ket::PauliOperator {n_qubits};
+    for (std::size_t i_term {0}; i_term < 40; ++i_term) {
+        auto terms = std::vector<PT> {};
+        for (std::size_t i_qubit {0}; i_qubit < n_qubits; ++i_qubit) {
+            terms.push_back(static_cast<PT>(term_distrib(prng)));
+        }
+
+        const auto phase = static_cast<PP>(term_distrib(prng));
+        const auto coeff = std::complex<double> {coeff_distrib(prng), coeff_distrib(prng)};
+        pauli_op.add(coeff, ket::SparsePauliString {terms, phase});
+    }
+
+    const auto grouped_op = ket::GroupedPauliOperator {pauli_op};
+    REQUIRE(grouped_op.n_groups() <= (1UL << n_qubits));
+
+    for (std::size_t i_trial {0}; i_trial < 5; ++i_trial) {
+        const auto state = ket::generate_random_state(n_qubits, prng);
+
+        const auto actual = ket::expectation_value(grouped_op, state);
+        const auto expected = ket::expectation_value(pauli_op, state);
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+}
+
+TEST_CASE("expectation value of GroupedPauliOperator throws for mismatched number of qubits")
+{
+    const auto pauli_op = ket::PauliOperator {
+        {.coefficient={1.0, 0.0}, .pauli_string={PT::X, PT::I}},
+    };
+
+    const auto grouped_op = ket::GroupedPauliOperator {pauli_op};
+    const auto state = ket::QuantumState {"000"};
+
+    REQUIRE_THROWS_AS(ket::expectation_value(grouped_op, state), std::runtime_error);
+}
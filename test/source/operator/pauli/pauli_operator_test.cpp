@@ -1,5 +1,8 @@
 #include <cmath>
 #include <complex>
+#include <cstddef>
+#include <random>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
@@ -9,8 +12,12 @@
 #include "kettle/operator/pauli/sparse_pauli_string.hpp"
 #include "kettle/operator/pauli/pauli_operator.hpp"
 #include "kettle/simulation/simulate.hpp"
+#include "kettle/simulation/simulate_pauli.hpp"
+#include "kettle/state/random.hpp"
 #include "kettle/state/state.hpp"
 
+#include "kettle_internal/operator/pauli/pauli_operator_internal.hpp"
+
 
 using PT = ket::PauliTerm;
 
@@ -100,6 +107,43 @@ TEST_CASE("expectation value of SparsePauliString, 2-qubit")
     REQUIRE(ket::almost_eq(expval, testcase.expected));
 }
 
+TEST_CASE("expectation value of SparsePauliString, random strings and states")
+{
+    // the reference calculation explicitly applies the Pauli string to a copy of the state
+    const auto reference_expectation_value = [](const ket::SparsePauliString& pauli_string, const ket::QuantumState& state) {
+        auto ket = state;
+        ket::simulate(pauli_string, ket);
+
+        return ket::PAULI_PHASE_MAP.at(pauli_string.phase()) * ket::inner_product(state, ket);
+    };
+
+    const auto n_qubits = GENERATE(std::size_t {1}, std::size_t {3}, std::size_t {6});
+    const auto phase = GENERATE(
+        ket::PauliPhase::PLUS_ONE,
+        ket::PauliPhase::PLUS_EYE,
+        ket::PauliPhase::MINUS_ONE,
+        ket::PauliPhase::MINUS_EYE
+    );
+
+    auto prng = std::mt19937 {std::mt19937::default_seed};
+    auto term_distrib = std::uniform_int_distribution<int> {0, 3};
+
+    for (std::size_t i_trial {0}; i_trial < 20; ++i_trial) {
+        auto terms = std::vector<PT> {};
+        for (std::size_t i_qubit {0}; i_qubit < n_qubits; ++i_qubit) {
+            terms.push_back(static_cast<PT>(term_distrib(prng)));
+        }
+
+        const auto pauli_string = ket::SparsePauliString {terms, phase};
+        const auto state = ket::generate_random_state(n_qubits, prng);
+
+        const auto actual = ket::expectation_value(pauli_string, state);
+        const auto expected = reference_expectation_value(pauli_string, state);
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+}
+
 TEST_CASE("expectation value of PauliOperator")
 {
     SECTION("<0|(Z + X)|0>")
@@ -200,6 +244,130 @@ TEST_CASE("expectation value of PauliOperator")
     }
 }
 
+TEST_CASE("expectation value of PauliOperator does not depend on the number of threads")
+{
+    namespace ki = ket::internal;
+
+    // 17 qubits gives 8 chunks of amplitudes
+    const auto n_qubits = std::size_t {17};
+    auto prng = std::mt19937 {std::mt19937::default_seed};
+    auto term_distrib = std::uniform_int_distribution<int> {0, 3};
+
+    const auto state = ket::generate_random_state(n_qubits, prng);
+
+    // fewer terms than threads splits up the chunks, and more terms than threads splits up the terms
+    const auto n_terms = GENERATE(std::size_t {1}, std::size_t {3}, std::size_t {20});
+
+    auto term_masks = std::vector<ki::PauliStringMasks> {};
+    for (std::size_t i_term {0}; i_term < n_terms; ++i_term) {
+        auto terms = std::vector<PT> {};
+        for (std::size_t i_qubit {0}; i_qubit < n_qubits; ++i_qubit) {
+            terms.push_back(static_cast<PT>(term_distrib(prng)));
+        }
+
+        term_masks.push_back(ki::pauli_string_masks_(ket::SparsePauliString {terms}));
+    }
+
+    const auto chunk_value = [&](std::size_t i_term, const ki::FlatIndexPair& chunk) {
+        return ki::masked_expectation_sum_(state, term_masks[i_term].x_mask, term_masks[i_term].z_mask, chunk);
+    };
+
+    const auto expected = ki::chunked_item_sums_(n_terms, state.n_states(), 1, chunk_value);
+
+    for (const auto n_threads : {std::size_t {2}, std::size_t {3}, std::size_t {7}}) {
+        const auto actual = ki::chunked_item_sums_(n_terms, state.n_states(), n_threads, chunk_value);
+
+        // the results must be identical, not just close
+        REQUIRE(actual == expected);
+    }
+
+    // the chunked sums must also match a single pass over all the amplitudes
+    for (std::size_t i_term {0}; i_term < n_terms; ++i_term) {
+        const auto block = ki::FlatIndexPair {.i_lower=0, .i_upper=state.n_states()};
+        REQUIRE(ket::almost_eq(expected[i_term], chunk_value(i_term, block)));
+    }
+}
+
+TEST_CASE("PauliOperator.simplify()")
+{
+    using PP = ket::PauliPhase;
+
+    SECTION("merges duplicates and prunes small terms")
+    {
+        auto pauli_op = ket::PauliOperator {
+            {.coefficient={1.0, 0.0}, .pauli_string={PT::Z, PT::I}},
+            {.coefficient={2.0, 0.0}, .pauli_string={PT::X, PT::X}},
+            {.coefficient={0.5, 0.0}, .pauli_string={PT::Z, PT::I}},
+            {.coefficient={1.0e-14, 0.0}, .pauli_string={PT::Y, PT::I}},
+            {.coefficient={3.0, 0.0}, .pauli_string={PT::X, PT::X}},
+            {.coefficient={4.0, 0.0}, .pauli_string={PT::X, PT::X}},
+        };
+
+        const auto n_removed = pauli_op.simplify();
+
+        // sorted by X-mask; {Z, I} has an X-mask of 0b00, and {X, X} has an X-mask of 0b11
+        const auto expected = ket::PauliOperator {
+            {.coefficient={1.5, 0.0}, .pauli_string={PT::Z, PT::I}},
+            {.coefficient={9.0, 0.0}, .pauli_string={PT::X, PT::X}},
+        };
+
+        REQUIRE(n_removed == 4);
+        REQUIRE(ket::almost_eq(pauli_op, expected));
+    }
+
+    SECTION("folds the phases into the coefficients")
+    {
+        auto pauli_op = ket::PauliOperator {
+            {.coefficient={1.0, 0.0}, .pauli_string={{PT::Y}, PP::PLUS_EYE}},
+            {.coefficient={1.0, 0.0}, .pauli_string={{PT::Y}, PP::MINUS_EYE}},
+            {.coefficient={2.0, 0.0}, .pauli_string={{PT::X}, PP::MINUS_ONE}},
+        };
+
+        const auto n_removed = pauli_op.simplify();
+
+        const auto expected = ket::PauliOperator {
+            {.coefficient={-2.0, 0.0}, .pauli_string={PT::X}},
+        };
+
+        REQUIRE(n_removed == 2);
+        REQUIRE(ket::almost_eq(pauli_op, expected));
+    }
+
+    SECTION("custom tolerance")
+    {
+        auto pauli_op = ket::PauliOperator {
+            {.coefficient={1.0, 0.0}, .pauli_string={PT::Z}},
+            {.coefficient={0.0, 0.01}, .pauli_string={PT::X}},
+        };
+
+        REQUIRE(pauli_op.simplify(0.1) == 1);
+        REQUIRE(pauli_op.size() == 1);
+    }
+
+    SECTION("does not change the expectation value")
+    {
+        auto prng = std::mt19937 {std::mt19937::default_seed};
+        auto term_distrib = std::uniform_int_distribution<int> {0, 3};
+
+        // with 2 qubits and 30 terms, there must be duplicates
+        auto pauli_op = ket::PauliOperator {2};
+        for (std::size_t i_term {0}; i_term < 30; ++i_term) {
+            const auto phase = static_cast<PP>(term_distrib(prng));
+            const auto terms = std::vector<PT> {static_cast<PT>(term_distrib(prng)), static_cast<PT>(term_distrib(prng))};
+            pauli_op.add({static_cast<double>(i_term), 1.0}, ket::SparsePauliString {terms, phase});
+        }
+
+        const auto original = pauli_op;
+        const auto n_removed = pauli_op.simplify();
+
+        REQUIRE(n_removed >= 14);
+        REQUIRE(pauli_op.size() + n_removed == original.size());
+
+        const auto state = ket::generate_random_state(2, prng);
+        REQUIRE(ket::almost_eq(ket::expectation_value(pauli_op, state), ket::expectation_value(original, state)));
+    }
+}
+
 TEST_CASE("PauliOperator comparison")
 {
     SECTION("equal")
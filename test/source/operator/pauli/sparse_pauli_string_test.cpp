@@ -1,4 +1,10 @@
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
 #include "kettle/operator/pauli/sparse_pauli_string.hpp"
 
@@ -270,3 +276,141 @@ TEST_CASE("SparsePauliString operator==")
         }
     }
 }
+
+
+TEST_CASE("SparsePauliString masks")
+{
+    SECTION("single word")
+    {
+        auto pauli_string = ket::SparsePauliString {{PT::X, PT::Y, PT::Z, PT::I}};
+
+        REQUIRE(pauli_string.x_mask() == std::vector<std::uint64_t> {0b0011});
+        REQUIRE(pauli_string.z_mask() == std::vector<std::uint64_t> {0b0110});
+
+        pauli_string.overwrite(1, PT::X);
+        REQUIRE(pauli_string.x_mask() == std::vector<std::uint64_t> {0b0011});
+        REQUIRE(pauli_string.z_mask() == std::vector<std::uint64_t> {0b0100});
+
+        pauli_string.remove(0);
+        pauli_string.overwrite(3, PT::Z);
+        REQUIRE(pauli_string.x_mask() == std::vector<std::uint64_t> {0b0010});
+        REQUIRE(pauli_string.z_mask() == std::vector<std::uint64_t> {0b1100});
+    }
+
+    SECTION("multiple words")
+    {
+        auto pauli_string = ket::SparsePauliString {130};
+        pauli_string.add(1, PT::X);
+        pauli_string.add(64, PT::Y);
+        pauli_string.add(129, PT::Z);
+
+        REQUIRE(pauli_string.x_mask() == std::vector<std::uint64_t> {0b10, 0b1, 0b0});
+        REQUIRE(pauli_string.z_mask() == std::vector<std::uint64_t> {0b00, 0b1, 0b10});
+    }
+
+    SECTION("throws for repeated or out of range qubits")
+    {
+        REQUIRE_THROWS_AS(ket::SparsePauliString({{0, PT::X}, {0, PT::Z}}, 2), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::SparsePauliString({{2, PT::X}}, 2), std::runtime_error);
+    }
+}
+
+
+TEST_CASE("SparsePauliString multiplication")
+{
+    using PP = ket::PauliPhase;
+
+    SECTION("single qubit products")
+    {
+        struct TestCase
+        {
+            PT left;
+            PT right;
+            PT expected_term;
+            PP expected_phase;
+        };
+
+        auto testcase = GENERATE(
+            TestCase {PT::I, PT::I, PT::I, PP::PLUS_ONE},
+            TestCase {PT::I, PT::X, PT::X, PP::PLUS_ONE},
+            TestCase {PT::Y, PT::I, PT::Y, PP::PLUS_ONE},
+            TestCase {PT::X, PT::X, PT::I, PP::PLUS_ONE},
+            TestCase {PT::Y, PT::Y, PT::I, PP::PLUS_ONE},
+            TestCase {PT::Z, PT::Z, PT::I, PP::PLUS_ONE},
+            TestCase {PT::X, PT::Y, PT::Z, PP::PLUS_EYE},
+            TestCase {PT::Y, PT::X, PT::Z, PP::MINUS_EYE},
+            TestCase {PT::Y, PT::Z, PT::X, PP::PLUS_EYE},
+            TestCase {PT::Z, PT::Y, PT::X, PP::MINUS_EYE},
+            TestCase {PT::Z, PT::X, PT::Y, PP::PLUS_EYE},
+            TestCase {PT::X, PT::Z, PT::Y, PP::MINUS_EYE}
+        );
+
+        const auto left = ket::SparsePauliString {{testcase.left}};
+        const auto right = ket::SparsePauliString {{testcase.right}};
+        const auto expected = ket::SparsePauliString {{testcase.expected_term}, testcase.expected_phase};
+
+        REQUIRE(left * right == expected);
+    }
+
+    SECTION("phases of the inputs are combined")
+    {
+        const auto left = ket::SparsePauliString {{PT::X, PT::Z}, PP::PLUS_EYE};
+        const auto right = ket::SparsePauliString {{PT::Y, PT::X}, PP::MINUS_ONE};
+
+        // (i XZ) * (-YX) = -i (XY)(ZX) = -i (iZ)(iY) = i ZY
+        const auto expected = ket::SparsePauliString {{PT::Z, PT::Y}, PP::PLUS_EYE};
+
+        REQUIRE(left * right == expected);
+    }
+
+    SECTION("multiple words")
+    {
+        auto left = ket::SparsePauliString {100};
+        left.add(3, PT::X);
+        left.add(70, PT::Z);
+
+        auto right = ket::SparsePauliString {100};
+        right.add(70, PT::X);
+        right.add(99, PT::Y);
+
+        auto expected = ket::SparsePauliString {100, PP::PLUS_EYE};
+        expected.add(3, PT::X);
+        expected.add(70, PT::Y);
+        expected.add(99, PT::Y);
+
+        REQUIRE(left * right == expected);
+    }
+
+    SECTION("throws for different numbers of qubits")
+    {
+        const auto left = ket::SparsePauliString {{PT::X, PT::Z}};
+        const auto right = ket::SparsePauliString {{PT::X}};
+
+        REQUIRE_THROWS_AS(left * right, std::runtime_error);
+    }
+}
+
+
+TEST_CASE("SparsePauliString.commutes_with()")
+{
+    struct TestCase
+    {
+        ket::SparsePauliString left;
+        ket::SparsePauliString right;
+        bool expected;
+    };
+
+    auto testcase = GENERATE(
+        TestCase {{PT::X}, {PT::X}, true},
+        TestCase {{PT::X}, {PT::Z}, false},
+        TestCase {{PT::X}, {PT::I}, true},
+        TestCase {{PT::X, PT::X}, {PT::Z, PT::Z}, true},
+        TestCase {{PT::X, PT::Y}, {PT::Z, PT::Z}, true},
+        TestCase {{PT::X, PT::Y}, {PT::Z, PT::I}, false},
+        TestCase {{PT::X, PT::Y, PT::Z}, {PT::Y, PT::X, PT::Z}, true},
+        TestCase {{PT::X, PT::I, PT::Z}, {PT::Y, PT::X, PT::Z}, false}
+    );
+
+    REQUIRE(testcase.left.commutes_with(testcase.right) == testcase.expected);
+    REQUIRE(testcase.right.commutes_with(testcase.left) == testcase.expected);
+}
@@ -0,0 +1,195 @@
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/gates/random_u_gates.hpp"
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/optimize/adjoint_gradient.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+
+namespace
+{
+
+using PT = ket::PauliTerm;
+
+constexpr auto FINITE_DIFFERENCE_STEP = double {1.0e-5};
+constexpr auto GRADIENT_TOLERANCE = double {1.0e-6};
+
+auto simulated_expectation_value_(
+    const ket::QuantumCircuit& circuit,
+    const ket::PauliOperator& pauli_op,
+    const ket::QuantumState& initial_state
+) -> double
+{
+    auto state = initial_state;
+    ket::simulate(circuit, state);
+
+    return ket::expectation_value(pauli_op, state).real();
+}
+
+/*
+    Calculates the gradient with central finite differences, to compare against the adjoint method.
+*/
+auto finite_difference_gradient_(
+    ket::QuantumCircuit circuit,
+    const std::vector<ket::param::ParameterID>& parameter_ids,
+    const std::vector<double>& parameter_values,
+    const ket::PauliOperator& pauli_op,
+    const ket::QuantumState& initial_state
+) -> std::vector<double>
+{
+    auto gradient = std::vector<double> {};
+
+    for (std::size_t i {0}; i < parameter_ids.size(); ++i) {
+        circuit.set_parameter_value(parameter_ids[i], parameter_values[i] + FINITE_DIFFERENCE_STEP);
+        const auto forward = simulated_expectation_value_(circuit, pauli_op, initial_state);
+
+        circuit.set_parameter_value(parameter_ids[i], parameter_values[i] - FINITE_DIFFERENCE_STEP);
+        const auto backward = simulated_expectation_value_(circuit, pauli_op, initial_state);
+
+        circuit.set_parameter_value(parameter_ids[i], parameter_values[i]);
+        gradient.push_back((forward - backward) / (2.0 * FINITE_DIFFERENCE_STEP));
+    }
+
+    return gradient;
+}
+
+auto example_pauli_operator_() -> ket::PauliOperator
+{
+    return ket::PauliOperator {
+        {.coefficient= 0.5, .pauli_string={PT::I, PT::I, PT::I}},
+        {.coefficient=-1.2, .pauli_string={PT::X, PT::Y, PT::I}},
+        {.coefficient= 0.7, .pauli_string={PT::Z, PT::I, PT::Z}},
+        {.coefficient= 2.1, .pauli_string={PT::Y, PT::X, PT::Z}},
+        {.coefficient=-0.3, .pauli_string={PT::I, PT::Z, PT::X}}
+    };
+}
+
+void check_against_finite_differences_(
+    const ket::QuantumCircuit& circuit,
+    const std::vector<ket::param::ParameterID>& parameter_ids,
+    const std::vector<double>& parameter_values,
+    const ket::PauliOperator& pauli_op,
+    const ket::QuantumState& initial_state
+)
+{
+    const auto [expectation_value, gradient] = ket::adjoint_gradient(circuit, parameter_ids, pauli_op, initial_state);
+    const auto expected_gradient = finite_difference_gradient_(circuit, parameter_ids, parameter_values, pauli_op, initial_state);
+
+    REQUIRE_THAT(expectation_value, Catch::Matchers::WithinAbs(simulated_expectation_value_(circuit, pauli_op, initial_state), GRADIENT_TOLERANCE));
+
+    REQUIRE(gradient.size() == expected_gradient.size());
+    for (std::size_t i {0}; i < gradient.size(); ++i) {
+        REQUIRE_THAT(gradient[i], Catch::Matchers::WithinAbs(expected_gradient[i], GRADIENT_TOLERANCE));
+    }
+}
+
+}  // namespace
+
+
+TEST_CASE("adjoint_gradient()")
+{
+    SECTION("every kind of parameterized gate, mixed with fixed gates")
+    {
+        const auto values = std::vector<double> {0.31, -1.24, 2.05, 0.77, -0.58, 1.66, -2.43, 0.12, 0.94};
+
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);
+        const auto id0 = circuit.add_rx_gate(0, values[0], ket::param::parameterized {});
+        circuit.add_cx_gate(0, 1);
+        const auto id1 = circuit.add_ry_gate(1, values[1], ket::param::parameterized {});
+        circuit.add_s_gate(2);
+        const auto id2 = circuit.add_rz_gate(2, values[2], ket::param::parameterized {});
+        circuit.add_u_gate(ket::generate_random_unitary2x2(42), 1);
+        const auto id3 = circuit.add_p_gate(1, values[3], ket::param::parameterized {});
+        circuit.add_sx_gate(0);
+        const auto id4 = circuit.add_crx_gate(1, 2, values[4], ket::param::parameterized {});
+        circuit.add_t_gate(1);
+        const auto id5 = circuit.add_cry_gate(2, 0, values[5], ket::param::parameterized {});
+        circuit.add_cu_gate(ket::generate_random_unitary2x2(43), 0, 2);
+        const auto id6 = circuit.add_crz_gate(0, 1, values[6], ket::param::parameterized {});
+        circuit.add_cs_gate(2, 1);
+        const auto id7 = circuit.add_cp_gate(2, 0, values[7], ket::param::parameterized {});
+        const auto id8 = circuit.add_pauli_rotation_gate(
+            ket::SparsePauliString {{PT::Y, PT::Z, PT::X}, ket::PauliPhase::MINUS_ONE},
+            values[8],
+            ket::param::parameterized {}
+        );
+        circuit.add_h_gate(2);
+
+        const auto ids = std::vector {id0, id1, id2, id3, id4, id5, id6, id7, id8};
+        const auto initial_state = ket::generate_random_state(3, 1234);
+
+        check_against_finite_differences_(circuit, ids, values, example_pauli_operator_(), initial_state);
+    }
+
+    SECTION("shared parameters add up the contributions of each gate")
+    {
+        const auto theta = 0.83;
+        const auto phi = -1.37;
+
+        auto circuit = ket::QuantumCircuit {3};
+        const auto theta_id = circuit.add_ry_gate(0, theta, ket::param::parameterized {});
+        const auto phi_id = circuit.add_rx_gate(1, phi, ket::param::parameterized {});
+        circuit.add_cx_gate(0, 2);
+        circuit.add_ry_gate(1, theta_id);
+        circuit.add_crz_gate(1, 2, phi_id);
+        circuit.add_rx_gate(2, theta_id);
+        circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::X, PT::Y}}, theta_id);
+
+        REQUIRE(circuit.parameter_data_map().at(theta_id).count == 4);
+
+        const auto initial_state = ket::QuantumState {3};
+        check_against_finite_differences_(circuit, {theta_id, phi_id}, {theta, phi}, example_pauli_operator_(), initial_state);
+    }
+
+    SECTION("gradient follows the order of the requested parameters")
+    {
+        auto circuit = ket::QuantumCircuit {3};
+        const auto id0 = circuit.add_rx_gate(0, 0.4, ket::param::parameterized {});
+        const auto id1 = circuit.add_ry_gate(1, -0.9, ket::param::parameterized {});
+        const auto id2 = circuit.add_rx_gate(2, 1.3, ket::param::parameterized {});
+
+        const auto pauli_op = example_pauli_operator_();
+        const auto all = ket::adjoint_gradient(circuit, {id0, id1, id2}, pauli_op);
+        const auto subset = ket::adjoint_gradient(circuit, {id2, id0}, pauli_op);
+
+        REQUIRE(subset.gradient.size() == 2);
+        REQUIRE_THAT(subset.gradient[0], Catch::Matchers::WithinAbs(all.gradient[2], GRADIENT_TOLERANCE));
+        REQUIRE_THAT(subset.gradient[1], Catch::Matchers::WithinAbs(all.gradient[0], GRADIENT_TOLERANCE));
+    }
+
+    SECTION("throws for invalid inputs")
+    {
+        auto circuit = ket::QuantumCircuit {3, 1};
+        const auto id = circuit.add_rx_gate(0, 0.4, ket::param::parameterized {});
+
+        const auto pauli_op = example_pauli_operator_();
+
+        SECTION("unknown parameter")
+        {
+            const auto other = ket::param::Parameter {"other"};
+            REQUIRE_THROWS_AS(ket::adjoint_gradient(circuit, {other.id()}, pauli_op), std::runtime_error);
+        }
+
+        SECTION("mismatched number of qubits")
+        {
+            REQUIRE_THROWS_AS(ket::adjoint_gradient(circuit, {id}, pauli_op, ket::QuantumState {2}), std::runtime_error);
+        }
+
+        SECTION("measurement gates")
+        {
+            circuit.add_m_gate(0, 0);
+            REQUIRE_THROWS_AS(ket::adjoint_gradient(circuit, {id}, pauli_op), std::runtime_error);
+        }
+    }
+}
@@ -0,0 +1,254 @@
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/gates/random_u_gates.hpp"
+#include "kettle/operator/pauli/pauli_operator.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/optimize/adjoint_gradient.hpp"
+#include "kettle/optimize/parameter_shift_gradient.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+
+namespace
+{
+
+using PT = ket::PauliTerm;
+
+constexpr auto GRADIENT_TOLERANCE = double {1.0e-8};
+
+auto example_pauli_operator_() -> ket::PauliOperator
+{
+    return ket::PauliOperator {
+        {.coefficient= 0.5, .pauli_string={PT::I, PT::I, PT::I}},
+        {.coefficient=-1.2, .pauli_string={PT::X, PT::Y, PT::I}},
+        {.coefficient= 0.7, .pauli_string={PT::Z, PT::I, PT::Z}},
+        {.coefficient= 2.1, .pauli_string={PT::Y, PT::X, PT::Z}},
+        {.coefficient=-0.3, .pauli_string={PT::I, PT::Z, PT::X}}
+    };
+}
+
+void require_gradients_match_(const std::vector<double>& actual, const std::vector<double>& expected, double tolerance)
+{
+    REQUIRE(actual.size() == expected.size());
+    for (std::size_t i {0}; i < actual.size(); ++i) {
+        REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs(expected[i], tolerance));
+    }
+}
+
+}  // namespace
+
+
+TEST_CASE("parameter_shift_gradient()")
+{
+    SECTION("matches the adjoint method for every kind of parameterized gate")
+    {
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);
+        const auto id0 = circuit.add_rx_gate(0, 0.31, ket::param::parameterized {});
+        circuit.add_cx_gate(0, 1);
+        const auto id1 = circuit.add_ry_gate(1, -1.24, ket::param::parameterized {});
+        const auto id2 = circuit.add_rz_gate(2, 2.05, ket::param::parameterized {});
+        circuit.add_u_gate(ket::generate_random_unitary2x2(42), 1);
+        const auto id3 = circuit.add_p_gate(1, 0.77, ket::param::parameterized {});
+        const auto id4 = circuit.add_crx_gate(1, 2, -0.58, ket::param::parameterized {});
+        const auto id5 = circuit.add_cry_gate(2, 0, 1.66, ket::param::parameterized {});
+        const auto id6 = circuit.add_crz_gate(0, 1, -2.43, ket::param::parameterized {});
+        const auto id7 = circuit.add_cp_gate(2, 0, 0.12, ket::param::parameterized {});
+        const auto id8 = circuit.add_pauli_rotation_gate(
+            ket::SparsePauliString {{PT::Y, PT::Z, PT::X}, ket::PauliPhase::MINUS_ONE},
+            0.94,
+            ket::param::parameterized {}
+        );
+
+        // shared parameters
+        circuit.add_ry_gate(2, id0);
+        circuit.add_crx_gate(0, 2, id1);
+
+        const auto ids = std::vector {id0, id1, id2, id3, id4, id5, id6, id7, id8};
+        const auto pauli_op = example_pauli_operator_();
+        const auto initial_state = ket::generate_random_state(3, 1234);
+
+        const auto n_threads = static_cast<std::size_t>(GENERATE(1, 3));
+        const auto [cost, gradient] = ket::parameter_shift_gradient(circuit, ids, pauli_op, initial_state, std::nullopt, n_threads);
+        const auto [expected_cost, expected_gradient] = ket::adjoint_gradient(circuit, ids, pauli_op, initial_state);
+
+        REQUIRE_THAT(cost, Catch::Matchers::WithinAbs(expected_cost, GRADIENT_TOLERANCE));
+        require_gradients_match_(gradient, expected_gradient, GRADIENT_TOLERANCE);
+    }
+
+    SECTION("mid-circuit measurements and control flow")
+    {
+        // the parameters after the measurement see the same measurement outcome in every run
+        auto x_subcircuit = ket::QuantumCircuit {3};
+        x_subcircuit.add_x_gate(1);
+
+        const auto theta = 0.83;
+        const auto phi = -1.37;
+
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);
+        circuit.add_m_gate(0, 0);
+        circuit.add_if_statement(0, x_subcircuit);
+        const auto theta_id = circuit.add_rx_gate(1, theta, ket::param::parameterized {});
+        const auto phi_id = circuit.add_cry_gate(1, 2, phi, ket::param::parameterized {});
+        circuit.add_ry_gate(2, theta_id);
+
+        const auto pauli_op = example_pauli_operator_();
+        const auto initial_state = ket::QuantumState {3};
+        const auto prng_seed = GENERATE(1, 2, 3, 4);
+
+        const auto [cost, gradient] = ket::parameter_shift_gradient(circuit, {theta_id, phi_id}, pauli_op, initial_state, prng_seed);
+
+        // central finite differences, with the same measurement outcome
+        const auto step = 1.0e-5;
+        const auto cost_at = [&](double new_theta, double new_phi) {
+            auto shifted = circuit;
+            shifted.set_parameter_value(theta_id, new_theta);
+            shifted.set_parameter_value(phi_id, new_phi);
+
+            auto state = initial_state;
+            ket::simulate(shifted, state, prng_seed);
+            return ket::expectation_value(pauli_op, state).real();
+        };
+
+        const auto expected_gradient = std::vector<double> {
+            (cost_at(theta + step, phi) - cost_at(theta - step, phi)) / (2.0 * step),
+            (cost_at(theta, phi + step) - cost_at(theta, phi - step)) / (2.0 * step)
+        };
+
+        REQUIRE_THAT(cost, Catch::Matchers::WithinAbs(cost_at(theta, phi), GRADIENT_TOLERANCE));
+        require_gradients_match_(gradient, expected_gradient, 1.0e-6);
+    }
+
+    SECTION("custom cost function")
+    {
+        auto circuit = ket::QuantumCircuit {1};
+        const auto id = circuit.add_ry_gate(0, 0.4, ket::param::parameterized {});
+
+        // the probability of measuring |1> is sin^2(theta / 2), with derivative sin(theta) / 2
+        const auto probability_of_one = [](const ket::QuantumState& state) { return std::norm(state[1]); };
+        const auto [cost, gradient] = ket::parameter_shift_gradient(circuit, {id}, probability_of_one, ket::QuantumState {1});
+
+        REQUIRE_THAT(cost, Catch::Matchers::WithinAbs(std::sin(0.2) * std::sin(0.2), GRADIENT_TOLERANCE));
+        REQUIRE_THAT(gradient[0], Catch::Matchers::WithinAbs(std::sin(0.4) / 2.0, GRADIENT_TOLERANCE));
+    }
+
+    SECTION("runs concurrently when there are fewer runs than threads")
+    {
+        auto circuit = ket::QuantumCircuit {1};
+        const auto id = circuit.add_ry_gate(0, 0.4, ket::param::parameterized {});
+
+        // the two shifted runs and the unshifted run are fewer than the 8 threads
+        auto mutex = std::mutex {};
+        auto thread_ids = std::set<std::thread::id> {};
+        const auto recording_cost = [&](const ket::QuantumState& state) {
+            const auto lock = std::scoped_lock {mutex};
+            thread_ids.insert(std::this_thread::get_id());
+            return std::norm(state[1]);
+        };
+
+        std::ignore = ket::parameter_shift_gradient(circuit, {id}, recording_cost, ket::QuantumState {1}, std::nullopt, 8);
+
+        REQUIRE(thread_ids.size() > 1);
+    }
+
+    SECTION("throws for invalid inputs")
+    {
+        const auto pauli_op = example_pauli_operator_();
+
+        SECTION("unknown parameter")
+        {
+            auto circuit = ket::QuantumCircuit {3};
+            circuit.add_rx_gate(0, 0.4, ket::param::parameterized {});
+
+            const auto other = ket::param::Parameter {"other"};
+            REQUIRE_THROWS_AS(ket::parameter_shift_gradient(circuit, {other.id()}, pauli_op, ket::QuantumState {3}), std::runtime_error);
+        }
+
+        SECTION("parameterized gate inside control flow")
+        {
+            auto subcircuit = ket::QuantumCircuit {3};
+            const auto id = subcircuit.add_rx_gate(1, 0.4, ket::param::parameterized {});
+
+            auto circuit = ket::QuantumCircuit {3};
+            circuit.add_m_gate(0, 0);
+            circuit.add_if_statement(0, subcircuit);
+
+            REQUIRE_THROWS_AS(ket::parameter_shift_gradient(circuit, {id}, pauli_op, ket::QuantumState {3}), std::runtime_error);
+        }
+
+        SECTION("exceptions from the cost function are passed on")
+        {
+            auto circuit = ket::QuantumCircuit {3};
+            const auto id = circuit.add_rx_gate(0, 0.4, ket::param::parameterized {});
+
+            const auto throwing_cost = []([[maybe_unused]] const ket::QuantumState& state) -> double {
+                throw std::runtime_error {"cost function failed"};
+            };
+
+            REQUIRE_THROWS_AS(ket::parameter_shift_gradient(circuit, {id}, throwing_cost, ket::QuantumState {3}, std::nullopt, 2), std::runtime_error);
+        }
+    }
+}
+
+
+TEST_CASE("parameter_shift_objective()")
+{
+    auto circuit = ket::QuantumCircuit {3};
+    const auto id0 = circuit.add_rx_gate(0, 0.0, ket::param::parameterized {});
+    circuit.add_cx_gate(0, 1);
+    const auto id1 = circuit.add_ry_gate(1, 0.0, ket::param::parameterized {});
+    const auto id2 = circuit.add_crz_gate(1, 2, 0.0, ket::param::parameterized {});
+
+    const auto pauli_op = example_pauli_operator_();
+
+    auto objective = ket::ParameterShiftObjective {
+        .circuit=circuit,
+        .parameter_ids={id0, id1, id2},
+        .cost_function=[&pauli_op](const ket::QuantumState& state) { return ket::expectation_value(pauli_op, state).real(); },
+        .initial_state=ket::generate_random_state(3, 99)
+    };
+
+    const auto parameters = std::vector<double> {0.3, -0.8, 1.9};
+
+    auto expected_circuit = circuit;
+    for (std::size_t i {0}; i < parameters.size(); ++i) {
+        expected_circuit.set_parameter_value(objective.parameter_ids[i], parameters[i]);
+    }
+
+    const auto [expected_cost, expected_gradient] = ket::adjoint_gradient(expected_circuit, objective.parameter_ids, pauli_op, objective.initial_state);
+
+    SECTION("with a gradient")
+    {
+        auto grad = std::vector<double>(parameters.size(), 0.0);
+        const auto cost = ket::parameter_shift_objective(parameters, grad, &objective);
+
+        REQUIRE_THAT(cost, Catch::Matchers::WithinAbs(expected_cost, GRADIENT_TOLERANCE));
+        require_gradients_match_(grad, expected_gradient, GRADIENT_TOLERANCE);
+    }
+
+    SECTION("without a gradient")
+    {
+        auto grad = std::vector<double> {};
+        const auto cost = ket::parameter_shift_objective(parameters, grad, &objective);
+
+        REQUIRE_THAT(cost, Catch::Matchers::WithinAbs(expected_cost, GRADIENT_TOLERANCE));
+        REQUIRE(grad.empty());
+    }
+}
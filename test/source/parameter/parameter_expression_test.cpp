@@ -113,3 +113,58 @@ TEST_CASE("EvaluateExpression")
         REQUIRE_THAT(evaluator.evaluate(expr, map_variant), Catch::Matchers::WithinRel((1.5 * 0.5) + 2.2));
     }
 }
+
+
+TEST_CASE("accumulate_expression_gradient()")
+{
+    const auto theta = kp::Parameter {"theta"};
+    const auto phi = kp::Parameter {"phi"};
+    const auto map = kp::EvaluatedParameterDataMap { {theta.id(), 1.5}, {phi.id(), -0.4} };
+    const auto map_variant = kpi::MapVariant {std::reference_wrapper {map}};
+
+    SECTION("a single literal has no gradient")
+    {
+        auto gradients = kp::EvaluatedParameterDataMap {};
+        kpi::accumulate_expression_gradient(kp::LiteralExpression {1.5}, 2.0, map_variant, gradients);
+
+        REQUIRE(gradients.empty());
+    }
+
+    SECTION("a single parameter")
+    {
+        auto gradients = kp::EvaluatedParameterDataMap {};
+        kpi::accumulate_expression_gradient(theta, 2.0, map_variant, gradients);
+
+        REQUIRE(gradients.size() == 1);
+        REQUIRE_THAT(gradients.at(theta.id()), Catch::Matchers::WithinRel(2.0));
+    }
+
+    SECTION("(theta * phi) + (2.5 * theta)")
+    {
+        const auto product = kp::BinaryExpression {
+            .operation=kp::BinaryOperation::MUL,
+            .left=ket::ClonePtr {kp::ParameterExpression {theta}},
+            .right=ket::ClonePtr {kp::ParameterExpression {phi}}
+        };
+
+        const auto scaled = kp::BinaryExpression {
+            .operation=kp::BinaryOperation::MUL,
+            .left=ket::ClonePtr {kp::ParameterExpression {kp::LiteralExpression {2.5}}},
+            .right=ket::ClonePtr {kp::ParameterExpression {theta}}
+        };
+
+        const auto expr = kp::BinaryExpression {
+            .operation=kp::BinaryOperation::ADD,
+            .left=ket::ClonePtr {kp::ParameterExpression {product}},
+            .right=ket::ClonePtr {kp::ParameterExpression {scaled}}
+        };
+
+        // the gradient is added to the values that are already present
+        auto gradients = kp::EvaluatedParameterDataMap { {theta.id(), 1.0} };
+        kpi::accumulate_expression_gradient(expr, 2.0, map_variant, gradients);
+
+        // d/dtheta = phi + 2.5 = 2.1, d/dphi = theta = 1.5
+        REQUIRE_THAT(gradients.at(theta.id()), Catch::Matchers::WithinRel(1.0 + (2.0 * 2.1)));
+        REQUIRE_THAT(gradients.at(phi.id()), Catch::Matchers::WithinRel(2.0 * 1.5));
+    }
+}
@@ -0,0 +1,291 @@
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/parameter/parameter_expression.hpp"
+#include "kettle/parameter/parameter_slots.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/state.hpp"
+#include "kettle_internal/circuit/circuit_access.hpp"
+#include "kettle_internal/gates/primitive_gate/gate_create.hpp"
+#include "kettle_internal/parameter/parameter_expression_internal.hpp"
+#include "kettle_internal/parameter/parameter_slots_internal.hpp"
+
+
+namespace kp = ket::param;
+namespace kpi = ket::param::internal;
+
+
+namespace
+{
+
+auto literal_(double value) -> ket::ClonePtr<kp::ParameterExpression>
+{
+    return ket::ClonePtr {kp::ParameterExpression {kp::LiteralExpression {value}}};
+}
+
+auto parameter_(const kp::Parameter& parameter) -> ket::ClonePtr<kp::ParameterExpression>
+{
+    return ket::ClonePtr {kp::ParameterExpression {parameter}};
+}
+
+/*
+    Adds an RX gate with the angle `expr` to `circuit`; no public function creates gates with binary
+    expressions, so the gate is added directly.
+*/
+void add_rx_gate_with_expression_(ket::QuantumCircuit& circuit, std::size_t target, const kp::ParameterExpression& expr)
+{
+    ket::CircuitAccess_::elements(circuit).emplace_back(ket::internal::create::create_one_target_one_parameter_gate(ket::Gate::RX, target, expr));
+}
+
+}  // namespace
+
+
+TEST_CASE("parameter_slot_ids()")
+{
+    SECTION("slots follow the order of first appearance")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        const auto id0 = circuit.add_rx_gate(0, 0.1, kp::parameterized {});
+        const auto id1 = circuit.add_ry_gate(1, 0.2, kp::parameterized {});
+        circuit.add_rz_gate(0, id0);
+        const auto id2 = circuit.add_crx_gate(0, 1, 0.3, kp::parameterized {});
+
+        REQUIRE(ket::parameter_slot_ids(circuit) == std::vector {id0, id1, id2});
+        REQUIRE(ket::parameter_slot_values(circuit) == std::vector {0.1, 0.2, 0.3});
+    }
+
+    SECTION("subcircuits of control flow statements are visited in place")
+    {
+        auto if_circuit = ket::QuantumCircuit {2, 1};
+        const auto if_id = if_circuit.add_ry_gate(1, 0.5, kp::parameterized {});
+
+        auto else_circuit = ket::QuantumCircuit {2, 1};
+        const auto else_id = else_circuit.add_rz_gate(1, 0.6, kp::parameterized {});
+
+        auto circuit = ket::QuantumCircuit {2, 1};
+        const auto first_id = circuit.add_rx_gate(0, 0.4, kp::parameterized {});
+        circuit.add_m_gate(0, 0);
+        circuit.add_if_else_statement(0, if_circuit, else_circuit);
+        const auto last_id = circuit.add_rx_gate(1, 0.7, kp::parameterized {});
+
+        REQUIRE(ket::parameter_slot_ids(circuit) == std::vector {first_id, if_id, else_id, last_id});
+        REQUIRE(ket::parameter_slot_values(circuit) == std::vector {0.4, 0.5, 0.6, 0.7});
+    }
+
+    SECTION("uninitialized parameter values throw")
+    {
+        auto circuit = ket::QuantumCircuit {1};
+        const auto parameter = kp::Parameter {"theta"};
+        circuit.add_rx_gate(0, parameter.id());
+
+        REQUIRE(ket::parameter_slot_ids(circuit).size() == 1);
+        REQUIRE_THROWS_AS(ket::parameter_slot_values(circuit), std::runtime_error);
+    }
+}
+
+
+TEST_CASE("compile_parameter_slots() with nested parameter expressions")
+{
+    const auto theta = kp::Parameter {"theta"};
+    const auto phi = kp::Parameter {"phi"};
+
+    // `phi` appears first, so it is given slot 0
+    auto circuit = ket::QuantumCircuit {2};
+    circuit.add_rx_gate(0, phi.id());
+    circuit.add_ry_gate(1, theta.id());
+    circuit.set_parameter_value(theta.id(), 1.5);
+    circuit.set_parameter_value(phi.id(), -0.4);
+
+    const auto map = kp::EvaluatedParameterDataMap { {theta.id(), 1.5}, {phi.id(), -0.4} };
+    const auto map_variant = kpi::MapVariant {std::reference_wrapper {map}};
+
+    const auto check_against_evaluator = [&](const kp::ParameterExpression& expr) {
+        const auto expected = kpi::Evaluator {}.evaluate(expr, map_variant);
+
+        // as the last gate of the circuit
+        {
+            auto expr_circuit = circuit;
+            add_rx_gate_with_expression_(expr_circuit, 1, expr);
+
+            const auto compiled = kpi::compile_parameter_slots(expr_circuit);
+            const auto slot_values = kpi::parameter_values_from_slots(expr_circuit, compiled.slot_ids);
+            const auto& program = compiled.circuit.programs[expr_circuit.n_circuit_elements() - 1];
+
+            REQUIRE(compiled.slot_ids == std::vector {phi.id(), theta.id()});
+            REQUIRE_THAT(program.evaluate(slot_values), Catch::Matchers::WithinAbs(expected, 1.0e-12));
+        }
+
+        // as a gate inside the subcircuit of a repeat statement
+        {
+            auto body = ket::QuantumCircuit {2};
+            body.add_h_gate(0);
+            add_rx_gate_with_expression_(body, 1, expr);
+
+            auto expr_circuit = circuit;
+            expr_circuit.add_repeat_statement(2, body);
+
+            const auto compiled = kpi::compile_parameter_slots(expr_circuit);
+            const auto slot_values = kpi::parameter_values_from_slots(expr_circuit, compiled.slot_ids);
+
+            const auto i_repeat = expr_circuit.n_circuit_elements() - 1;
+            const auto& compiled_body = compiled.circuit.subcircuits[compiled.circuit.i_subcircuits[i_repeat]];
+
+            REQUIRE_THAT(compiled_body.programs[1].evaluate(slot_values), Catch::Matchers::WithinAbs(expected, 1.0e-12));
+        }
+    };
+
+    SECTION("a single parameter")
+    {
+        check_against_evaluator(kp::ParameterExpression {phi});
+    }
+
+    SECTION("sums and products")
+    {
+        // (theta + 1.1) * (phi * 3.0)
+        const auto expr = kp::ParameterExpression {kp::BinaryExpression {
+            .operation=kp::BinaryOperation::MUL,
+            .left=ket::ClonePtr {kp::ParameterExpression {kp::BinaryExpression {
+                .operation=kp::BinaryOperation::ADD, .left=parameter_(theta), .right=literal_(1.1)
+            }}},
+            .right=ket::ClonePtr {kp::ParameterExpression {kp::BinaryExpression {
+                .operation=kp::BinaryOperation::MUL, .left=parameter_(phi), .right=literal_(3.0)
+            }}}
+        }};
+
+        check_against_evaluator(expr);
+    }
+
+    SECTION("deeply nested expressions that do not fit in the inline stack")
+    {
+        // theta + (phi + (theta + (phi + ...))), which needs a stack as deep as the expression
+        const auto n_levels = static_cast<std::size_t>(GENERATE(8, 15, 16, 17, 40));
+
+        auto expr = kp::ParameterExpression {kp::LiteralExpression {0.25}};
+        for (std::size_t i {0}; i < n_levels; ++i) {
+            const auto operation = (i % 3 == 0) ? kp::BinaryOperation::MUL : kp::BinaryOperation::ADD;
+            const auto& param = (i % 2 == 0) ? theta : phi;
+
+            expr = kp::ParameterExpression {kp::BinaryExpression {
+                .operation=operation, .left=parameter_(param), .right=ket::ClonePtr {std::move(expr)}
+            }};
+        }
+
+        check_against_evaluator(expr);
+    }
+
+    SECTION("a nested expression is simulated with its value")
+    {
+        // 2.0 * theta + phi
+        const auto expr = kp::ParameterExpression {kp::BinaryExpression {
+            .operation=kp::BinaryOperation::ADD,
+            .left=ket::ClonePtr {kp::ParameterExpression {kp::BinaryExpression {
+                .operation=kp::BinaryOperation::MUL, .left=literal_(2.0), .right=parameter_(theta)
+            }}},
+            .right=parameter_(phi)
+        }};
+
+        auto expr_circuit = circuit;
+        add_rx_gate_with_expression_(expr_circuit, 1, expr);
+
+        auto expected_circuit = circuit;
+        expected_circuit.add_rx_gate(1, 2.0 * 1.5 - 0.4);
+
+        auto expected = ket::QuantumState {2};
+        ket::simulate(expected_circuit, expected);
+
+        const auto compiled = kp::CompiledCircuit {expr_circuit};
+        auto actual = ket::QuantumState {2};
+        ket::simulate(compiled, actual, compiled.parameter_values());
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+}
+
+
+TEST_CASE("simulate() with a CompiledCircuit and parameter values in slot order")
+{
+    auto circuit = ket::QuantumCircuit {2};
+    circuit.add_h_gate(0);
+    const auto id0 = circuit.add_rx_gate(0, 0.0, kp::parameterized {});
+    circuit.add_cx_gate(0, 1);
+    const auto id1 = circuit.add_cry_gate(0, 1, 0.0, kp::parameterized {});
+    circuit.add_rz_gate(1, id0);
+
+    const auto values = std::vector {0.83, -1.37};
+    const auto compiled = kp::CompiledCircuit {circuit};
+
+    SECTION("matches simulating with the values stored in the circuit")
+    {
+        auto expected_circuit = circuit;
+        expected_circuit.set_parameter_value(id0, values[0]);
+        expected_circuit.set_parameter_value(id1, values[1]);
+
+        auto expected = ket::QuantumState {2};
+        ket::simulate(expected_circuit, expected);
+
+        auto actual = ket::QuantumState {2};
+        ket::simulate(compiled, actual, values);
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+
+    SECTION("one compiled circuit is simulated with several sets of values")
+    {
+        for (const auto& other_values : {std::vector {0.1, 0.2}, values, std::vector {-2.5, 1.0}}) {
+            auto expected_circuit = circuit;
+            expected_circuit.set_parameter_value(id0, other_values[0]);
+            expected_circuit.set_parameter_value(id1, other_values[1]);
+
+            auto expected = ket::QuantumState {2};
+            ket::simulate(expected_circuit, expected);
+
+            auto actual = ket::QuantumState {2};
+            ket::simulate(compiled, actual, other_values);
+
+            REQUIRE(ket::almost_eq(actual, expected));
+        }
+    }
+
+    SECTION("the values stored in the circuit, in slot order")
+    {
+        REQUIRE(compiled.slot_ids() == std::vector {id0, id1});
+        REQUIRE(compiled.parameter_values() == std::vector {0.0, 0.0});
+    }
+
+    SECTION("values inside control flow subcircuits")
+    {
+        auto subcircuit = ket::QuantumCircuit {2, 1};
+        const auto sub_id = subcircuit.add_ry_gate(1, 0.0, kp::parameterized {});
+
+        auto flow_circuit = ket::QuantumCircuit {2, 1};
+        flow_circuit.add_x_gate(0);
+        flow_circuit.add_m_gate(0, 0);
+        flow_circuit.add_if_statement(0, subcircuit);
+
+        auto expected_circuit = flow_circuit;
+        expected_circuit.set_parameter_value(sub_id, 1.2);
+
+        auto expected = ket::QuantumState {2};
+        ket::simulate(expected_circuit, expected);
+
+        auto actual = ket::QuantumState {2};
+        ket::simulate(kp::CompiledCircuit {flow_circuit}, actual, std::vector {1.2});
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+
+    SECTION("throws for the wrong number of values")
+    {
+        auto state = ket::QuantumState {2};
+        REQUIRE_THROWS_AS(ket::simulate(compiled, state, std::vector {0.1}), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::simulate(compiled, state, std::vector {0.1, 0.2, 0.3}), std::runtime_error);
+    }
+}
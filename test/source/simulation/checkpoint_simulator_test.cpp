@@ -0,0 +1,155 @@
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/parameter/parameter.hpp"
+#include "kettle/parameter/parameter_slots.hpp"
+#include "kettle/simulation/checkpoint_simulator.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+
+namespace
+{
+
+auto bytes_per_state_(std::size_t n_qubits) -> std::size_t
+{
+    return (1UL << n_qubits) * sizeof(std::complex<double>);
+}
+
+auto expected_state_(
+    const ket::QuantumCircuit& circuit,
+    const ket::QuantumState& initial_state,
+    const std::vector<double>& parameter_values
+) -> ket::QuantumState
+{
+    auto state = initial_state;
+    ket::simulate(ket::param::CompiledCircuit {circuit}, state, parameter_values);
+
+    return state;
+}
+
+}  // namespace
+
+
+TEST_CASE("CheckpointSimulator")
+{
+    // one layer of rotations per parameter, with entangling gates in between
+    auto circuit = ket::QuantumCircuit {3};
+    for (std::size_t i {0}; i < 4; ++i) {
+        circuit.add_ry_gate(i % 3, 0.1 * static_cast<double>(i + 1), ket::param::parameterized {});
+        circuit.add_h_gate(i % 3);
+        circuit.add_cx_gate(i % 3, (i + 1) % 3);
+    }
+
+    const auto initial_state = ket::generate_random_state(3, 1234);
+    const auto n_gates = std::size_t {12};
+
+    SECTION("results match the regular simulator")
+    {
+        auto simulator = ket::CheckpointSimulator {circuit, initial_state, 4 * bytes_per_state_(3)};
+        REQUIRE(simulator.n_checkpoints() == 3);
+
+        const auto all_values = std::vector<std::vector<double>> {
+            {0.1, 0.2, 0.3, 0.4},
+            {0.1, 0.2, 0.3, 0.9},  // change the last parameter
+            {0.1, 0.2, 0.3, 0.9},  // change nothing
+            {0.1, 0.7, 0.3, 0.9},  // change a middle parameter
+            {0.5, 0.7, 0.3, 0.9},  // change the first parameter
+            {0.5, 0.7, 0.6, 0.2}   // change several parameters
+        };
+
+        for (const auto& values : all_values) {
+            const auto& state = simulator.run(values);
+            REQUIRE(ket::almost_eq(state, expected_state_(circuit, initial_state, values)));
+        }
+    }
+
+    SECTION("statistics")
+    {
+        auto simulator = ket::CheckpointSimulator {circuit, initial_state, 4 * bytes_per_state_(3)};
+
+        // the first run has nothing to resume from
+        simulator.run(std::vector {0.1, 0.2, 0.3, 0.4});
+        REQUIRE(simulator.statistics().n_misses == 1);
+        REQUIRE(simulator.statistics().n_hits == 0);
+        REQUIRE(simulator.statistics().n_gates_simulated == n_gates);
+
+        // the last parameter is used by the 10th gate, so only the last 3 gates are simulated
+        simulator.run(std::vector {0.1, 0.2, 0.3, 0.9});
+        REQUIRE(simulator.statistics().n_hits == 1);
+        REQUIRE(simulator.statistics().n_gates_skipped == 9);
+        REQUIRE(simulator.statistics().n_gates_simulated == n_gates + 3);
+
+        // an unchanged run needs no simulation at all
+        simulator.run(std::vector {0.1, 0.2, 0.3, 0.9});
+        REQUIRE(simulator.statistics().n_hits == 2);
+        REQUIRE(simulator.statistics().n_gates_skipped == 9 + n_gates);
+
+        // the first parameter is used by the very first gate, so there is nothing to resume from
+        simulator.run(std::vector {0.5, 0.2, 0.3, 0.9});
+        REQUIRE(simulator.statistics().n_misses == 2);
+
+        simulator.reset_statistics();
+        REQUIRE(simulator.statistics().n_hits == 0);
+        REQUIRE(simulator.statistics().n_misses == 0);
+    }
+
+    SECTION("the memory budget limits the number of checkpoints")
+    {
+        const auto n_checkpoints = static_cast<std::size_t>(GENERATE(0, 1, 2));
+        const auto budget = n_checkpoints * bytes_per_state_(3) + bytes_per_state_(3) / 2;
+
+        auto simulator = ket::CheckpointSimulator {circuit, initial_state, budget};
+        REQUIRE(simulator.n_checkpoints() == n_checkpoints);
+
+        simulator.run(std::vector {0.1, 0.2, 0.3, 0.4});
+
+        const auto values = std::vector {0.1, 0.2, 0.3, 0.9};
+        REQUIRE(ket::almost_eq(simulator.run(values), expected_state_(circuit, initial_state, values)));
+
+        if (n_checkpoints == 0) {
+            REQUIRE(simulator.statistics().n_misses == 2);
+        }
+        else {
+            REQUIRE(simulator.statistics().n_hits == 1);
+        }
+    }
+
+    SECTION("run() with the values stored in the circuit")
+    {
+        auto simulator = ket::CheckpointSimulator {circuit, initial_state, 4 * bytes_per_state_(3)};
+
+        auto expected = initial_state;
+        ket::simulate(circuit, expected);
+
+        REQUIRE(ket::almost_eq(simulator.run(), expected));
+    }
+
+    SECTION("throws for invalid inputs")
+    {
+        SECTION("measurement gates")
+        {
+            auto measured = ket::QuantumCircuit {3, 1};
+            measured.add_m_gate(0, 0);
+            REQUIRE_THROWS_AS(ket::CheckpointSimulator(measured, initial_state, 0), std::runtime_error);
+        }
+
+        SECTION("mismatched number of qubits")
+        {
+            REQUIRE_THROWS_AS(ket::CheckpointSimulator(circuit, ket::QuantumState {2}, 0), std::runtime_error);
+        }
+
+        SECTION("wrong number of parameter values")
+        {
+            auto simulator = ket::CheckpointSimulator {circuit, initial_state, 0};
+            REQUIRE_THROWS_AS(simulator.run(std::vector {0.1, 0.2}), std::runtime_error);
+        }
+    }
+}
@@ -1,13 +1,22 @@
+#include <cstddef>
 #include <functional>
+#include <stdexcept>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_vector.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
 #include <kettle/circuit/circuit.hpp>
+#include <kettle/circuit_operations/append_circuits.hpp>
+#include <kettle/gates/common_u_gates.hpp>
+#include <kettle/gates/multiplicity_controlled_u_gate.hpp>
+#include <kettle/operator/pauli/sparse_pauli_string.hpp>
+#include <kettle/state/random.hpp>
 #include <kettle/state/state.hpp>
 #include <kettle/simulation/simulate.hpp>
 
+using PT = ket::PauliTerm;
+
 
 TEST_CASE("add_if_statement()")
 {
@@ -163,3 +172,168 @@ TEST_CASE("add_if_not_else_statement()")
         REQUIRE(ket::almost_eq(statevector, expected));
     }
 }
+
+TEST_CASE("add_repeat_statement()")
+{
+    const auto angle = 0.123;
+    const auto n_repetitions = GENERATE(std::size_t {0}, std::size_t {1}, std::size_t {5});
+
+    auto body = ket::QuantumCircuit {2};
+    body.add_rx_gate(0, angle);
+    body.add_cx_gate(0, 1);
+
+    auto repeated = ket::QuantumCircuit {2};
+    repeated.add_h_gate(1);
+    repeated.add_repeat_statement(n_repetitions, body);
+    repeated.add_h_gate(0);
+
+    auto unrolled = ket::QuantumCircuit {2};
+    unrolled.add_h_gate(1);
+    for (std::size_t i {0}; i < n_repetitions; ++i) {
+        unrolled.add_rx_gate(0, angle);
+        unrolled.add_cx_gate(0, 1);
+    }
+    unrolled.add_h_gate(0);
+
+    SECTION("gives the same state as the unrolled circuit")
+    {
+        auto repeated_state = ket::QuantumState {"00"};
+        ket::simulate(repeated, repeated_state);
+
+        auto unrolled_state = ket::QuantumState {"00"};
+        ket::simulate(unrolled, unrolled_state);
+
+        REQUIRE(ket::almost_eq(repeated_state, unrolled_state));
+        REQUIRE(repeated.n_circuit_elements() == 3);
+    }
+
+    SECTION("nested repeat statements multiply")
+    {
+        auto outer = ket::QuantumCircuit {2};
+        outer.add_repeat_statement(3, repeated);
+
+        auto expected_circuit = ket::QuantumCircuit {2};
+        for (std::size_t i {0}; i < 3; ++i) {
+            ket::extend_circuit(expected_circuit, unrolled);
+        }
+
+        auto outer_state = ket::QuantumState {"00"};
+        ket::simulate(outer, outer_state);
+
+        auto expected_state = ket::QuantumState {"00"};
+        ket::simulate(expected_circuit, expected_state);
+
+        REQUIRE(ket::almost_eq(outer_state, expected_state));
+    }
+
+    SECTION("throws for a subcircuit of a different size")
+    {
+        REQUIRE_THROWS_AS(repeated.add_repeat_statement(2, ket::QuantumCircuit {3}), std::runtime_error);
+    }
+}
+
+TEST_CASE("add_controlled_block()")
+{
+    const auto initial_state = ket::generate_random_state(4, 123);
+
+    SECTION("same as the controlled gates")
+    {
+        auto body = ket::QuantumCircuit {4};
+        body.add_h_gate(1);
+        body.add_rx_gate(2, 0.25);
+        body.add_cz_gate(1, 2);
+        body.add_crz_gate(2, 1, -0.75);
+
+        auto block_circuit = ket::QuantumCircuit {4};
+        block_circuit.add_controlled_block({0}, body);
+
+        auto expected_circuit = ket::QuantumCircuit {4};
+        expected_circuit.add_ch_gate(0, 1);
+        expected_circuit.add_crx_gate(0, 2, 0.25);
+        expected_circuit.add_ccu_gate(ket::z_gate(), 0, 1, 2);
+        expected_circuit.add_ccu_gate(ket::rz_gate(-0.75), 0, 2, 1);
+
+        auto block_state = initial_state;
+        ket::simulate(block_circuit, block_state);
+
+        auto expected_state = initial_state;
+        ket::simulate(expected_circuit, expected_state);
+
+        REQUIRE(ket::almost_eq(block_state, expected_state));
+    }
+
+    SECTION("nested blocks combine their control qubits")
+    {
+        auto inner = ket::QuantumCircuit {4};
+        inner.add_x_gate(2);
+
+        auto outer = ket::QuantumCircuit {4};
+        outer.add_controlled_block({3}, inner);
+
+        auto block_circuit = ket::QuantumCircuit {4};
+        block_circuit.add_controlled_block({0}, outer);
+
+        auto expected_circuit = ket::QuantumCircuit {4};
+        expected_circuit.add_ccx_gate(0, 3, 2);
+
+        auto block_state = initial_state;
+        ket::simulate(block_circuit, block_state);
+
+        auto expected_state = initial_state;
+        ket::simulate(expected_circuit, expected_state);
+
+        REQUIRE(ket::almost_eq(block_state, expected_state));
+    }
+
+    SECTION("repeat statements and diagonal Pauli rotations inside a block")
+    {
+        // the only qubit that is not a control qubit is qubit 0, so the diagonal rotation
+        // has to be applied without using qubit 0 as a fixed qubit
+        auto body = ket::QuantumCircuit {4};
+        body.add_pauli_rotation_gate(ket::SparsePauliString {{PT::Z, PT::I, PT::I, PT::I}}, 0.5);
+        body.add_sx_gate(0);
+
+        auto repeated = ket::QuantumCircuit {4};
+        repeated.add_repeat_statement(3, body);
+
+        auto block_circuit = ket::QuantumCircuit {4};
+        block_circuit.add_controlled_block({1, 2, 3}, repeated);
+
+        auto expected_circuit = ket::QuantumCircuit {4};
+        const auto body_matrix = ket::sx_gate() * ket::rz_gate(0.5);
+        for (std::size_t i {0}; i < 3; ++i) {
+            ket::apply_multiplicity_controlled_u_gate(expected_circuit, body_matrix, 0, {1, 2, 3});
+        }
+
+        auto block_state = initial_state;
+        ket::simulate(block_circuit, block_state);
+
+        auto expected_state = initial_state;
+        ket::simulate(expected_circuit, expected_state);
+
+        REQUIRE(ket::almost_eq(block_state, expected_state));
+    }
+
+    SECTION("throws")
+    {
+        auto circuit = ket::QuantumCircuit {4};
+
+        auto acts_on_control = ket::QuantumCircuit {4};
+        acts_on_control.add_cx_gate(1, 0);
+        REQUIRE_THROWS_AS(circuit.add_controlled_block({0}, acts_on_control), std::runtime_error);
+
+        auto measures = ket::QuantumCircuit {4};
+        measures.add_m_gate(1);
+        REQUIRE_THROWS_AS(circuit.add_controlled_block({0}, measures), std::runtime_error);
+
+        auto nested_measurement = ket::QuantumCircuit {4};
+        nested_measurement.add_repeat_statement(2, measures);
+        REQUIRE_THROWS_AS(circuit.add_controlled_block({0}, nested_measurement), std::runtime_error);
+
+        REQUIRE_THROWS_AS(circuit.add_controlled_block({}, ket::QuantumCircuit {4}), std::runtime_error);
+        REQUIRE_THROWS_AS(circuit.add_controlled_block({0, 0}, ket::QuantumCircuit {4}), std::runtime_error);
+        REQUIRE_THROWS_AS(circuit.add_controlled_block({4}, ket::QuantumCircuit {4}), std::runtime_error);
+        REQUIRE_THROWS_AS(circuit.add_controlled_block({0, 1, 2, 3}, ket::QuantumCircuit {4}), std::runtime_error);
+        REQUIRE_THROWS_AS(circuit.add_controlled_block({0}, ket::QuantumCircuit {3}), std::runtime_error);
+    }
+}
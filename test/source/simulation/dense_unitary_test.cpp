@@ -0,0 +1,141 @@
+#include <cstddef>
+#include <stdexcept>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit_operations/make_controlled_circuit.hpp"
+#include "kettle/gates/common_u_gates.hpp"
+#include "kettle/simulation/dense_unitary.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+
+namespace
+{
+
+auto example_circuit_() -> ket::QuantumCircuit
+{
+    auto circuit = ket::QuantumCircuit {3};
+    circuit.add_h_gate(0);
+    circuit.add_rx_gate(1, 0.25);
+    circuit.add_cx_gate(0, 2);
+    circuit.add_crz_gate(2, 1, -0.75);
+    circuit.add_u_gate(ket::sx_gate(), 2);
+    circuit.add_cu_gate(ket::y_gate(), 1, 0);
+
+    return circuit;
+}
+
+}  // namespace
+
+
+TEST_CASE("make_dense_unitary()")
+{
+    const auto circuit = example_circuit_();
+
+    SECTION("applying the unitary is the same as simulating the circuit")
+    {
+        const auto n_threads = GENERATE(std::size_t {1}, std::size_t {3}, std::size_t {16});
+        const auto unitary = ket::make_dense_unitary(circuit, n_threads);
+        REQUIRE(unitary.n_qubits() == 3);
+        REQUIRE(unitary.size() == 8);
+
+        auto expected = ket::generate_random_state(3, 42);
+        auto actual = expected;
+
+        ket::simulate(circuit, expected);
+        ket::apply_dense_unitary(actual, unitary, {0, 1, 2});
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+
+    SECTION("the identity")
+    {
+        const auto unitary = ket::make_dense_unitary(ket::QuantumCircuit {2});
+        REQUIRE(ket::almost_eq(unitary, ket::DenseUnitary {2}));
+    }
+
+    SECTION("throws for measurements")
+    {
+        auto measured = ket::QuantumCircuit {2};
+        measured.add_h_gate(0);
+        measured.add_m_gate(0);
+
+        REQUIRE_THROWS_AS(ket::make_dense_unitary(measured), std::runtime_error);
+    }
+
+    SECTION("throws for too many qubits, before allocating the matrix")
+    {
+        const auto n_qubits = ket::MAX_DENSE_UNITARY_QUBITS + 1;
+
+        REQUIRE_THROWS_AS(ket::make_dense_unitary(ket::QuantumCircuit {n_qubits}), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::DenseUnitary {n_qubits}, std::runtime_error);
+        REQUIRE_THROWS_AS(ket::DenseUnitary(64, {}), std::runtime_error);
+    }
+}
+
+TEST_CASE("dense_unitary_power_of_2()")
+{
+    const auto circuit = example_circuit_();
+    const auto unitary = ket::make_dense_unitary(circuit);
+    const auto exponent = GENERATE(std::size_t {0}, std::size_t {1}, std::size_t {3});
+
+    auto repeated = ket::QuantumCircuit {3};
+    repeated.add_repeat_statement(std::size_t {1} << exponent, circuit);
+
+    const auto expected = ket::make_dense_unitary(repeated);
+    const auto actual = ket::dense_unitary_power_of_2(unitary, exponent);
+
+    REQUIRE(ket::almost_eq(actual, expected));
+}
+
+TEST_CASE("apply_dense_unitary()")
+{
+    const auto unitary = ket::make_dense_unitary(example_circuit_());
+
+    SECTION("on a subset of the qubits of a larger state")
+    {
+        auto expected = ket::generate_random_state(5, 123);
+        auto actual = expected;
+
+        // the example circuit, with the qubits (0, 1, 2) mapped to (3, 0, 2)
+        auto mapped = ket::QuantumCircuit {5};
+        mapped.add_h_gate(3);
+        mapped.add_rx_gate(0, 0.25);
+        mapped.add_cx_gate(3, 2);
+        mapped.add_crz_gate(2, 0, -0.75);
+        mapped.add_u_gate(ket::sx_gate(), 2);
+        mapped.add_cu_gate(ket::y_gate(), 0, 3);
+
+        ket::simulate(mapped, expected);
+        ket::apply_dense_unitary(actual, unitary, {3, 0, 2});
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+
+    SECTION("controlled")
+    {
+        const auto n_threads = GENERATE(std::size_t {1}, std::size_t {4});
+
+        auto expected = ket::generate_random_state(6, 321);
+        auto actual = expected;
+
+        const auto controlled = ket::make_controlled_block_circuit(example_circuit_(), 6, {1, 5}, {3, 0, 2});
+        ket::simulate(controlled, expected);
+        ket::apply_controlled_dense_unitary(actual, unitary, {1, 5}, {3, 0, 2}, n_threads);
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+
+    SECTION("throws for invalid qubits")
+    {
+        auto state = ket::QuantumState {4};
+        REQUIRE_THROWS_AS(ket::apply_dense_unitary(state, unitary, {0, 1}), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::apply_dense_unitary(state, unitary, {0, 1, 4}), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::apply_dense_unitary(state, unitary, {0, 1, 1}), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::apply_controlled_dense_unitary(state, unitary, {1}, {0, 1, 2}), std::runtime_error);
+    }
+}
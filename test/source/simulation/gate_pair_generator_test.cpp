@@ -471,3 +471,61 @@ TEST_CASE("DoubleQubitGatePairGenerator set_state()")
 
     REQUIRE_THAT(partial_output, Catch::Matchers::RangeEquals(full_output_subset));
 }
+
+TEST_CASE("ControlledGatePairGenerator")
+{
+    SECTION("matches DoubleQubitGatePairGenerator with one control qubit")
+    {
+        const auto n_qubits = std::size_t {5};
+        const auto control_index = GENERATE(std::size_t {0}, std::size_t {2}, std::size_t {4});
+        const auto target_index = GENERATE(std::size_t {1}, std::size_t {3});
+
+        auto double_generator = ket::internal::DoubleQubitGatePairGenerator {control_index, target_index, n_qubits};
+        const auto expected = get_generated_index_pairs(double_generator);
+
+        const auto control_mask = ket::internal::pow_2_int(control_index);
+        auto controlled_generator = ket::internal::ControlledGatePairGenerator {target_index, control_mask, n_qubits};
+        const auto actual = get_generated_index_pairs(controlled_generator);
+
+        REQUIRE(controlled_generator.size() == num_pairs_for_double_qubit_gate(n_qubits));
+        REQUIRE_THAT(actual, Catch::Matchers::UnorderedRangeEquals(expected));
+    }
+
+    SECTION("yields the pairs where all the control qubits are 1")
+    {
+        // qubits 0 and 3 are the controls, and qubit 1 is the target
+        const auto n_qubits = std::size_t {4};
+        const auto control_mask = std::size_t {0b1001};
+
+        auto generator = ket::internal::ControlledGatePairGenerator {1, control_mask, n_qubits};
+        const auto actual = get_generated_index_pairs(generator);
+
+        // only qubit 2 is free
+        const auto expected = std::vector<IndexPair> {
+            {0b1001, 0b1011},
+            {0b1101, 0b1111},
+        };
+
+        REQUIRE_THAT(actual, Catch::Matchers::RangeEquals(expected));
+    }
+
+    SECTION("set_state()")
+    {
+        const auto n_qubits = std::size_t {6};
+        const auto control_mask = std::size_t {0b100100};
+
+        auto full_generator = ket::internal::ControlledGatePairGenerator {1, control_mask, n_qubits};
+        const auto full_output = get_generated_index_pairs(full_generator);
+
+        auto partial_generator = ket::internal::ControlledGatePairGenerator {1, control_mask, n_qubits};
+        partial_generator.set_state(3);
+        const auto partial_output = get_generated_index_pairs(partial_generator, 4);
+
+        const auto full_output_subset = std::vector<IndexPair> (
+            std::next(full_output.begin(), 3),
+            std::next(full_output.begin(), 7)
+        );
+
+        REQUIRE_THAT(partial_output, Catch::Matchers::RangeEquals(full_output_subset));
+    }
+}
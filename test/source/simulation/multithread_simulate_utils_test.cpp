@@ -79,3 +79,34 @@ TEST_CASE("partial_sum_pairs_()")
 
     REQUIRE_THAT(actual, Catch::Matchers::Equals(testcase.expected));
 }
+
+TEST_CASE("parallel_for_()")
+{
+    const auto n_work_items = GENERATE(std::size_t {0}, std::size_t {3}, std::size_t {100}, std::size_t {1001});
+    const auto n_threads = GENERATE(std::size_t {1}, std::size_t {2}, std::size_t {4}, std::size_t {7});
+
+    auto visits = std::vector<std::size_t>(n_work_items, 0);
+    auto thread_visits = std::vector<std::size_t>(n_threads, 0);
+
+    ket::internal::parallel_for_(n_work_items, n_threads, [&](const ket::internal::FlatIndexPair& block, std::size_t i_thread) {
+        ++thread_visits[i_thread];
+        for (auto i = block.i_lower; i < block.i_upper; ++i) {
+            ++visits[i];
+        }
+    });
+
+    // every work item is visited exactly once
+    REQUIRE_THAT(visits, Catch::Matchers::Equals(std::vector<std::size_t>(n_work_items, 1)));
+
+    // no thread index is used more than once
+    for (auto count : thread_visits) {
+        REQUIRE(count <= 1);
+    }
+}
+
+TEST_CASE("default_number_of_threads_()")
+{
+    REQUIRE(ket::internal::default_number_of_threads_(0) == 1);
+    REQUIRE(ket::internal::default_number_of_threads_(ket::internal::MINIMUM_WORK_ITEMS_PER_THREAD_ - 1) == 1);
+    REQUIRE(ket::internal::default_number_of_threads_(1UL << 30) >= 1);
+}
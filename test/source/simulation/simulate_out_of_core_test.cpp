@@ -0,0 +1,298 @@
+#include <cstddef>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/gates/common_u_gates.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/simulation/simulate_out_of_core.hpp"
+#include "kettle/state/disk_state.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+#include "kettle_internal/simulation/out_of_core_schedule.hpp"
+
+
+namespace
+{
+
+/*
+    A path in the temporary directory that is removed when the instance goes out of scope.
+*/
+class TemporaryFilepath_
+{
+public:
+    explicit TemporaryFilepath_(const std::string& filename)
+        : filepath_ {std::filesystem::temp_directory_path() / filename}
+    {}
+
+    TemporaryFilepath_(const TemporaryFilepath_&) = delete;
+    auto operator=(const TemporaryFilepath_&) -> TemporaryFilepath_& = delete;
+    TemporaryFilepath_(TemporaryFilepath_&&) = delete;
+    auto operator=(TemporaryFilepath_&&) -> TemporaryFilepath_& = delete;
+
+    ~TemporaryFilepath_()
+    {
+        std::filesystem::remove(filepath_);
+    }
+
+    [[nodiscard]]
+    auto path() const -> const std::filesystem::path&
+    {
+        return filepath_;
+    }
+
+private:
+    std::filesystem::path filepath_;
+};
+
+auto example_circuit_() -> ket::QuantumCircuit
+{
+    using PT = ket::PauliTerm;
+
+    auto circuit = ket::QuantumCircuit {5};
+    circuit.add_h_gate({0, 1, 2, 3, 4});
+    circuit.add_cx_gate(0, 4);
+    circuit.add_cx_gate(4, 1);
+    circuit.add_rx_gate(3, 0.25);
+    circuit.add_crz_gate(3, 2, -0.75);
+    circuit.add_cu_gate(ket::sx_gate(), 1, 3);
+    circuit.add_cp_gate(4, 3, 1.5);
+    circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::I, PT::Y, PT::Z, PT::X}}, 0.8);
+
+    auto body = ket::QuantumCircuit {5};
+    body.add_ry_gate(4, 0.3);
+    body.add_cx_gate(1, 0);
+    circuit.add_repeat_statement(3, body);
+
+    auto block = ket::QuantumCircuit {5};
+    block.add_y_gate(4);
+    block.add_cx_gate(3, 0);
+    circuit.add_controlled_block({1, 2}, block);
+
+    // a repeated body that needs more than one pass for most chunk sizes, with a repeat statement of its own
+    auto inner = ket::QuantumCircuit {5};
+    inner.add_rx_gate(2, 0.4);
+    inner.add_cz_gate(2, 4);
+
+    auto multi_pass_body = ket::QuantumCircuit {5};
+    multi_pass_body.add_h_gate(4);
+    multi_pass_body.add_cx_gate(4, 3);
+    multi_pass_body.add_repeat_statement(2, inner);
+    multi_pass_body.add_ry_gate(3, 0.6);
+    circuit.add_repeat_statement(4, multi_pass_body);
+
+    circuit.add_controlled_block({0}, multi_pass_body);
+
+    return circuit;
+}
+
+/*
+    The number of gates stored in `steps`, and the number of gates they apply once the loops and
+    repeated passes are run.
+*/
+struct GateCounts_
+{
+    std::size_t n_stored {0};
+    std::size_t n_applied {0};
+};
+
+auto count_gates_(const std::vector<ket::internal::OutOfCoreStep_>& steps) -> GateCounts_  // NOLINT(misc-no-recursion)
+{
+    namespace ki = ket::internal;
+
+    auto output = GateCounts_ {};
+
+    for (const auto& step : steps) {
+        if (const auto* pass = std::get_if<ki::OutOfCorePass_>(&step)) {
+            output.n_stored += pass->gates.size();
+            output.n_applied += pass->n_repetitions * pass->gates.size();
+        }
+        else {
+            const auto& loop = std::get<ki::OutOfCoreLoop_>(step);
+            const auto loop_counts = count_gates_(loop.steps);
+            output.n_stored += loop_counts.n_stored;
+            output.n_applied += loop.n_repetitions * loop_counts.n_applied;
+        }
+    }
+
+    return output;
+}
+
+}  // namespace
+
+
+TEST_CASE("simulate_out_of_core()")
+{
+    const auto filepath = TemporaryFilepath_ {"kettle_simulate_out_of_core_test.bin"};
+
+    SECTION("matches the in-memory simulation")
+    {
+        const auto n_chunk_qubits = GENERATE(std::size_t {1}, std::size_t {2}, std::size_t {3}, std::size_t {5});
+        const auto n_threads = GENERATE(std::size_t {1}, std::size_t {3});
+
+        const auto circuit = example_circuit_();
+
+        auto expected = ket::generate_random_state(5, 42);
+        auto disk_state = ket::DiskQuantumState {filepath.path(), expected, n_chunk_qubits};
+
+        ket::simulate(circuit, expected);
+        ket::simulate_out_of_core(circuit, disk_state, n_threads);
+
+        REQUIRE(ket::almost_eq(disk_state.to_state(), expected));
+    }
+
+    SECTION("throws for unsupported circuits")
+    {
+        auto disk_state = ket::DiskQuantumState {filepath.path(), 2, 1};
+
+        auto measured = ket::QuantumCircuit {2};
+        measured.add_h_gate(0);
+        measured.add_m_gate(0);
+        REQUIRE_THROWS_AS(ket::simulate_out_of_core(measured, disk_state), std::runtime_error);
+
+        auto branched = ket::QuantumCircuit {2};
+        branched.add_if_statement(0, ket::QuantumCircuit {2});
+        REQUIRE_THROWS_AS(ket::simulate_out_of_core(branched, disk_state), std::runtime_error);
+
+        REQUIRE_THROWS_AS(ket::simulate_out_of_core(ket::QuantumCircuit {3}, disk_state), std::runtime_error);
+    }
+}
+
+TEST_CASE("schedule_out_of_core_passes_()")
+{
+    namespace ki = ket::internal;
+
+    const auto gate = [](std::size_t target, std::size_t control_mask) {
+        return ki::OutOfCoreGate_ {.matrix=ket::x_gate(), .target=target, .control_mask=control_mask};
+    };
+
+    SECTION("gates on low qubits share a single pass")
+    {
+        const auto passes = ki::schedule_out_of_core_passes_({gate(0, 0), gate(1, 0b01), gate(0, 0b10)}, 2);
+
+        REQUIRE(passes.size() == 1);
+        REQUIRE(!passes[0].high_target);
+        REQUIRE(passes[0].gates.size() == 3);
+    }
+
+    SECTION("independent gates are moved into an earlier pass")
+    {
+        // the gate on qubit 1 does not interact with the gates on qubits 2 and 3
+        const auto passes = ki::schedule_out_of_core_passes_({gate(2, 0), gate(3, 0), gate(1, 0), gate(3, 0)}, 2);
+
+        REQUIRE(passes.size() == 2);
+        REQUIRE(passes[0].high_target == 2);
+        REQUIRE(passes[0].gates.size() == 2);
+        REQUIRE(passes[1].high_target == 3);
+        REQUIRE(passes[1].gates.size() == 2);
+    }
+
+    SECTION("gates never move ahead of gates on the same qubits")
+    {
+        const auto passes = ki::schedule_out_of_core_passes_({gate(2, 0), gate(3, 0), gate(0, 0b1000)}, 2);
+
+        REQUIRE(passes.size() == 2);
+        REQUIRE(passes[0].gates.size() == 1);
+        REQUIRE(passes[1].high_target == 3);
+        REQUIRE(passes[1].gates.size() == 2);
+    }
+}
+
+TEST_CASE("schedule_out_of_core_()")
+{
+    namespace ki = ket::internal;
+
+    SECTION("a repeated body that fits in a single pass is one pass applied many times")
+    {
+        auto body = ket::QuantumCircuit {4};
+        body.add_h_gate(3);
+        body.add_cx_gate(3, 0);
+
+        auto circuit = ket::QuantumCircuit {4};
+        circuit.add_x_gate(1);
+        circuit.add_repeat_statement(1'000, body);
+
+        const auto steps = ki::schedule_out_of_core_(circuit, 2);
+
+        REQUIRE(steps.size() == 2);
+        const auto& repeated = std::get<ki::OutOfCorePass_>(steps[1]);
+        REQUIRE(repeated.high_target == 3);
+        REQUIRE(repeated.n_repetitions == 1'000);
+        REQUIRE(repeated.gates.size() == 2);
+    }
+
+    SECTION("nested repeat statements are not unrolled")
+    {
+        auto inner = ket::QuantumCircuit {4};
+        inner.add_h_gate(2);
+
+        auto body = ket::QuantumCircuit {4};
+        body.add_h_gate(3);
+        body.add_repeat_statement(5, inner);
+        body.add_cx_gate(3, 2);
+
+        auto circuit = ket::QuantumCircuit {4};
+        circuit.add_repeat_statement(7, body);
+
+        const auto steps = ki::schedule_out_of_core_(circuit, 2);
+        const auto counts = count_gates_(steps);
+
+        REQUIRE(steps.size() == 1);
+        REQUIRE(std::get<ki::OutOfCoreLoop_>(steps[0]).n_repetitions == 7);
+        REQUIRE(counts.n_stored == 3);
+        REQUIRE(counts.n_applied == 7 * (1 + 5 + 1));
+    }
+
+    SECTION("a huge repeat of many high-target gates only stores the gates of a single repetition")
+    {
+        // every gate targets a high qubit that the next gate depends on, so each one needs its own pass
+        constexpr auto n_body_gates = std::size_t {1'000};
+        constexpr auto n_repetitions = std::size_t {1'000'000'000'000};
+
+        auto body = ket::QuantumCircuit {8};
+        for (std::size_t i {0}; i < n_body_gates; ++i) {
+            const auto target = 4 + (i % 4);
+            const auto control = 4 + ((i + 1) % 4);
+            body.add_cx_gate(control, target);
+        }
+
+        auto circuit = ket::QuantumCircuit {8};
+        circuit.add_repeat_statement(n_repetitions, body);
+
+        const auto steps = ki::schedule_out_of_core_(circuit, 4);
+
+        const auto counts = count_gates_(steps);
+        REQUIRE(counts.n_stored == n_body_gates);
+        REQUIRE(counts.n_applied == n_repetitions * n_body_gates);
+    }
+}
+
+TEST_CASE("schedule_out_of_core_passes_() with a pass for every gate")
+{
+    namespace ki = ket::internal;
+
+    // each gate targets a different high qubit than the gate before it, and is controlled by the
+    // qubit that gate targets; so no two gates can share a pass, and sweeping through the remaining
+    // gates once per pass would take a quadratic time
+    constexpr auto n_gates = std::size_t {200'000};
+
+    auto gates = std::vector<ki::OutOfCoreGate_> {};
+    gates.reserve(n_gates);
+    for (std::size_t i {0}; i < n_gates; ++i) {
+        const auto target = 4 + (i % 4);
+        const auto control = 4 + ((i + 3) % 4);
+        gates.push_back({.matrix=ket::x_gate(), .target=target, .control_mask=std::size_t {1} << control});
+    }
+
+    const auto passes = ki::schedule_out_of_core_passes_(gates, 4);
+
+    REQUIRE(passes.size() == n_gates);
+}
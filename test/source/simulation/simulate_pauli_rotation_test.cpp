@@ -0,0 +1,259 @@
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "kettle/circuit/circuit.hpp"
+#include "kettle/circuit_operations/collapse_pauli_rotation_gadgets.hpp"
+#include "kettle/circuit_operations/compare_circuits.hpp"
+#include "kettle/circuit_operations/make_controlled_circuit.hpp"
+#include "kettle/circuit_operations/transpile_to_primitive.hpp"
+#include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/simulation/simulate.hpp"
+#include "kettle/simulation/simulate_pauli.hpp"
+#include "kettle/state/random.hpp"
+#include "kettle/state/state.hpp"
+
+
+namespace
+{
+
+auto random_pauli_string_(std::size_t n_qubits, ket::PauliPhase phase, std::mt19937& prng) -> ket::SparsePauliString
+{
+    auto term_dist = std::uniform_int_distribution<int> {0, 3};
+
+    auto pauli_string = ket::SparsePauliString {n_qubits, phase};
+    while (pauli_string.size() == 0) {
+        for (std::size_t i {0}; i < n_qubits; ++i) {
+            const auto term = static_cast<ket::PauliTerm>(term_dist(prng));
+            if (term != ket::PauliTerm::I) {
+                pauli_string.overwrite(i, term);
+            }
+        }
+    }
+
+    return pauli_string;
+}
+
+/*
+    Calculates exp(-i theta P / 2)|psi> = cos(theta / 2)|psi> - i sin(theta / 2) P|psi> directly.
+*/
+auto expected_rotated_state_(
+    const ket::SparsePauliString& pauli_string,
+    double theta,
+    const ket::QuantumState& state
+) -> ket::QuantumState
+{
+    auto pauli_state = state;
+    ket::simulate(pauli_string, pauli_state);
+
+    // `simulate()` for a Pauli string does not apply the phase of the string
+    const auto sign = (pauli_string.phase() == ket::PauliPhase::MINUS_ONE) ? -1.0 : 1.0;
+    const auto mixing = std::complex<double> {0.0, -sign * std::sin(theta / 2.0)};
+
+    auto amplitudes = std::vector<std::complex<double>> {};
+    for (std::size_t i {0}; i < state.n_states(); ++i) {
+        amplitudes.push_back((std::cos(theta / 2.0) * state[i]) + (mixing * pauli_state[i]));
+    }
+
+    return ket::QuantumState {amplitudes};
+}
+
+}  // namespace
+
+
+TEST_CASE("simulate PAULI_ROT gate")
+{
+    using PT = ket::PauliTerm;
+
+    SECTION("single-qubit strings match the RX, RY, and RZ gates")
+    {
+        const auto theta = 0.7234;
+        const auto [term, target] = GENERATE(
+            std::pair {PT::X, std::size_t {0}},
+            std::pair {PT::Y, std::size_t {1}},
+            std::pair {PT::Z, std::size_t {2}}
+        );
+
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_pauli_rotation_gate(ket::SparsePauliString {{{target, term}}, 3}, theta);
+
+        auto expected_circuit = ket::QuantumCircuit {3};
+        if (term == PT::X) {
+            expected_circuit.add_rx_gate(target, theta);
+        }
+        else if (term == PT::Y) {
+            expected_circuit.add_ry_gate(target, theta);
+        }
+        else {
+            expected_circuit.add_rz_gate(target, theta);
+        }
+
+        auto state = ket::generate_random_state(3, 12345);
+        auto expected = state;
+
+        ket::simulate(circuit, state);
+        ket::simulate(expected_circuit, expected);
+
+        REQUIRE(ket::almost_eq(state, expected));
+    }
+
+    SECTION("random strings match cos(theta / 2) I - i sin(theta / 2) P")
+    {
+        auto prng = std::mt19937 {42};
+        auto angle_dist = std::uniform_real_distribution<double> {-2.0 * std::numbers::pi, 2.0 * std::numbers::pi};
+
+        const auto n_qubits = GENERATE(std::size_t {1}, std::size_t {4}, std::size_t {7});
+        const auto phase = GENERATE(ket::PauliPhase::PLUS_ONE, ket::PauliPhase::MINUS_ONE);
+
+        for (std::size_t i_trial {0}; i_trial < 10; ++i_trial) {
+            const auto pauli_string = random_pauli_string_(n_qubits, phase, prng);
+            const auto theta = angle_dist(prng);
+
+            auto circuit = ket::QuantumCircuit {n_qubits};
+            circuit.add_pauli_rotation_gate(pauli_string, theta);
+
+            auto state = ket::generate_random_state(n_qubits, prng);
+            const auto expected = expected_rotated_state_(pauli_string, theta, state);
+            ket::simulate(circuit, state);
+
+            REQUIRE(ket::almost_eq(state, expected));
+        }
+    }
+
+    SECTION("matches the gadget of primitive gates from transpile_to_primitive()")
+    {
+        auto prng = std::mt19937 {314};
+        const auto n_qubits = std::size_t {5};
+        const auto phase = GENERATE(ket::PauliPhase::PLUS_ONE, ket::PauliPhase::MINUS_ONE);
+
+        for (std::size_t i_trial {0}; i_trial < 10; ++i_trial) {
+            auto circuit = ket::QuantumCircuit {n_qubits};
+            circuit.add_pauli_rotation_gate(random_pauli_string_(n_qubits, phase, prng), 1.234);
+            circuit.add_pauli_rotation_gate(random_pauli_string_(n_qubits, phase, prng), -0.345);
+
+            const auto transpiled = ket::transpile_to_primitive(circuit);
+
+            auto state = ket::generate_random_state(n_qubits, prng);
+            auto expected = state;
+
+            ket::simulate(circuit, state);
+            ket::simulate(transpiled, expected);
+
+            REQUIRE(ket::almost_eq(state, expected));
+        }
+    }
+
+    SECTION("parameterized angle")
+    {
+        const auto pauli_string = ket::SparsePauliString {{PT::X, PT::Y, PT::I, PT::Z}};
+        const auto theta = 0.4321;
+
+        auto circuit = ket::QuantumCircuit {4};
+        const auto id = circuit.add_pauli_rotation_gate(pauli_string, 0.0, ket::param::parameterized {});
+        circuit.add_pauli_rotation_gate(pauli_string, id);
+        circuit.set_parameter_value(id, theta);
+
+        auto expected_circuit = ket::QuantumCircuit {4};
+        expected_circuit.add_pauli_rotation_gate(pauli_string, 2.0 * theta);
+
+        auto state = ket::generate_random_state(4, 271);
+        auto expected = state;
+
+        ket::simulate(circuit, state);
+        ket::simulate(expected_circuit, expected);
+
+        REQUIRE(ket::almost_eq(state, expected));
+    }
+
+    SECTION("controlled Pauli rotation")
+    {
+        const auto pauli_string = ket::SparsePauliString {{PT::Y, PT::X, PT::Z}, ket::PauliPhase::MINUS_ONE};
+        const auto theta = 0.987;
+
+        auto subcircuit = ket::QuantumCircuit {3};
+        subcircuit.add_pauli_rotation_gate(pauli_string, theta);
+        const auto circuit = ket::make_controlled_circuit(subcircuit, 4, 0, {1, 2, 3});
+
+        auto expected_subcircuit = ket::transpile_to_primitive(subcircuit);
+        const auto expected_circuit = ket::make_controlled_circuit(expected_subcircuit, 4, 0, {1, 2, 3});
+
+        auto state = ket::generate_random_state(4, 161);
+        auto expected = state;
+
+        ket::simulate(circuit, state);
+        ket::simulate(expected_circuit, expected);
+
+        REQUIRE(ket::almost_eq(state, expected));
+    }
+
+    SECTION("invalid Pauli strings throw")
+    {
+        auto circuit = ket::QuantumCircuit {3};
+
+        REQUIRE_THROWS_AS(circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::Z}}, 0.1), std::runtime_error);
+        REQUIRE_THROWS_AS(circuit.add_pauli_rotation_gate(ket::SparsePauliString {3}, 0.1), std::runtime_error);
+        REQUIRE_THROWS_AS(circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::I, PT::I, PT::I}}, 0.1), std::runtime_error);
+        REQUIRE_THROWS_AS(
+            circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::Z, PT::Y}, ket::PauliPhase::PLUS_EYE}, 0.1),
+            std::runtime_error
+        );
+    }
+}
+
+
+TEST_CASE("collapse_pauli_rotation_gadgets()")
+{
+    using PT = ket::PauliTerm;
+
+    SECTION("transpiled gadgets are collapsed back into PAULI_ROT gates")
+    {
+        auto circuit = ket::QuantumCircuit {5};
+        circuit.add_h_gate(0);
+        circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::X, PT::I, PT::Y, PT::Z, PT::I}}, 0.5);
+        circuit.add_pauli_rotation_gate(ket::SparsePauliString {{PT::I, PT::Z, PT::I, PT::I, PT::Z}}, -1.5);
+        circuit.add_h_gate(2);
+
+        const auto collapsed = ket::collapse_pauli_rotation_gadgets(ket::transpile_to_primitive(circuit));
+
+        REQUIRE(collapsed.n_circuit_elements() == 4);
+        REQUIRE(ket::almost_eq(collapsed, circuit));
+    }
+
+    SECTION("incomplete gadgets are left alone")
+    {
+        auto circuit = ket::QuantumCircuit {3};
+        circuit.add_h_gate(0);
+        circuit.add_cx_gate(0, 1);
+        circuit.add_rz_gate(1, 0.25);
+        circuit.add_cx_gate(0, 1);
+
+        // the H gate on qubit 0 is never undone, so only the ZZ rotation is recognized
+        const auto collapsed = ket::collapse_pauli_rotation_gadgets(circuit);
+
+        auto expected = ket::QuantumCircuit {3};
+        expected.add_h_gate(0);
+        expected.add_pauli_rotation_gate(ket::SparsePauliString {{PT::Z, PT::Z, PT::I}}, 0.25);
+
+        REQUIRE(ket::almost_eq(collapsed, expected));
+    }
+
+    SECTION("single RZ gates are left alone")
+    {
+        auto circuit = ket::QuantumCircuit {2};
+        circuit.add_h_gate(0);
+        circuit.add_rz_gate(0, 0.25);
+        circuit.add_h_gate(0);
+
+        const auto collapsed = ket::collapse_pauli_rotation_gadgets(circuit);
+
+        REQUIRE(collapsed.n_circuit_elements() == 3);
+        REQUIRE(ket::almost_eq(collapsed, circuit));
+    }
+}
@@ -1,9 +1,16 @@
+#include <cstddef>
+#include <random>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
+#include "kettle/circuit/circuit.hpp"
 #include "kettle/operator/pauli/sparse_pauli_string.hpp"
+#include "kettle/simulation/simulate.hpp"
 #include "kettle/simulation/simulate_pauli.hpp"
+#include "kettle/state/random.hpp"
 #include "kettle/state/state.hpp"
 
 
@@ -86,3 +93,45 @@ TEST_CASE("simulate pauli string")
         REQUIRE(ket::almost_eq(statevector, expected));
     }
 }
+
+TEST_CASE("simulate pauli string matches simulating the equivalent circuit")
+{
+    using PT = ket::PauliTerm;
+
+    // the larger state is big enough to be split among several threads
+    const auto n_qubits = GENERATE(std::size_t {1}, std::size_t {4}, std::size_t {17});
+
+    auto prng = std::mt19937 {std::mt19937::default_seed};
+    auto term_distrib = std::uniform_int_distribution<int> {0, 3};
+
+    for (std::size_t i_trial {0}; i_trial < 5; ++i_trial) {
+        auto circuit = ket::QuantumCircuit {n_qubits};
+        auto terms = std::vector<PT> {};
+
+        for (std::size_t i_qubit {0}; i_qubit < n_qubits; ++i_qubit) {
+            const auto term = static_cast<PT>(term_distrib(prng));
+            terms.push_back(term);
+
+            if (term == PT::X) {
+                circuit.add_x_gate(i_qubit);
+            }
+            else if (term == PT::Y) {
+                circuit.add_y_gate(i_qubit);
+            }
+            else if (term == PT::Z) {
+                circuit.add_z_gate(i_qubit);
+            }
+        }
+
+        // the phase of the Pauli string is not applied during the simulation
+        const auto pauli_string = ket::SparsePauliString {terms, ket::PauliPhase::MINUS_EYE};
+
+        auto actual = ket::generate_random_state(n_qubits, prng);
+        auto expected = actual;
+
+        ket::simulate(pauli_string, actual);
+        ket::simulate(circuit, expected);
+
+        REQUIRE(ket::almost_eq(actual, expected));
+    }
+}
@@ -0,0 +1,140 @@
+#include <complex>
+#include <cstddef>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <kettle/state/disk_state.hpp>
+#include <kettle/state/random.hpp>
+#include <kettle/state/state.hpp>
+
+
+namespace
+{
+
+/*
+    A path in the temporary directory that is removed when the instance goes out of scope.
+*/
+class TemporaryFilepath_
+{
+public:
+    explicit TemporaryFilepath_(const std::string& filename)
+        : filepath_ {std::filesystem::temp_directory_path() / filename}
+    {}
+
+    TemporaryFilepath_(const TemporaryFilepath_&) = delete;
+    auto operator=(const TemporaryFilepath_&) -> TemporaryFilepath_& = delete;
+    TemporaryFilepath_(TemporaryFilepath_&&) = delete;
+    auto operator=(TemporaryFilepath_&&) -> TemporaryFilepath_& = delete;
+
+    ~TemporaryFilepath_()
+    {
+        std::filesystem::remove(filepath_);
+    }
+
+    [[nodiscard]]
+    auto path() const -> const std::filesystem::path&
+    {
+        return filepath_;
+    }
+
+private:
+    std::filesystem::path filepath_;
+};
+
+}  // namespace
+
+
+TEST_CASE("DiskQuantumState")
+{
+    const auto filepath = TemporaryFilepath_ {"kettle_disk_state_test.bin"};
+
+    SECTION("starts in the all-zero computational basis state")
+    {
+        const auto disk_state = ket::DiskQuantumState {filepath.path(), 4, 2};
+        REQUIRE(disk_state.n_qubits() == 4);
+        REQUIRE(disk_state.n_states() == 16);
+        REQUIRE(disk_state.n_chunk_qubits() == 2);
+        REQUIRE(disk_state.n_chunk_states() == 4);
+        REQUIRE(disk_state.n_chunks() == 4);
+        REQUIRE(std::filesystem::file_size(filepath.path()) == 16 * 16);
+
+        REQUIRE(ket::almost_eq(disk_state.to_state(), ket::QuantumState {4}));
+    }
+
+    SECTION("round trip through a QuantumState")
+    {
+        const auto n_chunk_qubits = GENERATE(std::size_t {1}, std::size_t {3}, std::size_t {5});
+        const auto state = ket::generate_random_state(5, 42);
+
+        const auto disk_state = ket::DiskQuantumState {filepath.path(), state, n_chunk_qubits};
+
+        REQUIRE(ket::almost_eq(disk_state.to_state(), state, 1.0e-24));
+    }
+
+    SECTION("reads and writes chunks")
+    {
+        const auto state = ket::generate_random_state(4, 123);
+        auto disk_state = ket::DiskQuantumState {filepath.path(), state, 2};
+
+        auto chunk = std::vector<std::complex<double>>(4);
+        disk_state.read_chunk(2, chunk);
+        for (std::size_t i {0}; i < 4; ++i) {
+            REQUIRE(chunk[i] == state[8 + i]);
+        }
+
+        // swap the first and third chunks
+        auto other = std::vector<std::complex<double>>(4);
+        disk_state.read_chunk(0, other);
+        disk_state.write_chunk(0, chunk);
+        disk_state.write_chunk(2, other);
+
+        const auto swapped = disk_state.to_state();
+        for (std::size_t i {0}; i < 4; ++i) {
+            REQUIRE(swapped[i] == state[8 + i]);
+            REQUIRE(swapped[4 + i] == state[4 + i]);
+            REQUIRE(swapped[8 + i] == state[i]);
+        }
+    }
+
+    SECTION("opens an existing file")
+    {
+        const auto state = ket::generate_random_state(6, 321);
+        {
+            const auto disk_state = ket::DiskQuantumState {filepath.path(), state, 3};
+        }
+
+        const auto reopened = ket::DiskQuantumState {filepath.path(), 4};
+        REQUIRE(reopened.n_qubits() == 6);
+        REQUIRE(reopened.n_chunks() == 4);
+        REQUIRE(ket::almost_eq(reopened.to_state(), state, 1.0e-24));
+    }
+
+    SECTION("move construction")
+    {
+        auto disk_state = ket::DiskQuantumState {filepath.path(), 3, 1};
+        const auto moved = std::move(disk_state);
+
+        REQUIRE(ket::almost_eq(moved.to_state(), ket::QuantumState {3}));
+    }
+
+    SECTION("throws for invalid chunk sizes and indices")
+    {
+        REQUIRE_THROWS_AS(ket::DiskQuantumState(filepath.path(), 3, 0), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::DiskQuantumState(filepath.path(), 3, 4), std::runtime_error);
+        REQUIRE_THROWS_AS(ket::DiskQuantumState(filepath.path(), 0, 1), std::runtime_error);
+
+        auto disk_state = ket::DiskQuantumState {filepath.path(), 3, 2};
+        auto chunk = std::vector<std::complex<double>>(4);
+        REQUIRE_THROWS_AS(disk_state.read_chunk(2, chunk), std::runtime_error);
+
+        auto wrong_size = std::vector<std::complex<double>>(2);
+        REQUIRE_THROWS_AS(disk_state.read_chunk(0, wrong_size), std::runtime_error);
+        REQUIRE_THROWS_AS(disk_state.write_chunk(0, wrong_size), std::runtime_error);
+    }
+}